@@ -1,26 +1,172 @@
 #pragma once
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <boost/functional/hash.hpp>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+TRAJOPT_IGNORE_WARNINGS_POP
 
-template <class KeyT, class ValueT, unsigned bufsize>
-class Cache
+namespace trajopt
+{
+/** @brief Hash of all elements of a sequence, e.g. a vector of joint values */
+template <class KeyT>
+struct RangeHash
+{
+  std::size_t operator()(const KeyT& key) const { return boost::hash_range(key.begin(), key.end()); }
+};
+
+/**
+ * @brief Thread safe least recently used cache.
+ *
+ * The hash only selects the bucket, keys are always compared exactly. Values are stored as shared immutable handles,
+ * so a lookup never copies them and a handle stays valid after its entry was evicted.
+ */
+template <class KeyT, class ValueT, class HashT = std::hash<KeyT>>
+class LRUCache
 {
 public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  using ValueConstPtr = std::shared_ptr<const ValueT>;
+
+  /** @param capacity The number of entries kept, a capacity of zero disables the cache */
+  explicit LRUCache(std::size_t capacity = 10) : capacity_(capacity) {}
+  ~LRUCache() = default;
+  LRUCache(const LRUCache& other) { *this = other; }
+  LRUCache& operator=(const LRUCache& other)
+  {
+    if (this == &other)
+      return *this;
+
+    std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+    std::unique_lock<std::mutex> other_lock(other.mutex_, std::defer_lock);
+    std::lock(lock, other_lock);
+    capacity_ = other.capacity_;
+    n_hits_ = other.n_hits_;
+    n_misses_ = other.n_misses_;
+    lru_.clear();
+    index_.clear();
+    for (auto it = other.lru_.rbegin(); it != other.lru_.rend(); ++it)
+      insert(**it, other.index_.at(**it).value);
+    return *this;
+  }
+
+  /**
+   * @brief Look up the value stored for key and mark it as the most recently used entry
+   * @return The value or nullptr if there is none
+   */
+  ValueConstPtr get(const KeyT& key)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end())
+    {
+      ++n_misses_;
+      return nullptr;
+    }
+    ++n_hits_;
+    lru_.splice(lru_.begin(), lru_, it->second.position);
+    return it->second.value;
+  }
+
+  /**
+   * @brief Store value for key, replacing any value stored before and evicting the least recently used entry if the
+   * cache is full
+   * @return The handle to the stored value
+   */
+  ValueConstPtr put(KeyT key, ValueConstPtr value)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    insert(std::move(key), value);
+    return value;
+  }
+  ValueConstPtr put(KeyT key, ValueT value)
+  {
+    return put(std::move(key), std::make_shared<const ValueT>(std::move(value)));
+  }
+
+  /** @brief Change the number of entries kept, evicting the least recently used ones if there are more */
+  void setCapacity(std::size_t capacity)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacity;
+    evict();
+  }
+  std::size_t getCapacity() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return capacity_;
+  }
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index_.size();
+  }
+  /** @brief Remove all entries, the statistics are kept */
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+  }
+
+  /** @brief Number of lookups which found a value */
+  long getNumHits() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return n_hits_;
+  }
+  /** @brief Number of lookups which did not find a value */
+  long getNumMisses() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return n_misses_;
+  }
 
-  KeyT keybuf[bufsize];    // circular buffer
-  ValueT valbuf[bufsize];  // circular buffer
-  int m_i{ 0 };
-  Cache() { memset(keybuf, 666, sizeof(keybuf)); }
-  void put(const KeyT& key, const ValueT& value)
+private:
+  struct Entry
   {
-    keybuf[m_i] = key;
-    valbuf[m_i] = value;
-    ++m_i;
-    if (static_cast<unsigned>(m_i) == bufsize)
-      m_i = 0;
+    ValueConstPtr value;
+    /** @brief Position in lru_ */
+    typename std::list<const KeyT*>::iterator position;
+  };
+
+  mutable std::mutex mutex_;
+  std::size_t capacity_;
+  long n_hits_{ 0 };
+  long n_misses_{ 0 };
+  /** @brief The keys of index_ (which are stable across rehashing), most recently used first */
+  std::list<const KeyT*> lru_;
+  std::unordered_map<KeyT, Entry, HashT> index_;
+
+  void insert(KeyT key, const ValueConstPtr& value)
+  {
+    if (capacity_ == 0)
+      return;
+
+    auto it = index_.find(key);
+    if (it != index_.end())
+    {
+      it->second.value = value;
+      lru_.splice(lru_.begin(), lru_, it->second.position);
+      return;
+    }
+
+    it = index_.emplace(std::move(key), Entry{ value, lru_.end() }).first;
+    lru_.push_front(&it->first);
+    it->second.position = lru_.begin();
+    evict();
   }
-  ValueT* get(const KeyT& key)
+
+  void evict()
   {
-    KeyT* it = std::find(&keybuf[0], &keybuf[0] + bufsize, key);
-    return (it == &keybuf[0] + bufsize) ? nullptr : &valbuf[it - &keybuf[0]];
+    while (index_.size() > capacity_)
+    {
+      auto it = index_.find(*lru_.back());
+      lru_.pop_back();
+      index_.erase(it);
+    }
   }
 };
+}  // namespace trajopt
@@ -4,10 +4,21 @@
 #include <tesseract_kinematics/core/forward_kinematics.h>
 #include <trajopt/cache.hxx>
 #include <trajopt/common.hpp>
+#include <trajopt/contact_manager_pool.hpp>
+#include <trajopt/kinematics_cache.hpp>
 #include <trajopt_sco/modeling.hpp>
 
+namespace util
+{
+class ThreadPool;
+}
+
 namespace trajopt
 {
+class LinkMotionBounds;
+class StaticEnvironmentSDF;
+class SphereRobotModel;
+
 /**
  * @brief This contains the different types of expression evaluators used when performing continuous collision checking.
  */
@@ -70,6 +81,51 @@ struct GradientResults
   const Eigen::Vector2d& data;
 };
 
+/** @brief The contact results of a single collision check, shared between the cache and its users */
+struct CollisionCacheData
+{
+  using Ptr = std::shared_ptr<CollisionCacheData>;
+  using ConstPtr = std::shared_ptr<const CollisionCacheData>;
+
+  tesseract_collision::ContactResultMap contact_results_map;
+  tesseract_collision::ContactResultVector contact_results_vector;
+};
+
+/** @brief Collision results keyed by the values of the variables of a collision evaluator */
+using CollisionCache = LRUCache<DblVec, CollisionCacheData, RangeHash<DblVec>>;
+
+/** @brief Settings of the incremental collision checks of a collision evaluator, see setIncrementalCheck */
+struct IncrementalCollisionConfig
+{
+  /** @brief Largest change of any variable from the reference for which the distances are predicted, zero disables */
+  double max_step{ 0 };
+
+  /** @brief The distances are only predicted while all of them stay this far beyond their safety margin */
+  double prediction_margin{ 0.05 };
+
+  /** @brief Run the exact check for every prediction as well, record the prediction error and use the exact results */
+  bool validate{ false };
+};
+
+/** @brief Statistics of the incremental collision checks of a collision evaluator */
+struct IncrementalCollisionStats
+{
+  /** @brief Number of distance evaluations which ran the exact check */
+  long num_exact{ 0 };
+
+  /** @brief Number of distance evaluations which were predicted */
+  long num_predicted{ 0 };
+
+  /** @brief Number of predictions which were compared to the exact check */
+  long num_validated{ 0 };
+
+  /** @brief Number of validated predictions for which the exact check found a link pair within its safety margin */
+  long num_missed{ 0 };
+
+  /** @brief Largest error of the predicted distance of a link pair reported by both */
+  double max_distance_error{ 0 };
+};
+
 /**
  * @brief Base class for collision evaluators containing function that are commonly used between them.
  *
@@ -92,7 +148,9 @@ struct CollisionEvaluator
                      tesseract_collision::ContactTestType contact_test_type,
                      double longest_valid_segment_length,
                      double safety_margin_buffer,
-                     bool dynamic_environment = false);
+                     bool dynamic_environment = false,
+                     ContactManagerPool::Ptr contact_manager_pool = nullptr,
+                     KinematicsCache::Ptr kinematics_cache = nullptr);
   virtual ~CollisionEvaluator() = default;
   CollisionEvaluator(const CollisionEvaluator&) = default;
   CollisionEvaluator& operator=(const CollisionEvaluator&) = default;
@@ -146,6 +204,14 @@ struct CollisionEvaluator
                       tesseract_collision::ContactResultMap& dist_map,
                       tesseract_collision::ContactResultVector& dist_vector);
 
+  /**
+   * @brief This function checks to see if results are cached for the values of the evaluator's variables in x. If not
+   * it calls CalcCollisions and caches the results with these values as the key.
+   * @param x Optimizer variables
+   * @return Shared handle to the cached results, which must not be modified
+   */
+  CollisionCacheData::ConstPtr GetCollisionsCached(const DblVec& x);
+
   /**
    * @brief This function checks to see if results are cached for input variable x. If not it calls CalcCollisions and
    * caches the results vector with x as the key.
@@ -160,6 +226,18 @@ struct CollisionEvaluator
    */
   void GetCollisionsCached(const DblVec& x, tesseract_collision::ContactResultMap&);
 
+  /**
+   * @brief Same as GetCollisionsCached, but the distances are predicted to first order when incremental checks are
+   * enabled and x is close to the last exactly checked values (see setIncrementalCheck). Predicted distances belong to
+   * the contacts of the reference, which are returned unchanged, so they are meant for evaluating costs and
+   * constraints, not for building their convex approximations. When validating the predictions, the exact results are
+   * returned.
+   * @param x Optimizer variables
+   * @param dists The returned distances of the contacts in contact_results_vector of the results
+   * @return Shared handle to the results, which must not be modified
+   */
+  CollisionCacheData::ConstPtr GetCollisionsEstimated(const DblVec& x, DblVec& dists);
+
   /**
    * @brief Extracts the gradient information based on the contact results
    * @param dofvals The joint values
@@ -215,7 +293,75 @@ struct CollisionEvaluator
    * @return Safety margin information
    */
   const SafetyMarginData::ConstPtr getSafetyMarginData() const { return safety_margin_data_; }
-  Cache<size_t, std::pair<tesseract_collision::ContactResultMap, tesseract_collision::ContactResultVector>, 10> m_cache;
+
+  /** @brief Get the buffer added to the safety margins, contacts within it are reported but do not add costs */
+  double getSafetyMarginBuffer() const { return safety_margin_buffer_; }
+
+  /**
+   * @brief True if the evaluator may check at the same time as other evaluators, see sco::Cost::isThreadSafe
+   *
+   * The evaluators compute the kinematics through the KinematicsCache and lease contact managers and state solvers
+   * from the ContactManagerPool, which are safe to share. Only a dynamic environment is used directly.
+   */
+  bool isThreadSafe() const { return !dynamic_environment_; }
+
+  /**
+   * @brief Enable the adaptive subdivision of the segments checked by the evaluator
+   *
+   * Instead of checking every interpolated state (or casted sub-segment), the clearance found by a check is used
+   * together with bounds on the motion of the active links to skip the following ones which provably cannot be in
+   * contact (conservative advancement). The contact results are the same as without it. It is not available with
+   * ContactTestType::FIRST, since contacts beyond the contact distance could hide the ones of interest.
+   * @param margin Clearance beyond the contact distance which is measured by a check. Larger ones skip more states but
+   * make every check more expensive. Zero disables the adaptive subdivision.
+   * @param motion_bounds The motion bounds of the active links, calculated if not provided
+   */
+  void setAdaptiveSubdivision(double margin, std::shared_ptr<const LinkMotionBounds> motion_bounds = nullptr);
+
+  /**
+   * @brief Enable the incremental collision checks of the evaluator
+   *
+   * The results of the last exact check are kept as reference together with the gradients of their distances. While
+   * no variable moved more than max_step from the reference, e.g. for the trial steps inside the trust region, the
+   * distances are predicted to first order instead of running the narrow phase. The exact check is only run if a
+   * predicted distance gets within prediction_margin of its safety margin. Link pairs which were not reported at the
+   * reference, i.e. which were farther apart than the safety margin buffer, are assumed to stay out of contact, so the
+   * exact check is run as well if the motion bounds allow the active links to move relative to each other or to the
+   * environment by the buffer. It is not available for the weighted sum expression types or if the motion of the
+   * active links cannot be bounded.
+   * @param config The settings, a max_step of zero disables the incremental checks
+   * @param motion_bounds The motion bounds of the active links, calculated if not provided
+   */
+  void setIncrementalCheck(const IncrementalCollisionConfig& config,
+                           std::shared_ptr<const LinkMotionBounds> motion_bounds = nullptr);
+
+  /** @brief Get the settings of the incremental collision checks */
+  const IncrementalCollisionConfig& getIncrementalCheck() const { return incremental_config_; }
+
+  /** @brief Get the statistics of the incremental collision checks, including the validated prediction errors */
+  const IncrementalCollisionStats& getIncrementalStats() const { return incremental_stats_; }
+
+  /** @brief Get the number of narrow phase checks, i.e. calls of contactTest, run by the evaluator so far */
+  long getNumContactTests() const { return num_contact_tests_; }
+
+  /**
+   * @brief Inform the evaluator of the trust region size of the optimizer, see CollisionTrustRegionCallback
+   *
+   * Evaluators which approximate the geometry of the robot switch to exact checks once it is small. The results for
+   * the same variables change then, so the terms have to be evaluated again at the current iterate.
+   * @return True if the evaluator switched its geometry
+   */
+  virtual bool setTrustRegionSize(double /*trust_box_size*/) { return false; }
+
+  /**
+   * @brief Switch evaluators which approximate the geometry of the robot to exact checks regardless of the trust region
+   * size, e.g. before the optimizer reports convergence
+   * @return True if the evaluator switched its geometry
+   */
+  virtual bool useExactGeometry() { return false; }
+
+  /** @brief Collision results of the most recently used variable values, see GetCollisionsCached */
+  CollisionCache m_cache;
 
 protected:
   tesseract_kinematics::ForwardKinematics::ConstPtr manip_;
@@ -226,7 +372,6 @@ protected:
   double safety_margin_buffer_;
   tesseract_collision::ContactTestType contact_test_type_;
   double longest_valid_segment_length_;
-  tesseract_environment::StateSolver::Ptr state_solver_;
   sco::VarVector vars0_;
   sco::VarVector vars1_;
   CollisionExpressionEvaluatorType evaluator_type_;
@@ -234,6 +379,104 @@ protected:
                                                      const Eigen::Ref<const Eigen::VectorXd>& joint_values)>
       get_state_fn_;
   bool dynamic_environment_;
+  /** @brief Provides the contact managers and state solvers, which may be shared with other evaluators */
+  ContactManagerPool::Ptr contact_manager_pool_;
+  /** @brief The settings of the contact managers leased from contact_manager_pool_ */
+  ContactManagerConfig contact_manager_config_;
+  /** @brief Caches the Jacobians of manip_, which may be shared with other terms */
+  KinematicsCache::Ptr kinematics_cache_;
+  /** @brief The kinematic links of manip_ which the active links are attached to */
+  std::vector<std::string> active_kin_links_;
+  /** @brief For each active link the index of its kinematic link in active_kin_links_ */
+  std::vector<std::size_t> active_link_kin_index_;
+  /** @brief For each active link its transform relative to its kinematic link */
+  tesseract_common::VectorIsometry3d active_link_offsets_;
+  /** @brief The indices of the active links ordered by their kinematic link */
+  std::vector<std::size_t> active_link_order_;
+  /** @brief Indicates if the active link transforms are calculated from manip_ rather than by a state solver */
+  bool use_active_link_kinematics_{ false };
+  /** @brief The clearance beyond the contact distance measured by a check, zero if not subdividing adaptively */
+  double adaptive_subdivision_margin_{ 0 };
+  /** @brief Bounds on the motion of the active links, used by the adaptive subdivision */
+  std::shared_ptr<const LinkMotionBounds> motion_bounds_;
+  /** @brief The number of narrow phase checks run by the evaluator */
+  long num_contact_tests_{ 0 };
+  /** @brief The settings of the incremental collision checks */
+  IncrementalCollisionConfig incremental_config_;
+  /** @brief Bounds on the motion of the active links, used to limit the steps of the incremental checks */
+  std::shared_ptr<const LinkMotionBounds> incremental_motion_bounds_;
+  /** @brief The statistics of the incremental collision checks */
+  IncrementalCollisionStats incremental_stats_;
+  /** @brief The values of the evaluator's variables of the reference of the incremental checks */
+  DblVec incremental_ref_key_;
+  /** @brief The exact results at incremental_ref_key_ */
+  CollisionCacheData::ConstPtr incremental_ref_;
+  /** @brief For each contact of incremental_ref_ the gradient of its distance, computed when first needed */
+  std::vector<Eigen::VectorXd> incremental_ref_gradients_;
+
+  /**
+   * @brief Calculate the world transforms of the active links in the state of the environment's state solver
+   *
+   * Only the forward kinematics of the kinematic links the active links are attached to are calculated, each of them
+   * once, instead of the state of the whole environment. The results are written into link_transforms so its memory
+   * can be reused for all states of a collision check. If an active link is not rigidly attached to a kinematic link of
+   * manip_, this falls back to a state solver leased from contact_manager_pool_.
+   * @param joint_values The joint values of manip_
+   * @param link_transforms The returned transforms, in the order of the active link names
+   */
+  void CalcActiveLinkTransforms(const Eigen::Ref<const Eigen::VectorXd>& joint_values,
+                                tesseract_common::VectorIsometry3d& link_transforms) const;
+
+  /**
+   * @brief Check the active links against each other with a contact manager leased with contact_manager_config_, for
+   * evaluators which check them against the rest of the environment without one
+   * @param link_transforms The world transforms of the active links, see CalcActiveLinkTransforms
+   * @param contacts The contacts within the contact distance of their pair, i.e. its safety margin plus the safety
+   * margin buffer, are added to these
+   */
+  void CalcActiveLinkCollisions(const tesseract_common::VectorIsometry3d& link_transforms,
+                                tesseract_collision::ContactResultMap& contacts);
+
+  /** @brief Indicates if the incremental collision checks are enabled, see setIncrementalCheck */
+  bool useIncrementalCheck() const { return incremental_config_.max_step > 0; }
+
+  /** @brief Drop the cached results and the reference of the incremental checks, e.g. after CalcCollisions changed */
+  void ClearCollisionCache();
+
+  /** @brief Run the exact check for x and cache its results with key */
+  CollisionCacheData::ConstPtr CalcCollisionsCached(const DblVec& x, DblVec key);
+
+  /** @brief Make exact results the reference of the incremental checks */
+  void SetIncrementalReference(const DblVec& key, CollisionCacheData::ConstPtr data);
+
+  /**
+   * @brief Check if the distances can be predicted from the reference and calculate the gradients if needed
+   * @param key The values of the evaluator's variables
+   * @param delta The returned change of the variables from the reference
+   * @return False if the variables or the links moved too far or there is no reference
+   */
+  bool PrepareIncrementalPrediction(const DblVec& key, Eigen::VectorXd& delta);
+
+  /**
+   * @brief Predict the distances of the reference contacts to first order
+   * @param delta The change of the variables from the reference
+   * @param dists The returned distances, in the order of contact_results_vector of the reference
+   * @return False if any of the distances gets too close to its safety margin
+   */
+  bool PredictDistances(const Eigen::VectorXd& delta, DblVec& dists) const;
+
+  /** @brief Record the error of the predicted distances of the reference contacts compared to the exact results */
+  void ValidatePrediction(const DblVec& predicted_dists, const CollisionCacheData& exact);
+
+  /** @brief Indicates if segments are subdivided adaptively, see setAdaptiveSubdivision */
+  bool useAdaptiveSubdivision() const { return adaptive_subdivision_margin_ > 0; }
+
+  /**
+   * @brief Remove the contacts which are only reported because of the adaptive subdivision margin
+   * @param contacts The results of a check with the adaptive subdivision margin
+   * @return Lower bound on how much closer any link pair may get before it is reported, at most the margin
+   */
+  double removeAdaptiveSubdivisionContacts(tesseract_collision::ContactResultMap& contacts) const;
 
   void CollisionsToDistanceExpressions(sco::AffExprVector& exprs,
                                        AlignedVector<Eigen::Vector2d>& exprs_data,
@@ -387,7 +630,9 @@ public:
                                    sco::VarVector vars,
                                    CollisionExpressionEvaluatorType type,
                                    double safety_margin_buffer,
-                                   bool dynamic_environment = false);
+                                   bool dynamic_environment = false,
+                                   ContactManagerPool::Ptr contact_manager_pool = nullptr,
+                                   KinematicsCache::Ptr kinematics_cache = nullptr);
   /**
   @brief linearize all contact distances in terms of robot dofs
   ;
@@ -410,7 +655,6 @@ public:
   sco::VarVector GetVars() override { return vars0_; }
 
 private:
-  tesseract_collision::DiscreteContactManager::Ptr contact_manager_;
   std::function<void(const DblVec&, sco::AffExprVector&, AlignedVector<Eigen::Vector2d>&)> fn_;
 };
 
@@ -434,7 +678,9 @@ public:
                          sco::VarVector vars0,
                          sco::VarVector vars1,
                          CollisionExpressionEvaluatorType type,
-                         double safety_margin_buffer);
+                         double safety_margin_buffer,
+                         ContactManagerPool::Ptr contact_manager_pool = nullptr,
+                         KinematicsCache::Ptr kinematics_cache = nullptr);
   void CalcDistExpressions(const DblVec& x,
                            sco::AffExprVector& exprs,
                            AlignedVector<Eigen::Vector2d>& exprs_data) override;
@@ -452,7 +698,6 @@ public:
   sco::VarVector GetVars() override { return concat(vars0_, vars1_); }
 
 private:
-  tesseract_collision::ContinuousContactManager::Ptr contact_manager_;
   std::function<void(const DblVec&, sco::AffExprVector&, AlignedVector<Eigen::Vector2d>&)> fn_;
 };
 
@@ -476,7 +721,9 @@ public:
                              sco::VarVector vars0,
                              sco::VarVector vars1,
                              CollisionExpressionEvaluatorType type,
-                             double safety_margin_buffer);
+                             double safety_margin_buffer,
+                             ContactManagerPool::Ptr contact_manager_pool = nullptr,
+                             KinematicsCache::Ptr kinematics_cache = nullptr);
   void CalcDistExpressions(const DblVec& x,
                            sco::AffExprVector& exprs,
                            AlignedVector<Eigen::Vector2d>& exprs_data) override;
@@ -493,11 +740,161 @@ public:
   void Plot(const tesseract_visualization::Visualization::Ptr& plotter, const DblVec& x) override;
   sco::VarVector GetVars() override { return concat(vars0_, vars1_); }
 
+protected:
+  /** @brief Checks the active links in the state with the given world transforms */
+  using StateContactTest =
+      std::function<void(const tesseract_common::VectorIsometry3d&, tesseract_collision::ContactResultMap&)>;
+
+  /**
+   * @brief Check every interpolated state between the two states with contact_test instead of a contact manager and
+   * combine the results like CalcCollisions. The adaptive subdivision is not used.
+   */
+  void CalcInterpolatedCollisions(const DblVec& x,
+                                  const StateContactTest& contact_test,
+                                  tesseract_collision::ContactResultMap& dist_results);
+
 private:
-  tesseract_collision::DiscreteContactManager::Ptr contact_manager_;
   std::function<void(const DblVec&, sco::AffExprVector&, AlignedVector<Eigen::Vector2d>&)> fn_;
 };
 
+/**
+ * @brief This collision evaluator checks a single state against signed distance fields of the static part of the
+ * environment instead of using a contact manager, see StaticEnvironmentSDF. Only the contacts between the active links
+ * are checked with a contact manager.
+ */
+struct SingleTimestepSDFCollisionEvaluator : public SingleTimestepCollisionEvaluator
+{
+public:
+  using Ptr = std::shared_ptr<SingleTimestepSDFCollisionEvaluator>;
+  using ConstPtr = std::shared_ptr<const SingleTimestepSDFCollisionEvaluator>;
+
+  SingleTimestepSDFCollisionEvaluator(tesseract_kinematics::ForwardKinematics::ConstPtr manip,
+                                      tesseract_environment::Environment::ConstPtr env,
+                                      tesseract_environment::AdjacencyMap::ConstPtr adjacency_map,
+                                      const Eigen::Isometry3d& world_to_base,
+                                      SafetyMarginData::ConstPtr safety_margin_data,
+                                      tesseract_collision::ContactTestType contact_test_type,
+                                      sco::VarVector vars,
+                                      CollisionExpressionEvaluatorType type,
+                                      double safety_margin_buffer,
+                                      std::shared_ptr<const StaticEnvironmentSDF> sdf,
+                                      ContactManagerPool::Ptr contact_manager_pool = nullptr,
+                                      KinematicsCache::Ptr kinematics_cache = nullptr);
+  void CalcCollisions(const DblVec& x, tesseract_collision::ContactResultMap& dist_results) override;
+
+protected:
+  std::shared_ptr<const StaticEnvironmentSDF> sdf_;
+};
+
+/**
+ * @brief This collision evaluator operates on two states and checks the interpolated states between them against
+ * signed distance fields of the static part of the environment, like DiscreteCollisionEvaluator does with a contact
+ * manager. Only the contacts between the active links are checked with a contact manager.
+ */
+struct DiscreteSDFCollisionEvaluator : public DiscreteCollisionEvaluator
+{
+public:
+  using Ptr = std::shared_ptr<DiscreteSDFCollisionEvaluator>;
+  using ConstPtr = std::shared_ptr<const DiscreteSDFCollisionEvaluator>;
+
+  DiscreteSDFCollisionEvaluator(tesseract_kinematics::ForwardKinematics::ConstPtr manip,
+                                tesseract_environment::Environment::ConstPtr env,
+                                tesseract_environment::AdjacencyMap::ConstPtr adjacency_map,
+                                const Eigen::Isometry3d& world_to_base,
+                                SafetyMarginData::ConstPtr safety_margin_data,
+                                tesseract_collision::ContactTestType contact_test_type,
+                                double longest_valid_segment_length,
+                                sco::VarVector vars0,
+                                sco::VarVector vars1,
+                                CollisionExpressionEvaluatorType type,
+                                double safety_margin_buffer,
+                                std::shared_ptr<const StaticEnvironmentSDF> sdf,
+                                ContactManagerPool::Ptr contact_manager_pool = nullptr,
+                                KinematicsCache::Ptr kinematics_cache = nullptr);
+  void CalcCollisions(const DblVec& x, tesseract_collision::ContactResultMap& dist_results) override;
+
+protected:
+  std::shared_ptr<const StaticEnvironmentSDF> sdf_;
+};
+
+/**
+ * @brief This collision evaluator checks a single state with a SphereRobotModel while the trust region of the
+ * optimizer is large, and like SingleTimestepCollisionEvaluator once it gets smaller than exact_trust_region_size (see
+ * setTrustRegionSize).
+ */
+struct SingleTimestepSphereCollisionEvaluator : public SingleTimestepCollisionEvaluator
+{
+public:
+  using Ptr = std::shared_ptr<SingleTimestepSphereCollisionEvaluator>;
+  using ConstPtr = std::shared_ptr<const SingleTimestepSphereCollisionEvaluator>;
+
+  SingleTimestepSphereCollisionEvaluator(tesseract_kinematics::ForwardKinematics::ConstPtr manip,
+                                         tesseract_environment::Environment::ConstPtr env,
+                                         tesseract_environment::AdjacencyMap::ConstPtr adjacency_map,
+                                         const Eigen::Isometry3d& world_to_base,
+                                         SafetyMarginData::ConstPtr safety_margin_data,
+                                         tesseract_collision::ContactTestType contact_test_type,
+                                         sco::VarVector vars,
+                                         CollisionExpressionEvaluatorType type,
+                                         double safety_margin_buffer,
+                                         std::shared_ptr<const SphereRobotModel> sphere_model,
+                                         double exact_trust_region_size,
+                                         ContactManagerPool::Ptr contact_manager_pool = nullptr,
+                                         KinematicsCache::Ptr kinematics_cache = nullptr);
+  void CalcCollisions(const DblVec& x, tesseract_collision::ContactResultMap& dist_results) override;
+  bool setTrustRegionSize(double trust_box_size) override;
+  bool useExactGeometry() override;
+
+  /** @brief Check with the spheres (true) or the exact geometry (false), the cached results are dropped on change */
+  void setUseApproximation(bool use_approximation);
+  bool getUseApproximation() const { return use_approximation_; }
+
+protected:
+  std::shared_ptr<const SphereRobotModel> sphere_model_;
+  double exact_trust_region_size_;
+  bool use_approximation_{ true };
+};
+
+/**
+ * @brief This collision evaluator checks the interpolated states between two states with a SphereRobotModel while the
+ * trust region of the optimizer is large, and like DiscreteCollisionEvaluator once it gets smaller than
+ * exact_trust_region_size (see setTrustRegionSize).
+ */
+struct DiscreteSphereCollisionEvaluator : public DiscreteCollisionEvaluator
+{
+public:
+  using Ptr = std::shared_ptr<DiscreteSphereCollisionEvaluator>;
+  using ConstPtr = std::shared_ptr<const DiscreteSphereCollisionEvaluator>;
+
+  DiscreteSphereCollisionEvaluator(tesseract_kinematics::ForwardKinematics::ConstPtr manip,
+                                   tesseract_environment::Environment::ConstPtr env,
+                                   tesseract_environment::AdjacencyMap::ConstPtr adjacency_map,
+                                   const Eigen::Isometry3d& world_to_base,
+                                   SafetyMarginData::ConstPtr safety_margin_data,
+                                   tesseract_collision::ContactTestType contact_test_type,
+                                   double longest_valid_segment_length,
+                                   sco::VarVector vars0,
+                                   sco::VarVector vars1,
+                                   CollisionExpressionEvaluatorType type,
+                                   double safety_margin_buffer,
+                                   std::shared_ptr<const SphereRobotModel> sphere_model,
+                                   double exact_trust_region_size,
+                                   ContactManagerPool::Ptr contact_manager_pool = nullptr,
+                                   KinematicsCache::Ptr kinematics_cache = nullptr);
+  void CalcCollisions(const DblVec& x, tesseract_collision::ContactResultMap& dist_results) override;
+  bool setTrustRegionSize(double trust_box_size) override;
+  bool useExactGeometry() override;
+
+  /** @brief Check with the spheres (true) or the exact geometry (false), the cached results are dropped on change */
+  void setUseApproximation(bool use_approximation);
+  bool getUseApproximation() const { return use_approximation_; }
+
+protected:
+  std::shared_ptr<const SphereRobotModel> sphere_model_;
+  double exact_trust_region_size_;
+  bool use_approximation_{ true };
+};
+
 class CollisionCost : public sco::Cost, public Plotter
 {
 public:
@@ -510,7 +907,8 @@ public:
                 tesseract_collision::ContactTestType contact_test_type,
                 sco::VarVector vars,
                 CollisionExpressionEvaluatorType type,
-                double safety_margin_buffer);
+                double safety_margin_buffer,
+                ContactManagerPool::Ptr contact_manager_pool = nullptr);
   /* constructor for discrete continuous and cast continuous cost */
   CollisionCost(tesseract_kinematics::ForwardKinematics::ConstPtr manip,
                 tesseract_environment::Environment::ConstPtr env,
@@ -523,11 +921,16 @@ public:
                 sco::VarVector vars1,
                 CollisionExpressionEvaluatorType type,
                 bool discrete,
-                double safety_margin_buffer);
+                double safety_margin_buffer,
+                ContactManagerPool::Ptr contact_manager_pool = nullptr);
+  /* constructor for an existing evaluator */
+  explicit CollisionCost(CollisionEvaluator::Ptr calc);
   sco::ConvexObjective::Ptr convex(const DblVec& x, sco::Model* model) override;
   double value(const DblVec&) override;
   void Plot(const tesseract_visualization::Visualization::Ptr& plotter, const DblVec& x) override;
   sco::VarVector getVars() override { return m_calc->GetVars(); }
+  bool isThreadSafe() override { return m_calc->isThreadSafe(); }
+  const CollisionEvaluator::Ptr& getEvaluator() const { return m_calc; }
 
 private:
   CollisionEvaluator::Ptr m_calc;
@@ -545,7 +948,8 @@ public:
                       tesseract_collision::ContactTestType contact_test_type,
                       sco::VarVector vars,
                       CollisionExpressionEvaluatorType type,
-                      double safety_margin_buffer);
+                      double safety_margin_buffer,
+                      ContactManagerPool::Ptr contact_manager_pool = nullptr);
   /* constructor for discrete continuous and cast continuous cost */
   CollisionConstraint(tesseract_kinematics::ForwardKinematics::ConstPtr manip,
                       tesseract_environment::Environment::ConstPtr env,
@@ -558,13 +962,112 @@ public:
                       sco::VarVector vars1,
                       CollisionExpressionEvaluatorType type,
                       bool discrete,
-                      double safety_margin_buffer);
+                      double safety_margin_buffer,
+                      ContactManagerPool::Ptr contact_manager_pool = nullptr);
+  /* constructor for an existing evaluator */
+  explicit CollisionConstraint(CollisionEvaluator::Ptr calc);
   sco::ConvexConstraints::Ptr convex(const DblVec& x, sco::Model* model) override;
   DblVec value(const DblVec&) override;
   void Plot(const DblVec& x);
   sco::VarVector getVars() override { return m_calc->GetVars(); }
+  bool isThreadSafe() override { return m_calc->isThreadSafe(); }
+  const CollisionEvaluator::Ptr& getEvaluator() const { return m_calc; }
 
 private:
   CollisionEvaluator::Ptr m_calc;
 };
+
+/**
+ * @brief Evaluates the collision evaluators of all timesteps of a trajectory in one pass.
+ *
+ * The timesteps are checked concurrently, every check leasing its own contact manager from the evaluators' (usually
+ * shared) ContactManagerPool. The results of each timestep are written to their own slot and concatenated in timestep
+ * order, so they do not depend on the number of threads. An evaluator is only ever used by one thread at a time, but
+ * objects shared between evaluators (e.g. the kinematics) have to be safe to use concurrently if n_threads > 1.
+ */
+class TrajectoryCollisionEvaluator
+{
+public:
+  using Ptr = std::shared_ptr<TrajectoryCollisionEvaluator>;
+  using ConstPtr = std::shared_ptr<const TrajectoryCollisionEvaluator>;
+
+  /**
+   * @param evaluators The evaluator of every timestep, in timestep order
+   * @param n_threads The number of threads checking the timesteps, 1 checks them serially
+   */
+  TrajectoryCollisionEvaluator(std::vector<CollisionEvaluator::Ptr> evaluators, int n_threads = 1);
+  ~TrajectoryCollisionEvaluator();
+  TrajectoryCollisionEvaluator(const TrajectoryCollisionEvaluator&) = delete;
+  TrajectoryCollisionEvaluator& operator=(const TrajectoryCollisionEvaluator&) = delete;
+  TrajectoryCollisionEvaluator(TrajectoryCollisionEvaluator&&) noexcept;
+  TrajectoryCollisionEvaluator& operator=(TrajectoryCollisionEvaluator&&) noexcept;
+
+  /**
+   * @brief The distance expressions of all timesteps, see CollisionEvaluator::CalcDistExpressions
+   * @param x Optimizer variables
+   * @param exprs Returned affine expression representation of the contact information
+   * @param exprs_data The safety margin pair associated with the expression
+   */
+  void CalcDistExpressions(const DblVec& x, sco::AffExprVector& exprs, AlignedVector<Eigen::Vector2d>& exprs_data);
+
+  /**
+   * @brief The violation of every contact of all timesteps, scaled by the coefficient of its link pair
+   * @param x Optimizer variables
+   * @param viols Returned violations
+   */
+  void CalcViolations(const DblVec& x, DblVec& viols);
+
+  /** @brief Plot the results of every timestep */
+  void Plot(const tesseract_visualization::Visualization::Ptr& plotter, const DblVec& x);
+
+  /** @brief The variables of all timesteps, each listed once */
+  const sco::VarVector& GetVars() const { return vars_; }
+
+  /** @brief The evaluator of every timestep */
+  const std::vector<CollisionEvaluator::Ptr>& GetEvaluators() const { return evaluators_; }
+
+  /** @brief True if all evaluators are thread safe, see CollisionEvaluator::isThreadSafe */
+  bool isThreadSafe() const;
+
+private:
+  std::vector<CollisionEvaluator::Ptr> evaluators_;
+  sco::VarVector vars_;
+  /** @brief Null if the timesteps are checked serially */
+  std::unique_ptr<util::ThreadPool> thread_pool_;
+
+  /** @brief Call fn(i) for the index of every evaluator, concurrently if there is a thread pool */
+  void forEachEvaluator(const std::function<void(std::size_t)>& fn);
+};
+
+/** @brief A collision cost over all timesteps of a trajectory, see TrajectoryCollisionEvaluator */
+class TrajectoryCollisionCost : public sco::Cost, public Plotter
+{
+public:
+  TrajectoryCollisionCost(std::vector<CollisionEvaluator::Ptr> evaluators, int n_threads = 1);
+  sco::ConvexObjective::Ptr convex(const DblVec& x, sco::Model* model) override;
+  double value(const DblVec&) override;
+  void Plot(const tesseract_visualization::Visualization::Ptr& plotter, const DblVec& x) override;
+  sco::VarVector getVars() override { return m_calc->GetVars(); }
+  bool isThreadSafe() override { return m_calc->isThreadSafe(); }
+  const TrajectoryCollisionEvaluator::Ptr& getEvaluator() const { return m_calc; }
+
+private:
+  TrajectoryCollisionEvaluator::Ptr m_calc;
+};
+
+/** @brief A collision constraint over all timesteps of a trajectory, see TrajectoryCollisionEvaluator */
+class TrajectoryCollisionConstraint : public sco::IneqConstraint
+{
+public:
+  TrajectoryCollisionConstraint(std::vector<CollisionEvaluator::Ptr> evaluators, int n_threads = 1);
+  sco::ConvexConstraints::Ptr convex(const DblVec& x, sco::Model* model) override;
+  DblVec value(const DblVec&) override;
+  sco::VarVector getVars() override { return m_calc->GetVars(); }
+  bool isThreadSafe() override { return m_calc->isThreadSafe(); }
+  const TrajectoryCollisionEvaluator::Ptr& getEvaluator() const { return m_calc; }
+
+private:
+  TrajectoryCollisionEvaluator::Ptr m_calc;
+};
+
 }  // namespace trajopt
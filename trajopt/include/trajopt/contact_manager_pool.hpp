@@ -0,0 +1,199 @@
+#pragma once
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <tesseract_collision/core/continuous_contact_manager.h>
+#include <tesseract_collision/core/discrete_contact_manager.h>
+#include <tesseract_environment/core/environment.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+namespace trajopt
+{
+/** @brief The settings a collision evaluator requires of a contact manager */
+struct ContactManagerConfig
+{
+  /** @brief The links which are moved by the evaluator */
+  std::vector<std::string> active_links;
+  /** @brief Contacts further apart than this are not reported */
+  double default_margin{ 0 };
+  /** @brief If false, the links which are not active are disabled, so only the active links are checked */
+  bool check_static_links{ true };
+
+  bool operator==(const ContactManagerConfig& other) const
+  {
+    return default_margin == other.default_margin && check_static_links == other.check_static_links &&
+           active_links == other.active_links;
+  }
+  bool operator!=(const ContactManagerConfig& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief A thread safe stack of clones of one type, i.e. contact managers, state solvers or kinematics objects.
+ *
+ * A manager is cloned only if all existing ones are leased. The settings of a ContactManagerConfig are only applied if
+ * they differ from the ones the manager was last leased with.
+ */
+template <typename ManagerT>
+class CloneStack
+{
+public:
+  using ManagerPtr = std::shared_ptr<ManagerT>;
+
+  /** @brief A manager together with the settings applied to it */
+  struct Entry
+  {
+    ManagerPtr manager;
+    ContactManagerConfig config;
+    bool configured{ false };
+  };
+
+  /** @brief Exclusive use of a contact manager, which is returned to the stack when the lease is destroyed */
+  class Lease
+  {
+  public:
+    Lease(CloneStack* stack, Entry entry) : stack_(stack), entry_(std::move(entry)) {}
+    ~Lease()
+    {
+      if (stack_ != nullptr)
+        stack_->release(std::move(entry_));
+    }
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    Lease(Lease&& other) noexcept : stack_(other.stack_), entry_(std::move(other.entry_)) { other.stack_ = nullptr; }
+    Lease& operator=(Lease&&) = delete;
+
+    ManagerT* operator->() const { return entry_.manager.get(); }
+    ManagerT& operator*() const { return *entry_.manager; }
+
+  private:
+    CloneStack* stack_;
+    Entry entry_;
+  };
+
+  explicit CloneStack(std::function<ManagerPtr()> clone) : clone_(std::move(clone)) {}
+  CloneStack(const CloneStack&) = delete;
+  CloneStack& operator=(const CloneStack&) = delete;
+  CloneStack(CloneStack&&) = delete;
+  CloneStack& operator=(CloneStack&&) = delete;
+  ~CloneStack() = default;
+
+  /** @brief Lease a manager as it was left by its last lease, cloning a new one if none is available */
+  Lease lease() { return Lease(this, acquire()); }
+
+  /** @brief Lease a contact manager with the given settings applied, cloning a new one if none is available */
+  Lease lease(const ContactManagerConfig& config)
+  {
+    Entry entry = acquire();
+    if (!entry.configured || entry.config != config)
+    {
+      // The enabled links only change if the static links are disabled before or after
+      if ((entry.configured && !entry.config.check_static_links) || !config.check_static_links)
+      {
+        for (const auto& name : entry.manager->getCollisionObjects())
+        {
+          if (config.check_static_links ||
+              std::find(config.active_links.begin(), config.active_links.end(), name) != config.active_links.end())
+            entry.manager->enableCollisionObject(name);
+          else
+            entry.manager->disableCollisionObject(name);
+        }
+      }
+      entry.manager->setActiveCollisionObjects(config.active_links);
+      entry.manager->setDefaultCollisionMarginData(config.default_margin);
+      entry.config = config;
+      entry.configured = true;
+    }
+    return Lease(this, std::move(entry));
+  }
+
+  /** @brief The number of managers cloned so far */
+  std::size_t getNumManagers() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return n_managers_;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::function<ManagerPtr()> clone_;
+  std::vector<Entry> free_;
+  std::size_t n_managers_{ 0 };
+
+  Entry acquire()
+  {
+    Entry entry;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty())
+    {
+      entry.manager = clone_();
+      if (entry.manager == nullptr)
+        throw std::runtime_error("ContactManagerPool: the environment has no object of the requested type to clone");
+      ++n_managers_;
+    }
+    else
+    {
+      entry = std::move(free_.back());
+      free_.pop_back();
+    }
+    return entry;
+  }
+
+  void release(Entry entry)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(std::move(entry));
+  }
+};
+
+/**
+ * @brief Contact managers and state solvers of an environment shared by all collision terms of a problem.
+ *
+ * Cloning a contact manager copies the whole collision world, and cloning a state solver the whole scene graph.
+ * Instead of every collision term owning clones, the terms lease them from the pool for the duration of a single
+ * collision check. The number of clones is therefore bounded by the number of concurrent checks (i.e. threads) rather
+ * than by the number of terms.
+ *
+ * The pool has to outlive all of its leases.
+ */
+class ContactManagerPool
+{
+public:
+  using Ptr = std::shared_ptr<ContactManagerPool>;
+  using ConstPtr = std::shared_ptr<const ContactManagerPool>;
+  using DiscreteLease = CloneStack<tesseract_collision::DiscreteContactManager>::Lease;
+  using ContinuousLease = CloneStack<tesseract_collision::ContinuousContactManager>::Lease;
+  using StateSolverLease = CloneStack<tesseract_environment::StateSolver>::Lease;
+
+  ContactManagerPool(tesseract_environment::Environment::ConstPtr env);
+
+  /** @brief Lease a discrete contact manager with the given settings applied */
+  DiscreteLease leaseDiscrete(const ContactManagerConfig& config) { return discrete_.lease(config); }
+  /** @brief Lease a continuous contact manager with the given settings applied */
+  ContinuousLease leaseContinuous(const ContactManagerConfig& config) { return continuous_.lease(config); }
+  /**
+   * @brief Lease a state solver
+   *
+   * Its state is the one left by the previous lease, so only its results for explicitly given joint values are defined.
+   */
+  StateSolverLease leaseStateSolver() { return state_solvers_.lease(); }
+
+  /** @brief The number of discrete contact managers cloned from the environment so far */
+  std::size_t getNumDiscreteManagers() const { return discrete_.getNumManagers(); }
+  /** @brief The number of continuous contact managers cloned from the environment so far */
+  std::size_t getNumContinuousManagers() const { return continuous_.getNumManagers(); }
+  /** @brief The number of state solvers cloned from the environment so far */
+  std::size_t getNumStateSolvers() const { return state_solvers_.getNumManagers(); }
+
+private:
+  tesseract_environment::Environment::ConstPtr env_;
+  CloneStack<tesseract_collision::DiscreteContactManager> discrete_;
+  CloneStack<tesseract_collision::ContinuousContactManager> continuous_;
+  CloneStack<tesseract_environment::StateSolver> state_solvers_;
+};
+}  // namespace trajopt
@@ -10,6 +10,7 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt/common.hpp>
+#include <trajopt/kinematics_cache.hpp>
 #include <trajopt_sco/modeling.hpp>
 #include <trajopt_sco/modeling_utils.hpp>
 
@@ -58,6 +59,9 @@ struct DynamicCartPoseErrCalculator : public TrajOptVectorOfVector
    */
   Eigen::VectorXi indices_;
 
+  /** @brief Caches the poses and Jacobians of manip_, it may be shared with other terms of the problem */
+  KinematicsCache::Ptr kin_cache_;
+
   DynamicCartPoseErrCalculator(
       std::string target,
       tesseract_kinematics::ForwardKinematics::ConstPtr manip,
@@ -66,7 +70,8 @@ struct DynamicCartPoseErrCalculator : public TrajOptVectorOfVector
       std::string link,
       const Eigen::Isometry3d& tcp = Eigen::Isometry3d::Identity(),
       const Eigen::Isometry3d& target_tcp = Eigen::Isometry3d::Identity(),
-      Eigen::VectorXi indices = Eigen::Matrix<int, 1, 6>(std::vector<int>({ 0, 1, 2, 3, 4, 5 }).data()))
+      Eigen::VectorXi indices = Eigen::Matrix<int, 1, 6>(std::vector<int>({ 0, 1, 2, 3, 4, 5 }).data()),
+      KinematicsCache::Ptr kinematics_cache = nullptr)
     : manip_(std::move(manip))
     , adjacency_map_(std::move(adjacency_map))
     , world_to_base_(world_to_base)
@@ -75,7 +80,9 @@ struct DynamicCartPoseErrCalculator : public TrajOptVectorOfVector
     , target_(std::move(target))
     , target_tcp_(target_tcp)
     , indices_(std::move(indices))
+    , kin_cache_(kinematics_cache ? std::move(kinematics_cache) : std::make_shared<KinematicsCache>(manip_, 0))
   {
+    assert(kin_cache_->getManipulator() == manip_);
     kin_link_ = adjacency_map_->getLinkMapping(link_);
     if (kin_link_ == nullptr)
     {
@@ -136,6 +143,9 @@ struct DynamicCartPoseJacCalculator : sco::MatrixOfVector
    */
   Eigen::VectorXi indices_;
 
+  /** @brief Caches the poses and Jacobians of manip_, it may be shared with other terms of the problem */
+  KinematicsCache::Ptr kin_cache_;
+
   DynamicCartPoseJacCalculator(
       std::string target,
       tesseract_kinematics::ForwardKinematics::ConstPtr manip,
@@ -144,7 +154,8 @@ struct DynamicCartPoseJacCalculator : sco::MatrixOfVector
       std::string link,
       const Eigen::Isometry3d& tcp = Eigen::Isometry3d::Identity(),
       const Eigen::Isometry3d& target_tcp = Eigen::Isometry3d::Identity(),
-      Eigen::VectorXi indices = Eigen::Matrix<int, 1, 6>(std::vector<int>({ 0, 1, 2, 3, 4, 5 }).data()))
+      Eigen::VectorXi indices = Eigen::Matrix<int, 1, 6>(std::vector<int>({ 0, 1, 2, 3, 4, 5 }).data()),
+      KinematicsCache::Ptr kinematics_cache = nullptr)
     : manip_(std::move(manip))
     , adjacency_map_(std::move(adjacency_map))
     , world_to_base_(world_to_base)
@@ -153,7 +164,9 @@ struct DynamicCartPoseJacCalculator : sco::MatrixOfVector
     , target_(std::move(target))
     , target_tcp_(target_tcp)
     , indices_(std::move(indices))
+    , kin_cache_(kinematics_cache ? std::move(kinematics_cache) : std::make_shared<KinematicsCache>(manip_, 0))
   {
+    assert(kin_cache_->getManipulator() == manip_);
     kin_link_ = adjacency_map_->getLinkMapping(link_);
     if (kin_link_ == nullptr)
     {
@@ -196,6 +209,9 @@ struct CartPoseErrCalculator : public TrajOptVectorOfVector
    */
   Eigen::VectorXi indices_;
 
+  /** @brief Caches the poses and Jacobians of manip_, it may be shared with other terms of the problem */
+  KinematicsCache::Ptr kin_cache_;
+
   CartPoseErrCalculator(
       const Eigen::Isometry3d& pose,
       tesseract_kinematics::ForwardKinematics::ConstPtr manip,
@@ -203,7 +219,8 @@ struct CartPoseErrCalculator : public TrajOptVectorOfVector
       const Eigen::Isometry3d& world_to_base,
       std::string link,
       const Eigen::Isometry3d& tcp = Eigen::Isometry3d::Identity(),
-      Eigen::VectorXi indices = Eigen::Matrix<int, 1, 6>(std::vector<int>({ 0, 1, 2, 3, 4, 5 }).data()))
+      Eigen::VectorXi indices = Eigen::Matrix<int, 1, 6>(std::vector<int>({ 0, 1, 2, 3, 4, 5 }).data()),
+      KinematicsCache::Ptr kinematics_cache = nullptr)
     : pose_inv_(pose.inverse())
     , manip_(std::move(manip))
     , adjacency_map_(std::move(adjacency_map))
@@ -211,7 +228,9 @@ struct CartPoseErrCalculator : public TrajOptVectorOfVector
     , link_(std::move(link))
     , tcp_(tcp)
     , indices_(std::move(indices))
+    , kin_cache_(kinematics_cache ? std::move(kinematics_cache) : std::make_shared<KinematicsCache>(manip_, 0))
   {
+    assert(kin_cache_->getManipulator() == manip_);
     kin_link_ = adjacency_map_->getLinkMapping(link_);
     if (kin_link_ == nullptr)
     {
@@ -247,6 +266,9 @@ struct CartPoseJacCalculator : sco::MatrixOfVector
    */
   Eigen::VectorXi indices_;
 
+  /** @brief Caches the poses and Jacobians of manip_, it may be shared with other terms of the problem */
+  KinematicsCache::Ptr kin_cache_;
+
   CartPoseJacCalculator(
       const Eigen::Isometry3d& pose,
       tesseract_kinematics::ForwardKinematics::ConstPtr manip,
@@ -254,7 +276,8 @@ struct CartPoseJacCalculator : sco::MatrixOfVector
       const Eigen::Isometry3d& world_to_base,
       std::string link,
       const Eigen::Isometry3d& tcp = Eigen::Isometry3d::Identity(),
-      Eigen::VectorXi indices = Eigen::Matrix<int, 1, 6>(std::vector<int>({ 0, 1, 2, 3, 4, 5 }).data()))
+      Eigen::VectorXi indices = Eigen::Matrix<int, 1, 6>(std::vector<int>({ 0, 1, 2, 3, 4, 5 }).data()),
+      KinematicsCache::Ptr kinematics_cache = nullptr)
     : pose_inv_(pose.inverse())
     , manip_(std::move(manip))
     , adjacency_map_(std::move(adjacency_map))
@@ -262,7 +285,9 @@ struct CartPoseJacCalculator : sco::MatrixOfVector
     , link_(std::move(link))
     , tcp_(tcp)
     , indices_(std::move(indices))
+    , kin_cache_(kinematics_cache ? std::move(kinematics_cache) : std::make_shared<KinematicsCache>(manip_, 0))
   {
+    assert(kin_cache_->getManipulator() == manip_);
     kin_link_ = adjacency_map_->getLinkMapping(link_);
     if (kin_link_ == nullptr)
     {
@@ -289,19 +314,24 @@ struct CartVelJacCalculator : sco::MatrixOfVector
   tesseract_environment::AdjacencyMapPair::ConstPtr kin_link_;
   double limit_;
   Eigen::Isometry3d tcp_;
+  /** @brief Caches the poses and Jacobians of manip_, it may be shared with other terms of the problem */
+  KinematicsCache::Ptr kin_cache_;
   CartVelJacCalculator(tesseract_kinematics::ForwardKinematics::ConstPtr manip,
                        tesseract_environment::AdjacencyMap::ConstPtr adjacency_map,
                        const Eigen::Isometry3d& world_to_base,
                        std::string link,
                        double limit,
-                       const Eigen::Isometry3d& tcp = Eigen::Isometry3d::Identity())
+                       const Eigen::Isometry3d& tcp = Eigen::Isometry3d::Identity(),
+                       KinematicsCache::Ptr kinematics_cache = nullptr)
     : manip_(std::move(manip))
     , adjacency_map_(std::move(adjacency_map))
     , world_to_base_(world_to_base)
     , link_(std::move(link))
     , limit_(limit)
     , tcp_(tcp)
+    , kin_cache_(kinematics_cache ? std::move(kinematics_cache) : std::make_shared<KinematicsCache>(manip_, 0))
   {
+    assert(kin_cache_->getManipulator() == manip_);
     kin_link_ = adjacency_map_->getLinkMapping(link_);
   }
 
@@ -322,19 +352,24 @@ struct CartVelErrCalculator : sco::VectorOfVector
   tesseract_environment::AdjacencyMapPair::ConstPtr kin_link_;
   double limit_;
   Eigen::Isometry3d tcp_;
+  /** @brief Caches the poses and Jacobians of manip_, it may be shared with other terms of the problem */
+  KinematicsCache::Ptr kin_cache_;
   CartVelErrCalculator(tesseract_kinematics::ForwardKinematics::ConstPtr manip,
                        tesseract_environment::AdjacencyMap::ConstPtr adjacency_map,
                        const Eigen::Isometry3d& world_to_base,
                        std::string link,
                        double limit,
-                       const Eigen::Isometry3d& tcp = Eigen::Isometry3d::Identity())
+                       const Eigen::Isometry3d& tcp = Eigen::Isometry3d::Identity(),
+                       KinematicsCache::Ptr kinematics_cache = nullptr)
     : manip_(std::move(manip))
     , adjacency_map_(std::move(adjacency_map))
     , world_to_base_(world_to_base)
     , link_(std::move(link))
     , limit_(limit)
     , tcp_(tcp)
+    , kin_cache_(kinematics_cache ? std::move(kinematics_cache) : std::make_shared<KinematicsCache>(manip_, 0))
   {
+    assert(kin_cache_->getManipulator() == manip_);
     kin_link_ = adjacency_map_->getLinkMapping(link_);
   }
 
@@ -420,11 +455,18 @@ struct AvoidSingularityErrCalculator : sco::VectorOfVector
   /** @brief Damping factor to prevent the cost from becoming infinite when the smallest singular value is very close or
    * equal to zero */
   double lambda_;
+  /** @brief Caches the poses and Jacobians of fwd_kin_, it may be shared with other terms of the problem */
+  KinematicsCache::Ptr kin_cache_;
   AvoidSingularityErrCalculator(tesseract_kinematics::ForwardKinematics::ConstPtr fwd_kin,
                                 std::string link_name,
-                                double lambda = 1.0e-3)
-    : fwd_kin_(std::move(fwd_kin)), link_name_(std::move(link_name)), lambda_(lambda)
+                                double lambda = 1.0e-3,
+                                KinematicsCache::Ptr kinematics_cache = nullptr)
+    : fwd_kin_(std::move(fwd_kin))
+    , link_name_(std::move(link_name))
+    , lambda_(lambda)
+    , kin_cache_(kinematics_cache ? std::move(kinematics_cache) : std::make_shared<KinematicsCache>(fwd_kin_, 0))
   {
+    assert(kin_cache_->getManipulator() == fwd_kin_);
   }
   Eigen::VectorXd operator()(const Eigen::VectorXd& var_vals) const override;
 };
@@ -443,12 +485,20 @@ struct AvoidSingularityJacCalculator : sco::MatrixOfVector
   /** @brief Small number used to perturb each joint in the current state to calculate the partial derivative of the
    * robot jacobian */
   double eps_;
+  /** @brief Caches the poses and Jacobians of fwd_kin_, it may be shared with other terms of the problem */
+  KinematicsCache::Ptr kin_cache_;
   AvoidSingularityJacCalculator(tesseract_kinematics::ForwardKinematics::ConstPtr fwd_kin,
                                 std::string link_name,
                                 double lambda = 1.0e-3,
-                                double eps = 1.0e-6)
-    : fwd_kin_(std::move(fwd_kin)), link_name_(std::move(link_name)), lambda_(lambda), eps_(eps)
+                                double eps = 1.0e-6,
+                                KinematicsCache::Ptr kinematics_cache = nullptr)
+    : fwd_kin_(std::move(fwd_kin))
+    , link_name_(std::move(link_name))
+    , lambda_(lambda)
+    , eps_(eps)
+    , kin_cache_(kinematics_cache ? std::move(kinematics_cache) : std::make_shared<KinematicsCache>(fwd_kin_, 0))
   {
+    assert(kin_cache_->getManipulator() == fwd_kin_);
   }
   /** @brief Helper function for numerically calculating the partial derivative of the jacobian */
   Eigen::MatrixXd jacobianPartialDerivative(const Eigen::VectorXd& state,
@@ -0,0 +1,102 @@
+#pragma once
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <boost/functional/hash.hpp>
+#include <Eigen/Geometry>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <tesseract_kinematics/core/forward_kinematics.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt/cache.hxx>
+#include <trajopt/contact_manager_pool.hpp>
+
+namespace trajopt
+{
+/** @brief A link of a kinematics object at specific joint values */
+struct KinematicsCacheKey
+{
+  std::string link_name;
+  std::vector<double> joint_values;
+
+  bool operator==(const KinematicsCacheKey& other) const
+  {
+    return joint_values == other.joint_values && link_name == other.link_name;
+  }
+};
+
+struct KinematicsCacheKeyHash
+{
+  std::size_t operator()(const KinematicsCacheKey& key) const
+  {
+    std::size_t seed = boost::hash_range(key.joint_values.begin(), key.joint_values.end());
+    boost::hash_combine(seed, key.link_name);
+    return seed;
+  }
+};
+
+/**
+ * @brief The link poses and Jacobians of a kinematics object, cached by link and joint values.
+ *
+ * Within an SQP iteration the terms of a timestep (Cartesian poses and velocities, collision gradients, ...) all
+ * require the poses and Jacobians of the same links at the same joint values. Sharing one cache between the terms of a
+ * problem computes each of them once. Joint values are compared exactly, so the results are the same as uncached ones.
+ *
+ * The terms may use the cache concurrently: the caches are guarded by a mutex, and the results are calculated outside
+ * of it with leased clones of the kinematics object, which itself is not safe to use from several threads.
+ */
+class KinematicsCache
+{
+public:
+  using Ptr = std::shared_ptr<KinematicsCache>;
+  using ConstPtr = std::shared_ptr<const KinematicsCache>;
+
+  /**
+   * @param manip The kinematics object whose results are cached
+   * @param capacity The number of poses and the number of Jacobians kept, zero disables the cache
+   */
+  KinematicsCache(tesseract_kinematics::ForwardKinematics::ConstPtr manip, std::size_t capacity = 2048);
+
+  /** @brief The pose of a link in the base frame of the kinematics object, see ForwardKinematics::calcFwdKin */
+  Eigen::Isometry3d calcFwdKin(const Eigen::Ref<const Eigen::VectorXd>& joint_angles, const std::string& link_name);
+
+  /** @brief The Jacobian of a link in the base frame of the kinematics object, see ForwardKinematics::calcJacobian */
+  Eigen::MatrixXd calcJacobian(const Eigen::Ref<const Eigen::VectorXd>& joint_angles, const std::string& link_name);
+
+  /** @brief Like calcFwdKin, without looking up or keeping the result, for joint values which are unlikely to recur */
+  Eigen::Isometry3d calcFwdKinUncached(const Eigen::Ref<const Eigen::VectorXd>& joint_angles,
+                                       const std::string& link_name) const;
+
+  /** @brief Like calcJacobian, without looking up or keeping the result */
+  Eigen::MatrixXd calcJacobianUncached(const Eigen::Ref<const Eigen::VectorXd>& joint_angles,
+                                       const std::string& link_name) const;
+
+  /** @brief The kinematics object whose results are cached */
+  const tesseract_kinematics::ForwardKinematics::ConstPtr& getManipulator() const { return manip_; }
+
+  void setCapacity(std::size_t capacity);
+  std::size_t getCapacity() const;
+  /** @brief Remove all entries, the statistics are kept */
+  void clear();
+
+  /** @brief Number of poses which were found in the cache */
+  long getNumFwdKinHits() const;
+  /** @brief Number of poses which had to be calculated */
+  long getNumFwdKinMisses() const;
+  /** @brief Number of Jacobians which were found in the cache */
+  long getNumJacobianHits() const;
+  /** @brief Number of Jacobians which had to be calculated */
+  long getNumJacobianMisses() const;
+
+private:
+  tesseract_kinematics::ForwardKinematics::ConstPtr manip_;
+  /** @brief Clones of manip_, one for each thread calculating at the same time */
+  mutable CloneStack<tesseract_kinematics::ForwardKinematics> kinematics_;
+  /** @brief Guards pose_cache_ and jacobian_cache_, whose lookups reorder their entries */
+  mutable std::mutex mutex_;
+  LRUCache<KinematicsCacheKey, Eigen::Isometry3d, KinematicsCacheKeyHash> pose_cache_;
+  LRUCache<KinematicsCacheKey, Eigen::MatrixXd, KinematicsCacheKeyHash> jacobian_cache_;
+};
+}  // namespace trajopt
@@ -0,0 +1,66 @@
+#pragma once
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <Eigen/Core>
+#include <memory>
+#include <string>
+#include <vector>
+#include <tesseract_kinematics/core/forward_kinematics.h>
+#include <tesseract_scene_graph/graph.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+namespace trajopt
+{
+/**
+ * @brief Calculate the distance from the origin of a link to the farthest point of its collision geometry
+ * @param link The link
+ * @param radius The returned distance, zero if the link has no collision geometry
+ * @return False if the geometry is unbounded or of an unsupported type
+ */
+bool calcCollisionRadius(const tesseract_scene_graph::Link& link, double& radius);
+
+/**
+ * @brief Upper bounds on how far the collision geometry of links moves when the joints of a kinematics object move.
+ *
+ * The bound of a link is linear in the joint changes, sum_j w_j * |dq_j|. For a revolute joint w_j is the distance from
+ * the joint origin to the farthest point of the geometry below it along the kinematic chain, accumulated over the rigid
+ * offsets of the chain, and for a prismatic joint it is one. These hold for every configuration, so the bounds can be
+ * used for conservative advancement: a link pair with a clearance d cannot touch while the joints move by less than
+ * d in terms of the bound.
+ */
+class LinkMotionBounds
+{
+public:
+  using Ptr = std::shared_ptr<LinkMotionBounds>;
+  using ConstPtr = std::shared_ptr<const LinkMotionBounds>;
+
+  /**
+   * @param manip The kinematics object whose joints move the links
+   * @param scene_graph The scene graph containing the links, their collision geometry and the joints
+   * @param link_names The links to bound, typically the active links of an adjacency map
+   */
+  LinkMotionBounds(const tesseract_kinematics::ForwardKinematics& manip,
+                   const tesseract_scene_graph::SceneGraph& scene_graph,
+                   const std::vector<std::string>& link_names);
+
+  /**
+   * @brief Indicates if all links could be bounded. Geometry without bounds (planes, octrees) and joints other than
+   * revolute, continuous, prismatic and fixed ones cannot be, in which case the bounds must not be used.
+   */
+  bool isValid() const { return valid_; }
+
+  /** @brief The weights of the bounds, a row per link and a column per joint of the kinematics object */
+  const Eigen::MatrixXd& getWeights() const { return weights_; }
+
+  /**
+   * @brief Upper bound on how far any two of the links move relative to each other
+   * @param delta The change of the joint values
+   * @return The sum of the two largest link bounds
+   */
+  double calcRelativeMotion(const Eigen::Ref<const Eigen::VectorXd>& delta) const;
+
+private:
+  Eigen::MatrixXd weights_;
+  bool valid_{ true };
+};
+}  // namespace trajopt
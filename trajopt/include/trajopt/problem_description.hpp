@@ -6,7 +6,10 @@ TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <tesseract_environment/core/environment.h>
 #include <trajopt/common.hpp>
+#include <trajopt/contact_manager_pool.hpp>
 #include <trajopt/json_marshal.hpp>
+#include <trajopt/kinematics_cache.hpp>
+#include <trajopt/signed_distance_field.hpp>
 #include <trajopt_sco/optimizers.hpp>
 
 namespace sco
@@ -59,6 +62,10 @@ public:
   int GetNumDOF() { return m_traj_vars.cols(); }
   tesseract_kinematics::ForwardKinematics::ConstPtr GetKin() { return m_kin; }
   tesseract_environment::Environment::ConstPtr GetEnv() { return m_env; }
+  /** @brief The contact managers shared by the collision terms of this problem, created on first use */
+  ContactManagerPool::Ptr GetContactManagerPool();
+  /** @brief The link poses and Jacobians of GetKin() shared by the terms of this problem, created on first use */
+  KinematicsCache::Ptr GetKinematicsCache();
   void SetInitTraj(const TrajArray& x) { m_init_traj = x; }
   TrajArray GetInitTraj() { return m_init_traj; }
   friend TrajOptProb::Ptr ConstructProblem(const ProblemConstructionInfo&);
@@ -66,6 +73,12 @@ public:
   bool GetHasTime() { return has_time; }
   /** @brief Sets TrajOptProb.has_time  */
   void SetHasTime(bool tmp) { has_time = tmp; }
+  /** @brief Number of threads the terms are convexified with, see BasicInfo::convexify_threads */
+  int GetConvexifyThreads() { return m_convexify_threads; }
+  void SetConvexifyThreads(int n_threads) { m_convexify_threads = n_threads; }
+  /** @brief Number of threads the terms are evaluated with, see BasicInfo::evaluate_threads */
+  int GetEvaluateThreads() { return m_evaluate_threads; }
+  void SetEvaluateThreads(int n_threads) { m_evaluate_threads = n_threads; }
 
 private:
   /** @brief If true, the last column in the optimization matrix will be 1/dt */
@@ -73,7 +86,11 @@ private:
   VarArray m_traj_vars;
   tesseract_kinematics::ForwardKinematics::ConstPtr m_kin;
   tesseract_environment::Environment::ConstPtr m_env;
+  ContactManagerPool::Ptr m_contact_manager_pool;
+  KinematicsCache::Ptr m_kinematics_cache;
   TrajArray m_init_traj;
+  int m_convexify_threads{ 1 };
+  int m_evaluate_threads{ 1 };
 };
 
 // void  SetupPlotting(TrajOptProb& prob, Optimizer& opt); TODO: Levi
@@ -87,6 +104,8 @@ struct TrajOptResult
   DblVec cost_vals, cnt_viols;
   TrajArray traj;
   sco::OptStatus status;
+  int n_sqp_iters, n_qp_solves;
+  sco::OptTimings timings;
   TrajOptResult(sco::OptResults& opt, TrajOptProb& prob);
 };
 
@@ -121,6 +140,20 @@ struct BasicInfo
 
   /** @brief The lower limit of 1/dt values allowed in the optimization*/
   double dt_lower_lim = 1.0;
+
+  /**
+   * @brief Number of threads OptimizeProblem convexifies the terms with, see
+   * sco::BasicTrustRegionSQPParameters::convexify_threads. Only thread safe terms, e.g. the joint position, velocity
+   * and acceleration terms, are convexified concurrently. Terms using the kinematics or collision checking are not.
+   */
+  int convexify_threads = 1;
+
+  /**
+   * @brief Number of threads OptimizeProblem evaluates the exact terms with, see
+   * sco::BasicTrustRegionSQPParameters::evaluate_threads. Like for convexify_threads only thread safe terms are
+   * evaluated concurrently.
+   */
+  int evaluate_threads = 1;
 };
 
 /**
@@ -585,6 +618,50 @@ struct CollisionTermInfo : public TermInfo
   when the safety margin distance is small.*/
   double safety_margin_buffer = 0.05;
 
+  /**
+   * @brief If greater than zero, the interpolated states of a segment are checked adaptively. The clearance up to this
+   * distance beyond the contact distance is measured, and the states which provably cannot be in contact are skipped
+   * (see CollisionEvaluator::setAdaptiveSubdivision). It has no effect on single timestep checks.
+   */
+  double adaptive_subdivision_margin = 0;
+
+  /**
+   * @brief If greater than zero, the distances of trial steps which move no variable by more than this from the last
+   * exactly checked values are predicted to first order instead of being checked (see
+   * CollisionEvaluator::setIncrementalCheck). They are only predicted while the links provably move by less than the
+   * safety margin buffer.
+   */
+  double incremental_max_step = 0;
+
+  /** @brief The exact check is run if a predicted distance gets within this distance of its safety margin */
+  double incremental_prediction_margin = 0.05;
+
+  /** @brief Run the exact check for every prediction as well, record the prediction error and use the exact results */
+  bool incremental_validate = false;
+
+  /**
+   * @brief If greater than zero, the active links are checked against signed distance fields of the static part of the
+   * environment with this resolution instead of using contact managers (see StaticEnvironmentSDF). The fields are built
+   * once when the term is created. Contacts between active links are still checked with contact managers. It is not
+   * available for casted checks.
+   */
+  double sdf_resolution = 0;
+
+  /** @brief The largest number of grid points of a signed distance field, contact managers are used if exceeded */
+  int sdf_max_cells = static_cast<int>(SignedDistanceField::DEFAULT_MAX_CELLS);
+
+  /**
+   * @brief If greater than zero, the active links are approximated by spheres with this spacing (see SphereRobotModel)
+   * until the trust region of the optimizer gets smaller than sphere_exact_trust_region_size or the optimizer
+   * converges, then the exact geometry is checked. The static links are checked with the signed distance fields if
+   * sdf_resolution is set, otherwise they have to be boxes. The optimizer needs a CollisionTrustRegionCallback as
+   * refinement callback, which OptimizeProblem adds. It is not available for casted checks.
+   */
+  double sphere_spacing = 0;
+
+  /** @brief The trust region size below which the exact geometry is checked instead of the spheres */
+  double sphere_exact_trust_region_size = 0.01;
+
   /** @brief Set the contact test type that should be used. */
   tesseract_collision::ContactTestType contact_test_type = tesseract_collision::ContactTestType::ALL;
 
@@ -592,6 +669,15 @@ struct CollisionTermInfo : public TermInfo
   /** @brief optimization, etc. */
   std::vector<SafetyMarginData::Ptr> info;
 
+  /**
+   * @brief Add a single term which checks all timesteps in one pass instead of a term per timestep. The distance
+   * expressions are the same, they are only grouped into one term (see TrajectoryCollisionEvaluator).
+   */
+  bool batched = false;
+
+  /** @brief The number of threads checking the timesteps of a batched term, 1 checks them serially */
+  int batch_threads = 1;
+
   /** @brief Used to add term to pci from json */
   void fromJson(ProblemConstructionInfo& pci, const Json::Value& v) override;
   /** @brief Converts term info into cost/constraint and adds it to trajopt problem */
@@ -623,6 +709,17 @@ TrajOptProb::Ptr ConstructProblem(const Json::Value&, const tesseract_environmen
 TrajOptResult::Ptr OptimizeProblem(const TrajOptProb::Ptr&,
                                    const tesseract_visualization::Visualization::Ptr& plotter = nullptr);
 
+/**
+ * @brief Returns a refinement callback for the optimizer which passes its trust region size to the collision evaluators
+ * of the collision terms of the problem before every iteration, see CollisionEvaluator::setTrustRegionSize. Before the
+ * optimizer reports convergence, the evaluators switch to the exact geometry in any case.
+ *
+ * If an evaluator switches its geometry, the optimizer evaluates the terms at the current iterate again, so the merit
+ * of the next step is compared against the exact one and the solution is checked with the exact geometry.
+ * @param opt The optimizer, which has to outlive the callback
+ */
+sco::Optimizer::RefinementCallback CollisionTrustRegionCallback(const sco::BasicTrustRegionSQP& opt);
+
 /**
  * @brief Applies a cost to avoid kinematic singularities
  */
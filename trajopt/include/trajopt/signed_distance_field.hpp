@@ -0,0 +1,173 @@
+#pragma once
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <tesseract_collision/core/types.h>
+#include <tesseract_environment/core/environment.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+namespace trajopt
+{
+/** @brief Spheres covering the surface of the collision geometry of a link, in the frame of the link */
+struct CollisionSpheres
+{
+  std::vector<Eigen::Vector3d> centers;
+  std::vector<double> radii;
+};
+
+/**
+ * @brief Cover the surface of the collision geometry of a link with spheres
+ *
+ * Spheres are represented exactly and capsules by spheres along their axis. The surfaces of boxes, cylinders, cones
+ * and the faces of meshes are sampled on a grid, where the radius of the spheres is chosen such that they cover the
+ * surface between the samples. The distances of the spheres therefore do not overestimate the distance of the
+ * geometry, by at most about the spacing.
+ * @param link The link
+ * @param spacing The largest distance between the samples
+ * @param spheres The returned spheres
+ * @return False if the geometry is of an unsupported type
+ */
+bool calcCollisionSpheres(const tesseract_scene_graph::Link& link, double spacing, CollisionSpheres& spheres);
+
+/**
+ * @brief A signed distance field of the collision geometry of a set of links which do not move.
+ *
+ * The distances are sampled once on a regular grid covering the links, by measuring the distance of a probe sphere
+ * placed at every grid point with a contact manager of the environment. Queries interpolate the samples trilinearly,
+ * so they take constant time regardless of the complexity of the geometry. Distances beyond max_distance are not
+ * measured, and points outside of the grid are reported at max_distance with a zero gradient. Since the probe only
+ * sees the surface, points inside of non-convex meshes are not reported as penetrating.
+ */
+class SignedDistanceField
+{
+public:
+  using Ptr = std::shared_ptr<SignedDistanceField>;
+  using ConstPtr = std::shared_ptr<const SignedDistanceField>;
+
+  /** @brief The default limit of the number of grid points, which take 8 bytes each */
+  static const std::size_t DEFAULT_MAX_CELLS = 16777216;
+
+  /**
+   * @param env The environment, the links are voxelized in its current state
+   * @param link_names The links to voxelize
+   * @param resolution The distance between the grid points
+   * @param max_distance The largest distance which is measured
+   * @param max_cells The largest number of grid points, the field is not built if the links need more
+   */
+  SignedDistanceField(const tesseract_environment::Environment& env,
+                      std::vector<std::string> link_names,
+                      double resolution,
+                      double max_distance,
+                      std::size_t max_cells = DEFAULT_MAX_CELLS);
+
+  /**
+   * @brief Indicates if the field could be built, i.e. all of the links have bounded geometry and the grid does not
+   * exceed max_cells
+   */
+  bool isValid() const { return valid_; }
+
+  /** @brief The links of the field */
+  const std::vector<std::string>& getLinkNames() const { return link_names_; }
+
+  double getResolution() const { return resolution_; }
+  double getMaxDistance() const { return max_distance_; }
+
+  /**
+   * @brief Calculate the signed distance of a point to the links of the field
+   * @param point The point in world coordinates
+   * @param gradient The returned gradient of the distance
+   * @param link_index The returned index of the closest link in getLinkNames()
+   * @return The signed distance, negative inside of the links
+   */
+  double calcDistance(const Eigen::Vector3d& point, Eigen::Vector3d& gradient, std::size_t& link_index) const;
+
+private:
+  std::vector<std::string> link_names_;
+  double resolution_;
+  double max_distance_;
+  bool valid_{ true };
+  /** @brief The position of the first grid point */
+  Eigen::Vector3d origin_{ Eigen::Vector3d::Zero() };
+  /** @brief The number of grid points along each axis */
+  Eigen::Array3i size_{ Eigen::Array3i::Zero() };
+  /** @brief The distance at every grid point, x being the fastest changing index */
+  std::vector<float> distances_;
+  /** @brief The index of the closest link at every grid point */
+  std::vector<unsigned> closest_links_;
+
+  std::size_t index(int x, int y, int z) const
+  {
+    return static_cast<std::size_t>(x) +
+           static_cast<std::size_t>(size_(0)) *
+               (static_cast<std::size_t>(y) + static_cast<std::size_t>(size_(1)) * static_cast<std::size_t>(z));
+  }
+};
+
+/**
+ * @brief Signed distance fields of the static part of an environment, checked against the active links of a
+ * kinematics object instead of a contact manager.
+ *
+ * The static links are grouped by the active links they are allowed to collide with, and a field is built for every
+ * group, so the allowed collision matrix of the environment is respected. The active links are represented by
+ * CollisionSpheres. Contacts between active links are not checked, the collision evaluators check them with contact
+ * managers.
+ */
+class StaticEnvironmentSDF
+{
+public:
+  using Ptr = std::shared_ptr<StaticEnvironmentSDF>;
+  using ConstPtr = std::shared_ptr<const StaticEnvironmentSDF>;
+
+  /**
+   * @param env The environment
+   * @param active_links The links which move, all other links with collision geometry are voxelized
+   * @param resolution The distance between the grid points of the fields and between the samples of the active links
+   * @param max_distance The largest distance which is measured, at least the largest contact distance of the checks
+   * @param max_cells The largest number of grid points of each field
+   */
+  StaticEnvironmentSDF(const tesseract_environment::Environment& env,
+                       std::vector<std::string> active_links,
+                       double resolution,
+                       double max_distance,
+                       std::size_t max_cells = SignedDistanceField::DEFAULT_MAX_CELLS);
+
+  /** @brief Indicates if all fields could be built and all active links could be represented by spheres */
+  bool isValid() const { return valid_; }
+
+  /** @brief The active links, in the order expected by contactTest */
+  const std::vector<std::string>& getActiveLinkNames() const { return active_links_; }
+
+  /**
+   * @brief Find the contacts of the active links with the static links
+   *
+   * The closest contact of every link pair closer than its contact distance is reported, also for
+   * ContactTestType::ALL.
+   * @param contacts The returned contacts
+   * @param link_transforms The world transforms of the active links, in the order of getActiveLinkNames()
+   * @param contact_distance_fn The contact distance of a pair of links
+   * @param type The type of contact test
+   */
+  void contactTest(tesseract_collision::ContactResultMap& contacts,
+                   const tesseract_common::VectorIsometry3d& link_transforms,
+                   const std::function<double(const std::string&, const std::string&)>& contact_distance_fn,
+                   tesseract_collision::ContactTestType type) const;
+
+private:
+  /** @brief A field together with the active links it is not checked against */
+  struct Field
+  {
+    SignedDistanceField::ConstPtr sdf;
+    std::vector<bool> allowed;
+  };
+
+  std::vector<std::string> active_links_;
+  std::vector<CollisionSpheres> active_link_spheres_;
+  std::vector<Field> fields_;
+  bool valid_{ true };
+};
+}  // namespace trajopt
@@ -0,0 +1,145 @@
+#pragma once
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <tesseract_collision/core/types.h>
+#include <tesseract_environment/core/environment.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt/signed_distance_field.hpp>
+#include <trajopt/typedefs.hpp>
+
+namespace trajopt
+{
+/**
+ * @brief Sphere centers stored as one column per coordinate, so the distance kernels work on contiguous arrays and are
+ * vectorized by Eigen
+ */
+using SphereCenters = Eigen::Matrix<double, Eigen::Dynamic, 3>;
+
+/**
+ * @brief Calculate the distances between the surfaces of a sphere and a set of spheres
+ * @param center The center of the sphere
+ * @param radius The radius of the sphere
+ * @param centers The centers of the set
+ * @param radii The radii of the set
+ * @param distances The returned distances, negative if the spheres overlap
+ */
+void calcSphereSphereDistances(const Eigen::Vector3d& center,
+                               double radius,
+                               const SphereCenters& centers,
+                               const Eigen::ArrayXd& radii,
+                               Eigen::ArrayXd& distances);
+
+/**
+ * @brief Calculate the signed distances between the surfaces of a set of spheres and a box
+ * @param centers The centers of the spheres, in the frame of the box
+ * @param radii The radii of the spheres
+ * @param half_extents Half of the size of the box, which is centered at the origin of its frame
+ * @param distances The returned distances, negative if a sphere penetrates the box
+ */
+void calcSphereBoxDistances(const SphereCenters& centers,
+                            const Eigen::ArrayXd& radii,
+                            const Eigen::Array3d& half_extents,
+                            Eigen::ArrayXd& distances);
+
+/**
+ * @brief An approximation of the active links of a kinematics object by spheres, used for fast and rough collision
+ * checks while the optimizer is far from convergence.
+ *
+ * The spheres are generated from the collision geometry of the links with calcCollisionSpheres. The active links are
+ * checked against each other unless the allowed collision matrix of the environment allows it. The static links are
+ * checked with the given StaticEnvironmentSDF, or without one with the exact distance to their geometry if it only
+ * consists of boxes. Only the closest pair of spheres of every pair of links (or box of a static link) is reported,
+ * also for ContactTestType::ALL.
+ */
+class SphereRobotModel
+{
+public:
+  using Ptr = std::shared_ptr<SphereRobotModel>;
+  using ConstPtr = std::shared_ptr<const SphereRobotModel>;
+
+  /**
+   * @param env The environment, the static links are used in its current state
+   * @param active_links The links which move
+   * @param spacing The largest distance between the spheres sampling the surface of an active link
+   * @param environment_sdf The fields of the static links, built for the same active links. If null the static links
+   * are checked as boxes.
+   */
+  SphereRobotModel(const tesseract_environment::Environment& env,
+                   std::vector<std::string> active_links,
+                   double spacing,
+                   StaticEnvironmentSDF::ConstPtr environment_sdf = nullptr);
+
+  /**
+   * @brief Indicates if all active links could be represented by spheres and all static links can be checked, i.e.
+   * there is a valid field or they only consist of boxes
+   */
+  bool isValid() const { return valid_; }
+
+  /** @brief The active links, in the order expected by contactTest */
+  const std::vector<std::string>& getActiveLinkNames() const { return active_links_; }
+
+  /** @brief The number of spheres of all active links */
+  long getNumSpheres() const;
+
+  /**
+   * @brief Find the contacts of the active links with each other and with the static links
+   * @param contacts The returned contacts
+   * @param link_transforms The world transforms of the active links, in the order of getActiveLinkNames()
+   * @param contact_distance_fn The contact distance of a pair of links
+   * @param type The type of contact test
+   */
+  void contactTest(tesseract_collision::ContactResultMap& contacts,
+                   const tesseract_common::VectorIsometry3d& link_transforms,
+                   const std::function<double(const std::string&, const std::string&)>& contact_distance_fn,
+                   tesseract_collision::ContactTestType type) const;
+
+private:
+  /** @brief The spheres of an active link in its frame, together with a sphere bounding all of them */
+  struct LinkSpheres
+  {
+    SphereCenters centers;
+    Eigen::ArrayXd radii;
+    Eigen::Vector3d bounding_center{ Eigen::Vector3d::Zero() };
+    double bounding_radius{ -1 };
+  };
+
+  /** @brief A box of a static link in world coordinates, together with the active links it is not checked against */
+  struct StaticBox
+  {
+    std::string link_name;
+    Eigen::Isometry3d transform;
+    Eigen::Array3d half_extents;
+    std::vector<bool> allowed;
+  };
+
+  std::vector<std::string> active_links_;
+  std::vector<LinkSpheres> link_spheres_;
+  /** @brief The pairs of active links which are checked against each other */
+  std::vector<std::pair<std::size_t, std::size_t>> self_pairs_;
+  StaticEnvironmentSDF::ConstPtr environment_sdf_;
+  AlignedVector<StaticBox> static_boxes_;
+  bool valid_{ true };
+
+  /** @return True if a contact was found and the test should stop because of ContactTestType::FIRST */
+  bool selfContactTest(tesseract_collision::ContactResultMap& contacts,
+                       const std::vector<SphereCenters>& world_centers,
+                       const tesseract_common::VectorIsometry3d& link_transforms,
+                       const std::function<double(const std::string&, const std::string&)>& contact_distance_fn,
+                       tesseract_collision::ContactTestType type) const;
+
+  /** @return True if a contact was found and the test should stop because of ContactTestType::FIRST */
+  bool boxContactTest(tesseract_collision::ContactResultMap& contacts,
+                      const std::vector<SphereCenters>& world_centers,
+                      const tesseract_common::VectorIsometry3d& link_transforms,
+                      const std::function<double(const std::string&, const std::string&)>& contact_distance_fn,
+                      tesseract_collision::ContactTestType type) const;
+};
+}  // namespace trajopt
@@ -24,6 +24,9 @@ public:
   /** @brief Numerically evaluate cost given the vector of values */
   double value(const DblVec&) override;
   sco::VarVector getVars() override { return vars_.flatten(); }
+  bool isThreadSafe() override { return true; }
+  /** @brief The quadratic expression does not depend on x */
+  bool hasConstantConvexification() override { return true; }
 
 private:
   /** @brief The variables being optimized. Used to properly index the vector being optimized */
@@ -60,6 +63,7 @@ public:
   /** @brief Numerically evaluate cost given the vector of values */
   double value(const DblVec&) override;
   sco::VarVector getVars() override { return vars_.flatten(); }
+  bool isThreadSafe() override { return true; }
 
 private:
   /** @brief The variables being optimized. Used to properly index the vector being optimized */
@@ -95,6 +99,7 @@ public:
   DblVec value(const DblVec&) override;
 
   sco::VarVector getVars() override { return vars_.flatten(); }
+  bool isThreadSafe() override { return true; }
 
 private:
   /** @brief The variables being optimized. Used to properly index the vector being optimized */
@@ -127,6 +132,7 @@ public:
   /** @brief Numerically evaluate cost given the vector of values */
   DblVec value(const DblVec&) override;
   sco::VarVector getVars() override { return vars_.flatten(); }
+  bool isThreadSafe() override { return true; }
 
 private:
   /** @brief The variables being optimized. Used to properly index the vector being optimized */
@@ -161,6 +167,9 @@ public:
   /** @brief Numerically evaluate cost given the vector of values using Eigen*/
   double value(const DblVec&) override;
   sco::VarVector getVars() override { return vars_.flatten(); }
+  bool isThreadSafe() override { return true; }
+  /** @brief The quadratic expression does not depend on x */
+  bool hasConstantConvexification() override { return true; }
 
 private:
   /** @brief The variables being optimized. Used to properly index the vector being optimized */
@@ -193,6 +202,7 @@ public:
   /** @brief Numerically evaluate cost given the vector of values */
   double value(const DblVec&) override;
   sco::VarVector getVars() override { return vars_.flatten(); }
+  bool isThreadSafe() override { return true; }
 
 private:
   /** @brief The variables being optimized. Used to properly index the vector being optimized */
@@ -228,6 +238,7 @@ public:
   DblVec value(const DblVec&) override;
 
   sco::VarVector getVars() override { return vars_.flatten(); }
+  bool isThreadSafe() override { return true; }
 
 private:
   /** @brief The variables being optimized. Used to properly index the vector being optimized */
@@ -260,6 +271,7 @@ public:
   /** @brief Numerically evaluate cost given the vector of values */
   DblVec value(const DblVec&) override;
   sco::VarVector getVars() override { return vars_.flatten(); }
+  bool isThreadSafe() override { return true; }
 
 private:
   /** @brief The variables being optimized. Used to properly index the vector being optimized */
@@ -294,6 +306,9 @@ public:
   /** @brief Numerically evaluate cost given the vector of values */
   double value(const DblVec&) override;
   sco::VarVector getVars() override { return vars_.flatten(); }
+  bool isThreadSafe() override { return true; }
+  /** @brief The quadratic expression does not depend on x */
+  bool hasConstantConvexification() override { return true; }
 
 private:
   /** @brief The variables being optimized. Used to properly index the vector being optimized */
@@ -326,6 +341,7 @@ public:
   /** @brief Numerically evaluate cost given the vector of values */
   double value(const DblVec&) override;
   sco::VarVector getVars() override { return vars_.flatten(); }
+  bool isThreadSafe() override { return true; }
 
 private:
   /** @brief The variables being optimized. Used to properly index the vector being optimized */
@@ -361,6 +377,7 @@ public:
   DblVec value(const DblVec&) override;
 
   sco::VarVector getVars() override { return vars_.flatten(); }
+  bool isThreadSafe() override { return true; }
 
 private:
   /** @brief The variables being optimized. Used to properly index the vector being optimized */
@@ -393,6 +410,7 @@ public:
   /** @brief Numerically evaluate cost given the vector of values */
   DblVec value(const DblVec&) override;
   sco::VarVector getVars() override { return vars_.flatten(); }
+  bool isThreadSafe() override { return true; }
 
 private:
   /** @brief The variables being optimized. Used to properly index the vector being optimized */
@@ -427,6 +445,9 @@ public:
   /** @brief Numerically evaluate cost given the vector of values */
   double value(const DblVec&) override;
   sco::VarVector getVars() override { return vars_.flatten(); }
+  bool isThreadSafe() override { return true; }
+  /** @brief The quadratic expression does not depend on x */
+  bool hasConstantConvexification() override { return true; }
 
 private:
   /** @brief The variables being optimized. Used to properly index the vector being optimized */
@@ -459,6 +480,7 @@ public:
   /** @brief Numerically evaluate cost given the vector of values */
   double value(const DblVec&) override;
   sco::VarVector getVars() override { return vars_.flatten(); }
+  bool isThreadSafe() override { return true; }
 
 private:
   /** @brief The variables being optimized. Used to properly index the vector being optimized */
@@ -494,6 +516,7 @@ public:
   DblVec value(const DblVec&) override;
 
   sco::VarVector getVars() override { return vars_.flatten(); }
+  bool isThreadSafe() override { return true; }
 
 private:
   /** @brief The variables being optimized. Used to properly index the vector being optimized */
@@ -526,6 +549,7 @@ public:
   /** @brief Numerically evaluate cost given the vector of values */
   DblVec value(const DblVec&) override;
   sco::VarVector getVars() override { return vars_.flatten(); }
+  bool isThreadSafe() override { return true; }
 
 private:
   /** @brief The variables being optimized. Used to properly index the vector being optimized */
@@ -1,6 +1,12 @@
 #include <trajopt_utils/macros.h>
 TRAJOPT_IGNORE_WARNINGS_PUSH
-#include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <iterator>
+#include <numeric>
+#include <unordered_set>
+#include <console_bridge/console.h>
 #include <tesseract_kinematics/core/forward_kinematics.h>
 #include <tesseract_kinematics/core/utils.h>
 #include <tesseract_visualization/markers/arrow_marker.h>
@@ -8,6 +14,9 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt/collision_terms.hpp>
+#include <trajopt/link_motion_bounds.hpp>
+#include <trajopt/signed_distance_field.hpp>
+#include <trajopt/sphere_robot_model.hpp>
 #include <trajopt/utils.hpp>
 #include <trajopt_sco/expr_ops.hpp>
 #include <trajopt_sco/expr_vec_ops.hpp>
@@ -16,6 +25,7 @@ TRAJOPT_IGNORE_WARNINGS_POP
 #include <trajopt_utils/eigen_conversions.hpp>
 #include <trajopt_utils/logging.hpp>
 #include <trajopt_utils/stl_to_string.hpp>
+#include <trajopt_utils/thread_pool.hpp>
 
 namespace trajopt
 {
@@ -175,7 +185,7 @@ GradientResults CollisionEvaluator::GetGradient(const Eigen::VectorXd& dofvals,
       results.gradients[i].has_gradient = true;
 
       // Calculate Jacobian
-      Eigen::MatrixXd jac = manip_->calcJacobian(dofvals, it->link_name);
+      Eigen::MatrixXd jac = kinematics_cache_->calcJacobian(dofvals, it->link_name);
 
       // Need to change the base and ref point of the jacobian.
       // When changing ref point you must provide a vector from the current ref
@@ -237,15 +247,23 @@ GradientResults CollisionEvaluator::GetGradient(const Eigen::VectorXd& dofvals0,
     {
       results.gradients[i].has_gradient = true;
 
+      // Calculate Jacobian, only the states of the timesteps are worth caching
+      Eigen::MatrixXd jac;
       if (contact_result.cc_type[i] == tesseract_collision::ContinuousCollisionType::CCType_Time0)
+      {
         dofvalst = dofvals0;
+        jac = kinematics_cache_->calcJacobian(dofvalst, it->link_name);
+      }
       else if (contact_result.cc_type[i] == tesseract_collision::ContinuousCollisionType::CCType_Time1)
+      {
         dofvalst = dofvals1;
+        jac = kinematics_cache_->calcJacobian(dofvalst, it->link_name);
+      }
       else
+      {
         dofvalst = dofvals0 + (dofvals1 - dofvals0) * contact_result.cc_time[i];
-
-      // Calculate Jacobian
-      Eigen::MatrixXd jac = manip_->calcJacobian(dofvalst, it->link_name);
+        jac = kinematics_cache_->calcJacobianUncached(dofvalst, it->link_name);
+      }
 
       // Need to change the base and ref point of the jacobian.
       // When changing ref point you must provide a vector from the current ref
@@ -523,7 +541,9 @@ CollisionEvaluator::CollisionEvaluator(tesseract_kinematics::ForwardKinematics::
                                        tesseract_collision::ContactTestType contact_test_type,
                                        double longest_valid_segment_length,
                                        double safety_margin_buffer,
-                                       bool dynamic_environment)
+                                       bool dynamic_environment,
+                                       ContactManagerPool::Ptr contact_manager_pool,
+                                       KinematicsCache::Ptr kinematics_cache)
   : manip_(std::move(manip))
   , env_(std::move(env))
   , adjacency_map_(std::move(adjacency_map))
@@ -532,10 +552,21 @@ CollisionEvaluator::CollisionEvaluator(tesseract_kinematics::ForwardKinematics::
   , safety_margin_buffer_(safety_margin_buffer)
   , contact_test_type_(contact_test_type)
   , longest_valid_segment_length_(longest_valid_segment_length)
-  , state_solver_(env_->getStateSolver())
   , dynamic_environment_(dynamic_environment)
+  , contact_manager_pool_(std::move(contact_manager_pool))
+  , kinematics_cache_(std::move(kinematics_cache))
 {
-  // If the environment is not expected to change, then the cloned state solver may be used each time.
+  if (contact_manager_pool_ == nullptr)
+    contact_manager_pool_ = std::make_shared<ContactManagerPool>(env_);
+  if (kinematics_cache_ == nullptr)
+    kinematics_cache_ = std::make_shared<KinematicsCache>(manip_, 0);
+  assert(kinematics_cache_->getManipulator() == manip_);
+
+  contact_manager_config_.active_links = adjacency_map_->getActiveLinkNames();
+  /** @todo Should remove trajopt safety margin data structure and use the one from tesseract */
+  contact_manager_config_.default_margin = safety_margin_data_->getMaxSafetyMargin() + safety_margin_buffer_;
+
+  // If the environment is not expected to change, then a state solver cloned once may be used each time.
   if (dynamic_environment_)
     get_state_fn_ = [&](const std::vector<std::string>& joint_names,
                         const Eigen::Ref<const Eigen::VectorXd>& joint_values) {
@@ -544,15 +575,151 @@ CollisionEvaluator::CollisionEvaluator(tesseract_kinematics::ForwardKinematics::
   else
     get_state_fn_ = [&](const std::vector<std::string>& joint_names,
                         const Eigen::Ref<const Eigen::VectorXd>& joint_values) {
-      return state_solver_->getState(joint_names, joint_values);
+      ContactManagerPool::StateSolverLease state_solver = contact_manager_pool_->leaseStateSolver();
+      return state_solver->getState(joint_names, joint_values);
     };
+
+  // Relative to the state of the state solvers the active links only move with manip_, so their transforms
+  // follow from its kinematics
+  const std::vector<std::string>& active_links = adjacency_map_->getActiveLinkNames();
+  use_active_link_kinematics_ = true;
+  active_link_kin_index_.reserve(active_links.size());
+  active_link_offsets_.reserve(active_links.size());
+  for (const auto& link_name : active_links)
+  {
+    tesseract_environment::AdjacencyMapPair::ConstPtr it = adjacency_map_->getLinkMapping(link_name);
+    if (it == nullptr)
+    {
+      use_active_link_kinematics_ = false;
+      break;
+    }
+
+    auto kin_link = std::find(active_kin_links_.begin(), active_kin_links_.end(), it->link_name);
+    active_link_kin_index_.push_back(static_cast<std::size_t>(std::distance(active_kin_links_.begin(), kin_link)));
+    if (kin_link == active_kin_links_.end())
+      active_kin_links_.push_back(it->link_name);
+    active_link_offsets_.push_back(it->transform);
+  }
+
+  active_link_order_.resize(active_link_kin_index_.size());
+  std::iota(active_link_order_.begin(), active_link_order_.end(), 0);
+  std::stable_sort(active_link_order_.begin(), active_link_order_.end(), [this](std::size_t a, std::size_t b) {
+    return active_link_kin_index_[a] < active_link_kin_index_[b];
+  });
+}
+
+void CollisionEvaluator::CalcActiveLinkTransforms(const Eigen::Ref<const Eigen::VectorXd>& joint_values,
+                                                  tesseract_common::VectorIsometry3d& link_transforms) const
+{
+  const std::vector<std::string>& active_links = adjacency_map_->getActiveLinkNames();
+  link_transforms.resize(active_links.size());
+
+  if (!use_active_link_kinematics_)
+  {
+    ContactManagerPool::StateSolverLease state_solver = contact_manager_pool_->leaseStateSolver();
+    tesseract_environment::EnvState::Ptr state = state_solver->getState(manip_->getJointNames(), joint_values);
+    for (std::size_t i = 0; i < active_links.size(); ++i)
+      link_transforms[i] = state->link_transforms[active_links[i]];
+    return;
+  }
+
+  std::size_t kin_index = active_kin_links_.size();
+  Eigen::Isometry3d kin_link_pose;
+  for (std::size_t i : active_link_order_)
+  {
+    if (active_link_kin_index_[i] != kin_index)
+    {
+      kin_index = active_link_kin_index_[i];
+      kin_link_pose =
+          world_to_base_ * kinematics_cache_->calcFwdKinUncached(joint_values, active_kin_links_[kin_index]);
+    }
+    link_transforms[i] = kin_link_pose * active_link_offsets_[i];
+  }
+}
+
+void CollisionEvaluator::CalcActiveLinkCollisions(const tesseract_common::VectorIsometry3d& link_transforms,
+                                                  tesseract_collision::ContactResultMap& contacts)
+{
+  const std::vector<std::string>& active_links = adjacency_map_->getActiveLinkNames();
+  if (active_links.size() < 2)
+    return;
+  if (contact_test_type_ == tesseract_collision::ContactTestType::FIRST && !contacts.empty())
+    return;
+
+  assert(!contact_manager_config_.check_static_links);
+  ContactManagerPool::DiscreteLease contact_manager = contact_manager_pool_->leaseDiscrete(contact_manager_config_);
+  contact_manager->setCollisionObjectsTransform(active_links, link_transforms);
+
+  // The pairs of active links are disjoint from the ones the caller found
+  tesseract_collision::ContactResultMap active_contacts;
+  ++num_contact_tests_;
+  contact_manager->contactTest(active_contacts, contact_test_type_);
+  for (auto& pair : active_contacts)
+  {
+    // The contact manager checks with the largest safety margin, each pair only keeps the contacts within its own
+    const Eigen::Vector2d& data = getSafetyMarginData()->getPairSafetyMarginData(pair.first.first, pair.first.second);
+    auto end = std::remove_if(
+        pair.second.begin(), pair.second.end(), [&data, this](const tesseract_collision::ContactResult& r) {
+          return (!((data[0] + safety_margin_buffer_) > r.distance));
+        });
+    pair.second.erase(end, pair.second.end());
+    if (!pair.second.empty())
+      contacts[pair.first] = std::move(pair.second);
+  }
+}
+
+void CollisionEvaluator::setAdaptiveSubdivision(double margin, LinkMotionBounds::ConstPtr motion_bounds)
+{
+  if (margin > 0 && contact_test_type_ == tesseract_collision::ContactTestType::FIRST)
+  {
+    CONSOLE_BRIDGE_logWarn("Adaptive subdivision is not available with contact test type FIRST");
+    margin = 0;
+  }
+
+  if (margin > 0 && motion_bounds == nullptr)
+    motion_bounds =
+        std::make_shared<LinkMotionBounds>(*manip_, *env_->getSceneGraph(), adjacency_map_->getActiveLinkNames());
+
+  if (margin > 0 && !motion_bounds->isValid())
+  {
+    CONSOLE_BRIDGE_logWarn("Adaptive subdivision is disabled, the motion of the active links cannot be bounded");
+    margin = 0;
+  }
+
+  adaptive_subdivision_margin_ = std::max(margin, 0.0);
+  motion_bounds_ = useAdaptiveSubdivision() ? std::move(motion_bounds) : nullptr;
+  assert(!motion_bounds_ ||
+         motion_bounds_->getWeights().rows() == static_cast<Eigen::Index>(adjacency_map_->getActiveLinkNames().size()));
+
+  contact_manager_config_.default_margin =
+      safety_margin_data_->getMaxSafetyMargin() + safety_margin_buffer_ + adaptive_subdivision_margin_;
+}
+
+double CollisionEvaluator::removeAdaptiveSubdivisionContacts(tesseract_collision::ContactResultMap& contacts) const
+{
+  double contact_distance = safety_margin_data_->getMaxSafetyMargin() + safety_margin_buffer_;
+  double clearance = adaptive_subdivision_margin_;
+  for (auto it = contacts.begin(); it != contacts.end();)
+  {
+    for (const auto& r : it->second)
+      clearance = std::min(clearance, r.distance - contact_distance);
+
+    auto end = std::remove_if(it->second.begin(), it->second.end(), [contact_distance](const auto& r) {
+      return r.distance >= contact_distance;
+    });
+    it->second.erase(end, it->second.end());
+
+    if (it->second.empty())
+      it = contacts.erase(it);
+    else
+      ++it;
+  }
+  return clearance;
 }
 
 void CollisionEvaluator::CalcDists(const DblVec& x, DblVec& dists)
 {
-  tesseract_collision::ContactResultVector dist_results;
-  GetCollisionsCached(x, dist_results);
-  CollisionsToDistances(dist_results, dists);
+  CollisionsToDistances(GetCollisionsCached(x)->contact_results_vector, dists);
 }
 
 void CollisionEvaluator::CalcCollisions(const DblVec& x,
@@ -563,49 +730,275 @@ void CollisionEvaluator::CalcCollisions(const DblVec& x,
   tesseract_collision::flattenCopyResults(dist_map, dist_vector);
 }
 
-inline size_t hash(const DblVec& x) { return boost::hash_range(x.begin(), x.end()); }
+CollisionCacheData::ConstPtr CollisionEvaluator::GetCollisionsCached(const DblVec& x)
+{
+  DblVec key = sco::getDblVec(x, GetVars());
+  CollisionCacheData::ConstPtr cached = m_cache.get(key);
+  if (cached != nullptr)
+  {
+    LOG_DEBUG("using cached collision check\n");
+    if (useIncrementalCheck())
+      SetIncrementalReference(key, cached);
+    return cached;
+  }
+
+  LOG_DEBUG("not using cached collision check\n");
+  return CalcCollisionsCached(x, std::move(key));
+}
+
+CollisionCacheData::ConstPtr CollisionEvaluator::CalcCollisionsCached(const DblVec& x, DblVec key)
+{
+  auto data = std::make_shared<CollisionCacheData>();
+  CalcCollisions(x, data->contact_results_map, data->contact_results_vector);
+  if (useIncrementalCheck())
+    SetIncrementalReference(key, data);
+  return m_cache.put(std::move(key), data);
+}
+
 void CollisionEvaluator::GetCollisionsCached(const DblVec& x, tesseract_collision::ContactResultVector& dist_results)
 {
-  size_t key = hash(sco::getDblVec(x, GetVars()));
-  auto it = m_cache.get(key);
-  if (it != nullptr)
+  dist_results = GetCollisionsCached(x)->contact_results_vector;
+}
+
+void CollisionEvaluator::GetCollisionsCached(const DblVec& x, tesseract_collision::ContactResultMap& dist_results)
+{
+  dist_results = GetCollisionsCached(x)->contact_results_map;
+}
+
+CollisionCacheData::ConstPtr CollisionEvaluator::GetCollisionsEstimated(const DblVec& x, DblVec& dists)
+{
+  if (!useIncrementalCheck())
+  {
+    CollisionCacheData::ConstPtr collisions = GetCollisionsCached(x);
+    CollisionsToDistances(collisions->contact_results_vector, dists);
+    return collisions;
+  }
+
+  DblVec key = sco::getDblVec(x, GetVars());
+  CollisionCacheData::ConstPtr cached = m_cache.get(key);
+  if (cached != nullptr)
   {
     LOG_DEBUG("using cached collision check\n");
-    dist_results = it->second;
+    SetIncrementalReference(key, cached);
+    CollisionsToDistances(cached->contact_results_vector, dists);
+    return cached;
+  }
+
+  Eigen::VectorXd delta;
+  CollisionCacheData::ConstPtr exact;
+  if (!PrepareIncrementalPrediction(key, delta))
+  {
+    ++incremental_stats_.num_exact;
+    exact = CalcCollisionsCached(x, std::move(key));
+  }
+  else if (!incremental_config_.validate)
+  {
+    // The predicted distances belong to the contacts of the reference, which are shared instead of copied
+    if (PredictDistances(delta, dists))
+    {
+      ++incremental_stats_.num_predicted;
+      return incremental_ref_;
+    }
+    ++incremental_stats_.num_exact;
+    exact = CalcCollisionsCached(x, std::move(key));
   }
   else
   {
-    LOG_DEBUG("not using cached collision check\n");
-    tesseract_collision::ContactResultMap dist_map;
-    CalcCollisions(x, dist_map, dist_results);
-    m_cache.put(key, std::make_pair(dist_map, dist_results));
+    // The exact check runs while predicting. Its results are returned, the prediction is only compared to them.
+    std::future<CollisionCacheData::Ptr> exact_future = std::async(std::launch::async, [this, &x]() {
+      auto data = std::make_shared<CollisionCacheData>();
+      CalcCollisions(x, data->contact_results_map, data->contact_results_vector);
+      return data;
+    });
+    DblVec predicted_dists;
+    bool predicted = PredictDistances(delta, predicted_dists);
+    exact = exact_future.get();
+    if (predicted)
+    {
+      ++incremental_stats_.num_predicted;
+      ValidatePrediction(predicted_dists, *exact);
+    }
+    else
+    {
+      ++incremental_stats_.num_exact;
+      SetIncrementalReference(key, exact);
+    }
+    exact = m_cache.put(std::move(key), exact);
   }
+
+  CollisionsToDistances(exact->contact_results_vector, dists);
+  return exact;
 }
 
-void CollisionEvaluator::GetCollisionsCached(const DblVec& x, tesseract_collision::ContactResultMap& dist_results)
+void CollisionEvaluator::setIncrementalCheck(const IncrementalCollisionConfig& config,
+                                             LinkMotionBounds::ConstPtr motion_bounds)
 {
-  size_t key = hash(sco::getDblVec(x, GetVars()));
-  auto it = m_cache.get(key);
-  if (it != nullptr)
+  incremental_config_ = config;
+  if (useIncrementalCheck() &&
+      (evaluator_type_ == CollisionExpressionEvaluatorType::START_FREE_END_FREE_WEIGHTED_SUM ||
+       evaluator_type_ == CollisionExpressionEvaluatorType::START_FREE_END_FIXED_WEIGHTED_SUM ||
+       evaluator_type_ == CollisionExpressionEvaluatorType::START_FIXED_END_FREE_WEIGHTED_SUM ||
+       evaluator_type_ == CollisionExpressionEvaluatorType::SINGLE_TIME_STEP_WEIGHTED_SUM))
   {
-    LOG_DEBUG("using cached collision check\n");
-    dist_results = it->first;
+    CONSOLE_BRIDGE_logWarn("Incremental collision checks are not available for the weighted sum expression types");
+    incremental_config_.max_step = 0;
   }
-  else
+
+  if (useIncrementalCheck() && motion_bounds == nullptr)
+    motion_bounds =
+        std::make_shared<LinkMotionBounds>(*manip_, *env_->getSceneGraph(), adjacency_map_->getActiveLinkNames());
+
+  if (useIncrementalCheck() && !motion_bounds->isValid())
   {
-    LOG_DEBUG("not using cached collision check\n");
-    tesseract_collision::ContactResultVector dist_vector;
-    CalcCollisions(x, dist_results, dist_vector);
-    m_cache.put(key, std::make_pair(dist_results, dist_vector));
+    CONSOLE_BRIDGE_logWarn("Incremental collision checks are disabled, the motion of the active links is unbounded");
+    incremental_config_.max_step = 0;
   }
+
+  incremental_motion_bounds_ = useIncrementalCheck() ? std::move(motion_bounds) : nullptr;
+
+  incremental_ref_key_.clear();
+  incremental_ref_ = nullptr;
+  incremental_ref_gradients_.clear();
+}
+
+void CollisionEvaluator::ClearCollisionCache()
+{
+  m_cache.clear();
+  incremental_ref_key_.clear();
+  incremental_ref_ = nullptr;
+  incremental_ref_gradients_.clear();
+}
+
+void CollisionEvaluator::SetIncrementalReference(const DblVec& key, CollisionCacheData::ConstPtr data)
+{
+  if (data == incremental_ref_ && key == incremental_ref_key_)
+    return;
+
+  incremental_ref_key_ = key;
+  incremental_ref_ = std::move(data);
+  incremental_ref_gradients_.clear();
+}
+
+bool CollisionEvaluator::PrepareIncrementalPrediction(const DblVec& key, Eigen::VectorXd& delta)
+{
+  if (incremental_ref_ == nullptr || key.empty() || key.size() != incremental_ref_key_.size())
+    return false;
+
+  Eigen::VectorXd ref_values = util::toVectorXd(incremental_ref_key_);
+  delta = util::toVectorXd(key) - ref_values;
+  if (delta.cwiseAbs().maxCoeff() > incremental_config_.max_step)
+    return false;
+
+  // Link pairs which were not reported at the reference may only be skipped while they provably cannot reach their
+  // safety margin. The states checked in between are interpolated, so their motion is bounded by the one of the ends.
+  auto n0 = static_cast<Eigen::Index>(vars0_.size());
+  double motion = incremental_motion_bounds_->calcRelativeMotion(delta.head(n0));
+  if (delta.size() > n0)
+    motion = std::max(motion, incremental_motion_bounds_->calcRelativeMotion(delta.tail(delta.size() - n0)));
+  if (motion >= safety_margin_buffer_)
+    return false;
+
+  const tesseract_collision::ContactResultVector& dist_results = incremental_ref_->contact_results_vector;
+  if (incremental_ref_gradients_.size() == dist_results.size())
+    return true;
+
+  // The variables of the evaluator are the ones of the first state followed by the ones of the second state, if any
+  Eigen::Index n1 = ref_values.size() - n0;
+  bool state0_free = (evaluator_type_ == CollisionExpressionEvaluatorType::START_FREE_END_FREE ||
+                      evaluator_type_ == CollisionExpressionEvaluatorType::START_FREE_END_FIXED ||
+                      evaluator_type_ == CollisionExpressionEvaluatorType::SINGLE_TIME_STEP);
+  bool state1_free = (evaluator_type_ == CollisionExpressionEvaluatorType::START_FREE_END_FREE ||
+                      evaluator_type_ == CollisionExpressionEvaluatorType::START_FIXED_END_FREE);
+  Eigen::VectorXd dofvals0 = ref_values.head(n0);
+  Eigen::VectorXd dofvals1 = ref_values.tail(n1);
+
+  // Same gradients as used by the distance expressions, see CollisionsToDistanceExpressions
+  auto add_gradient = [](Eigen::VectorXd& gradient, Eigen::Index start, const GradientResults& grad) {
+    for (const auto& g : grad.gradients)
+    {
+      if (g.has_gradient)
+        gradient.segment(start, g.gradient.size()) += g.scale * g.gradient;
+    }
+  };
+
+  incremental_ref_gradients_.clear();
+  incremental_ref_gradients_.reserve(dist_results.size());
+  for (const auto& res : dist_results)
+  {
+    Eigen::VectorXd gradient = Eigen::VectorXd::Zero(ref_values.size());
+    if (state0_free)
+      add_gradient(gradient, 0, GetGradient(dofvals0, res, false));
+    if (state1_free && n1 > 0)
+      add_gradient(gradient, n0, GetGradient(dofvals1, res, true));
+    incremental_ref_gradients_.push_back(std::move(gradient));
+  }
+  return true;
+}
+
+bool CollisionEvaluator::PredictDistances(const Eigen::VectorXd& delta, DblVec& dists) const
+{
+  const tesseract_collision::ContactResultVector& dist_results = incremental_ref_->contact_results_vector;
+  assert(incremental_ref_gradients_.size() == dist_results.size());
+
+  dists.clear();
+  dists.reserve(dist_results.size());
+  for (std::size_t i = 0; i < dist_results.size(); ++i)
+  {
+    const tesseract_collision::ContactResult& res = dist_results[i];
+    double dist = res.distance + incremental_ref_gradients_[i].dot(delta);
+    const Eigen::Vector2d& data = safety_margin_data_->getPairSafetyMarginData(res.link_names[0], res.link_names[1]);
+    if (dist < data[0] + incremental_config_.prediction_margin)
+      return false;
+
+    dists.push_back(dist);
+  }
+  return true;
+}
+
+void CollisionEvaluator::ValidatePrediction(const DblVec& predicted_dists, const CollisionCacheData& exact)
+{
+  auto min_distance = [](const tesseract_collision::ContactResultVector& results) {
+    double dist = std::numeric_limits<double>::max();
+    for (const auto& res : results)
+      dist = std::min(dist, res.distance);
+    return dist;
+  };
+
+  bool missed = false;
+  for (const auto& pair : exact.contact_results_map)
+  {
+    const Eigen::Vector2d& data = safety_margin_data_->getPairSafetyMarginData(pair.first.first, pair.first.second);
+    missed = missed || (min_distance(pair.second) < data[0]);
+  }
+
+  // The results vector of the reference is flattened from its map, so the predicted distances are in the same order
+  double error = 0;
+  std::size_t i = 0;
+  for (const auto& pair : incremental_ref_->contact_results_map)
+  {
+    double predicted_dist = std::numeric_limits<double>::max();
+    for (std::size_t j = 0; j < pair.second.size(); ++j)
+      predicted_dist = std::min(predicted_dist, predicted_dists[i++]);
+
+    auto it = exact.contact_results_map.find(pair.first);
+    if (it != exact.contact_results_map.end())
+      error = std::max(error, std::abs(predicted_dist - min_distance(it->second)));
+  }
+  assert(i == predicted_dists.size());
+
+  ++incremental_stats_.num_validated;
+  if (missed)
+    ++incremental_stats_.num_missed;
+  incremental_stats_.max_distance_error = std::max(incremental_stats_.max_distance_error, error);
+  LOG_DEBUG("incremental collision check prediction error %f%s\n", error, missed ? ", missed contact" : "");
 }
 
 void CollisionEvaluator::CalcDistExpressionsStartFree(const DblVec& x,
                                                       sco::AffExprVector& exprs,
                                                       AlignedVector<Eigen::Vector2d>& exprs_data)
 {
-  tesseract_collision::ContactResultVector dist_results;
-  GetCollisionsCached(x, dist_results);
+  CollisionCacheData::ConstPtr collisions = GetCollisionsCached(x);
+  const tesseract_collision::ContactResultVector& dist_results = collisions->contact_results_vector;
 
   sco::AffExprVector exprs0;
   CollisionsToDistanceExpressions(exprs0, exprs_data, dist_results, vars0_, x, false);
@@ -624,8 +1017,8 @@ void CollisionEvaluator::CalcDistExpressionsEndFree(const DblVec& x,
                                                     sco::AffExprVector& exprs,
                                                     AlignedVector<Eigen::Vector2d>& exprs_data)
 {
-  tesseract_collision::ContactResultVector dist_results;
-  GetCollisionsCached(x, dist_results);
+  CollisionCacheData::ConstPtr collisions = GetCollisionsCached(x);
+  const tesseract_collision::ContactResultVector& dist_results = collisions->contact_results_vector;
 
   sco::AffExprVector exprs1;
   CollisionsToDistanceExpressions(exprs1, exprs_data, dist_results, vars1_, x, true);
@@ -644,8 +1037,8 @@ void CollisionEvaluator::CalcDistExpressionsBothFree(const DblVec& x,
                                                      sco::AffExprVector& exprs,
                                                      AlignedVector<Eigen::Vector2d>& exprs_data)
 {
-  tesseract_collision::ContactResultVector dist_results;
-  GetCollisionsCached(x, dist_results);
+  CollisionCacheData::ConstPtr collisions = GetCollisionsCached(x);
+  const tesseract_collision::ContactResultVector& dist_results = collisions->contact_results_vector;
 
   sco::AffExprVector exprs0, exprs1;
   AlignedVector<Eigen::Vector2d> exprs_data0, exprs_data1;
@@ -670,8 +1063,8 @@ void CollisionEvaluator::CalcDistExpressionsStartFreeW(const DblVec& x,
                                                        sco::AffExprVector& exprs,
                                                        AlignedVector<Eigen::Vector2d>& exprs_data)
 {
-  tesseract_collision::ContactResultMap dist_results;
-  GetCollisionsCached(x, dist_results);
+  CollisionCacheData::ConstPtr collisions = GetCollisionsCached(x);
+  const tesseract_collision::ContactResultMap& dist_results = collisions->contact_results_map;
 
   sco::AffExprVector exprs0;
   CollisionsToDistanceExpressionsContinuousW(exprs0, exprs_data, dist_results, vars0_, vars1_, x, false);
@@ -689,8 +1082,8 @@ void CollisionEvaluator::CalcDistExpressionsEndFreeW(const DblVec& x,
                                                      sco::AffExprVector& exprs,
                                                      AlignedVector<Eigen::Vector2d>& exprs_data)
 {
-  tesseract_collision::ContactResultMap dist_results;
-  GetCollisionsCached(x, dist_results);
+  CollisionCacheData::ConstPtr collisions = GetCollisionsCached(x);
+  const tesseract_collision::ContactResultMap& dist_results = collisions->contact_results_map;
 
   sco::AffExprVector exprs1;
   CollisionsToDistanceExpressionsContinuousW(exprs1, exprs_data, dist_results, vars0_, vars1_, x, true);
@@ -708,8 +1101,8 @@ void CollisionEvaluator::CalcDistExpressionsBothFreeW(const DblVec& x,
                                                       sco::AffExprVector& exprs,
                                                       AlignedVector<Eigen::Vector2d>& exprs_data)
 {
-  tesseract_collision::ContactResultMap dist_results;
-  GetCollisionsCached(x, dist_results);
+  CollisionCacheData::ConstPtr collisions = GetCollisionsCached(x);
+  const tesseract_collision::ContactResultMap& dist_results = collisions->contact_results_map;
 
   sco::AffExprVector exprs0, exprs1;
   AlignedVector<Eigen::Vector2d> exprs_data0, exprs_data1;
@@ -732,8 +1125,8 @@ void CollisionEvaluator::CalcDistExpressionsSingleTimeStep(const DblVec& x,
                                                            sco::AffExprVector& exprs,
                                                            AlignedVector<Eigen::Vector2d>& exprs_data)
 {
-  tesseract_collision::ContactResultVector dist_results;
-  GetCollisionsCached(x, dist_results);
+  CollisionCacheData::ConstPtr collisions = GetCollisionsCached(x);
+  const tesseract_collision::ContactResultVector& dist_results = collisions->contact_results_vector;
   CollisionsToDistanceExpressions(exprs, exprs_data, dist_results, vars0_, x, false);
   assert(dist_results.size() == exprs.size());
 
@@ -748,8 +1141,8 @@ void CollisionEvaluator::CalcDistExpressionsSingleTimeStepW(const DblVec& x,
                                                             sco::AffExprVector& exprs,
                                                             AlignedVector<Eigen::Vector2d>& exprs_data)
 {
-  tesseract_collision::ContactResultMap dist_results;
-  GetCollisionsCached(x, dist_results);
+  CollisionCacheData::ConstPtr collisions = GetCollisionsCached(x);
+  const tesseract_collision::ContactResultMap& dist_results = collisions->contact_results_map;
   CollisionsToDistanceExpressionsW(exprs, exprs_data, dist_results, vars0_, x, false);
   assert(dist_results.size() == exprs.size());
 
@@ -897,7 +1290,9 @@ SingleTimestepCollisionEvaluator::SingleTimestepCollisionEvaluator(
     sco::VarVector vars,
     CollisionExpressionEvaluatorType type,
     double safety_margin_buffer,
-    bool dynamic_environment)
+    bool dynamic_environment,
+    ContactManagerPool::Ptr contact_manager_pool,
+    KinematicsCache::Ptr kinematics_cache)
   : CollisionEvaluator(std::move(manip),
                        std::move(env),
                        std::move(adjacency_map),
@@ -906,16 +1301,13 @@ SingleTimestepCollisionEvaluator::SingleTimestepCollisionEvaluator(
                        contact_test_type,
                        0,
                        safety_margin_buffer,
-                       dynamic_environment)
+                       dynamic_environment,
+                       std::move(contact_manager_pool),
+                       std::move(kinematics_cache))
 {
   vars0_ = std::move(vars);
   evaluator_type_ = type;
 
-  contact_manager_ = env_->getDiscreteContactManager();
-  contact_manager_->setActiveCollisionObjects(adjacency_map_->getActiveLinkNames());
-  /** @todo Should remove trajopt safety margin data structure and use the one from tesseract */
-  contact_manager_->setDefaultCollisionMarginData(safety_margin_data_->getMaxSafetyMargin() + safety_margin_buffer_);
-
   switch (evaluator_type_)
   {
     case CollisionExpressionEvaluatorType::SINGLE_TIME_STEP:
@@ -953,12 +1345,22 @@ void SingleTimestepCollisionEvaluator::CalcCollisions(const DblVec& x,
 void SingleTimestepCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eigen::VectorXd>& dof_vals,
                                                       tesseract_collision::ContactResultMap& dist_results)
 {
-  tesseract_environment::EnvState::Ptr state = get_state_fn_(manip_->getJointNames(), dof_vals);
-
-  for (const auto& link_name : env_->getActiveLinkNames())
-    contact_manager_->setCollisionObjectsTransform(link_name, state->link_transforms[link_name]);
+  ContactManagerPool::DiscreteLease contact_manager = contact_manager_pool_->leaseDiscrete(contact_manager_config_);
+  if (dynamic_environment_)
+  {
+    tesseract_environment::EnvState::Ptr state = get_state_fn_(manip_->getJointNames(), dof_vals);
+    for (const auto& link_name : env_->getActiveLinkNames())
+      contact_manager->setCollisionObjectsTransform(link_name, state->link_transforms[link_name]);
+  }
+  else
+  {
+    tesseract_common::VectorIsometry3d link_transforms;
+    CalcActiveLinkTransforms(dof_vals, link_transforms);
+    contact_manager->setCollisionObjectsTransform(adjacency_map_->getActiveLinkNames(), link_transforms);
+  }
 
-  contact_manager_->contactTest(dist_results, contact_test_type_);
+  ++num_contact_tests_;
+  contact_manager->contactTest(dist_results, contact_test_type_);
 
   for (auto& pair : dist_results)
   {
@@ -981,8 +1383,8 @@ void SingleTimestepCollisionEvaluator::CalcDistExpressions(const DblVec& x,
 
 void SingleTimestepCollisionEvaluator::Plot(const tesseract_visualization::Visualization::Ptr& plotter, const DblVec& x)
 {
-  tesseract_collision::ContactResultVector dist_results;
-  GetCollisionsCached(x, dist_results);
+  CollisionCacheData::ConstPtr collisions = GetCollisionsCached(x);
+  const tesseract_collision::ContactResultVector& dist_results = collisions->contact_results_vector;
   Eigen::VectorXd dofvals = sco::getVec(x, vars0_);
 
   Eigen::VectorXd safety_distance(dist_results.size());
@@ -1038,7 +1440,9 @@ DiscreteCollisionEvaluator::DiscreteCollisionEvaluator(tesseract_kinematics::For
                                                        sco::VarVector vars0,
                                                        sco::VarVector vars1,
                                                        CollisionExpressionEvaluatorType type,
-                                                       double safety_margin_buffer)
+                                                       double safety_margin_buffer,
+                                                       ContactManagerPool::Ptr contact_manager_pool,
+                                                       KinematicsCache::Ptr kinematics_cache)
   : CollisionEvaluator(std::move(manip),
                        std::move(env),
                        std::move(adjacency_map),
@@ -1046,17 +1450,15 @@ DiscreteCollisionEvaluator::DiscreteCollisionEvaluator(tesseract_kinematics::For
                        std::move(safety_margin_data),
                        contact_test_type,
                        longest_valid_segment_length,
-                       safety_margin_buffer)
+                       safety_margin_buffer,
+                       false,
+                       std::move(contact_manager_pool),
+                       std::move(kinematics_cache))
 {
   vars0_ = std::move(vars0);
   vars1_ = std::move(vars1);
   evaluator_type_ = type;
 
-  contact_manager_ = env_->getDiscreteContactManager();
-  contact_manager_->setActiveCollisionObjects(adjacency_map_->getActiveLinkNames());
-  /** @todo Should remove trajopt safety margin data structure and use the one from tesseract */
-  contact_manager_->setDefaultCollisionMarginData(safety_margin_data_->getMaxSafetyMargin() + safety_margin_buffer_);
-
   switch (evaluator_type_)
   {
     case CollisionExpressionEvaluatorType::START_FREE_END_FREE:
@@ -1131,6 +1533,8 @@ void DiscreteCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eigen::Ve
                                                 const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
                                                 tesseract_collision::ContactResultMap& dist_results)
 {
+  ContactManagerPool::DiscreteLease contact_manager = contact_manager_pool_->leaseDiscrete(contact_manager_config_);
+
   // The first step is to see if the distance between two states is larger than the longest valid segment. If larger
   // the collision checking is broken up into multiple casted collision checks such that each check is less then
   // the longest valid segment length.
@@ -1154,15 +1558,34 @@ void DiscreteCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eigen::Ve
   std::vector<tesseract_collision::ContactResultMap> contacts_vector;
   contacts_vector.reserve(static_cast<size_t>(subtraj.rows()));
   bool contact_found = false;
+  tesseract_common::VectorIsometry3d link_transforms;
+
+  // When subdividing adaptively, the states which the links cannot reach from the last checked one without using up
+  // its clearance are skipped
+  bool adaptive = useAdaptiveSubdivision();
+  double step_motion = adaptive ? motion_bounds_->calcRelativeMotion(subtraj.row(1) - subtraj.row(0)) : 0;
+  double clearance = -1;
+  int last_checked = 0;
   for (int i = 0; i < subtraj.rows(); ++i)
   {
     tesseract_collision::ContactResultMap contacts;
-    tesseract_environment::EnvState::Ptr state0 = state_solver_->getState(manip_->getJointNames(), subtraj.row(i));
+    if (adaptive && static_cast<double>(i - last_checked) * step_motion < clearance)
+    {
+      contacts_vector.push_back(contacts);
+      continue;
+    }
+
+    CalcActiveLinkTransforms(subtraj.row(i), link_transforms);
+    contact_manager->setCollisionObjectsTransform(active_links, link_transforms);
 
-    for (const auto& link_name : active_links)
-      contact_manager_->setCollisionObjectsTransform(link_name, state0->link_transforms[link_name]);
+    ++num_contact_tests_;
+    contact_manager->contactTest(contacts, contact_test_type_);
+    if (adaptive)
+    {
+      clearance = removeAdaptiveSubdivisionContacts(contacts);
+      last_checked = i;
+    }
 
-    contact_manager_->contactTest(contacts, contact_test_type_);
     if (!contacts.empty())
       contact_found = true;
 
@@ -1180,17 +1603,50 @@ void DiscreteCollisionEvaluator::CalcDistExpressions(const DblVec& x,
   fn_(x, exprs, exprs_data);
 }
 
+void DiscreteCollisionEvaluator::CalcInterpolatedCollisions(const DblVec& x,
+                                                            const StateContactTest& contact_test,
+                                                            tesseract_collision::ContactResultMap& dist_results)
+{
+  Eigen::VectorXd dof_vals0 = sco::getVec(x, vars0_);
+  Eigen::VectorXd dof_vals1 = sco::getVec(x, vars1_);
+
+  // Same interpolation as CalcCollisions
+  double dist = (dof_vals1 - dof_vals0).norm();
+  long cnt = 2;
+  if (dist > longest_valid_segment_length_)
+    cnt = static_cast<long>(std::ceil(dist / longest_valid_segment_length_)) + 1;
+
+  tesseract_common::TrajArray subtraj(cnt, dof_vals0.size());
+  for (long i = 0; i < dof_vals0.size(); ++i)
+    subtraj.col(i) = Eigen::VectorXd::LinSpaced(cnt, dof_vals0(i), dof_vals1(i));
+
+  std::vector<tesseract_collision::ContactResultMap> contacts_vector(static_cast<std::size_t>(subtraj.rows()));
+  bool contact_found = false;
+  tesseract_common::VectorIsometry3d link_transforms;
+  for (long i = 0; i < subtraj.rows(); ++i)
+  {
+    tesseract_collision::ContactResultMap& contacts = contacts_vector[static_cast<std::size_t>(i)];
+    CalcActiveLinkTransforms(subtraj.row(i), link_transforms);
+    contact_test(link_transforms, contacts);
+    if (!contacts.empty())
+      contact_found = true;
+  }
+
+  if (contact_found)
+    processInterpolatedCollisionResults(contacts_vector, dist_results, 1.0 / double(subtraj.rows() - 1));
+}
+
 void DiscreteCollisionEvaluator::Plot(const tesseract_visualization::Visualization::Ptr& plotter, const DblVec& x)
 {
-  tesseract_collision::ContactResultVector dist_results;
-  GetCollisionsCached(x, dist_results);
+  CollisionCacheData::ConstPtr collisions = GetCollisionsCached(x);
+  const tesseract_collision::ContactResultVector& dist_results = collisions->contact_results_vector;
   Eigen::VectorXd dofvals0 = sco::getVec(x, vars0_);
   Eigen::VectorXd dofvals1 = sco::getVec(x, vars1_);
 
   Eigen::VectorXd safety_distance(dist_results.size());
   for (auto i = 0u; i < dist_results.size(); ++i)
   {
-    tesseract_collision::ContactResult& res = dist_results[i];
+    const tesseract_collision::ContactResult& res = dist_results[i];
     // Contains the contact distance threshold and coefficient for the given link pair
     const Eigen::Vector2d& data = getSafetyMarginData()->getPairSafetyMarginData(res.link_names[0], res.link_names[1]);
     safety_distance[i] = data[0];
@@ -1269,6 +1725,268 @@ void DiscreteCollisionEvaluator::Plot(const tesseract_visualization::Visualizati
 
 ////////////////////////////////////////
 
+/** @brief The contact distance of a link pair, i.e. its safety margin plus the safety margin buffer */
+static std::function<double(const std::string&, const std::string&)>
+contactDistanceFn(SafetyMarginData::ConstPtr safety_margin_data, double safety_margin_buffer)
+{
+  return [safety_margin_data, safety_margin_buffer](const std::string& link1, const std::string& link2) {
+    return safety_margin_data->getPairSafetyMarginData(link1, link2)[0] + safety_margin_buffer;
+  };
+}
+
+SingleTimestepSDFCollisionEvaluator::SingleTimestepSDFCollisionEvaluator(
+    tesseract_kinematics::ForwardKinematics::ConstPtr manip,
+    tesseract_environment::Environment::ConstPtr env,
+    tesseract_environment::AdjacencyMap::ConstPtr adjacency_map,
+    const Eigen::Isometry3d& world_to_base,
+    SafetyMarginData::ConstPtr safety_margin_data,
+    tesseract_collision::ContactTestType contact_test_type,
+    sco::VarVector vars,
+    CollisionExpressionEvaluatorType type,
+    double safety_margin_buffer,
+    StaticEnvironmentSDF::ConstPtr sdf,
+    ContactManagerPool::Ptr contact_manager_pool,
+    KinematicsCache::Ptr kinematics_cache)
+  : SingleTimestepCollisionEvaluator(std::move(manip),
+                                     std::move(env),
+                                     std::move(adjacency_map),
+                                     world_to_base,
+                                     std::move(safety_margin_data),
+                                     contact_test_type,
+                                     std::move(vars),
+                                     type,
+                                     safety_margin_buffer,
+                                     false,
+                                     std::move(contact_manager_pool),
+                                     std::move(kinematics_cache))
+  , sdf_(std::move(sdf))
+{
+  if (sdf_ == nullptr || !sdf_->isValid() || sdf_->getActiveLinkNames() != adjacency_map_->getActiveLinkNames())
+    PRINT_AND_THROW("Signed distance field does not match the active links of SingleTimestepSDFCollisionEvaluator!");
+
+  // The fields only cover the static links, the active links are checked against each other with a contact manager
+  contact_manager_config_.check_static_links = false;
+}
+
+void SingleTimestepSDFCollisionEvaluator::CalcCollisions(const DblVec& x,
+                                                         tesseract_collision::ContactResultMap& dist_results)
+{
+  tesseract_common::VectorIsometry3d link_transforms;
+  CalcActiveLinkTransforms(sco::getVec(x, vars0_), link_transforms);
+  ++num_contact_tests_;
+  sdf_->contactTest(
+      dist_results, link_transforms, contactDistanceFn(safety_margin_data_, safety_margin_buffer_), contact_test_type_);
+  CalcActiveLinkCollisions(link_transforms, dist_results);
+}
+
+DiscreteSDFCollisionEvaluator::DiscreteSDFCollisionEvaluator(
+    tesseract_kinematics::ForwardKinematics::ConstPtr manip,
+    tesseract_environment::Environment::ConstPtr env,
+    tesseract_environment::AdjacencyMap::ConstPtr adjacency_map,
+    const Eigen::Isometry3d& world_to_base,
+    SafetyMarginData::ConstPtr safety_margin_data,
+    tesseract_collision::ContactTestType contact_test_type,
+    double longest_valid_segment_length,
+    sco::VarVector vars0,
+    sco::VarVector vars1,
+    CollisionExpressionEvaluatorType type,
+    double safety_margin_buffer,
+    StaticEnvironmentSDF::ConstPtr sdf,
+    ContactManagerPool::Ptr contact_manager_pool,
+    KinematicsCache::Ptr kinematics_cache)
+  : DiscreteCollisionEvaluator(std::move(manip),
+                               std::move(env),
+                               std::move(adjacency_map),
+                               world_to_base,
+                               std::move(safety_margin_data),
+                               contact_test_type,
+                               longest_valid_segment_length,
+                               std::move(vars0),
+                               std::move(vars1),
+                               type,
+                               safety_margin_buffer,
+                               std::move(contact_manager_pool),
+                               std::move(kinematics_cache))
+  , sdf_(std::move(sdf))
+{
+  if (sdf_ == nullptr || !sdf_->isValid() || sdf_->getActiveLinkNames() != adjacency_map_->getActiveLinkNames())
+    PRINT_AND_THROW("The signed distance field does not match the active links of DiscreteSDFCollisionEvaluator!");
+
+  // The fields only cover the static links, the active links are checked against each other with a contact manager
+  contact_manager_config_.check_static_links = false;
+}
+
+void DiscreteSDFCollisionEvaluator::CalcCollisions(const DblVec& x, tesseract_collision::ContactResultMap& dist_results)
+{
+  auto contact_distance_fn = contactDistanceFn(safety_margin_data_, safety_margin_buffer_);
+  auto contact_test = [this, &contact_distance_fn](const tesseract_common::VectorIsometry3d& link_transforms,
+                                                   tesseract_collision::ContactResultMap& contacts) {
+    ++num_contact_tests_;
+    sdf_->contactTest(contacts, link_transforms, contact_distance_fn, contact_test_type_);
+    CalcActiveLinkCollisions(link_transforms, contacts);
+  };
+  CalcInterpolatedCollisions(x, contact_test, dist_results);
+}
+
+SingleTimestepSphereCollisionEvaluator::SingleTimestepSphereCollisionEvaluator(
+    tesseract_kinematics::ForwardKinematics::ConstPtr manip,
+    tesseract_environment::Environment::ConstPtr env,
+    tesseract_environment::AdjacencyMap::ConstPtr adjacency_map,
+    const Eigen::Isometry3d& world_to_base,
+    SafetyMarginData::ConstPtr safety_margin_data,
+    tesseract_collision::ContactTestType contact_test_type,
+    sco::VarVector vars,
+    CollisionExpressionEvaluatorType type,
+    double safety_margin_buffer,
+    SphereRobotModel::ConstPtr sphere_model,
+    double exact_trust_region_size,
+    ContactManagerPool::Ptr contact_manager_pool,
+    KinematicsCache::Ptr kinematics_cache)
+  : SingleTimestepCollisionEvaluator(std::move(manip),
+                                     std::move(env),
+                                     std::move(adjacency_map),
+                                     world_to_base,
+                                     std::move(safety_margin_data),
+                                     contact_test_type,
+                                     std::move(vars),
+                                     type,
+                                     safety_margin_buffer,
+                                     false,
+                                     std::move(contact_manager_pool),
+                                     std::move(kinematics_cache))
+  , sphere_model_(std::move(sphere_model))
+  , exact_trust_region_size_(exact_trust_region_size)
+{
+  if (sphere_model_ == nullptr || !sphere_model_->isValid() ||
+      sphere_model_->getActiveLinkNames() != adjacency_map_->getActiveLinkNames())
+    PRINT_AND_THROW("The sphere model does not match the active links of SingleTimestepSphereCollisionEvaluator!");
+}
+
+void SingleTimestepSphereCollisionEvaluator::CalcCollisions(const DblVec& x,
+                                                            tesseract_collision::ContactResultMap& dist_results)
+{
+  if (!use_approximation_)
+  {
+    SingleTimestepCollisionEvaluator::CalcCollisions(x, dist_results);
+    return;
+  }
+
+  tesseract_common::VectorIsometry3d link_transforms;
+  CalcActiveLinkTransforms(sco::getVec(x, vars0_), link_transforms);
+  ++num_contact_tests_;
+  sphere_model_->contactTest(
+      dist_results, link_transforms, contactDistanceFn(safety_margin_data_, safety_margin_buffer_), contact_test_type_);
+}
+
+bool SingleTimestepSphereCollisionEvaluator::setTrustRegionSize(double trust_box_size)
+{
+  if (trust_box_size >= exact_trust_region_size_)
+    return false;
+
+  return useExactGeometry();
+}
+
+bool SingleTimestepSphereCollisionEvaluator::useExactGeometry()
+{
+  if (!use_approximation_)
+    return false;
+
+  setUseApproximation(false);
+  return true;
+}
+
+void SingleTimestepSphereCollisionEvaluator::setUseApproximation(bool use_approximation)
+{
+  if (use_approximation == use_approximation_)
+    return;
+
+  use_approximation_ = use_approximation;
+  ClearCollisionCache();
+}
+
+DiscreteSphereCollisionEvaluator::DiscreteSphereCollisionEvaluator(
+    tesseract_kinematics::ForwardKinematics::ConstPtr manip,
+    tesseract_environment::Environment::ConstPtr env,
+    tesseract_environment::AdjacencyMap::ConstPtr adjacency_map,
+    const Eigen::Isometry3d& world_to_base,
+    SafetyMarginData::ConstPtr safety_margin_data,
+    tesseract_collision::ContactTestType contact_test_type,
+    double longest_valid_segment_length,
+    sco::VarVector vars0,
+    sco::VarVector vars1,
+    CollisionExpressionEvaluatorType type,
+    double safety_margin_buffer,
+    SphereRobotModel::ConstPtr sphere_model,
+    double exact_trust_region_size,
+    ContactManagerPool::Ptr contact_manager_pool,
+    KinematicsCache::Ptr kinematics_cache)
+  : DiscreteCollisionEvaluator(std::move(manip),
+                               std::move(env),
+                               std::move(adjacency_map),
+                               world_to_base,
+                               std::move(safety_margin_data),
+                               contact_test_type,
+                               longest_valid_segment_length,
+                               std::move(vars0),
+                               std::move(vars1),
+                               type,
+                               safety_margin_buffer,
+                               std::move(contact_manager_pool),
+                               std::move(kinematics_cache))
+  , sphere_model_(std::move(sphere_model))
+  , exact_trust_region_size_(exact_trust_region_size)
+{
+  if (sphere_model_ == nullptr || !sphere_model_->isValid() ||
+      sphere_model_->getActiveLinkNames() != adjacency_map_->getActiveLinkNames())
+    PRINT_AND_THROW("The sphere model does not match the active links of DiscreteSphereCollisionEvaluator!");
+}
+
+void DiscreteSphereCollisionEvaluator::CalcCollisions(const DblVec& x,
+                                                      tesseract_collision::ContactResultMap& dist_results)
+{
+  if (!use_approximation_)
+  {
+    DiscreteCollisionEvaluator::CalcCollisions(x, dist_results);
+    return;
+  }
+
+  auto contact_distance_fn = contactDistanceFn(safety_margin_data_, safety_margin_buffer_);
+  auto contact_test = [this, &contact_distance_fn](const tesseract_common::VectorIsometry3d& link_transforms,
+                                                   tesseract_collision::ContactResultMap& contacts) {
+    ++num_contact_tests_;
+    sphere_model_->contactTest(contacts, link_transforms, contact_distance_fn, contact_test_type_);
+  };
+  CalcInterpolatedCollisions(x, contact_test, dist_results);
+}
+
+bool DiscreteSphereCollisionEvaluator::setTrustRegionSize(double trust_box_size)
+{
+  if (trust_box_size >= exact_trust_region_size_)
+    return false;
+
+  return useExactGeometry();
+}
+
+bool DiscreteSphereCollisionEvaluator::useExactGeometry()
+{
+  if (!use_approximation_)
+    return false;
+
+  setUseApproximation(false);
+  return true;
+}
+
+void DiscreteSphereCollisionEvaluator::setUseApproximation(bool use_approximation)
+{
+  if (use_approximation == use_approximation_)
+    return;
+
+  use_approximation_ = use_approximation;
+  ClearCollisionCache();
+}
+
+////////////////////////////////////////
+
 CastCollisionEvaluator::CastCollisionEvaluator(tesseract_kinematics::ForwardKinematics::ConstPtr manip,
                                                tesseract_environment::Environment::ConstPtr env,
                                                tesseract_environment::AdjacencyMap::ConstPtr adjacency_map,
@@ -1279,7 +1997,9 @@ CastCollisionEvaluator::CastCollisionEvaluator(tesseract_kinematics::ForwardKine
                                                sco::VarVector vars0,
                                                sco::VarVector vars1,
                                                CollisionExpressionEvaluatorType type,
-                                               double safety_margin_buffer)
+                                               double safety_margin_buffer,
+                                               ContactManagerPool::Ptr contact_manager_pool,
+                                               KinematicsCache::Ptr kinematics_cache)
   : CollisionEvaluator(std::move(manip),
                        std::move(env),
                        std::move(adjacency_map),
@@ -1287,17 +2007,15 @@ CastCollisionEvaluator::CastCollisionEvaluator(tesseract_kinematics::ForwardKine
                        std::move(safety_margin_data),
                        contact_test_type,
                        longest_valid_segment_length,
-                       safety_margin_buffer)
+                       safety_margin_buffer,
+                       false,
+                       std::move(contact_manager_pool),
+                       std::move(kinematics_cache))
 {
   vars0_ = std::move(vars0);
   vars1_ = std::move(vars1);
   evaluator_type_ = type;
 
-  contact_manager_ = env_->getContinuousContactManager();
-  contact_manager_->setActiveCollisionObjects(adjacency_map_->getActiveLinkNames());
-  /** @todo Should remove trajopt safety margin data structure and use the one from tesseract */
-  contact_manager_->setDefaultCollisionMarginData(safety_margin_data_->getMaxSafetyMargin() + safety_margin_buffer_);
-
   switch (evaluator_type_)
   {
     case CollisionExpressionEvaluatorType::START_FREE_END_FREE:
@@ -1372,6 +2090,8 @@ void CastCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eigen::Vector
                                             const Eigen::Ref<const Eigen::VectorXd>& dof_vals1,
                                             tesseract_collision::ContactResultMap& dist_results)
 {
+  ContactManagerPool::ContinuousLease contact_manager = contact_manager_pool_->leaseContinuous(contact_manager_config_);
+
   // The first step is to see if the distance between two states is larger than the longest valid segment. If larger
   // the collision checking is broken up into multiple casted collision checks such that each check is less then
   // the longest valid segment length.
@@ -1390,18 +2110,41 @@ void CastCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eigen::Vector
     std::vector<tesseract_collision::ContactResultMap> contacts_vector;
     contacts_vector.reserve(static_cast<size_t>(subtraj.rows()));
     bool contact_found = false;
+    // The end transforms of a segment are the start transforms of the next one
+    tesseract_common::VectorIsometry3d link_transforms0;
+    tesseract_common::VectorIsometry3d link_transforms1;
+    CalcActiveLinkTransforms(subtraj.row(0), link_transforms1);
+
+    // When subdividing adaptively, the segments which the links cannot reach from the end of the last checked one
+    // without using up its clearance are skipped
+    bool adaptive = useAdaptiveSubdivision();
+    double step_motion = adaptive ? motion_bounds_->calcRelativeMotion(subtraj.row(1) - subtraj.row(0)) : 0;
+    double clearance = -1;
+    int last_checked = 0;
     for (int i = 0; i < subtraj.rows() - 1; ++i)
     {
       tesseract_collision::ContactResultMap contacts;
-      tesseract_environment::EnvState::Ptr state0 = state_solver_->getState(manip_->getJointNames(), subtraj.row(i));
-      tesseract_environment::EnvState::Ptr state1 =
-          state_solver_->getState(manip_->getJointNames(), subtraj.row(i + 1));
+      if (adaptive && static_cast<double>(i - last_checked) * step_motion < clearance)
+      {
+        contacts_vector.push_back(contacts);
+        continue;
+      }
 
-      for (const auto& link_name : adjacency_map_->getActiveLinkNames())
-        contact_manager_->setCollisionObjectsTransform(
-            link_name, state0->link_transforms[link_name], state1->link_transforms[link_name]);
+      if (adaptive && i > 0 && i != last_checked + 1)
+        CalcActiveLinkTransforms(subtraj.row(i), link_transforms1);
+      link_transforms0.swap(link_transforms1);
+      CalcActiveLinkTransforms(subtraj.row(i + 1), link_transforms1);
+      contact_manager->setCollisionObjectsTransform(
+          adjacency_map_->getActiveLinkNames(), link_transforms0, link_transforms1);
+
+      ++num_contact_tests_;
+      contact_manager->contactTest(contacts, contact_test_type_);
+      if (adaptive)
+      {
+        clearance = removeAdaptiveSubdivisionContacts(contacts);
+        last_checked = i;
+      }
 
-      contact_manager_->contactTest(contacts, contact_test_type_);
       if (!contacts.empty())
         contact_found = true;
 
@@ -1413,13 +2156,17 @@ void CastCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eigen::Vector
   }
   else
   {
-    tesseract_environment::EnvState::Ptr state0 = state_solver_->getState(manip_->getJointNames(), dof_vals0);
-    tesseract_environment::EnvState::Ptr state1 = state_solver_->getState(manip_->getJointNames(), dof_vals1);
-    for (const auto& link_name : adjacency_map_->getActiveLinkNames())
-      contact_manager_->setCollisionObjectsTransform(
-          link_name, state0->link_transforms[link_name], state1->link_transforms[link_name]);
-
-    contact_manager_->contactTest(dist_results, contact_test_type_);
+    tesseract_common::VectorIsometry3d link_transforms0;
+    tesseract_common::VectorIsometry3d link_transforms1;
+    CalcActiveLinkTransforms(dof_vals0, link_transforms0);
+    CalcActiveLinkTransforms(dof_vals1, link_transforms1);
+    contact_manager->setCollisionObjectsTransform(
+        adjacency_map_->getActiveLinkNames(), link_transforms0, link_transforms1);
+
+    ++num_contact_tests_;
+    contact_manager->contactTest(dist_results, contact_test_type_);
+    if (useAdaptiveSubdivision())
+      removeAdaptiveSubdivisionContacts(dist_results);
 
     // Dont include contacts at the fixed state
     for (auto& pair : dist_results)
@@ -1440,8 +2187,8 @@ void CastCollisionEvaluator::CalcDistExpressions(const DblVec& x,
 
 void CastCollisionEvaluator::Plot(const tesseract_visualization::Visualization::Ptr& plotter, const DblVec& x)
 {
-  tesseract_collision::ContactResultVector dist_results;
-  GetCollisionsCached(x, dist_results);
+  CollisionCacheData::ConstPtr collisions = GetCollisionsCached(x);
+  const tesseract_collision::ContactResultVector& dist_results = collisions->contact_results_vector;
   Eigen::VectorXd dofvals = sco::getVec(x, vars0_);
 
   Eigen::VectorXd safety_distance(dist_results.size());
@@ -1526,7 +2273,8 @@ CollisionCost::CollisionCost(tesseract_kinematics::ForwardKinematics::ConstPtr m
                              tesseract_collision::ContactTestType contact_test_type,
                              sco::VarVector vars,
                              CollisionExpressionEvaluatorType type,
-                             double safety_margin_buffer)
+                             double safety_margin_buffer,
+                             ContactManagerPool::Ptr contact_manager_pool)
   : Cost("collision")
 {
   m_calc = std::make_shared<SingleTimestepCollisionEvaluator>(std::move(manip),
@@ -1537,7 +2285,9 @@ CollisionCost::CollisionCost(tesseract_kinematics::ForwardKinematics::ConstPtr m
                                                               contact_test_type,
                                                               std::move(vars),
                                                               type,
-                                                              safety_margin_buffer);
+                                                              safety_margin_buffer,
+                                                              false,
+                                                              std::move(contact_manager_pool));
 }
 
 CollisionCost::CollisionCost(tesseract_kinematics::ForwardKinematics::ConstPtr manip,
@@ -1551,7 +2301,8 @@ CollisionCost::CollisionCost(tesseract_kinematics::ForwardKinematics::ConstPtr m
                              sco::VarVector vars1,
                              CollisionExpressionEvaluatorType type,
                              bool discrete,
-                             double safety_margin_buffer)
+                             double safety_margin_buffer,
+                             ContactManagerPool::Ptr contact_manager_pool)
 {
   if (discrete)
   {
@@ -1566,7 +2317,8 @@ CollisionCost::CollisionCost(tesseract_kinematics::ForwardKinematics::ConstPtr m
                                                           std::move(vars0),
                                                           std::move(vars1),
                                                           type,
-                                                          safety_margin_buffer);
+                                                          safety_margin_buffer,
+                                                          std::move(contact_manager_pool));
   }
   else
   {
@@ -1581,7 +2333,8 @@ CollisionCost::CollisionCost(tesseract_kinematics::ForwardKinematics::ConstPtr m
                                                       std::move(vars0),
                                                       std::move(vars1),
                                                       type,
-                                                      safety_margin_buffer);
+                                                      safety_margin_buffer,
+                                                      std::move(contact_manager_pool));
   }
 }
 
@@ -1594,8 +2347,6 @@ sco::ConvexObjective::Ptr CollisionCost::convex(const sco::DblVec& x, sco::Model
   m_calc->CalcDistExpressions(x, exprs, exprs_data);
   assert(exprs.size() == exprs_data.size());
 
-  tesseract_collision::ContactResultVector dist_results;
-  m_calc->GetCollisionsCached(x, dist_results);
   for (std::size_t i = 0; i < exprs.size(); ++i)
   {
     // Contains the contact distance threshold and coefficient for the given link pair
@@ -1610,10 +2361,9 @@ sco::ConvexObjective::Ptr CollisionCost::convex(const sco::DblVec& x, sco::Model
 double CollisionCost::value(const sco::DblVec& x)
 {
   DblVec dists;
-  m_calc->CalcDists(x, dists);
+  CollisionCacheData::ConstPtr collisions = m_calc->GetCollisionsEstimated(x, dists);
+  const tesseract_collision::ContactResultVector& dist_results = collisions->contact_results_vector;
 
-  tesseract_collision::ContactResultVector dist_results;
-  m_calc->GetCollisionsCached(x, dist_results);
   double out = 0;
   for (std::size_t i = 0; i < dists.size(); ++i)
   {
@@ -1625,6 +2375,8 @@ double CollisionCost::value(const sco::DblVec& x)
   return out;
 }
 
+CollisionCost::CollisionCost(CollisionEvaluator::Ptr calc) : Cost("collision"), m_calc(std::move(calc)) {}
+
 void CollisionCost::Plot(const tesseract_visualization::Visualization::Ptr& plotter, const DblVec& x)
 {
   m_calc->Plot(plotter, x);
@@ -1639,7 +2391,8 @@ CollisionConstraint::CollisionConstraint(tesseract_kinematics::ForwardKinematics
                                          tesseract_collision::ContactTestType contact_test_type,
                                          sco::VarVector vars,
                                          CollisionExpressionEvaluatorType type,
-                                         double safety_margin_buffer)
+                                         double safety_margin_buffer,
+                                         ContactManagerPool::Ptr contact_manager_pool)
 {
   name_ = "collision";
   m_calc = std::make_shared<SingleTimestepCollisionEvaluator>(std::move(manip),
@@ -1650,7 +2403,9 @@ CollisionConstraint::CollisionConstraint(tesseract_kinematics::ForwardKinematics
                                                               contact_test_type,
                                                               std::move(vars),
                                                               type,
-                                                              safety_margin_buffer);
+                                                              safety_margin_buffer,
+                                                              false,
+                                                              std::move(contact_manager_pool));
 }
 
 CollisionConstraint::CollisionConstraint(tesseract_kinematics::ForwardKinematics::ConstPtr manip,
@@ -1664,7 +2419,8 @@ CollisionConstraint::CollisionConstraint(tesseract_kinematics::ForwardKinematics
                                          sco::VarVector vars1,
                                          CollisionExpressionEvaluatorType type,
                                          bool discrete,
-                                         double safety_margin_buffer)
+                                         double safety_margin_buffer,
+                                         ContactManagerPool::Ptr contact_manager_pool)
 {
   if (discrete)
   {
@@ -1679,7 +2435,8 @@ CollisionConstraint::CollisionConstraint(tesseract_kinematics::ForwardKinematics
                                                           std::move(vars0),
                                                           std::move(vars1),
                                                           type,
-                                                          safety_margin_buffer);
+                                                          safety_margin_buffer,
+                                                          std::move(contact_manager_pool));
   }
   else
   {
@@ -1694,10 +2451,16 @@ CollisionConstraint::CollisionConstraint(tesseract_kinematics::ForwardKinematics
                                                       std::move(vars0),
                                                       std::move(vars1),
                                                       type,
-                                                      safety_margin_buffer);
+                                                      safety_margin_buffer,
+                                                      std::move(contact_manager_pool));
   }
 }
 
+CollisionConstraint::CollisionConstraint(CollisionEvaluator::Ptr calc) : m_calc(std::move(calc))
+{
+  name_ = "collision";
+}
+
 sco::ConvexConstraints::Ptr CollisionConstraint::convex(const sco::DblVec& x, sco::Model* model)
 {
   auto out = std::make_shared<sco::ConvexConstraints>(model);
@@ -1707,8 +2470,6 @@ sco::ConvexConstraints::Ptr CollisionConstraint::convex(const sco::DblVec& x, sc
   m_calc->CalcDistExpressions(x, exprs, exprs_data);
   assert(exprs.size() == exprs_data.size());
 
-  tesseract_collision::ContactResultVector dist_results;
-  m_calc->GetCollisionsCached(x, dist_results);
   for (std::size_t i = 0; i < exprs.size(); ++i)
   {
     // Contains the contact distance threshold and coefficient for the given link pair
@@ -1723,10 +2484,9 @@ sco::ConvexConstraints::Ptr CollisionConstraint::convex(const sco::DblVec& x, sc
 DblVec CollisionConstraint::value(const sco::DblVec& x)
 {
   DblVec dists;
-  m_calc->CalcDists(x, dists);
+  CollisionCacheData::ConstPtr collisions = m_calc->GetCollisionsEstimated(x, dists);
+  const tesseract_collision::ContactResultVector& dist_results = collisions->contact_results_vector;
 
-  tesseract_collision::ContactResultVector dist_results;
-  m_calc->GetCollisionsCached(x, dist_results);
   DblVec out(dists.size());
   for (std::size_t i = 0; i < dists.size(); ++i)
   {
@@ -1738,4 +2498,173 @@ DblVec CollisionConstraint::value(const sco::DblVec& x)
   }
   return out;
 }
+
+//////////////////////////////////////////
+
+TrajectoryCollisionEvaluator::TrajectoryCollisionEvaluator(std::vector<CollisionEvaluator::Ptr> evaluators,
+                                                           int n_threads)
+  : evaluators_(std::move(evaluators))
+{
+  // Adjacent timesteps share variables, the optimizer expects each of them once
+  std::unordered_set<const sco::VarRep*> added;
+  for (const CollisionEvaluator::Ptr& evaluator : evaluators_)
+  {
+    for (const sco::Var& var : evaluator->GetVars())
+    {
+      if (added.insert(var.var_rep.get()).second)
+        vars_.push_back(var);
+    }
+  }
+
+  if (n_threads > 1 && evaluators_.size() > 1)
+    thread_pool_ = std::make_unique<util::ThreadPool>(
+        std::min(static_cast<std::size_t>(n_threads), evaluators_.size()));
+}
+
+TrajectoryCollisionEvaluator::~TrajectoryCollisionEvaluator() = default;
+TrajectoryCollisionEvaluator::TrajectoryCollisionEvaluator(TrajectoryCollisionEvaluator&&) noexcept = default;
+TrajectoryCollisionEvaluator&
+TrajectoryCollisionEvaluator::operator=(TrajectoryCollisionEvaluator&&) noexcept = default;
+
+void TrajectoryCollisionEvaluator::forEachEvaluator(const std::function<void(std::size_t)>& fn)
+{
+  if (thread_pool_)
+  {
+    thread_pool_->parallelFor(evaluators_.size(), fn);
+    return;
+  }
+
+  for (std::size_t i = 0; i < evaluators_.size(); ++i)
+    fn(i);
+}
+
+void TrajectoryCollisionEvaluator::CalcDistExpressions(const DblVec& x,
+                                                       sco::AffExprVector& exprs,
+                                                       AlignedVector<Eigen::Vector2d>& exprs_data)
+{
+  std::vector<sco::AffExprVector> step_exprs(evaluators_.size());
+  std::vector<AlignedVector<Eigen::Vector2d>> step_exprs_data(evaluators_.size());
+  forEachEvaluator([&](std::size_t i) { evaluators_[i]->CalcDistExpressions(x, step_exprs[i], step_exprs_data[i]); });
+
+  std::size_t n_exprs = 0;
+  for (const sco::AffExprVector& e : step_exprs)
+    n_exprs += e.size();
+
+  exprs.clear();
+  exprs_data.clear();
+  exprs.reserve(n_exprs);
+  exprs_data.reserve(n_exprs);
+  for (std::size_t i = 0; i < evaluators_.size(); ++i)
+  {
+    assert(step_exprs[i].size() == step_exprs_data[i].size());
+    std::move(step_exprs[i].begin(), step_exprs[i].end(), std::back_inserter(exprs));
+    exprs_data.insert(exprs_data.end(), step_exprs_data[i].begin(), step_exprs_data[i].end());
+  }
+}
+
+void TrajectoryCollisionEvaluator::CalcViolations(const DblVec& x, DblVec& viols)
+{
+  std::vector<DblVec> step_viols(evaluators_.size());
+  forEachEvaluator([&](std::size_t i) {
+    const CollisionEvaluator::Ptr& evaluator = evaluators_[i];
+    DblVec dists;
+    CollisionCacheData::ConstPtr collisions = evaluator->GetCollisionsEstimated(x, dists);
+    const tesseract_collision::ContactResultVector& dist_results = collisions->contact_results_vector;
+
+    DblVec& out = step_viols[i];
+    out.reserve(dist_results.size());
+    for (std::size_t j = 0; j < dist_results.size(); ++j)
+    {
+      // Contains the contact distance threshold and coefficient for the given link pair
+      const Eigen::Vector2d& data = evaluator->getSafetyMarginData()->getPairSafetyMarginData(
+          dist_results[j].link_names[0], dist_results[j].link_names[1]);
+      out.push_back(sco::pospart(data[0] - dists[j]) * data[1]);
+    }
+  });
+
+  viols.clear();
+  for (const DblVec& v : step_viols)
+    viols.insert(viols.end(), v.begin(), v.end());
+}
+
+void TrajectoryCollisionEvaluator::Plot(const tesseract_visualization::Visualization::Ptr& plotter, const DblVec& x)
+{
+  for (const CollisionEvaluator::Ptr& evaluator : evaluators_)
+    evaluator->Plot(plotter, x);
+}
+
+bool TrajectoryCollisionEvaluator::isThreadSafe() const
+{
+  return std::all_of(evaluators_.begin(), evaluators_.end(), [](const CollisionEvaluator::Ptr& evaluator) {
+    return evaluator->isThreadSafe();
+  });
+}
+
+TrajectoryCollisionCost::TrajectoryCollisionCost(std::vector<CollisionEvaluator::Ptr> evaluators, int n_threads)
+  : Cost("trajectory_collision")
+  , m_calc(std::make_shared<TrajectoryCollisionEvaluator>(std::move(evaluators), n_threads))
+{
+}
+
+sco::ConvexObjective::Ptr TrajectoryCollisionCost::convex(const sco::DblVec& x, sco::Model* model)
+{
+  auto out = std::make_shared<sco::ConvexObjective>(model);
+  sco::AffExprVector exprs;
+  AlignedVector<Eigen::Vector2d> exprs_data;
+
+  m_calc->CalcDistExpressions(x, exprs, exprs_data);
+  for (std::size_t i = 0; i < exprs.size(); ++i)
+  {
+    // Contains the contact distance threshold and coefficient for the given link pair
+    const Eigen::Vector2d& data = exprs_data[i];
+
+    sco::AffExpr viol = sco::exprSub(sco::AffExpr(data[0]), exprs[i]);
+    out->addHinge(viol, data[1]);
+  }
+  return out;
+}
+
+double TrajectoryCollisionCost::value(const sco::DblVec& x)
+{
+  DblVec viols;
+  m_calc->CalcViolations(x, viols);
+  return std::accumulate(viols.begin(), viols.end(), 0.0);
+}
+
+void TrajectoryCollisionCost::Plot(const tesseract_visualization::Visualization::Ptr& plotter, const DblVec& x)
+{
+  m_calc->Plot(plotter, x);
+}
+
+TrajectoryCollisionConstraint::TrajectoryCollisionConstraint(std::vector<CollisionEvaluator::Ptr> evaluators,
+                                                             int n_threads)
+  : m_calc(std::make_shared<TrajectoryCollisionEvaluator>(std::move(evaluators), n_threads))
+{
+  name_ = "trajectory_collision";
+}
+
+sco::ConvexConstraints::Ptr TrajectoryCollisionConstraint::convex(const sco::DblVec& x, sco::Model* model)
+{
+  auto out = std::make_shared<sco::ConvexConstraints>(model);
+  sco::AffExprVector exprs;
+  AlignedVector<Eigen::Vector2d> exprs_data;
+
+  m_calc->CalcDistExpressions(x, exprs, exprs_data);
+  for (std::size_t i = 0; i < exprs.size(); ++i)
+  {
+    // Contains the contact distance threshold and coefficient for the given link pair
+    const Eigen::Vector2d& data = exprs_data[i];
+
+    sco::AffExpr viol = sco::exprSub(sco::AffExpr(data[0]), exprs[i]);
+    out->addIneqCnt(sco::exprMult(viol, data[1]));
+  }
+  return out;
+}
+
+DblVec TrajectoryCollisionConstraint::value(const sco::DblVec& x)
+{
+  DblVec viols;
+  m_calc->CalcViolations(x, viols);
+  return viols;
+}
 }  // namespace trajopt
@@ -0,0 +1,12 @@
+#include <trajopt/contact_manager_pool.hpp>
+
+namespace trajopt
+{
+ContactManagerPool::ContactManagerPool(tesseract_environment::Environment::ConstPtr env)
+  : env_(std::move(env))
+  , discrete_([this]() { return env_->getDiscreteContactManager(); })
+  , continuous_([this]() { return env_->getContinuousContactManager(); })
+  , state_solvers_([this]() { return env_->getStateSolver(); })
+{
+}
+}  // namespace trajopt
@@ -55,8 +55,8 @@ namespace trajopt
 {
 VectorXd DynamicCartPoseErrCalculator::operator()(const VectorXd& dof_vals) const
 {
-  Isometry3d new_pose = manip_->calcFwdKin(dof_vals, kin_link_->link_name);
-  Isometry3d target_pose = manip_->calcFwdKin(dof_vals, kin_target_->link_name);
+  Isometry3d new_pose = kin_cache_->calcFwdKin(dof_vals, kin_link_->link_name);
+  Isometry3d target_pose = kin_cache_->calcFwdKin(dof_vals, kin_target_->link_name);
 
   Eigen::Isometry3d link_tf = world_to_base_ * new_pose * kin_link_->transform * tcp_;
   Eigen::Isometry3d target_tf = world_to_base_ * target_pose * kin_target_->transform * target_tcp_;
@@ -72,8 +72,8 @@ VectorXd DynamicCartPoseErrCalculator::operator()(const VectorXd& dof_vals) cons
 void DynamicCartPoseErrCalculator::Plot(const tesseract_visualization::Visualization::Ptr& plotter,
                                         const VectorXd& dof_vals)
 {
-  Isometry3d cur_pose = manip_->calcFwdKin(dof_vals, kin_link_->link_name);
-  Isometry3d target_pose = manip_->calcFwdKin(dof_vals, kin_target_->link_name);
+  Isometry3d cur_pose = kin_cache_->calcFwdKin(dof_vals, kin_link_->link_name);
+  Isometry3d target_pose = kin_cache_->calcFwdKin(dof_vals, kin_target_->link_name);
 
   Eigen::Isometry3d cur_tf = world_to_base_ * cur_pose * kin_link_->transform * tcp_;
   Eigen::Isometry3d target_tf = world_to_base_ * target_pose * kin_target_->transform * target_tcp_;
@@ -95,21 +95,21 @@ void DynamicCartPoseErrCalculator::Plot(const tesseract_visualization::Visualiza
 MatrixXd DynamicCartPoseJacCalculator::operator()(const VectorXd& dof_vals) const
 {
   auto n_dof = static_cast<int>(manip_->numJoints());
-  Isometry3d cur_pose = manip_->calcFwdKin(dof_vals, kin_link_->link_name);
-  Isometry3d target_pose = manip_->calcFwdKin(dof_vals, kin_target_->link_name);
+  Isometry3d cur_pose = kin_cache_->calcFwdKin(dof_vals, kin_link_->link_name);
+  Isometry3d target_pose = kin_cache_->calcFwdKin(dof_vals, kin_target_->link_name);
 
   Eigen::Isometry3d cur_tf = world_to_base_ * cur_pose * kin_link_->transform * tcp_;
   Eigen::Isometry3d target_tf = world_to_base_ * target_pose * kin_target_->transform * target_tcp_;
 
   // Get the jacobian of link in the targets coordinate system
-  MatrixXd jac_link = manip_->calcJacobian(dof_vals, kin_link_->link_name);
+  MatrixXd jac_link = kin_cache_->calcJacobian(dof_vals, kin_link_->link_name);
   tesseract_kinematics::jacobianChangeBase(jac_link, world_to_base_);
   tesseract_kinematics::jacobianChangeRefPoint(
       jac_link, (world_to_base_ * cur_pose).linear() * (kin_link_->transform * tcp_).translation());
   tesseract_kinematics::jacobianChangeBase(jac_link, target_tf.inverse());
 
   // Get the jacobian of the target in the targets coordinate system
-  MatrixXd jac_target = manip_->calcJacobian(dof_vals, kin_target_->link_name);
+  MatrixXd jac_target = kin_cache_->calcJacobian(dof_vals, kin_target_->link_name);
   tesseract_kinematics::jacobianChangeBase(jac_target, world_to_base_);
   tesseract_kinematics::jacobianChangeRefPoint(
       jac_target, (world_to_base_ * target_pose).linear() * (kin_target_->transform * target_tcp_).translation());
@@ -151,7 +151,7 @@ MatrixXd DynamicCartPoseJacCalculator::operator()(const VectorXd& dof_vals) cons
 
 VectorXd CartPoseErrCalculator::operator()(const VectorXd& dof_vals) const
 {
-  Isometry3d new_pose = manip_->calcFwdKin(dof_vals, kin_link_->link_name);
+  Isometry3d new_pose = kin_cache_->calcFwdKin(dof_vals, kin_link_->link_name);
 
   new_pose = world_to_base_ * new_pose * kin_link_->transform * tcp_;
 
@@ -166,7 +166,7 @@ VectorXd CartPoseErrCalculator::operator()(const VectorXd& dof_vals) const
 
 void CartPoseErrCalculator::Plot(const tesseract_visualization::Visualization::Ptr& plotter, const VectorXd& dof_vals)
 {
-  Isometry3d cur_pose = manip_->calcFwdKin(dof_vals, kin_link_->link_name);
+  Isometry3d cur_pose = kin_cache_->calcFwdKin(dof_vals, kin_link_->link_name);
   cur_pose = world_to_base_ * cur_pose * kin_link_->transform * tcp_;
 
   Isometry3d target = pose_inv_.inverse();
@@ -187,8 +187,8 @@ void CartPoseErrCalculator::Plot(const tesseract_visualization::Visualization::P
 
 MatrixXd CartPoseJacCalculator::operator()(const VectorXd& dof_vals) const
 {
-  Eigen::Isometry3d tf0 = manip_->calcFwdKin(dof_vals, kin_link_->link_name);
-  MatrixXd jac0 = manip_->calcJacobian(dof_vals, kin_link_->link_name);
+  Eigen::Isometry3d tf0 = kin_cache_->calcFwdKin(dof_vals, kin_link_->link_name);
+  MatrixXd jac0 = kin_cache_->calcJacobian(dof_vals, kin_link_->link_name);
   tesseract_kinematics::jacobianChangeBase(jac0, world_to_base_);
   tesseract_kinematics::jacobianChangeRefPoint(
       jac0, (world_to_base_ * tf0).linear() * (kin_link_->transform * tcp_).translation());
@@ -238,28 +238,28 @@ MatrixXd CartVelJacCalculator::operator()(const VectorXd& dof_vals) const
 
   if (tcp_.translation().isZero())
   {
-    tf0 = manip_->calcFwdKin(dof_vals.topRows(n_dof), kin_link_->link_name);
-    jac0 = manip_->calcJacobian(dof_vals.topRows(n_dof), kin_link_->link_name);
+    tf0 = kin_cache_->calcFwdKin(dof_vals.topRows(n_dof), kin_link_->link_name);
+    jac0 = kin_cache_->calcJacobian(dof_vals.topRows(n_dof), kin_link_->link_name);
     tesseract_kinematics::jacobianChangeBase(jac0, world_to_base_);
     tesseract_kinematics::jacobianChangeRefPoint(jac0,
                                                  (world_to_base_ * tf0).linear() * kin_link_->transform.translation());
 
-    tf1 = manip_->calcFwdKin(dof_vals.bottomRows(n_dof), kin_link_->link_name);
-    jac1 = manip_->calcJacobian(dof_vals.bottomRows(n_dof), kin_link_->link_name);
+    tf1 = kin_cache_->calcFwdKin(dof_vals.bottomRows(n_dof), kin_link_->link_name);
+    jac1 = kin_cache_->calcJacobian(dof_vals.bottomRows(n_dof), kin_link_->link_name);
     tesseract_kinematics::jacobianChangeBase(jac1, world_to_base_);
     tesseract_kinematics::jacobianChangeRefPoint(jac1,
                                                  (world_to_base_ * tf1).linear() * kin_link_->transform.translation());
   }
   else
   {
-    tf0 = manip_->calcFwdKin(dof_vals.topRows(n_dof), kin_link_->link_name);
-    jac0 = manip_->calcJacobian(dof_vals.topRows(n_dof), kin_link_->link_name);
+    tf0 = kin_cache_->calcFwdKin(dof_vals.topRows(n_dof), kin_link_->link_name);
+    jac0 = kin_cache_->calcJacobian(dof_vals.topRows(n_dof), kin_link_->link_name);
     tesseract_kinematics::jacobianChangeBase(jac0, world_to_base_);
     tesseract_kinematics::jacobianChangeRefPoint(
         jac0, (world_to_base_ * tf0).linear() * (kin_link_->transform * tcp_).translation());
 
-    tf1 = manip_->calcFwdKin(dof_vals.bottomRows(n_dof), kin_link_->link_name);
-    jac1 = manip_->calcJacobian(dof_vals.bottomRows(n_dof), kin_link_->link_name);
+    tf1 = kin_cache_->calcFwdKin(dof_vals.bottomRows(n_dof), kin_link_->link_name);
+    jac1 = kin_cache_->calcJacobian(dof_vals.bottomRows(n_dof), kin_link_->link_name);
     tesseract_kinematics::jacobianChangeBase(jac1, world_to_base_);
     tesseract_kinematics::jacobianChangeRefPoint(
         jac1, (world_to_base_ * tf1).linear() * (kin_link_->transform * tcp_).translation());
@@ -275,8 +275,8 @@ MatrixXd CartVelJacCalculator::operator()(const VectorXd& dof_vals) const
 VectorXd CartVelErrCalculator::operator()(const VectorXd& dof_vals) const
 {
   auto n_dof = static_cast<int>(manip_->numJoints());
-  Isometry3d pose0 = manip_->calcFwdKin(dof_vals.topRows(n_dof), kin_link_->link_name);
-  Isometry3d pose1 = manip_->calcFwdKin(dof_vals.bottomRows(n_dof), kin_link_->link_name);
+  Isometry3d pose0 = kin_cache_->calcFwdKin(dof_vals.topRows(n_dof), kin_link_->link_name);
+  Isometry3d pose1 = kin_cache_->calcFwdKin(dof_vals.bottomRows(n_dof), kin_link_->link_name);
 
   pose0 = world_to_base_ * pose0 * kin_link_->transform * tcp_;
   pose1 = world_to_base_ * pose1 * kin_link_->transform * tcp_;
@@ -449,7 +449,7 @@ MatrixXd TimeCostJacCalculator::operator()(const VectorXd& var_vals) const
 VectorXd AvoidSingularityErrCalculator::operator()(const VectorXd& var_vals) const
 {
   // Calculate the SVD of the jacobian at this joint state
-  MatrixXd jacobian = fwd_kin_->calcJacobian(var_vals, link_name_);
+  MatrixXd jacobian = kin_cache_->calcJacobian(var_vals, link_name_);
   JacobiSVD<MatrixXd> svd(jacobian, Eigen::ComputeThinU | Eigen::ComputeThinV);
 
   // Get the U and V vectors for the smallest singular value
@@ -474,7 +474,7 @@ MatrixXd AvoidSingularityJacCalculator::jacobianPartialDerivative(const VectorXd
   double eps = eps_;
   joints(jntIdx) += eps;
 
-  MatrixXd jacobian_increment = fwd_kin_->calcJacobian(joints, link_name_);
+  MatrixXd jacobian_increment = kin_cache_->calcJacobianUncached(joints, link_name_);
   return (jacobian_increment - jacobian) / eps;
 }
 
@@ -484,7 +484,7 @@ MatrixXd AvoidSingularityJacCalculator::operator()(const VectorXd& var_vals) con
   cost_jacobian.resize(1, var_vals.size());
 
   // Calculate the SVD of the jacobian at this joint state
-  MatrixXd jacobian = fwd_kin_->calcJacobian(var_vals, link_name_);
+  MatrixXd jacobian = kin_cache_->calcJacobian(var_vals, link_name_);
   JacobiSVD<MatrixXd> svd(jacobian, Eigen::ComputeThinU | Eigen::ComputeThinV);
 
   // Get the U and V vectors for the smallest singular value
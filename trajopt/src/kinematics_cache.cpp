@@ -0,0 +1,116 @@
+#include <trajopt/kinematics_cache.hpp>
+
+namespace trajopt
+{
+static KinematicsCacheKey makeKey(const Eigen::Ref<const Eigen::VectorXd>& joint_angles, const std::string& link_name)
+{
+  return KinematicsCacheKey{ link_name,
+                             std::vector<double>(joint_angles.data(), joint_angles.data() + joint_angles.size()) };
+}
+
+KinematicsCache::KinematicsCache(tesseract_kinematics::ForwardKinematics::ConstPtr manip, std::size_t capacity)
+  : manip_(std::move(manip))
+  , kinematics_([this]() { return manip_->clone(); })
+  , pose_cache_(capacity)
+  , jacobian_cache_(capacity)
+{
+}
+
+Eigen::Isometry3d KinematicsCache::calcFwdKin(const Eigen::Ref<const Eigen::VectorXd>& joint_angles,
+                                              const std::string& link_name)
+{
+  if (getCapacity() == 0)
+    return calcFwdKinUncached(joint_angles, link_name);
+
+  KinematicsCacheKey key = makeKey(joint_angles, link_name);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto pose = pose_cache_.get(key))
+      return *pose;
+  }
+
+  // Fixed size Eigen types have to be allocated aligned
+  auto pose = std::allocate_shared<Eigen::Isometry3d>(Eigen::aligned_allocator<Eigen::Isometry3d>(),
+                                                      calcFwdKinUncached(joint_angles, link_name));
+  std::lock_guard<std::mutex> lock(mutex_);
+  pose_cache_.put(std::move(key), pose);
+  return *pose;
+}
+
+Eigen::MatrixXd KinematicsCache::calcJacobian(const Eigen::Ref<const Eigen::VectorXd>& joint_angles,
+                                              const std::string& link_name)
+{
+  if (getCapacity() == 0)
+    return calcJacobianUncached(joint_angles, link_name);
+
+  KinematicsCacheKey key = makeKey(joint_angles, link_name);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto jacobian = jacobian_cache_.get(key))
+      return *jacobian;
+  }
+
+  auto jacobian = std::make_shared<const Eigen::MatrixXd>(calcJacobianUncached(joint_angles, link_name));
+  std::lock_guard<std::mutex> lock(mutex_);
+  jacobian_cache_.put(std::move(key), jacobian);
+  return *jacobian;
+}
+
+Eigen::Isometry3d KinematicsCache::calcFwdKinUncached(const Eigen::Ref<const Eigen::VectorXd>& joint_angles,
+                                                      const std::string& link_name) const
+{
+  CloneStack<tesseract_kinematics::ForwardKinematics>::Lease kin = kinematics_.lease();
+  return kin->calcFwdKin(joint_angles, link_name);
+}
+
+Eigen::MatrixXd KinematicsCache::calcJacobianUncached(const Eigen::Ref<const Eigen::VectorXd>& joint_angles,
+                                                      const std::string& link_name) const
+{
+  CloneStack<tesseract_kinematics::ForwardKinematics>::Lease kin = kinematics_.lease();
+  return kin->calcJacobian(joint_angles, link_name);
+}
+
+void KinematicsCache::setCapacity(std::size_t capacity)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  pose_cache_.setCapacity(capacity);
+  jacobian_cache_.setCapacity(capacity);
+}
+
+std::size_t KinematicsCache::getCapacity() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pose_cache_.getCapacity();
+}
+
+void KinematicsCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  pose_cache_.clear();
+  jacobian_cache_.clear();
+}
+
+long KinematicsCache::getNumFwdKinHits() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pose_cache_.getNumHits();
+}
+
+long KinematicsCache::getNumFwdKinMisses() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pose_cache_.getNumMisses();
+}
+
+long KinematicsCache::getNumJacobianHits() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return jacobian_cache_.getNumHits();
+}
+
+long KinematicsCache::getNumJacobianMisses() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return jacobian_cache_.getNumMisses();
+}
+}  // namespace trajopt
@@ -0,0 +1,176 @@
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
+#include <cmath>
+#include <console_bridge/console.h>
+#include <tesseract_geometry/geometries.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt/link_motion_bounds.hpp>
+
+namespace trajopt
+{
+bool calcCollisionRadius(const tesseract_scene_graph::Link& link, double& radius)
+{
+  radius = 0;
+  for (const auto& collision : link.collision)
+  {
+    const Eigen::Isometry3d& origin = collision->origin;
+    const tesseract_geometry::Geometry::ConstPtr& geometry = collision->geometry;
+    double offset = origin.translation().norm();
+    switch (geometry->getType())
+    {
+      case tesseract_geometry::GeometryType::SPHERE:
+      {
+        const auto& sphere = static_cast<const tesseract_geometry::Sphere&>(*geometry);
+        radius = std::max(radius, offset + sphere.getRadius());
+        break;
+      }
+      case tesseract_geometry::GeometryType::BOX:
+      {
+        const auto& box = static_cast<const tesseract_geometry::Box&>(*geometry);
+        radius = std::max(radius, offset + 0.5 * Eigen::Vector3d(box.getX(), box.getY(), box.getZ()).norm());
+        break;
+      }
+      case tesseract_geometry::GeometryType::CYLINDER:
+      {
+        const auto& cylinder = static_cast<const tesseract_geometry::Cylinder&>(*geometry);
+        radius = std::max(radius, offset + Eigen::Vector2d(cylinder.getRadius(), 0.5 * cylinder.getLength()).norm());
+        break;
+      }
+      case tesseract_geometry::GeometryType::CAPSULE:
+      {
+        const auto& capsule = static_cast<const tesseract_geometry::Capsule&>(*geometry);
+        radius = std::max(radius, offset + capsule.getRadius() + 0.5 * capsule.getLength());
+        break;
+      }
+      case tesseract_geometry::GeometryType::CONE:
+      {
+        const auto& cone = static_cast<const tesseract_geometry::Cone&>(*geometry);
+        radius = std::max(radius, offset + Eigen::Vector2d(cone.getRadius(), 0.5 * cone.getLength()).norm());
+        break;
+      }
+      case tesseract_geometry::GeometryType::MESH:
+      case tesseract_geometry::GeometryType::CONVEX_MESH:
+      case tesseract_geometry::GeometryType::SDF_MESH:
+      {
+        const auto& mesh = static_cast<const tesseract_geometry::PolygonMesh&>(*geometry);
+        // Whether or not the vertices are already scaled, this does not underestimate the extent
+        double scale = std::max(1.0, mesh.getScale().cwiseAbs().maxCoeff());
+        for (const auto& vertex : *mesh.getVertices())
+          radius = std::max(radius, (origin * (scale * vertex)).norm());
+        break;
+      }
+      case tesseract_geometry::GeometryType::OCTREE:
+      {
+        const auto& octree = static_cast<const tesseract_geometry::Octree&>(*geometry);
+        Eigen::Vector3d lower, upper;
+        octree.getOctree()->getMetricMin(lower.x(), lower.y(), lower.z());
+        octree.getOctree()->getMetricMax(upper.x(), upper.y(), upper.z());
+        for (int corner = 0; corner < 8; ++corner)
+        {
+          Eigen::Vector3d point((corner & 1) ? upper.x() : lower.x(),
+                                (corner & 2) ? upper.y() : lower.y(),
+                                (corner & 4) ? upper.z() : lower.z());
+          radius = std::max(radius, (origin * point).norm());
+        }
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+LinkMotionBounds::LinkMotionBounds(const tesseract_kinematics::ForwardKinematics& manip,
+                                   const tesseract_scene_graph::SceneGraph& scene_graph,
+                                   const std::vector<std::string>& link_names)
+  : weights_(Eigen::MatrixXd::Zero(static_cast<Eigen::Index>(link_names.size()), manip.numJoints()))
+{
+  const std::vector<std::string>& joint_names = manip.getJointNames();
+  for (std::size_t i = 0; i < link_names.size() && valid_; ++i)
+  {
+    auto row = static_cast<Eigen::Index>(i);
+    tesseract_scene_graph::Link::ConstPtr link = scene_graph.getLink(link_names[i]);
+    double reach = 0;
+    if (link == nullptr || !calcCollisionRadius(*link, reach))
+    {
+      CONSOLE_BRIDGE_logWarn("LinkMotionBounds: the collision geometry of link '%s' cannot be bounded",
+                             link_names[i].c_str());
+      valid_ = false;
+      break;
+    }
+
+    // Walk up the kinematic chain, where reach bounds the distance from the current link origin to the geometry
+    std::string current = link_names[i];
+    while (current != manip.getBaseLinkName())
+    {
+      std::vector<tesseract_scene_graph::Joint::ConstPtr> joints = scene_graph.getInboundJoints(current);
+      if (joints.empty())
+        break;
+
+      const tesseract_scene_graph::Joint& joint = *joints.front();
+      auto it = std::find(joint_names.begin(), joint_names.end(), joint.getName());
+      auto col = static_cast<Eigen::Index>(std::distance(joint_names.begin(), it));
+      bool is_manip_joint = (it != joint_names.end());
+      switch (joint.type)
+      {
+        case tesseract_scene_graph::JointType::REVOLUTE:
+        case tesseract_scene_graph::JointType::CONTINUOUS:
+        {
+          // The child frame of a revolute joint is located on its axis
+          if (is_manip_joint)
+            weights_(row, col) = std::max(weights_(row, col), reach);
+          break;
+        }
+        case tesseract_scene_graph::JointType::PRISMATIC:
+        {
+          if (joint.limits == nullptr)
+          {
+            valid_ = false;
+            break;
+          }
+          if (is_manip_joint)
+            weights_(row, col) = 1;
+          reach += std::max(std::abs(joint.limits->lower), std::abs(joint.limits->upper));
+          break;
+        }
+        case tesseract_scene_graph::JointType::FIXED:
+          break;
+        default:
+          valid_ = false;
+      }
+
+      if (!valid_)
+      {
+        CONSOLE_BRIDGE_logWarn("LinkMotionBounds: joint '%s' is not supported", joint.getName().c_str());
+        break;
+      }
+
+      reach += joint.parent_to_joint_origin_transform.translation().norm();
+      current = joint.parent_link_name;
+    }
+  }
+}
+
+double LinkMotionBounds::calcRelativeMotion(const Eigen::Ref<const Eigen::VectorXd>& delta) const
+{
+  Eigen::VectorXd motion = weights_ * delta.cwiseAbs();
+  double first = 0;
+  double second = 0;
+  for (Eigen::Index i = 0; i < motion.size(); ++i)
+  {
+    if (motion(i) > first)
+    {
+      second = first;
+      first = motion(i);
+    }
+    else if (motion(i) > second)
+    {
+      second = motion(i);
+    }
+  }
+  return first + second;
+}
+}  // namespace trajopt
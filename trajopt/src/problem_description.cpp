@@ -1,13 +1,16 @@
 #include <trajopt_utils/macros.h>
 TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt/collision_terms.hpp>
 #include <trajopt/common.hpp>
 #include <trajopt/kinematic_terms.hpp>
+#include <trajopt/link_motion_bounds.hpp>
 #include <trajopt/plot_callback.hpp>
 #include <trajopt/problem_description.hpp>
+#include <trajopt/sphere_robot_model.hpp>
 #include <trajopt/trajectory_costs.hpp>
 #include <trajopt_sco/expr_op_overloads.hpp>
 #include <trajopt_sco/expr_ops.hpp>
@@ -81,6 +84,17 @@ void checkParameterSize(trajopt::DblVec& parameter,
   }
 }
 
+/**
+ * @brief Declare a term thread safe whose error and Jacobian calculators share no mutable state other than a
+ * KinematicsCache, see sco::Cost::isThreadSafe
+ */
+template <typename TermT>
+std::shared_ptr<TermT> makeThreadSafe(std::shared_ptr<TermT> term)
+{
+  term->setThreadSafe(true);
+  return term;
+}
+
 #if 0
 BoolVec toMask(const VectorXd& x) {
   BoolVec out(x.size());
@@ -118,12 +132,17 @@ void ProblemConstructionInfo::readBasicInfo(const Json::Value& v)
   json_marshal::childFromJson(v, basic_info.dt_lower_lim, "dt_lower_lim", 1.0);
   json_marshal::childFromJson(v, basic_info.dt_upper_lim, "dt_upper_lim", 1.0);
   json_marshal::childFromJson(v, basic_info.use_time, "use_time", false);
+  json_marshal::childFromJson(v, basic_info.convexify_threads, "convexify_threads", 1);
+  json_marshal::childFromJson(v, basic_info.evaluate_threads, "evaluate_threads", 1);
 
   if (basic_info.dt_lower_lim <= 0 || basic_info.dt_upper_lim < basic_info.dt_lower_lim)
   {
     PRINT_AND_THROW("dt limits (Basic Info) invalid. The lower limit must be positive, "
                     "and the minimum upper limit is equal to the lower limit.");
   }
+
+  if (basic_info.convexify_threads < 1 || basic_info.evaluate_threads < 1)
+    PRINT_AND_THROW("convexify_threads and evaluate_threads (Basic Info) must be at least 1");
 }
 
 void ProblemConstructionInfo::readOptInfo(const Json::Value& v)
@@ -369,7 +388,12 @@ void generateInitTraj(TrajArray& init_traj, const ProblemConstructionInfo& pci)
 }
 
 TrajOptResult::TrajOptResult(sco::OptResults& opt, TrajOptProb& prob)
-  : cost_vals(opt.cost_vals), cnt_viols(opt.cnt_viols), status(opt.status)
+  : cost_vals(opt.cost_vals)
+  , cnt_viols(opt.cnt_viols)
+  , status(opt.status)
+  , n_sqp_iters(opt.n_sqp_iters)
+  , n_qp_solves(opt.n_qp_solves)
+  , timings(opt.timings)
 {
   for (const sco::Cost::Ptr& cost : prob.getCosts())
   {
@@ -384,6 +408,43 @@ TrajOptResult::TrajOptResult(sco::OptResults& opt, TrajOptProb& prob)
   traj = getTraj(opt.x, prob.GetVars());
 }
 
+sco::Optimizer::RefinementCallback CollisionTrustRegionCallback(const sco::BasicTrustRegionSQP& opt)
+{
+  return [&opt](sco::OptProb* prob, const sco::OptResults&, bool converging) {
+    double trust_box_size = opt.getParameters().trust_box_size;
+    bool switched = false;
+    auto update = [trust_box_size, converging, &switched](const CollisionEvaluator::Ptr& evaluator) {
+      // The solution is always checked with the exact geometry, however large the trust region is
+      if (converging ? evaluator->useExactGeometry() : evaluator->setTrustRegionSize(trust_box_size))
+        switched = true;
+    };
+
+    for (const sco::Cost::Ptr& cost : prob->getCosts())
+    {
+      if (auto* collision_cost = dynamic_cast<CollisionCost*>(cost.get()))
+        update(collision_cost->getEvaluator());
+      else if (auto* trajectory_cost = dynamic_cast<TrajectoryCollisionCost*>(cost.get()))
+        std::for_each(trajectory_cost->getEvaluator()->GetEvaluators().begin(),
+                      trajectory_cost->getEvaluator()->GetEvaluators().end(),
+                      update);
+    }
+
+    for (const sco::Constraint::Ptr& cnt : prob->getConstraints())
+    {
+      if (auto* collision_cnt = dynamic_cast<CollisionConstraint*>(cnt.get()))
+        update(collision_cnt->getEvaluator());
+      else if (auto* trajectory_cnt = dynamic_cast<TrajectoryCollisionConstraint*>(cnt.get()))
+        std::for_each(trajectory_cnt->getEvaluator()->GetEvaluators().begin(),
+                      trajectory_cnt->getEvaluator()->GetEvaluators().end(),
+                      update);
+    }
+
+    if (switched)
+      LOG_INFO("collision checks switched to the exact geometry at trust region size %f", trust_box_size);
+    return switched;
+  };
+}
+
 TrajOptResult::Ptr OptimizeProblem(const TrajOptProb::Ptr& prob,
                                    const tesseract_visualization::Visualization::Ptr& plotter)
 {
@@ -393,8 +454,11 @@ TrajOptResult::Ptr OptimizeProblem(const TrajOptProb::Ptr& prob,
   param.min_approx_improve_frac = .001;
   param.improve_ratio_threshold = .2;
   param.initial_merit_error_coeff = 20;
+  param.convexify_threads = prob->GetConvexifyThreads();
+  param.evaluate_threads = prob->GetEvaluateThreads();
   if (plotter)
     opt.addCallback(PlotCallback(*prob, plotter));
+  opt.addRefinementCallback(CollisionTrustRegionCallback(opt));
   opt.initialize(trajToDblVec(prob->GetInitTraj()));
   opt.optimize();
   return std::make_shared<TrajOptResult>(opt.results(), *prob);
@@ -540,7 +604,11 @@ TrajOptProb::Ptr ConstructProblem(const Json::Value& root, const tesseract_envir
 }
 
 TrajOptProb::TrajOptProb(int n_steps, const ProblemConstructionInfo& pci)
-  : OptProb(pci.basic_info.convex_solver), m_kin(pci.kin), m_env(pci.env)
+  : OptProb(pci.basic_info.convex_solver)
+  , m_kin(pci.kin)
+  , m_env(pci.env)
+  , m_convexify_threads(pci.basic_info.convexify_threads)
+  , m_evaluate_threads(pci.basic_info.evaluate_threads)
 {
   const Eigen::MatrixX2d& limits = m_kin->getLimits().joint_limits;
   auto n_dof = static_cast<int>(m_kin->numJoints());
@@ -572,6 +640,20 @@ TrajOptProb::TrajOptProb(int n_steps, const ProblemConstructionInfo& pci)
 
 TrajOptProb::TrajOptProb() = default;
 
+ContactManagerPool::Ptr TrajOptProb::GetContactManagerPool()
+{
+  if (m_contact_manager_pool == nullptr)
+    m_contact_manager_pool = std::make_shared<ContactManagerPool>(m_env);
+  return m_contact_manager_pool;
+}
+
+KinematicsCache::Ptr TrajOptProb::GetKinematicsCache()
+{
+  if (m_kinematics_cache == nullptr)
+    m_kinematics_cache = std::make_shared<KinematicsCache>(m_kin);
+  return m_kinematics_cache;
+}
+
 void UserDefinedTermInfo::fromJson(ProblemConstructionInfo& /*pci*/, const Json::Value& /*v*/)
 {
   PRINT_AND_THROW("UserDefinedTermInfo does not support fromJson!");
@@ -751,22 +833,22 @@ void DynamicCartPoseTermInfo::hatch(TrajOptProb& prob)
         prob.GetEnv()->getSceneGraph(), prob.GetKin()->getActiveLinkNames(), state->link_transforms);
 
     auto f = std::make_shared<DynamicCartPoseErrCalculator>(
-        target, prob.GetKin(), adjacency_map, world_to_base, link, tcp, target_tcp, indices);
+        target, prob.GetKin(), adjacency_map, world_to_base, link, tcp, target_tcp, indices, prob.GetKinematicsCache());
 
     // This is currently not being used. There is an intermittent bug that needs to be tracked down it is not used.
     auto dfdx = std::make_shared<DynamicCartPoseJacCalculator>(
-        target, prob.GetKin(), adjacency_map, world_to_base, link, tcp, target_tcp, indices);
+        target, prob.GetKin(), adjacency_map, world_to_base, link, tcp, target_tcp, indices, prob.GetKinematicsCache());
 
     // Apply error calculator as either cost or constraint
     if (term_type & TT_COST)
     {
-      prob.addCost(
-          std::make_shared<TrajOptCostFromErrFunc>(f, prob.GetVarRow(timestep, 0, n_dof), coeff, sco::ABS, name));
+      prob.addCost(makeThreadSafe(
+          std::make_shared<TrajOptCostFromErrFunc>(f, prob.GetVarRow(timestep, 0, n_dof), coeff, sco::ABS, name)));
     }
     else if (term_type & TT_CNT)
     {
-      prob.addConstraint(
-          std::make_shared<TrajOptConstraintFromErrFunc>(f, prob.GetVarRow(timestep, 0, n_dof), coeff, sco::EQ, name));
+      prob.addConstraint(makeThreadSafe(
+          std::make_shared<TrajOptConstraintFromErrFunc>(f, prob.GetVarRow(timestep, 0, n_dof), coeff, sco::EQ, name)));
     }
     else
     {
@@ -900,25 +982,37 @@ void CartPoseTermInfo::hatch(TrajOptProb& prob)
   }
   else if ((term_type & TT_COST) && ~(term_type | ~TT_USE_TIME))
   {
-    auto f = std::make_shared<CartPoseErrCalculator>(
-        world_to_target * input_pose, prob.GetKin(), adjacency_map, world_to_base, link, tcp, indices);
+    auto f = std::make_shared<CartPoseErrCalculator>(world_to_target * input_pose,
+                                                     prob.GetKin(),
+                                                     adjacency_map,
+                                                     world_to_base,
+                                                     link,
+                                                     tcp,
+                                                     indices,
+                                                     prob.GetKinematicsCache());
 
     // This is currently not being used. There is an intermittent bug that needs to be tracked down it is not used.
     auto dfdx = std::make_shared<CartPoseJacCalculator>(
-        input_pose, prob.GetKin(), adjacency_map, world_to_base, link, tcp, indices);
-    prob.addCost(
-        std::make_shared<TrajOptCostFromErrFunc>(f, prob.GetVarRow(timestep, 0, n_dof), coeff, sco::ABS, name));
+        input_pose, prob.GetKin(), adjacency_map, world_to_base, link, tcp, indices, prob.GetKinematicsCache());
+    prob.addCost(makeThreadSafe(
+        std::make_shared<TrajOptCostFromErrFunc>(f, prob.GetVarRow(timestep, 0, n_dof), coeff, sco::ABS, name)));
   }
   else if ((term_type & TT_CNT) && ~(term_type | ~TT_USE_TIME))
   {
-    auto f = std::make_shared<CartPoseErrCalculator>(
-        world_to_target * input_pose, prob.GetKin(), adjacency_map, world_to_base, link, tcp, indices);
+    auto f = std::make_shared<CartPoseErrCalculator>(world_to_target * input_pose,
+                                                     prob.GetKin(),
+                                                     adjacency_map,
+                                                     world_to_base,
+                                                     link,
+                                                     tcp,
+                                                     indices,
+                                                     prob.GetKinematicsCache());
 
     // This is currently not being used. There is an intermittent bug that needs to be tracked down it is not used.
     auto dfdx = std::make_shared<CartPoseJacCalculator>(
-        input_pose, prob.GetKin(), adjacency_map, world_to_base, link, tcp, indices);
-    prob.addConstraint(
-        std::make_shared<TrajOptConstraintFromErrFunc>(f, prob.GetVarRow(timestep, 0, n_dof), coeff, sco::EQ, name));
+        input_pose, prob.GetKin(), adjacency_map, world_to_base, link, tcp, indices, prob.GetKinematicsCache());
+    prob.addConstraint(makeThreadSafe(
+        std::make_shared<TrajOptConstraintFromErrFunc>(f, prob.GetVarRow(timestep, 0, n_dof), coeff, sco::EQ, name)));
   }
   else
   {
@@ -978,34 +1072,54 @@ void CartVelTermInfo::hatch(TrajOptProb& prob)
   {
     for (int iStep = first_step; iStep <= last_step; ++iStep)
     {
-      auto f =
-          std::make_shared<CartVelErrCalculator>(prob.GetKin(), adjacency_map, world_to_base, link, max_displacement);
-      auto dfdx =
-          std::make_shared<CartVelJacCalculator>(prob.GetKin(), adjacency_map, world_to_base, link, max_displacement);
-      prob.addCost(std::make_shared<TrajOptCostFromErrFunc>(
+      auto f = std::make_shared<CartVelErrCalculator>(prob.GetKin(),
+                                                      adjacency_map,
+                                                      world_to_base,
+                                                      link,
+                                                      max_displacement,
+                                                      Eigen::Isometry3d::Identity(),
+                                                      prob.GetKinematicsCache());
+      auto dfdx = std::make_shared<CartVelJacCalculator>(prob.GetKin(),
+                                                         adjacency_map,
+                                                         world_to_base,
+                                                         link,
+                                                         max_displacement,
+                                                         Eigen::Isometry3d::Identity(),
+                                                         prob.GetKinematicsCache());
+      prob.addCost(makeThreadSafe(std::make_shared<TrajOptCostFromErrFunc>(
           f,
           dfdx,
           concat(prob.GetVarRow(iStep, 0, n_dof), prob.GetVarRow(iStep + 1, 0, n_dof)),
           Eigen::VectorXd::Ones(0),
           sco::ABS,
-          name));
+          name)));
     }
   }
   else if ((term_type & TT_CNT) && ~(term_type | ~TT_USE_TIME))
   {
     for (int iStep = first_step; iStep <= last_step; ++iStep)
     {
-      auto f =
-          std::make_shared<CartVelErrCalculator>(prob.GetKin(), adjacency_map, world_to_base, link, max_displacement);
-      auto dfdx =
-          std::make_shared<CartVelJacCalculator>(prob.GetKin(), adjacency_map, world_to_base, link, max_displacement);
-      prob.addConstraint(std::make_shared<TrajOptConstraintFromErrFunc>(
+      auto f = std::make_shared<CartVelErrCalculator>(prob.GetKin(),
+                                                      adjacency_map,
+                                                      world_to_base,
+                                                      link,
+                                                      max_displacement,
+                                                      Eigen::Isometry3d::Identity(),
+                                                      prob.GetKinematicsCache());
+      auto dfdx = std::make_shared<CartVelJacCalculator>(prob.GetKin(),
+                                                         adjacency_map,
+                                                         world_to_base,
+                                                         link,
+                                                         max_displacement,
+                                                         Eigen::Isometry3d::Identity(),
+                                                         prob.GetKinematicsCache());
+      prob.addConstraint(makeThreadSafe(std::make_shared<TrajOptConstraintFromErrFunc>(
           f,
           dfdx,
           concat(prob.GetVarRow(iStep, 0, n_dof), prob.GetVarRow(iStep + 1, 0, n_dof)),
           Eigen::VectorXd::Ones(0),
           sco::INEQ,
-          "CartVel"));
+          "CartVel")));
     }
   }
   else
@@ -1216,12 +1330,12 @@ void JointVelTermInfo::hatch(TrajOptProb& prob)
         DblVec single_jnt_coeffs = DblVec(num_vels * 2, coeffs[j]);
         auto f = std::make_shared<JointVelErrCalculator>(targets[j], upper_tols[j], lower_tols[j]);
         auto dfdx = std::make_shared<JointVelJacCalculator>();
-        prob.addCost(std::make_shared<TrajOptCostFromErrFunc>(f,
-                                                              dfdx,
-                                                              concat(joint_vars_vec, time_vars_vec),
-                                                              util::toVectorXd(single_jnt_coeffs),
-                                                              sco::SQUARED,
-                                                              name + "_j" + std::to_string(j)));
+        prob.addCost(makeThreadSafe(std::make_shared<TrajOptCostFromErrFunc>(f,
+                                                                             dfdx,
+                                                                             concat(joint_vars_vec, time_vars_vec),
+                                                                             util::toVectorXd(single_jnt_coeffs),
+                                                                             sco::SQUARED,
+                                                                             name + "_j" + std::to_string(j))));
       }
       // Otherwise it's a hinged "inequality" cost
       else
@@ -1229,12 +1343,12 @@ void JointVelTermInfo::hatch(TrajOptProb& prob)
         DblVec single_jnt_coeffs = DblVec(num_vels * 2, coeffs[j]);
         auto f = std::make_shared<JointVelErrCalculator>(targets[j], upper_tols[j], lower_tols[j]);
         auto dfdx = std::make_shared<JointVelJacCalculator>();
-        prob.addCost(std::make_shared<TrajOptCostFromErrFunc>(f,
-                                                              dfdx,
-                                                              concat(joint_vars_vec, time_vars_vec),
-                                                              util::toVectorXd(single_jnt_coeffs),
-                                                              sco::HINGE,
-                                                              name + "_j" + std::to_string(j)));
+        prob.addCost(makeThreadSafe(std::make_shared<TrajOptCostFromErrFunc>(f,
+                                                                             dfdx,
+                                                                             concat(joint_vars_vec, time_vars_vec),
+                                                                             util::toVectorXd(single_jnt_coeffs),
+                                                                             sco::HINGE,
+                                                                             name + "_j" + std::to_string(j))));
       }
     }
   }
@@ -1255,12 +1369,13 @@ void JointVelTermInfo::hatch(TrajOptProb& prob)
         DblVec single_jnt_coeffs = DblVec(num_vels * 2, coeffs[j]);
         auto f = std::make_shared<JointVelErrCalculator>(targets[j], upper_tols[j], lower_tols[j]);
         auto dfdx = std::make_shared<JointVelJacCalculator>();
-        prob.addConstraint(std::make_shared<TrajOptConstraintFromErrFunc>(f,
-                                                                          dfdx,
-                                                                          concat(joint_vars_vec, time_vars_vec),
-                                                                          util::toVectorXd(single_jnt_coeffs),
-                                                                          sco::EQ,
-                                                                          name + "_j" + std::to_string(j)));
+        prob.addConstraint(makeThreadSafe(std::make_shared<TrajOptConstraintFromErrFunc>(
+            f,
+            dfdx,
+            concat(joint_vars_vec, time_vars_vec),
+            util::toVectorXd(single_jnt_coeffs),
+            sco::EQ,
+            name + "_j" + std::to_string(j))));
       }
       // Otherwise it's a hinged "inequality" constraint
       else
@@ -1268,12 +1383,13 @@ void JointVelTermInfo::hatch(TrajOptProb& prob)
         DblVec single_jnt_coeffs = DblVec(num_vels * 2, coeffs[j]);
         auto f = std::make_shared<JointVelErrCalculator>(targets[j], upper_tols[j], lower_tols[j]);
         auto dfdx = std::make_shared<JointVelJacCalculator>();
-        prob.addConstraint(std::make_shared<TrajOptConstraintFromErrFunc>(f,
-                                                                          dfdx,
-                                                                          concat(joint_vars_vec, time_vars_vec),
-                                                                          util::toVectorXd(single_jnt_coeffs),
-                                                                          sco::INEQ,
-                                                                          name + "_j" + std::to_string(j)));
+        prob.addConstraint(makeThreadSafe(std::make_shared<TrajOptConstraintFromErrFunc>(
+            f,
+            dfdx,
+            concat(joint_vars_vec, time_vars_vec),
+            util::toVectorXd(single_jnt_coeffs),
+            sco::INEQ,
+            name + "_j" + std::to_string(j))));
       }
     }
   }
@@ -1581,12 +1697,31 @@ void CollisionTermInfo::fromJson(ProblemConstructionInfo& pci, const Json::Value
   json_marshal::childFromJson(params, last_step, "last_step", n_steps - 1);
   json_marshal::childFromJson(params, longest_valid_segment_length, "longest_valid_segment_length", 0.5);
   json_marshal::childFromJson(params, safety_margin_buffer, "safety_margin_buffer", 0.5);
+  json_marshal::childFromJson(params, adaptive_subdivision_margin, "adaptive_subdivision_margin", 0.0);
+  json_marshal::childFromJson(params, incremental_max_step, "incremental_max_step", 0.0);
+  json_marshal::childFromJson(params, incremental_prediction_margin, "incremental_prediction_margin", 0.05);
+  json_marshal::childFromJson(params, incremental_validate, "incremental_validate", false);
+  json_marshal::childFromJson(params, sdf_resolution, "sdf_resolution", 0.0);
+  json_marshal::childFromJson(
+      params, sdf_max_cells, "sdf_max_cells", static_cast<int>(SignedDistanceField::DEFAULT_MAX_CELLS));
+  json_marshal::childFromJson(params, sphere_spacing, "sphere_spacing", 0.0);
+  json_marshal::childFromJson(params, sphere_exact_trust_region_size, "sphere_exact_trust_region_size", 0.01);
+  json_marshal::childFromJson(params, batched, "batched", false);
+  json_marshal::childFromJson(params, batch_threads, "batch_threads", 1);
 
   FAIL_IF_FALSE(longest_valid_segment_length >= 0);
   FAIL_IF_FALSE((first_step >= 0) && (first_step < n_steps));
   FAIL_IF_FALSE((last_step >= first_step) && (last_step < n_steps));
   FAIL_IF_FALSE(collision_evaluator_type <= 2);
   FAIL_IF_FALSE(safety_margin_buffer >= 0);
+  FAIL_IF_FALSE(adaptive_subdivision_margin >= 0);
+  FAIL_IF_FALSE(incremental_max_step >= 0);
+  FAIL_IF_FALSE(incremental_prediction_margin >= 0);
+  FAIL_IF_FALSE(sdf_resolution >= 0);
+  FAIL_IF_FALSE(sdf_max_cells >= 0);
+  FAIL_IF_FALSE(sphere_spacing >= 0);
+  FAIL_IF_FALSE(sphere_exact_trust_region_size >= 0);
+  FAIL_IF_FALSE(batch_threads >= 1);
 
   evaluator_type = static_cast<CollisionEvaluatorType>(collision_evaluator_type);
 
@@ -1693,14 +1828,28 @@ void CollisionTermInfo::fromJson(ProblemConstructionInfo& pci, const Json::Value
                                "fixed_steps",
                                "contact_test_type",
                                "longest_valid_segment_length",
+                               "adaptive_subdivision_margin",
+                               "incremental_max_step",
+                               "incremental_prediction_margin",
+                               "incremental_validate",
+                               "sdf_resolution",
+                               "sdf_max_cells",
+                               "sphere_spacing",
+                               "sphere_exact_trust_region_size",
                                "coeffs",
                                "dist_pen",
-                               "pairs" };
+                               "pairs",
+                               "batched",
+                               "batch_threads" };
   ensure_only_members(params, all_fields, sizeof(all_fields) / sizeof(char*));
 }
 
 void CollisionTermInfo::hatch(TrajOptProb& prob)
 {
+  // The casted checks sweep the exact geometry with the contact managers, neither model can replace them
+  if (evaluator_type == CollisionEvaluatorType::CAST_CONTINUOUS && (sdf_resolution > 0 || sphere_spacing > 0))
+    PRINT_AND_THROW("Signed distance fields and sphere approximations are not available for casted collision checks");
+
   int n_dof = static_cast<int>(prob.GetKin()->numJoints());
   tesseract_environment::EnvState::ConstPtr state = prob.GetEnv()->getCurrentState();
   Eigen::Isometry3d world_to_base = Eigen::Isometry3d::Identity();
@@ -1716,156 +1865,262 @@ void CollisionTermInfo::hatch(TrajOptProb& prob)
   tesseract_environment::AdjacencyMap::Ptr adjacency_map = std::make_shared<tesseract_environment::AdjacencyMap>(
       prob.GetEnv()->getSceneGraph(), prob.GetKin()->getActiveLinkNames(), state->link_transforms);
 
-  if (term_type == TT_COST)
+  // The kinematics cache computes with clones of the kinematics, so timesteps checked concurrently may share both
+  KinematicsCache::Ptr kinematics_cache = prob.GetKinematicsCache();
+
+  // The signed distance fields cover the largest contact distance of all timesteps, so they are shared as well
+  StaticEnvironmentSDF::ConstPtr sdf;
+  if (sdf_resolution > 0)
   {
-    if (evaluator_type != CollisionEvaluatorType::SINGLE_TIMESTEP)
-    {
-      bool discrete_continuous = (evaluator_type == CollisionEvaluatorType::DISCRETE_CONTINUOUS);
-      for (int i = first_step; i < last_step; ++i)
-      {
-        bool current_fixed = std::find(fixed_steps.begin(), fixed_steps.end(), i) != fixed_steps.end();
-        bool next_fixed = std::find(fixed_steps.begin(), fixed_steps.end(), i + 1) != fixed_steps.end();
+    double max_distance = 0;
+    for (const auto& safety_margin_data : info)
+      max_distance = std::max(max_distance, safety_margin_data->getMaxSafetyMargin());
+    max_distance += safety_margin_buffer + sdf_resolution;
 
-        CollisionExpressionEvaluatorType expression_evaluator_type;
-        if (!current_fixed && !next_fixed)
-        {
-          expression_evaluator_type = (use_weighted_sum) ?
-                                          CollisionExpressionEvaluatorType::START_FREE_END_FREE_WEIGHTED_SUM :
-                                          CollisionExpressionEvaluatorType::START_FREE_END_FREE;
-        }
-        else if (current_fixed)
-        {
-          expression_evaluator_type = (use_weighted_sum) ?
-                                          CollisionExpressionEvaluatorType::START_FIXED_END_FREE_WEIGHTED_SUM :
-                                          CollisionExpressionEvaluatorType::START_FIXED_END_FREE;
-        }
-        else if (next_fixed)
-        {
-          expression_evaluator_type = (use_weighted_sum) ?
-                                          CollisionExpressionEvaluatorType::START_FREE_END_FIXED_WEIGHTED_SUM :
-                                          CollisionExpressionEvaluatorType::START_FREE_END_FIXED;
-        }
-        else
-        {
-          PRINT_AND_THROW("Currently two adjacent fixed steps are not supported in collision term.");
-        }
+    sdf = std::make_shared<StaticEnvironmentSDF>(*prob.GetEnv(),
+                                                 adjacency_map->getActiveLinkNames(),
+                                                 sdf_resolution,
+                                                 max_distance,
+                                                 static_cast<std::size_t>(sdf_max_cells));
+    if (!sdf->isValid())
+    {
+      CONSOLE_BRIDGE_logWarn("The environment cannot be represented by signed distance fields, using contact managers");
+      sdf = nullptr;
+    }
+  }
 
-        auto c = std::make_shared<CollisionCost>(prob.GetKin(),
-                                                 prob.GetEnv(),
-                                                 adjacency_map,
-                                                 world_to_base,
-                                                 info[static_cast<size_t>(i - first_step)],
-                                                 contact_test_type,
-                                                 longest_valid_segment_length,
-                                                 prob.GetVarRow(i, 0, n_dof),
-                                                 prob.GetVarRow(i + 1, 0, n_dof),
-                                                 expression_evaluator_type,
-                                                 discrete_continuous,
-                                                 safety_margin_buffer);
-
-        prob.addCost(c);
-        prob.getCosts().back()->setName((boost::format("%s_%i") % name.c_str() % i).str());
-      }
+  // The spheres check the active links against each other and use the fields for the static links, if there are any
+  SphereRobotModel::ConstPtr sphere_model;
+  if (sphere_spacing > 0)
+  {
+    sphere_model = std::make_shared<SphereRobotModel>(
+        *prob.GetEnv(), adjacency_map->getActiveLinkNames(), sphere_spacing, sdf);
+    if (!sphere_model->isValid())
+    {
+      CONSOLE_BRIDGE_logWarn("The robot cannot be approximated by spheres, checking the exact geometry");
+      sphere_model = nullptr;
     }
-    else
+  }
+
+  // The motion bounds of the active links only depend on the kinematics, so they are shared by all evaluators
+  bool adaptive_subdivision = adaptive_subdivision_margin > 0 &&
+                              evaluator_type != CollisionEvaluatorType::SINGLE_TIMESTEP &&
+                              (sdf == nullptr || sphere_model != nullptr);
+  LinkMotionBounds::ConstPtr motion_bounds;
+  if (adaptive_subdivision || incremental_max_step > 0)
+    motion_bounds = std::make_shared<LinkMotionBounds>(
+        *prob.GetKin(), *prob.GetEnv()->getSceneGraph(), adjacency_map->getActiveLinkNames());
+
+  // Create an evaluator for every timestep that is checked
+  std::vector<int> steps;
+  std::vector<CollisionEvaluator::Ptr> evaluators;
+  if (evaluator_type != CollisionEvaluatorType::SINGLE_TIMESTEP)
+  {
+    bool discrete_continuous = (evaluator_type == CollisionEvaluatorType::DISCRETE_CONTINUOUS);
+    for (int i = first_step; i < last_step; ++i)
     {
-      CollisionExpressionEvaluatorType expression_evaluator_type =
-          (use_weighted_sum) ? CollisionExpressionEvaluatorType::SINGLE_TIME_STEP_WEIGHTED_SUM :
-                               CollisionExpressionEvaluatorType::SINGLE_TIME_STEP;
-      for (int i = first_step; i <= last_step; ++i)
+      bool current_fixed = std::find(fixed_steps.begin(), fixed_steps.end(), i) != fixed_steps.end();
+      bool next_fixed = std::find(fixed_steps.begin(), fixed_steps.end(), i + 1) != fixed_steps.end();
+
+      CollisionExpressionEvaluatorType expression_evaluator_type;
+      if (!current_fixed && !next_fixed)
       {
-        if (std::find(fixed_steps.begin(), fixed_steps.end(), i) == fixed_steps.end())
-        {
-          auto c = std::make_shared<CollisionCost>(prob.GetKin(),
-                                                   prob.GetEnv(),
-                                                   adjacency_map,
-                                                   world_to_base,
-                                                   info[static_cast<size_t>(i - first_step)],
-                                                   contact_test_type,
-                                                   prob.GetVarRow(i, 0, n_dof),
-                                                   expression_evaluator_type,
-                                                   safety_margin_buffer);
-
-          prob.addCost(c);
-          prob.getCosts().back()->setName((boost::format("%s_%i") % name.c_str() % i).str());
-        }
+        expression_evaluator_type = (use_weighted_sum) ?
+                                        CollisionExpressionEvaluatorType::START_FREE_END_FREE_WEIGHTED_SUM :
+                                        CollisionExpressionEvaluatorType::START_FREE_END_FREE;
+      }
+      else if (current_fixed)
+      {
+        expression_evaluator_type = (use_weighted_sum) ?
+                                        CollisionExpressionEvaluatorType::START_FIXED_END_FREE_WEIGHTED_SUM :
+                                        CollisionExpressionEvaluatorType::START_FIXED_END_FREE;
       }
+      else if (next_fixed)
+      {
+        expression_evaluator_type = (use_weighted_sum) ?
+                                        CollisionExpressionEvaluatorType::START_FREE_END_FIXED_WEIGHTED_SUM :
+                                        CollisionExpressionEvaluatorType::START_FREE_END_FIXED;
+      }
+      else
+      {
+        PRINT_AND_THROW("Currently two adjacent fixed steps are not supported in collision term.");
+      }
+
+      if (discrete_continuous && sphere_model != nullptr)
+      {
+        evaluators.push_back(
+            std::make_shared<DiscreteSphereCollisionEvaluator>(prob.GetKin(),
+                                                               prob.GetEnv(),
+                                                               adjacency_map,
+                                                               world_to_base,
+                                                               info[static_cast<size_t>(i - first_step)],
+                                                               contact_test_type,
+                                                               longest_valid_segment_length,
+                                                               prob.GetVarRow(i, 0, n_dof),
+                                                               prob.GetVarRow(i + 1, 0, n_dof),
+                                                               expression_evaluator_type,
+                                                               safety_margin_buffer,
+                                                               sphere_model,
+                                                               sphere_exact_trust_region_size,
+                                                               prob.GetContactManagerPool(),
+                                                               kinematics_cache));
+      }
+      else if (discrete_continuous && sdf != nullptr)
+      {
+        evaluators.push_back(std::make_shared<DiscreteSDFCollisionEvaluator>(prob.GetKin(),
+                                                                             prob.GetEnv(),
+                                                                             adjacency_map,
+                                                                             world_to_base,
+                                                                             info[static_cast<size_t>(i - first_step)],
+                                                                             contact_test_type,
+                                                                             longest_valid_segment_length,
+                                                                             prob.GetVarRow(i, 0, n_dof),
+                                                                             prob.GetVarRow(i + 1, 0, n_dof),
+                                                                             expression_evaluator_type,
+                                                                             safety_margin_buffer,
+                                                                             sdf,
+                                                                             prob.GetContactManagerPool(),
+                                                                             kinematics_cache));
+      }
+      else if (discrete_continuous)
+      {
+        evaluators.push_back(std::make_shared<DiscreteCollisionEvaluator>(prob.GetKin(),
+                                                                          prob.GetEnv(),
+                                                                          adjacency_map,
+                                                                          world_to_base,
+                                                                          info[static_cast<size_t>(i - first_step)],
+                                                                          contact_test_type,
+                                                                          longest_valid_segment_length,
+                                                                          prob.GetVarRow(i, 0, n_dof),
+                                                                          prob.GetVarRow(i + 1, 0, n_dof),
+                                                                          expression_evaluator_type,
+                                                                          safety_margin_buffer,
+                                                                          prob.GetContactManagerPool(),
+                                                                          kinematics_cache));
+      }
+      else
+      {
+        evaluators.push_back(std::make_shared<CastCollisionEvaluator>(prob.GetKin(),
+                                                                      prob.GetEnv(),
+                                                                      adjacency_map,
+                                                                      world_to_base,
+                                                                      info[static_cast<size_t>(i - first_step)],
+                                                                      contact_test_type,
+                                                                      longest_valid_segment_length,
+                                                                      prob.GetVarRow(i, 0, n_dof),
+                                                                      prob.GetVarRow(i + 1, 0, n_dof),
+                                                                      expression_evaluator_type,
+                                                                      safety_margin_buffer,
+                                                                      prob.GetContactManagerPool(),
+                                                                      kinematics_cache));
+      }
+      if (adaptive_subdivision)
+        evaluators.back()->setAdaptiveSubdivision(adaptive_subdivision_margin, motion_bounds);
+      steps.push_back(i);
     }
   }
   else
-  {  // ALMOST COPIED
-    if (evaluator_type != CollisionEvaluatorType::SINGLE_TIMESTEP)
+  {
+    CollisionExpressionEvaluatorType expression_evaluator_type =
+        (use_weighted_sum) ? CollisionExpressionEvaluatorType::SINGLE_TIME_STEP_WEIGHTED_SUM :
+                             CollisionExpressionEvaluatorType::SINGLE_TIME_STEP;
+    for (int i = first_step; i <= last_step; ++i)
     {
-      bool discrete_continuous = (evaluator_type == CollisionEvaluatorType::DISCRETE_CONTINUOUS);
-      for (int i = first_step; i < last_step; ++i)
+      if (std::find(fixed_steps.begin(), fixed_steps.end(), i) != fixed_steps.end())
+        continue;
+
+      if (sphere_model != nullptr)
+      {
+        evaluators.push_back(
+            std::make_shared<SingleTimestepSphereCollisionEvaluator>(prob.GetKin(),
+                                                                     prob.GetEnv(),
+                                                                     adjacency_map,
+                                                                     world_to_base,
+                                                                     info[static_cast<size_t>(i - first_step)],
+                                                                     contact_test_type,
+                                                                     prob.GetVarRow(i, 0, n_dof),
+                                                                     expression_evaluator_type,
+                                                                     safety_margin_buffer,
+                                                                     sphere_model,
+                                                                     sphere_exact_trust_region_size,
+                                                                     prob.GetContactManagerPool(),
+                                                                     kinematics_cache));
+      }
+      else if (sdf != nullptr)
+      {
+        evaluators.push_back(
+            std::make_shared<SingleTimestepSDFCollisionEvaluator>(prob.GetKin(),
+                                                                  prob.GetEnv(),
+                                                                  adjacency_map,
+                                                                  world_to_base,
+                                                                  info[static_cast<size_t>(i - first_step)],
+                                                                  contact_test_type,
+                                                                  prob.GetVarRow(i, 0, n_dof),
+                                                                  expression_evaluator_type,
+                                                                  safety_margin_buffer,
+                                                                  sdf,
+                                                                  prob.GetContactManagerPool(),
+                                                                  kinematics_cache));
+      }
+      else
       {
-        bool current_fixed = std::find(fixed_steps.begin(), fixed_steps.end(), i) != fixed_steps.end();
-        bool next_fixed = std::find(fixed_steps.begin(), fixed_steps.end(), i + 1) != fixed_steps.end();
+        evaluators.push_back(
+            std::make_shared<SingleTimestepCollisionEvaluator>(prob.GetKin(),
+                                                               prob.GetEnv(),
+                                                               adjacency_map,
+                                                               world_to_base,
+                                                               info[static_cast<size_t>(i - first_step)],
+                                                               contact_test_type,
+                                                               prob.GetVarRow(i, 0, n_dof),
+                                                               expression_evaluator_type,
+                                                               safety_margin_buffer,
+                                                               false,
+                                                               prob.GetContactManagerPool(),
+                                                               kinematics_cache));
+      }
+      steps.push_back(i);
+    }
+  }
 
-        CollisionExpressionEvaluatorType expression_evaluator_type;
-        if (!current_fixed && !next_fixed)
-        {
-          expression_evaluator_type = (use_weighted_sum) ?
-                                          CollisionExpressionEvaluatorType::START_FREE_END_FREE_WEIGHTED_SUM :
-                                          CollisionExpressionEvaluatorType::START_FREE_END_FREE;
-        }
-        else if (current_fixed)
-        {
-          expression_evaluator_type = (use_weighted_sum) ?
-                                          CollisionExpressionEvaluatorType::START_FIXED_END_FREE_WEIGHTED_SUM :
-                                          CollisionExpressionEvaluatorType::START_FIXED_END_FREE;
-        }
-        else if (next_fixed)
-        {
-          expression_evaluator_type = (use_weighted_sum) ?
-                                          CollisionExpressionEvaluatorType::START_FREE_END_FIXED_WEIGHTED_SUM :
-                                          CollisionExpressionEvaluatorType::START_FREE_END_FIXED;
-        }
-        else
-        {
-          PRINT_AND_THROW("Currently two adjacent fixed steps are not supported in collision term.");
-        }
+  if (evaluators.empty())
+    return;
 
-        auto c = std::make_shared<CollisionConstraint>(prob.GetKin(),
-                                                       prob.GetEnv(),
-                                                       adjacency_map,
-                                                       world_to_base,
-                                                       info[static_cast<size_t>(i - first_step)],
-                                                       contact_test_type,
-                                                       longest_valid_segment_length,
-                                                       prob.GetVarRow(i, 0, n_dof),
-                                                       prob.GetVarRow(i + 1, 0, n_dof),
-                                                       expression_evaluator_type,
-                                                       discrete_continuous,
-                                                       safety_margin_buffer);
-
-        prob.addIneqConstraint(c);
-        prob.getIneqConstraints().back()->setName((boost::format("%s_%i") % name.c_str() % i).str());
-      }
+  if (incremental_max_step > 0)
+  {
+    IncrementalCollisionConfig incremental_config;
+    incremental_config.max_step = incremental_max_step;
+    incremental_config.prediction_margin = incremental_prediction_margin;
+    incremental_config.validate = incremental_validate;
+    for (const CollisionEvaluator::Ptr& evaluator : evaluators)
+      evaluator->setIncrementalCheck(incremental_config, motion_bounds);
+  }
+
+  if (batched)
+  {
+    if (term_type == TT_COST)
+    {
+      prob.addCost(std::make_shared<TrajectoryCollisionCost>(evaluators, batch_threads));
+      prob.getCosts().back()->setName(name);
     }
     else
     {
-      CollisionExpressionEvaluatorType expression_evaluator_type =
-          (use_weighted_sum) ? CollisionExpressionEvaluatorType::SINGLE_TIME_STEP_WEIGHTED_SUM :
-                               CollisionExpressionEvaluatorType::SINGLE_TIME_STEP;
-      for (int i = first_step; i <= last_step; ++i)
-      {
-        if (std::find(fixed_steps.begin(), fixed_steps.end(), i) == fixed_steps.end())
-        {
-          auto c = std::make_shared<CollisionConstraint>(prob.GetKin(),
-                                                         prob.GetEnv(),
-                                                         adjacency_map,
-                                                         world_to_base,
-                                                         info[static_cast<size_t>(i - first_step)],
-                                                         contact_test_type,
-                                                         prob.GetVarRow(i, 0, n_dof),
-                                                         expression_evaluator_type,
-                                                         safety_margin_buffer);
-
-          prob.addIneqConstraint(c);
-          prob.getIneqConstraints().back()->setName((boost::format("%s_%i") % name.c_str() % i).str());
-        }
-      }
+      prob.addIneqConstraint(std::make_shared<TrajectoryCollisionConstraint>(evaluators, batch_threads));
+      prob.getIneqConstraints().back()->setName(name);
+    }
+    return;
+  }
+
+  for (std::size_t k = 0; k < evaluators.size(); ++k)
+  {
+    if (term_type == TT_COST)
+    {
+      prob.addCost(std::make_shared<CollisionCost>(evaluators[k]));
+      prob.getCosts().back()->setName((boost::format("%s_%i") % name.c_str() % steps[k]).str());
+    }
+    else
+    {
+      prob.addIneqConstraint(std::make_shared<CollisionConstraint>(evaluators[k]));
+      prob.getIneqConstraints().back()->setName((boost::format("%s_%i") % name.c_str() % steps[k]).str());
     }
   }
 }
@@ -1946,8 +2201,8 @@ void AvoidSingularityTermInfo::hatch(TrajOptProb& prob)
   else
   {
     // Otherwise create a singularity cost and jacobian calculator with the problem's full set of joints
-    f = std::make_shared<AvoidSingularityErrCalculator>(kin, link, lambda);
-    dfdx = std::make_shared<AvoidSingularityJacCalculator>(kin, link, lambda);
+    f = std::make_shared<AvoidSingularityErrCalculator>(kin, link, lambda, prob.GetKinematicsCache());
+    dfdx = std::make_shared<AvoidSingularityJacCalculator>(kin, link, lambda, 1.0e-6, prob.GetKinematicsCache());
   }
 
   auto n_dof = static_cast<int>(kin->numJoints());
@@ -1958,13 +2213,13 @@ void AvoidSingularityTermInfo::hatch(TrajOptProb& prob)
     const std::string idx_name = name + "_" + std::to_string(i);
     if (term_type & TT_COST)
     {
-      prob.addCost(std::make_shared<TrajOptCostFromErrFunc>(
-          f, dfdx, prob.GetVarRow(i, 0, n_dof), util::toVectorXd(coeffs), sco::ABS, idx_name));
+      prob.addCost(makeThreadSafe(std::make_shared<TrajOptCostFromErrFunc>(
+          f, dfdx, prob.GetVarRow(i, 0, n_dof), util::toVectorXd(coeffs), sco::ABS, idx_name)));
     }
     else if (term_type & TT_CNT)
     {
-      prob.addConstraint(std::make_shared<TrajOptConstraintFromErrFunc>(
-          f, dfdx, prob.GetVarRow(i, 0, n_dof), util::toVectorXd(coeffs), sco::INEQ, idx_name));
+      prob.addConstraint(makeThreadSafe(std::make_shared<TrajOptConstraintFromErrFunc>(
+          f, dfdx, prob.GetVarRow(i, 0, n_dof), util::toVectorXd(coeffs), sco::INEQ, idx_name)));
     }
     else
     {
@@ -0,0 +1,509 @@
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <console_bridge/console.h>
+#include <tesseract_collision/core/common.h>
+#include <tesseract_geometry/geometries.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt/signed_distance_field.hpp>
+
+namespace trajopt
+{
+/**
+ * @brief Sample a surface patch p(u, v), u and v in [0, 1], at the centers of a grid of cells
+ *
+ * The lengths bound how far p moves along u and v, so every point of a cell is within the returned radius of its
+ * center.
+ */
+static void addSurfacePatch(CollisionSpheres& spheres,
+                            const Eigen::Isometry3d& origin,
+                            double spacing,
+                            double length_u,
+                            double length_v,
+                            const std::function<Eigen::Vector3d(double, double)>& patch)
+{
+  int n_u = std::max(1, static_cast<int>(std::ceil(length_u / spacing)));
+  int n_v = std::max(1, static_cast<int>(std::ceil(length_v / spacing)));
+  double radius = 0.5 * (length_u / n_u + length_v / n_v);
+  for (int i = 0; i < n_u; ++i)
+  {
+    for (int j = 0; j < n_v; ++j)
+    {
+      spheres.centers.push_back(origin * patch((i + 0.5) / n_u, (j + 0.5) / n_v));
+      spheres.radii.push_back(radius);
+    }
+  }
+}
+
+/** @brief Sample a disc of the given radius in the xy plane at height z */
+static void addDisc(CollisionSpheres& spheres, const Eigen::Isometry3d& origin, double spacing, double radius, double z)
+{
+  addSurfacePatch(spheres, origin, spacing, 2 * M_PI * radius, radius, [radius, z](double u, double v) {
+    return Eigen::Vector3d(v * radius * std::cos(2 * M_PI * u), v * radius * std::sin(2 * M_PI * u), z);
+  });
+}
+
+bool calcCollisionSpheres(const tesseract_scene_graph::Link& link, double spacing, CollisionSpheres& spheres)
+{
+  spheres.centers.clear();
+  spheres.radii.clear();
+  for (const auto& collision : link.collision)
+  {
+    const Eigen::Isometry3d& origin = collision->origin;
+    const tesseract_geometry::Geometry::ConstPtr& geometry = collision->geometry;
+    switch (geometry->getType())
+    {
+      case tesseract_geometry::GeometryType::SPHERE:
+      {
+        const auto& sphere = static_cast<const tesseract_geometry::Sphere&>(*geometry);
+        spheres.centers.push_back(origin.translation());
+        spheres.radii.push_back(sphere.getRadius());
+        break;
+      }
+      case tesseract_geometry::GeometryType::CAPSULE:
+      {
+        // Spheres along the axis, enlarged to cover the cylindrical part between them
+        const auto& capsule = static_cast<const tesseract_geometry::Capsule&>(*geometry);
+        double length = capsule.getLength();
+        int n = std::max(1, static_cast<int>(std::ceil(length / spacing)));
+        double radius = std::sqrt(capsule.getRadius() * capsule.getRadius() + 0.25 * (length / n) * (length / n));
+        for (int i = 0; i <= n; ++i)
+        {
+          spheres.centers.push_back(origin * Eigen::Vector3d(0, 0, length * (static_cast<double>(i) / n - 0.5)));
+          spheres.radii.push_back((i == 0 || i == n) ? capsule.getRadius() : radius);
+        }
+        break;
+      }
+      case tesseract_geometry::GeometryType::BOX:
+      {
+        const auto& box = static_cast<const tesseract_geometry::Box&>(*geometry);
+        Eigen::Vector3d half(0.5 * box.getX(), 0.5 * box.getY(), 0.5 * box.getZ());
+        for (int axis = 0; axis < 3; ++axis)
+        {
+          int axis_u = (axis + 1) % 3;
+          int axis_v = (axis + 2) % 3;
+          for (double side : { -1.0, 1.0 })
+          {
+            addSurfacePatch(
+                spheres, origin, spacing, 2 * half(axis_u), 2 * half(axis_v), [&, axis, side](double u, double v) {
+                  Eigen::Vector3d point;
+                  point(axis) = side * half(axis);
+                  point(axis_u) = (2 * u - 1) * half(axis_u);
+                  point(axis_v) = (2 * v - 1) * half(axis_v);
+                  return point;
+                });
+          }
+        }
+        break;
+      }
+      case tesseract_geometry::GeometryType::CYLINDER:
+      {
+        const auto& cylinder = static_cast<const tesseract_geometry::Cylinder&>(*geometry);
+        double radius = cylinder.getRadius();
+        double length = cylinder.getLength();
+        addSurfacePatch(spheres, origin, spacing, 2 * M_PI * radius, length, [radius, length](double u, double v) {
+          return Eigen::Vector3d(
+              radius * std::cos(2 * M_PI * u), radius * std::sin(2 * M_PI * u), length * (v - 0.5));
+        });
+        addDisc(spheres, origin, spacing, radius, -0.5 * length);
+        addDisc(spheres, origin, spacing, radius, 0.5 * length);
+        break;
+      }
+      case tesseract_geometry::GeometryType::CONE:
+      {
+        // The base is at -length / 2 and the tip at length / 2
+        const auto& cone = static_cast<const tesseract_geometry::Cone&>(*geometry);
+        double radius = cone.getRadius();
+        double length = cone.getLength();
+        double slant = std::sqrt(radius * radius + length * length);
+        addSurfacePatch(spheres, origin, spacing, 2 * M_PI * radius, slant, [radius, length](double u, double v) {
+          return Eigen::Vector3d((1 - v) * radius * std::cos(2 * M_PI * u),
+                                 (1 - v) * radius * std::sin(2 * M_PI * u),
+                                 length * (v - 0.5));
+        });
+        addDisc(spheres, origin, spacing, radius, -0.5 * length);
+        break;
+      }
+      case tesseract_geometry::GeometryType::MESH:
+      case tesseract_geometry::GeometryType::CONVEX_MESH:
+      case tesseract_geometry::GeometryType::SDF_MESH:
+      {
+        // The faces are stored as the number of vertices followed by their indices, they are sampled as triangle fans
+        const auto& mesh = static_cast<const tesseract_geometry::PolygonMesh&>(*geometry);
+        const tesseract_common::VectorVector3d& vertices = *mesh.getVertices();
+        const Eigen::VectorXi& faces = *mesh.getFaces();
+        for (Eigen::Index i = 0; i < faces.size(); i += faces(i) + 1)
+        {
+          const Eigen::Vector3d& a = vertices[static_cast<std::size_t>(faces(i + 1))];
+          for (Eigen::Index j = 2; j < faces(i); ++j)
+          {
+            const Eigen::Vector3d& b = vertices[static_cast<std::size_t>(faces(i + j))];
+            const Eigen::Vector3d& c = vertices[static_cast<std::size_t>(faces(i + j + 1))];
+            double length_u = std::max((b - a).norm(), (c - a).norm());
+            addSurfacePatch(spheres, origin, spacing, length_u, (c - b).norm(), [&a, &b, &c](double u, double v) {
+              return Eigen::Vector3d(a + u * ((1 - v) * (b - a) + v * (c - a)));
+            });
+          }
+        }
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Extend an axis aligned bounding box by the collision geometry of a link
+ * @param link The link
+ * @param link_transform The world transform of the link
+ * @param lower The lower corner of the box, which is extended
+ * @param upper The upper corner of the box, which is extended
+ * @return False if the geometry is of an unsupported type, e.g. unbounded
+ */
+static bool extendCollisionAABB(const tesseract_scene_graph::Link& link,
+                                const Eigen::Isometry3d& link_transform,
+                                Eigen::Vector3d& lower,
+                                Eigen::Vector3d& upper)
+{
+  for (const auto& collision : link.collision)
+  {
+    Eigen::Isometry3d origin = link_transform * collision->origin;
+    const tesseract_geometry::Geometry::ConstPtr& geometry = collision->geometry;
+
+    // The box of the geometry in its own frame, given by its center and half extents
+    Eigen::Vector3d center = Eigen::Vector3d::Zero();
+    Eigen::Vector3d half;
+    switch (geometry->getType())
+    {
+      case tesseract_geometry::GeometryType::SPHERE:
+      {
+        half.setConstant(static_cast<const tesseract_geometry::Sphere&>(*geometry).getRadius());
+        break;
+      }
+      case tesseract_geometry::GeometryType::CAPSULE:
+      {
+        const auto& capsule = static_cast<const tesseract_geometry::Capsule&>(*geometry);
+        half = Eigen::Vector3d(
+            capsule.getRadius(), capsule.getRadius(), 0.5 * capsule.getLength() + capsule.getRadius());
+        break;
+      }
+      case tesseract_geometry::GeometryType::BOX:
+      {
+        const auto& box = static_cast<const tesseract_geometry::Box&>(*geometry);
+        half = 0.5 * Eigen::Vector3d(box.getX(), box.getY(), box.getZ());
+        break;
+      }
+      case tesseract_geometry::GeometryType::CYLINDER:
+      {
+        const auto& cylinder = static_cast<const tesseract_geometry::Cylinder&>(*geometry);
+        half = Eigen::Vector3d(cylinder.getRadius(), cylinder.getRadius(), 0.5 * cylinder.getLength());
+        break;
+      }
+      case tesseract_geometry::GeometryType::CONE:
+      {
+        const auto& cone = static_cast<const tesseract_geometry::Cone&>(*geometry);
+        half = Eigen::Vector3d(cone.getRadius(), cone.getRadius(), 0.5 * cone.getLength());
+        break;
+      }
+      case tesseract_geometry::GeometryType::MESH:
+      case tesseract_geometry::GeometryType::CONVEX_MESH:
+      case tesseract_geometry::GeometryType::SDF_MESH:
+      {
+        const auto& mesh = static_cast<const tesseract_geometry::PolygonMesh&>(*geometry);
+        const tesseract_common::VectorVector3d& vertices = *mesh.getVertices();
+        if (vertices.empty())
+          continue;
+
+        Eigen::Vector3d mesh_lower = vertices.front();
+        Eigen::Vector3d mesh_upper = vertices.front();
+        for (const auto& vertex : vertices)
+        {
+          mesh_lower = mesh_lower.cwiseMin(vertex);
+          mesh_upper = mesh_upper.cwiseMax(vertex);
+        }
+        center = 0.5 * (mesh_lower + mesh_upper);
+        half = 0.5 * (mesh_upper - mesh_lower);
+        break;
+      }
+      default:
+        return false;
+    }
+
+    // The extents of a rotated box along the world axes
+    Eigen::Vector3d world_center = origin * center;
+    Eigen::Vector3d world_half = origin.linear().cwiseAbs() * half;
+    lower = lower.cwiseMin(world_center - world_half);
+    upper = upper.cwiseMax(world_center + world_half);
+  }
+  return true;
+}
+
+SignedDistanceField::SignedDistanceField(const tesseract_environment::Environment& env,
+                                         std::vector<std::string> link_names,
+                                         double resolution,
+                                         double max_distance,
+                                         std::size_t max_cells)
+  : link_names_(std::move(link_names)), resolution_(resolution), max_distance_(max_distance)
+{
+  assert(resolution_ > 0);
+  tesseract_environment::EnvState::ConstPtr state = env.getCurrentState();
+  tesseract_scene_graph::SceneGraph::ConstPtr scene_graph = env.getSceneGraph();
+
+  // The grid covers the bounding boxes of the collision geometry and the distances measured around them
+  Eigen::Vector3d lower = Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+  Eigen::Vector3d upper = Eigen::Vector3d::Constant(std::numeric_limits<double>::lowest());
+  std::unordered_map<std::string, unsigned> link_indices;
+  for (std::size_t i = 0; i < link_names_.size(); ++i)
+  {
+    tesseract_scene_graph::Link::ConstPtr link = scene_graph->getLink(link_names_[i]);
+    if (link == nullptr || !extendCollisionAABB(*link, state->link_transforms.at(link_names_[i]), lower, upper))
+    {
+      CONSOLE_BRIDGE_logWarn("SignedDistanceField: the collision geometry of link '%s' cannot be bounded",
+                             link_names_[i].c_str());
+      valid_ = false;
+      return;
+    }
+    link_indices[link_names_[i]] = static_cast<unsigned>(i);
+  }
+
+  if (link_names_.empty() || (lower.array() > upper.array()).any())
+    return;
+
+  // The number of cells is checked before it is converted, so large environments cannot overflow it
+  double padding = max_distance_ + resolution_;
+  Eigen::Array3d size = (((upper - lower).array() + 2 * padding) / resolution_).ceil() + 1;
+  if (size.prod() > static_cast<double>(max_cells))
+  {
+    CONSOLE_BRIDGE_logWarn("SignedDistanceField: %.0f grid cells are needed for a resolution of %f, at most %zu are "
+                           "allowed",
+                           size.prod(),
+                           resolution_,
+                           max_cells);
+    valid_ = false;
+    return;
+  }
+  origin_ = lower - Eigen::Vector3d::Constant(padding);
+  size_ = size.cast<int>();
+
+  // Measure the distances with a probe sphere which is checked against the links only
+  tesseract_collision::DiscreteContactManager::Ptr manager = env.getDiscreteContactManager();
+  for (const auto& name : manager->getCollisionObjects())
+  {
+    if (link_indices.find(name) == link_indices.end())
+      manager->disableCollisionObject(name);
+  }
+
+  const std::string probe_name = "trajopt_signed_distance_field_probe";
+  double probe_radius = 0.5 * resolution_;
+  tesseract_collision::CollisionShapesConst shapes{ std::make_shared<tesseract_geometry::Sphere>(probe_radius) };
+  tesseract_common::VectorIsometry3d shape_poses{ Eigen::Isometry3d::Identity() };
+  manager->addCollisionObject(probe_name, 0, shapes, shape_poses, true);
+  manager->setActiveCollisionObjects({ probe_name });
+  manager->setDefaultCollisionMarginData(max_distance_ + probe_radius);
+
+  std::size_t n_cells =
+      static_cast<std::size_t>(size_(0)) * static_cast<std::size_t>(size_(1)) * static_cast<std::size_t>(size_(2));
+  distances_.assign(n_cells, static_cast<float>(max_distance_));
+  closest_links_.assign(distances_.size(), 0);
+  Eigen::Isometry3d probe_pose = Eigen::Isometry3d::Identity();
+  tesseract_collision::ContactResultMap contacts;
+  for (int z = 0; z < size_(2); ++z)
+  {
+    for (int y = 0; y < size_(1); ++y)
+    {
+      for (int x = 0; x < size_(0); ++x)
+      {
+        probe_pose.translation() = origin_ + resolution_ * Eigen::Vector3d(x, y, z);
+        manager->setCollisionObjectsTransform(probe_name, probe_pose);
+        contacts.clear();
+        manager->contactTest(contacts, tesseract_collision::ContactTestType::CLOSEST);
+
+        std::size_t i = index(x, y, z);
+        for (const auto& pair : contacts)
+        {
+          for (const auto& res : pair.second)
+          {
+            // The distance of the probe center is the one of its surface plus its radius
+            auto distance = static_cast<float>(res.distance + probe_radius);
+            if (distance < distances_[i])
+            {
+              distances_[i] = distance;
+              const std::string& link_name = (res.link_names[0] == probe_name) ? res.link_names[1] : res.link_names[0];
+              closest_links_[i] = link_indices.at(link_name);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+double SignedDistanceField::calcDistance(const Eigen::Vector3d& point,
+                                         Eigen::Vector3d& gradient,
+                                         std::size_t& link_index) const
+{
+  gradient.setZero();
+  link_index = 0;
+  if (distances_.empty())
+    return max_distance_;
+
+  Eigen::Array3d grid_point = (point - origin_).array() / resolution_;
+  Eigen::Array3i cell = grid_point.floor().cast<int>();
+  if ((cell < 0).any() || (cell >= size_ - 1).any())
+    return max_distance_;
+
+  // Trilinear interpolation of the eight corners of the cell
+  Eigen::Array3d t = grid_point - cell.cast<double>();
+  double distance = 0;
+  for (int corner = 0; corner < 8; ++corner)
+  {
+    Eigen::Array3i offset((corner & 1) ? 1 : 0, (corner & 2) ? 1 : 0, (corner & 4) ? 1 : 0);
+    Eigen::Array3d weights = (offset == 1).select(t, 1 - t);
+    Eigen::Array3d signs = (offset == 1).select(Eigen::Array3d::Ones(), -Eigen::Array3d::Ones());
+    double value = distances_[index(cell(0) + offset(0), cell(1) + offset(1), cell(2) + offset(2))];
+
+    distance += weights.prod() * value;
+    gradient(0) += signs(0) * weights(1) * weights(2) * value;
+    gradient(1) += signs(1) * weights(0) * weights(2) * value;
+    gradient(2) += signs(2) * weights(0) * weights(1) * value;
+  }
+  gradient /= resolution_;
+
+  Eigen::Array3i nearest = cell + (t >= 0.5).cast<int>();
+  link_index = closest_links_[index(nearest(0), nearest(1), nearest(2))];
+  return distance;
+}
+
+StaticEnvironmentSDF::StaticEnvironmentSDF(const tesseract_environment::Environment& env,
+                                           std::vector<std::string> active_links,
+                                           double resolution,
+                                           double max_distance,
+                                           std::size_t max_cells)
+  : active_links_(std::move(active_links))
+{
+  tesseract_scene_graph::SceneGraph::ConstPtr scene_graph = env.getSceneGraph();
+
+  active_link_spheres_.resize(active_links_.size());
+  for (std::size_t i = 0; i < active_links_.size(); ++i)
+  {
+    tesseract_scene_graph::Link::ConstPtr link = scene_graph->getLink(active_links_[i]);
+    if (link == nullptr || !calcCollisionSpheres(*link, resolution, active_link_spheres_[i]))
+    {
+      CONSOLE_BRIDGE_logWarn("StaticEnvironmentSDF: the collision geometry of link '%s' is not supported",
+                             active_links_[i].c_str());
+      valid_ = false;
+      return;
+    }
+  }
+
+  // Group the static links by the active links they are allowed to collide with
+  auto acm = env.getAllowedCollisionMatrix();
+  std::map<std::vector<bool>, std::vector<std::string>> groups;
+  for (const auto& link_name : env.getLinkNames())
+  {
+    if (std::find(active_links_.begin(), active_links_.end(), link_name) != active_links_.end())
+      continue;
+
+    tesseract_scene_graph::Link::ConstPtr link = scene_graph->getLink(link_name);
+    if (link == nullptr || link->collision.empty())
+      continue;
+
+    std::vector<bool> allowed(active_links_.size());
+    for (std::size_t i = 0; i < active_links_.size(); ++i)
+      allowed[i] = acm->isCollisionAllowed(link_name, active_links_[i]);
+
+    if (std::find(allowed.begin(), allowed.end(), false) != allowed.end())
+      groups[allowed].push_back(link_name);
+  }
+
+  for (auto& group : groups)
+  {
+    auto sdf =
+        std::make_shared<SignedDistanceField>(env, std::move(group.second), resolution, max_distance, max_cells);
+    if (!sdf->isValid())
+    {
+      valid_ = false;
+      return;
+    }
+    fields_.push_back(Field{ sdf, group.first });
+  }
+}
+
+void StaticEnvironmentSDF::contactTest(
+    tesseract_collision::ContactResultMap& contacts,
+    const tesseract_common::VectorIsometry3d& link_transforms,
+    const std::function<double(const std::string&, const std::string&)>& contact_distance_fn,
+    tesseract_collision::ContactTestType type) const
+{
+  assert(link_transforms.size() == active_links_.size());
+  Eigen::Vector3d gradient;
+  std::size_t link_index = 0;
+  std::vector<double> closest_distances;
+  std::vector<std::size_t> closest_spheres;
+  for (const Field& field : fields_)
+  {
+    const std::vector<std::string>& field_links = field.sdf->getLinkNames();
+    for (std::size_t i = 0; i < active_links_.size(); ++i)
+    {
+      if (field.allowed[i])
+        continue;
+
+      // Find the closest sphere of the active link to every link of the field
+      const CollisionSpheres& spheres = active_link_spheres_[i];
+      const Eigen::Isometry3d& link_transform = link_transforms[i];
+      closest_distances.assign(field_links.size(), std::numeric_limits<double>::max());
+      closest_spheres.assign(field_links.size(), spheres.centers.size());
+      for (std::size_t s = 0; s < spheres.centers.size(); ++s)
+      {
+        double distance =
+            field.sdf->calcDistance(link_transform * spheres.centers[s], gradient, link_index) - spheres.radii[s];
+        if (distance < closest_distances[link_index])
+        {
+          closest_distances[link_index] = distance;
+          closest_spheres[link_index] = s;
+        }
+      }
+
+      for (std::size_t j = 0; j < field_links.size(); ++j)
+      {
+        if (closest_spheres[j] == spheres.centers.size() ||
+            !(closest_distances[j] < contact_distance_fn(active_links_[i], field_links[j])))
+          continue;
+
+        // The normal points from the active link towards the static link, against the gradient of the field
+        std::size_t s = closest_spheres[j];
+        Eigen::Vector3d center = link_transform * spheres.centers[s];
+        double center_distance = field.sdf->calcDistance(center, gradient, link_index);
+        Eigen::Vector3d normal = (gradient.norm() > 0) ? Eigen::Vector3d(-gradient.normalized()) :
+                                                         Eigen::Vector3d::Zero();
+
+        tesseract_collision::ContactResult res;
+        res.link_names[0] = active_links_[i];
+        res.link_names[1] = field_links[j];
+        res.distance = center_distance - spheres.radii[s];
+        res.normal = normal;
+        res.nearest_points[0] = center + spheres.radii[s] * normal;
+        res.nearest_points[1] = center + center_distance * normal;
+        res.nearest_points_local[0] = link_transform.inverse() * res.nearest_points[0];
+        res.nearest_points_local[1] = res.nearest_points[1];
+        res.transform[0] = link_transform;
+        res.transform[1] = Eigen::Isometry3d::Identity();
+        res.cc_transform[0] = link_transform;
+        res.cc_transform[1] = Eigen::Isometry3d::Identity();
+        contacts[tesseract_collision::getObjPairKey(res.link_names[0], res.link_names[1])].push_back(res);
+
+        if (type == tesseract_collision::ContactTestType::FIRST)
+          return;
+      }
+    }
+  }
+}
+}  // namespace trajopt
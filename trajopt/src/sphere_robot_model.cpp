@@ -0,0 +1,309 @@
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
+#include <limits>
+#include <console_bridge/console.h>
+#include <tesseract_collision/core/common.h>
+#include <tesseract_geometry/geometries.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt/sphere_robot_model.hpp>
+
+namespace trajopt
+{
+void calcSphereSphereDistances(const Eigen::Vector3d& center,
+                               double radius,
+                               const SphereCenters& centers,
+                               const Eigen::ArrayXd& radii,
+                               Eigen::ArrayXd& distances)
+{
+  distances = ((centers.col(0).array() - center(0)).square() + (centers.col(1).array() - center(1)).square() +
+               (centers.col(2).array() - center(2)).square())
+                  .sqrt() -
+              radii - radius;
+}
+
+void calcSphereBoxDistances(const SphereCenters& centers,
+                            const Eigen::ArrayXd& radii,
+                            const Eigen::Array3d& half_extents,
+                            Eigen::ArrayXd& distances)
+{
+  // Signed distance of a box: the length of the positive part of |p| - h outside, its largest coordinate inside
+  Eigen::ArrayXd dx = centers.col(0).array().abs() - half_extents(0);
+  Eigen::ArrayXd dy = centers.col(1).array().abs() - half_extents(1);
+  Eigen::ArrayXd dz = centers.col(2).array().abs() - half_extents(2);
+  distances = (dx.max(0.0).square() + dy.max(0.0).square() + dz.max(0.0).square()).sqrt() +
+              dx.max(dy).max(dz).min(0.0) - radii;
+}
+
+/** @brief The gradient of the signed distance of a box at a point, both in the frame of the box */
+static Eigen::Vector3d calcBoxGradient(const Eigen::Vector3d& point, const Eigen::Array3d& half_extents)
+{
+  Eigen::Array3d signs = (point.array() < 0).select(-Eigen::Array3d::Ones(), Eigen::Array3d::Ones());
+  Eigen::Array3d d = point.array().abs() - half_extents;
+  if ((d > 0).any())
+    return (d.max(0.0) * signs).matrix().normalized();
+
+  // Inside the gradient is the normal of the closest face
+  Eigen::Index axis = 0;
+  d.maxCoeff(&axis);
+  Eigen::Vector3d gradient = Eigen::Vector3d::Zero();
+  gradient(axis) = signs(axis);
+  return gradient;
+}
+
+SphereRobotModel::SphereRobotModel(const tesseract_environment::Environment& env,
+                                   std::vector<std::string> active_links,
+                                   double spacing,
+                                   StaticEnvironmentSDF::ConstPtr environment_sdf)
+  : active_links_(std::move(active_links)), environment_sdf_(std::move(environment_sdf))
+{
+  tesseract_scene_graph::SceneGraph::ConstPtr scene_graph = env.getSceneGraph();
+
+  CollisionSpheres spheres;
+  link_spheres_.resize(active_links_.size());
+  for (std::size_t i = 0; i < active_links_.size(); ++i)
+  {
+    tesseract_scene_graph::Link::ConstPtr link = scene_graph->getLink(active_links_[i]);
+    if (link == nullptr || !calcCollisionSpheres(*link, spacing, spheres))
+    {
+      CONSOLE_BRIDGE_logWarn("SphereRobotModel: the collision geometry of link '%s' is not supported",
+                             active_links_[i].c_str());
+      valid_ = false;
+      return;
+    }
+
+    LinkSpheres& link_spheres = link_spheres_[i];
+    auto n_spheres = static_cast<Eigen::Index>(spheres.centers.size());
+    link_spheres.centers.resize(n_spheres, 3);
+    link_spheres.radii.resize(n_spheres);
+    for (Eigen::Index s = 0; s < n_spheres; ++s)
+    {
+      link_spheres.centers.row(s) = spheres.centers[static_cast<std::size_t>(s)].transpose();
+      link_spheres.radii(s) = spheres.radii[static_cast<std::size_t>(s)];
+    }
+
+    if (n_spheres > 0)
+    {
+      link_spheres.bounding_center = link_spheres.centers.colwise().mean().transpose();
+      link_spheres.bounding_radius =
+          ((link_spheres.centers.rowwise() - link_spheres.bounding_center.transpose()).rowwise().norm().array() +
+           link_spheres.radii)
+              .maxCoeff();
+    }
+  }
+
+  auto acm = env.getAllowedCollisionMatrix();
+  for (std::size_t i = 0; i < active_links_.size(); ++i)
+  {
+    for (std::size_t j = i + 1; j < active_links_.size(); ++j)
+    {
+      if (link_spheres_[i].radii.size() > 0 && link_spheres_[j].radii.size() > 0 &&
+          !acm->isCollisionAllowed(active_links_[i], active_links_[j]))
+        self_pairs_.emplace_back(i, j);
+    }
+  }
+
+  if (environment_sdf_ != nullptr)
+  {
+    if (!environment_sdf_->isValid() || environment_sdf_->getActiveLinkNames() != active_links_)
+    {
+      CONSOLE_BRIDGE_logWarn("SphereRobotModel: the signed distance field does not match the active links");
+      valid_ = false;
+    }
+    return;
+  }
+
+  // Without a field the static links are checked as boxes
+  tesseract_environment::EnvState::ConstPtr state = env.getCurrentState();
+  for (const auto& link_name : env.getLinkNames())
+  {
+    if (std::find(active_links_.begin(), active_links_.end(), link_name) != active_links_.end())
+      continue;
+
+    tesseract_scene_graph::Link::ConstPtr link = scene_graph->getLink(link_name);
+    if (link == nullptr || link->collision.empty())
+      continue;
+
+    std::vector<bool> allowed(active_links_.size());
+    for (std::size_t i = 0; i < active_links_.size(); ++i)
+      allowed[i] = acm->isCollisionAllowed(link_name, active_links_[i]);
+
+    if (std::find(allowed.begin(), allowed.end(), false) == allowed.end())
+      continue;
+
+    for (const auto& collision : link->collision)
+    {
+      if (collision->geometry->getType() != tesseract_geometry::GeometryType::BOX)
+      {
+        CONSOLE_BRIDGE_logWarn("SphereRobotModel: link '%s' is not a box, a signed distance field is required",
+                               link_name.c_str());
+        valid_ = false;
+        return;
+      }
+
+      const auto& box = static_cast<const tesseract_geometry::Box&>(*collision->geometry);
+      static_boxes_.push_back(StaticBox{ link_name,
+                                         state->link_transforms.at(link_name) * collision->origin,
+                                         Eigen::Array3d(0.5 * box.getX(), 0.5 * box.getY(), 0.5 * box.getZ()),
+                                         allowed });
+    }
+  }
+}
+
+long SphereRobotModel::getNumSpheres() const
+{
+  long n_spheres = 0;
+  for (const LinkSpheres& link_spheres : link_spheres_)
+    n_spheres += link_spheres.radii.size();
+  return n_spheres;
+}
+
+void SphereRobotModel::contactTest(
+    tesseract_collision::ContactResultMap& contacts,
+    const tesseract_common::VectorIsometry3d& link_transforms,
+    const std::function<double(const std::string&, const std::string&)>& contact_distance_fn,
+    tesseract_collision::ContactTestType type) const
+{
+  assert(link_transforms.size() == active_links_.size());
+
+  // Transform all spheres of a link at once
+  std::vector<SphereCenters> world_centers(active_links_.size());
+  for (std::size_t i = 0; i < active_links_.size(); ++i)
+  {
+    const Eigen::Isometry3d& link_transform = link_transforms[i];
+    world_centers[i] = (link_spheres_[i].centers * link_transform.linear().transpose()).rowwise() +
+                       link_transform.translation().transpose();
+  }
+
+  if (selfContactTest(contacts, world_centers, link_transforms, contact_distance_fn, type))
+    return;
+
+  if (environment_sdf_ != nullptr)
+    environment_sdf_->contactTest(contacts, link_transforms, contact_distance_fn, type);
+  else
+    boxContactTest(contacts, world_centers, link_transforms, contact_distance_fn, type);
+}
+
+bool SphereRobotModel::selfContactTest(
+    tesseract_collision::ContactResultMap& contacts,
+    const std::vector<SphereCenters>& world_centers,
+    const tesseract_common::VectorIsometry3d& link_transforms,
+    const std::function<double(const std::string&, const std::string&)>& contact_distance_fn,
+    tesseract_collision::ContactTestType type) const
+{
+  Eigen::ArrayXd distances;
+  for (const auto& pair : self_pairs_)
+  {
+    std::size_t i = pair.first;
+    std::size_t j = pair.second;
+    const LinkSpheres& spheres_i = link_spheres_[i];
+    const LinkSpheres& spheres_j = link_spheres_[j];
+    double contact_distance = contact_distance_fn(active_links_[i], active_links_[j]);
+
+    Eigen::Vector3d bounding_i = link_transforms[i] * spheres_i.bounding_center;
+    Eigen::Vector3d bounding_j = link_transforms[j] * spheres_j.bounding_center;
+    if ((bounding_i - bounding_j).norm() - spheres_i.bounding_radius - spheres_j.bounding_radius >= contact_distance)
+      continue;
+
+    double closest_distance = std::numeric_limits<double>::max();
+    Eigen::Index closest_i = 0;
+    Eigen::Index closest_j = 0;
+    for (Eigen::Index s = 0; s < spheres_i.radii.size(); ++s)
+    {
+      Eigen::Vector3d center = world_centers[i].row(s).transpose();
+      calcSphereSphereDistances(center, spheres_i.radii(s), world_centers[j], spheres_j.radii, distances);
+      Eigen::Index t = 0;
+      double distance = distances.minCoeff(&t);
+      if (distance < closest_distance)
+      {
+        closest_distance = distance;
+        closest_i = s;
+        closest_j = t;
+      }
+    }
+
+    if (!(closest_distance < contact_distance))
+      continue;
+
+    // The normal points from link i towards link j
+    Eigen::Vector3d center_i = world_centers[i].row(closest_i).transpose();
+    Eigen::Vector3d center_j = world_centers[j].row(closest_j).transpose();
+    Eigen::Vector3d normal = center_j - center_i;
+    normal = (normal.norm() > 0) ? Eigen::Vector3d(normal.normalized()) : Eigen::Vector3d::Zero();
+
+    tesseract_collision::ContactResult res;
+    res.link_names[0] = active_links_[i];
+    res.link_names[1] = active_links_[j];
+    res.distance = closest_distance;
+    res.normal = normal;
+    res.nearest_points[0] = center_i + spheres_i.radii(closest_i) * normal;
+    res.nearest_points[1] = center_j - spheres_j.radii(closest_j) * normal;
+    res.nearest_points_local[0] = link_transforms[i].inverse() * res.nearest_points[0];
+    res.nearest_points_local[1] = link_transforms[j].inverse() * res.nearest_points[1];
+    res.transform[0] = link_transforms[i];
+    res.transform[1] = link_transforms[j];
+    res.cc_transform[0] = link_transforms[i];
+    res.cc_transform[1] = link_transforms[j];
+    contacts[tesseract_collision::getObjPairKey(res.link_names[0], res.link_names[1])].push_back(res);
+
+    if (type == tesseract_collision::ContactTestType::FIRST)
+      return true;
+  }
+  return false;
+}
+
+bool SphereRobotModel::boxContactTest(
+    tesseract_collision::ContactResultMap& contacts,
+    const std::vector<SphereCenters>& world_centers,
+    const tesseract_common::VectorIsometry3d& link_transforms,
+    const std::function<double(const std::string&, const std::string&)>& contact_distance_fn,
+    tesseract_collision::ContactTestType type) const
+{
+  Eigen::ArrayXd distances;
+  SphereCenters box_centers;
+  for (const StaticBox& box : static_boxes_)
+  {
+    for (std::size_t i = 0; i < active_links_.size(); ++i)
+    {
+      const LinkSpheres& spheres = link_spheres_[i];
+      if (box.allowed[i] || spheres.radii.size() == 0)
+        continue;
+
+      // Express the spheres in the frame of the box
+      double contact_distance = contact_distance_fn(active_links_[i], box.link_name);
+      box_centers = (world_centers[i].rowwise() - box.transform.translation().transpose()) * box.transform.linear();
+      calcSphereBoxDistances(box_centers, spheres.radii, box.half_extents, distances);
+      Eigen::Index s = 0;
+      double distance = distances.minCoeff(&s);
+      if (!(distance < contact_distance))
+        continue;
+
+      // The normal points from the active link towards the box, against the gradient of its distance
+      Eigen::Vector3d box_center = box_centers.row(s).transpose();
+      Eigen::Vector3d normal = -(box.transform.linear() * calcBoxGradient(box_center, box.half_extents));
+      Eigen::Vector3d center = world_centers[i].row(s).transpose();
+      double center_distance = distance + spheres.radii(s);
+
+      tesseract_collision::ContactResult res;
+      res.link_names[0] = active_links_[i];
+      res.link_names[1] = box.link_name;
+      res.distance = distance;
+      res.normal = normal;
+      res.nearest_points[0] = center + spheres.radii(s) * normal;
+      res.nearest_points[1] = center + center_distance * normal;
+      res.nearest_points_local[0] = link_transforms[i].inverse() * res.nearest_points[0];
+      res.nearest_points_local[1] = res.nearest_points[1];
+      res.transform[0] = link_transforms[i];
+      res.transform[1] = Eigen::Isometry3d::Identity();
+      res.cc_transform[0] = link_transforms[i];
+      res.cc_transform[1] = Eigen::Isometry3d::Identity();
+      contacts[tesseract_collision::getObjPairKey(res.link_names[0], res.link_names[1])].push_back(res);
+
+      if (type == tesseract_collision::ContactTestType::FIRST)
+        return true;
+    }
+  }
+  return false;
+}
+}  // namespace trajopt
@@ -0,0 +1,215 @@
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <tesseract_environment/core/environment.h>
+#include <tesseract_environment/ofkt/ofkt_state_solver.h>
+#include <tesseract_scene_graph/resource_locator.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt/problem_description.hpp>
+#include <trajopt/utils.hpp>
+#include <trajopt_utils/eigen_conversions.hpp>
+#include <trajopt_utils/logging.hpp>
+
+using namespace trajopt;
+using namespace tesseract_environment;
+using namespace tesseract_scene_graph;
+
+/** @brief Total length of the generated arms, independent of the number of joints */
+static const double ARM_LENGTH = 1.0;
+/** @brief Total bend of the generated arms in the start and goal configurations */
+static const double ARM_BEND = 1.2;
+
+/**
+ * @brief Creates the URDF of a serial arm with n_dof revolute joints, alternating between the z and y axis, next to a
+ * pole which is in the way of the straight line motion between the start and goal configurations (see
+ * chainConfiguration).
+ */
+inline std::string chainURDF(int n_dof)
+{
+  const double length = ARM_LENGTH / n_dof;
+  std::stringstream urdf;
+  urdf << "<robot name=\"chain\">\n"
+       << "  <link name=\"base_link\"/>\n";
+  for (int i = 0; i < n_dof; ++i)
+  {
+    std::string parent = (i == 0) ? "base_link" : "link_" + std::to_string(i - 1);
+    urdf << "  <link name=\"link_" << i << "\">\n"
+         << "    <collision>\n"
+         << "      <origin xyz=\"0 0 " << length / 2 << "\"/>\n"
+         << "      <geometry><cylinder radius=\"0.03\" length=\"" << length << "\"/></geometry>\n"
+         << "    </collision>\n"
+         << "  </link>\n"
+         << "  <joint name=\"joint_" << i << "\" type=\"revolute\">\n"
+         << "    <parent link=\"" << parent << "\"/>\n"
+         << "    <child link=\"link_" << i << "\"/>\n"
+         << "    <origin xyz=\"0 0 " << ((i == 0) ? 0.1 : length) << "\"/>\n"
+         << "    <axis xyz=\"0 " << ((i % 2 == 0) ? "0 1" : "1 0") << "\"/>\n"
+         << "    <limit lower=\"-3.14\" upper=\"3.14\" effort=\"100\" velocity=\"2\"/>\n"
+         << "  </joint>\n";
+  }
+  urdf << "  <link name=\"tool0\"/>\n"
+       << "  <joint name=\"joint_tool0\" type=\"fixed\">\n"
+       << "    <parent link=\"link_" << n_dof - 1 << "\"/>\n"
+       << "    <child link=\"tool0\"/>\n"
+       << "    <origin xyz=\"0 0 " << length << "\"/>\n"
+       << "  </joint>\n"
+       << "  <link name=\"pole\">\n"
+       << "    <collision><geometry><box size=\"0.1 0.1 1.2\"/></geometry></collision>\n"
+       << "  </link>\n"
+       << "  <joint name=\"joint_pole\" type=\"fixed\">\n"
+       << "    <parent link=\"base_link\"/>\n"
+       << "    <child link=\"pole\"/>\n"
+       << "    <origin xyz=\"0.45 0 0.6\"/>\n"
+       << "  </joint>\n"
+       << "</robot>\n";
+  return urdf.str();
+}
+
+inline std::string chainSRDF(int n_dof)
+{
+  std::stringstream srdf;
+  srdf << "<robot name=\"chain\">\n"
+       << "  <group name=\"manipulator\"><chain base_link=\"base_link\" tip_link=\"tool0\"/></group>\n"
+       << "  <disable_collisions link1=\"base_link\" link2=\"pole\" reason=\"Adjacent\"/>\n"
+       << "  <disable_collisions link1=\"base_link\" link2=\"link_0\" reason=\"Adjacent\"/>\n";
+  for (int i = 1; i < n_dof; ++i)
+    srdf << "  <disable_collisions link1=\"link_" << i - 1 << "\" link2=\"link_" << i << "\" reason=\"Adjacent\"/>\n";
+  srdf << "</robot>\n";
+  return srdf.str();
+}
+
+/**
+ * @brief Joint values of the generated arm, bent by ARM_BEND over all y axis joints and turned by base_angle
+ * @param base_angle Value of the first (z axis) joint
+ */
+inline DblVec chainConfiguration(int n_dof, double base_angle)
+{
+  DblVec out(static_cast<std::size_t>(n_dof), 0);
+  const int n_bending = n_dof / 2;
+  out[0] = base_angle;
+  for (int i = 1; i < n_dof; i += 2)
+    out[static_cast<std::size_t>(i)] = ARM_BEND / n_bending;
+  return out;
+}
+
+/**
+ * @brief Moves the generated arm around the pole: n_steps, joint velocity cost, collision cost with the given
+ * evaluator, start fixed and goal as constraint
+ */
+inline ProblemConstructionInfo createProblem(const Environment::Ptr& env,
+                                             int n_steps,
+                                             int n_dof,
+                                             CollisionEvaluatorType evaluator_type,
+                                             sco::ModelType convex_solver)
+{
+  ProblemConstructionInfo pci(env);
+  pci.basic_info.n_steps = n_steps;
+  pci.basic_info.manip = "manipulator";
+  pci.basic_info.fixed_timesteps = { 0 };
+  pci.basic_info.use_time = false;
+  pci.basic_info.convex_solver = convex_solver;
+  pci.kin = pci.getManipulator(pci.basic_info.manip);
+
+  DblVec start = chainConfiguration(n_dof, -1.2);
+  DblVec goal = chainConfiguration(n_dof, 1.2);
+  std::unordered_map<std::string, double> ipos;
+  for (std::size_t i = 0; i < start.size(); ++i)
+    ipos[pci.kin->getJointNames()[i]] = start[i];
+  env->setState(ipos);
+
+  auto vel = std::make_shared<JointVelTermInfo>();
+  vel->name = "joint_vel";
+  vel->term_type = TT_COST;
+  vel->coeffs = DblVec(static_cast<std::size_t>(n_dof), 1);
+  vel->targets = DblVec(static_cast<std::size_t>(n_dof), 0);
+  vel->first_step = 0;
+  vel->last_step = n_steps - 1;
+  pci.cost_infos.push_back(vel);
+
+  auto collision = std::make_shared<CollisionTermInfo>();
+  collision->name = "collision";
+  collision->term_type = TT_COST;
+  collision->evaluator_type = evaluator_type;
+  collision->first_step = 0;
+  collision->last_step = n_steps - 1;
+  collision->fixed_steps = { 0 };
+  collision->longest_valid_segment_length = 0.05;
+  collision->safety_margin_buffer = 0.05;
+  for (int i = 0; i < n_steps; ++i)
+    collision->info.push_back(std::make_shared<SafetyMarginData>(0.025, 20));
+  pci.cost_infos.push_back(collision);
+
+  auto target = std::make_shared<JointPosTermInfo>();
+  target->name = "goal";
+  target->term_type = TT_CNT;
+  target->coeffs = DblVec(static_cast<std::size_t>(n_dof), 1);
+  target->targets = goal;
+  target->first_step = n_steps - 1;
+  target->last_step = n_steps - 1;
+  pci.cnt_infos.push_back(target);
+
+  pci.init_info.type = InitInfo::JOINT_INTERPOLATED;
+  pci.init_info.data = util::toVectorXd(goal);
+  return pci;
+}
+
+/**
+ * @brief Times ConstructProblem + OptimizeProblem.
+ *
+ * Arguments are {n_steps, DOF, CollisionEvaluatorType, sco::ModelType}. Besides the wall time, the SQP iterations
+ * and QP solves of the last run are reported, as well as whether it converged.
+ */
+static void BM_PLANNING(benchmark::State& state)
+{
+  const auto n_steps = static_cast<int>(state.range(0));
+  const auto n_dof = static_cast<int>(state.range(1));
+  const auto evaluator_type = static_cast<CollisionEvaluatorType>(state.range(2));
+  const sco::ModelType convex_solver(static_cast<int>(state.range(3)));
+  util::gLogLevel = util::LevelError;
+
+  auto env = std::make_shared<Environment>();
+  auto locator = std::make_shared<SimpleResourceLocator>([](const std::string& url) { return url; });
+  if (!env->init<OFKTStateSolver>(chainURDF(n_dof), chainSRDF(n_dof), locator))
+  {
+    state.SkipWithError("Failed to initialize the environment");
+    return;
+  }
+
+  TrajOptResult::Ptr result;
+  for (auto _ : state)
+  {
+    ProblemConstructionInfo pci = createProblem(env, n_steps, n_dof, evaluator_type, convex_solver);
+    TrajOptProb::Ptr prob = ConstructProblem(pci);
+    result = OptimizeProblem(prob);
+  }
+
+  state.counters["sqp_iters"] = result->n_sqp_iters;
+  state.counters["qp_solves"] = result->n_qp_solves;
+  state.counters["converged"] = (result->status == sco::OPT_CONVERGED) ? 1 : 0;
+}
+
+/** @brief The sweep over problem sizes, collision evaluators and the convex solvers available in this build */
+static void planningArguments(benchmark::internal::Benchmark* b)
+{
+  for (sco::ModelType convex_solver : sco::availableSolvers())
+  {
+    for (int evaluator_type : { static_cast<int>(CollisionEvaluatorType::SINGLE_TIMESTEP),
+                                static_cast<int>(CollisionEvaluatorType::DISCRETE_CONTINUOUS),
+                                static_cast<int>(CollisionEvaluatorType::CAST_CONTINUOUS) })
+    {
+      for (int n_dof : { 6, 7, 10, 14 })
+      {
+        for (int n_steps : { 10, 50, 200, 1000, 2000 })
+          b->Args({ n_steps, n_dof, evaluator_type, static_cast<int>(convex_solver) });
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_PLANNING)->Apply(planningArguments)->UseRealTime()->Unit(benchmark::TimeUnit::kMillisecond);
+
+BENCHMARK_MAIN();
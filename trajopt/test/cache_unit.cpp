@@ -0,0 +1,76 @@
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt/cache.hxx>
+
+using namespace trajopt;
+
+/** @brief Maps every key to the same bucket, so lookups have to compare the keys */
+struct ConstantHash
+{
+  std::size_t operator()(const std::vector<double>& /*key*/) const { return 0; }
+};
+
+TEST(LRUCache, EvictsLeastRecentlyUsed)  // NOLINT
+{
+  LRUCache<std::vector<double>, std::string, RangeHash<std::vector<double>>> cache(2);
+  cache.put({ 1, 2 }, std::string("a"));
+  cache.put({ 3, 4 }, std::string("b"));
+  ASSERT_NE(cache.get({ 1, 2 }), nullptr);
+  cache.put({ 5, 6 }, std::string("c"));
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(*cache.get({ 1, 2 }), "a");
+  EXPECT_EQ(cache.get({ 3, 4 }), nullptr);
+  EXPECT_EQ(*cache.get({ 5, 6 }), "c");
+  EXPECT_EQ(cache.getNumHits(), 3);
+  EXPECT_EQ(cache.getNumMisses(), 1);
+
+  // Replacing a value keeps a single entry
+  cache.put({ 5, 6 }, std::string("d"));
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(*cache.get({ 5, 6 }), "d");
+
+  cache.setCapacity(1);
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_EQ(cache.get({ 1, 2 }), nullptr);
+  EXPECT_EQ(*cache.get({ 5, 6 }), "d");
+
+  cache.setCapacity(0);
+  cache.put({ 1, 2 }, std::string("a"));
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(LRUCache, ComparesKeysExactly)  // NOLINT
+{
+  LRUCache<std::vector<double>, int, ConstantHash> cache(10);
+  cache.put({ 1, 2 }, 1);
+  cache.put({ 1, 2.0000001 }, 2);
+  EXPECT_EQ(*cache.get({ 1, 2 }), 1);
+  EXPECT_EQ(*cache.get({ 1, 2.0000001 }), 2);
+  EXPECT_EQ(cache.get({ 2, 1 }), nullptr);
+}
+
+TEST(LRUCache, HandlesOutliveEviction)  // NOLINT
+{
+  LRUCache<std::vector<double>, std::vector<double>, RangeHash<std::vector<double>>> cache(1);
+  auto value = cache.put({ 1 }, std::vector<double>{ 1, 2, 3 });
+  EXPECT_EQ(cache.get({ 1 }), value);
+
+  cache.put({ 2 }, std::vector<double>{ 4 });
+  EXPECT_EQ(cache.get({ 1 }), nullptr);
+  EXPECT_EQ(value->size(), 3);
+
+  // Copies keep the entries in the same order
+  cache.setCapacity(2);
+  cache.put({ 3 }, std::vector<double>{ 5 });
+  auto copy = cache;
+  copy.put({ 4 }, std::vector<double>{ 6 });
+  EXPECT_EQ(copy.get({ 2 }), nullptr);
+  EXPECT_NE(copy.get({ 3 }), nullptr);
+  EXPECT_NE(cache.get({ 2 }), nullptr);
+}
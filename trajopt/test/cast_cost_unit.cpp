@@ -1,6 +1,10 @@
 #include <trajopt_utils/macros.h>
 TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
 #include <ctime>
+#include <functional>
+#include <limits>
+#include <stdexcept>
 #include <gtest/gtest.h>
 #include <tesseract_environment/core/environment.h>
 #include <tesseract_environment/ofkt/ofkt_state_solver.h>
@@ -52,6 +56,105 @@ public:
     // Create plotting tool
     //    plotter_.reset(new tesseract_ros::ROSBasicPlotting(env_));
   }
+
+  /** @brief Get the collision term of box_cast_test.json */
+  static CollisionTermInfo& getCollisionInfo(ProblemConstructionInfo& pci)
+  {
+    auto info = std::dynamic_pointer_cast<CollisionTermInfo>(pci.cost_infos.at(1));
+    if (info == nullptr)
+      throw std::runtime_error("box_cast_test.json has no collision cost");
+    return *info;
+  }
+
+  /** @brief Get the evaluators of the collision costs of a problem */
+  static std::vector<CollisionEvaluator::Ptr> getCollisionEvaluators(TrajOptProb& prob)
+  {
+    std::vector<CollisionEvaluator::Ptr> evaluators;
+    for (const sco::Cost::Ptr& cost : prob.getCosts())
+    {
+      auto* collision_cost = dynamic_cast<CollisionCost*>(cost.get());
+      if (collision_cost != nullptr)
+        evaluators.push_back(collision_cost->getEvaluator());
+    }
+    return evaluators;
+  }
+
+  /** @brief Get the sum of the collision costs of a problem for the variables x */
+  static double calcCollisionCost(TrajOptProb& prob, const DblVec& x)
+  {
+    double cost = 0;
+    for (const sco::Cost::Ptr& c : prob.getCosts())
+      if (dynamic_cast<CollisionCost*>(c.get()) != nullptr)
+        cost += c->value(x);
+    return cost;
+  }
+
+  /**
+   * @brief Construct the problem of box_cast_test.json, in which boxbot has to move around a box
+   * @param modify Changes the problem construction info, e.g. the collision term, before the problem is constructed
+   * @return The problem
+   */
+  TrajOptProb::Ptr constructBoxes(const std::function<void(ProblemConstructionInfo&)>& modify = nullptr)
+  {
+    std::unordered_map<std::string, double> ipos;
+    ipos["boxbot_x_joint"] = -1.9;
+    ipos["boxbot_y_joint"] = 0;
+    env_->setState(ipos);
+
+    Json::Value root = readJsonFile(std::string(TRAJOPT_DIR) + "/test/data/config/box_cast_test.json");
+    ProblemConstructionInfo pci(env_);
+    pci.fromJson(root);
+    if (modify)
+      modify(pci);
+    return ConstructProblem(pci);
+  }
+
+  /**
+   * @brief Check the trajectory of the variables x of a problem for collisions with a continuous contact manager
+   * @return True if the trajectory is in collision
+   */
+  bool checkBoxes(TrajOptProb& prob, const DblVec& x)
+  {
+    std::vector<ContactResultMap> collisions;
+    tesseract_environment::StateSolver::Ptr state_solver = prob.GetEnv()->getStateSolver();
+    ContinuousContactManager::Ptr manager = prob.GetEnv()->getContinuousContactManager();
+    AdjacencyMap::Ptr adjacency_map = std::make_shared<AdjacencyMap>(
+        env_->getSceneGraph(), prob.GetKin()->getActiveLinkNames(), prob.GetEnv()->getCurrentState()->link_transforms);
+
+    manager->setActiveCollisionObjects(adjacency_map->getActiveLinkNames());
+    manager->setDefaultCollisionMarginData(0);
+
+    tesseract_collision::CollisionCheckConfig config;
+    config.type = tesseract_collision::CollisionEvaluatorType::CONTINUOUS;
+    return checkTrajectory(
+        collisions, *manager, *state_solver, prob.GetKin()->getJointNames(), getTraj(x, prob.GetVars()), config);
+  }
+
+  /**
+   * @brief Optimize a problem of constructBoxes, starting from its initial trajectory, and expect the final trajectory
+   * to be collision free
+   * @param setup Changes the optimizer, e.g. its parameters or callbacks, before the optimization
+   * @return The optimized variables
+   */
+  DblVec optimizeBoxes(const TrajOptProb::Ptr& prob,
+                       const std::function<void(sco::BasicTrustRegionSQP&)>& setup = nullptr)
+  {
+    sco::BasicTrustRegionSQP opt(prob);
+    if (plotting)
+      opt.addCallback(PlotCallback(*prob, plotter_));
+    if (setup)
+      setup(opt);
+    opt.initialize(trajToDblVec(prob->GetInitTraj()));
+    opt.optimize();
+
+    if (plotting)
+      plotter_->clear();
+
+    bool found = checkBoxes(*prob, opt.x());
+    EXPECT_FALSE(found);
+    CONSOLE_BRIDGE_logDebug((found) ? ("Final trajectory is in collision") : ("Final trajectory is collision free"));
+    return opt.x();
+  }
 };
 
 TEST_F(CastTest, boxes)  // NOLINT
@@ -105,6 +208,210 @@ TEST_F(CastTest, boxes)  // NOLINT
   CONSOLE_BRIDGE_logDebug((found) ? ("Final trajectory is in collision") : ("Final trajectory is collision free"));
 }
 
+TEST_F(CastTest, boxes_adaptive_subdivision)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("CastTest, boxes_adaptive_subdivision");
+
+  // Skipping the states which cannot be in contact must not change the collision costs, for discrete and casted checks,
+  // but has to save narrow phase checks
+  for (auto evaluator_type : { CollisionEvaluatorType::DISCRETE_CONTINUOUS, CollisionEvaluatorType::CAST_CONTINUOUS })
+  {
+    TrajOptProb::Ptr uniform_prob = constructBoxes([evaluator_type](ProblemConstructionInfo& pci) {
+      getCollisionInfo(pci).evaluator_type = evaluator_type;
+    });
+    TrajOptProb::Ptr adaptive_prob = constructBoxes([evaluator_type](ProblemConstructionInfo& pci) {
+      getCollisionInfo(pci).evaluator_type = evaluator_type;
+      getCollisionInfo(pci).adaptive_subdivision_margin = 0.5;
+    });
+    ASSERT_TRUE(!!uniform_prob);
+    ASSERT_TRUE(!!adaptive_prob);
+    ASSERT_EQ(uniform_prob->getCosts().size(), adaptive_prob->getCosts().size());
+
+    DblVec x = trajToDblVec(uniform_prob->GetInitTraj());
+    for (std::size_t i = 0; i < uniform_prob->getCosts().size(); ++i)
+      EXPECT_NEAR(uniform_prob->getCosts()[i]->value(x), adaptive_prob->getCosts()[i]->value(x), 1e-8);
+
+    long uniform_tests = 0;
+    for (const auto& evaluator : getCollisionEvaluators(*uniform_prob))
+      uniform_tests += evaluator->getNumContactTests();
+    long adaptive_tests = 0;
+    for (const auto& evaluator : getCollisionEvaluators(*adaptive_prob))
+      adaptive_tests += evaluator->getNumContactTests();
+    EXPECT_GT(adaptive_tests, 0);
+    EXPECT_LT(adaptive_tests, uniform_tests);
+  }
+
+  optimizeBoxes(constructBoxes([](ProblemConstructionInfo& pci) {
+    getCollisionInfo(pci).evaluator_type = CollisionEvaluatorType::CAST_CONTINUOUS;
+    getCollisionInfo(pci).adaptive_subdivision_margin = 0.5;
+  }));
+}
+
+TEST_F(CastTest, boxes_incremental_check)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("CastTest, boxes_incremental_check");
+
+  auto incremental = [](ProblemConstructionInfo& pci) {
+    getCollisionInfo(pci).incremental_max_step = 0.05;
+    getCollisionInfo(pci).incremental_validate = true;
+  };
+
+  // Predicting the distances of small steps must not change the collision costs, for discrete and casted checks
+  for (auto evaluator_type : { CollisionEvaluatorType::DISCRETE_CONTINUOUS, CollisionEvaluatorType::CAST_CONTINUOUS })
+  {
+    TrajOptProb::Ptr exact_prob = constructBoxes([evaluator_type](ProblemConstructionInfo& pci) {
+      getCollisionInfo(pci).evaluator_type = evaluator_type;
+    });
+    TrajOptProb::Ptr incremental_prob = constructBoxes([evaluator_type, &incremental](ProblemConstructionInfo& pci) {
+      getCollisionInfo(pci).evaluator_type = evaluator_type;
+      incremental(pci);
+    });
+    ASSERT_TRUE(!!exact_prob);
+    ASSERT_TRUE(!!incremental_prob);
+    ASSERT_EQ(exact_prob->getCosts().size(), incremental_prob->getCosts().size());
+
+    // The first evaluation is the reference of the following one, which only moves the free middle timestep
+    DblVec x = trajToDblVec(exact_prob->GetInitTraj());
+    DblVec x_step = x;
+    x_step[2] += 0.01;
+    x_step[3] -= 0.01;
+    for (std::size_t i = 0; i < exact_prob->getCosts().size(); ++i)
+    {
+      EXPECT_NEAR(exact_prob->getCosts()[i]->value(x), incremental_prob->getCosts()[i]->value(x), 1e-8);
+      EXPECT_NEAR(exact_prob->getCosts()[i]->value(x_step), incremental_prob->getCosts()[i]->value(x_step), 1e-8);
+    }
+  }
+
+  TrajOptProb::Ptr prob = constructBoxes(incremental);
+  ASSERT_TRUE(!!prob);
+  optimizeBoxes(prob);
+
+  // The trial steps close to the solution are predicted, and the validation against the exact checks must not find
+  // contacts which the predictions missed or errors which exceed the safety margin buffer
+  long num_predicted = 0;
+  for (const auto& evaluator : getCollisionEvaluators(*prob))
+  {
+    const IncrementalCollisionStats& stats = evaluator->getIncrementalStats();
+    EXPECT_EQ(stats.num_validated, stats.num_predicted);
+    EXPECT_EQ(stats.num_missed, 0);
+    EXPECT_LT(stats.max_distance_error, evaluator->getSafetyMarginBuffer());
+    num_predicted += stats.num_predicted;
+  }
+  EXPECT_GT(num_predicted, 0);
+}
+
+TEST_F(CastTest, boxes_signed_distance_field)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("CastTest, boxes_signed_distance_field");
+
+  TrajOptProb::Ptr prob = constructBoxes([](ProblemConstructionInfo& pci) {
+    getCollisionInfo(pci).evaluator_type = CollisionEvaluatorType::DISCRETE_CONTINUOUS;
+    getCollisionInfo(pci).sdf_resolution = 0.02;
+  });
+  ASSERT_TRUE(!!prob);
+
+  // The initial trajectory passes through the obstacle, which the fields must report
+  EXPECT_GT(calcCollisionCost(*prob, trajToDblVec(prob->GetInitTraj())), 0);
+
+  DblVec x = optimizeBoxes(prob);
+
+  // Close to the obstacle the distances of the fields match the ones of the contact managers, up to the sampling of the
+  // grid and of the surface of the active link
+  TrajOptProb::Ptr exact_prob = constructBoxes([](ProblemConstructionInfo& pci) {
+    getCollisionInfo(pci).evaluator_type = CollisionEvaluatorType::DISCRETE_CONTINUOUS;
+  });
+  ASSERT_TRUE(!!exact_prob);
+  std::vector<CollisionEvaluator::Ptr> sdf_evaluators = getCollisionEvaluators(*prob);
+  std::vector<CollisionEvaluator::Ptr> exact_evaluators = getCollisionEvaluators(*exact_prob);
+  ASSERT_EQ(sdf_evaluators.size(), exact_evaluators.size());
+
+  auto min_distance = [](const ContactResultVector& results) {
+    double distance = std::numeric_limits<double>::max();
+    for (const auto& res : results)
+      distance = std::min(distance, res.distance);
+    return distance;
+  };
+
+  std::size_t num_pairs = 0;
+  for (std::size_t i = 0; i < sdf_evaluators.size(); ++i)
+  {
+    CollisionCacheData::ConstPtr sdf_results = sdf_evaluators[i]->GetCollisionsCached(x);
+    CollisionCacheData::ConstPtr exact_results = exact_evaluators[i]->GetCollisionsCached(x);
+    EXPECT_EQ(sdf_results->contact_results_map.size(), exact_results->contact_results_map.size());
+    for (const auto& pair : exact_results->contact_results_map)
+    {
+      auto it = sdf_results->contact_results_map.find(pair.first);
+      ASSERT_TRUE(it != sdf_results->contact_results_map.end());
+      EXPECT_NEAR(min_distance(it->second), min_distance(pair.second), 0.05);
+      ++num_pairs;
+    }
+  }
+  EXPECT_GT(num_pairs, 0u);
+}
+
+TEST_F(CastTest, boxes_sphere_approximation)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("CastTest, boxes_sphere_approximation");
+
+  TrajOptProb::Ptr prob = constructBoxes([](ProblemConstructionInfo& pci) {
+    getCollisionInfo(pci).evaluator_type = CollisionEvaluatorType::DISCRETE_CONTINUOUS;
+    getCollisionInfo(pci).sphere_spacing = 0.05;
+    getCollisionInfo(pci).sphere_exact_trust_region_size = 0.5;
+  });
+  ASSERT_TRUE(!!prob);
+
+  // The initial trajectory passes through the obstacle, which the spheres must report
+  EXPECT_GT(calcCollisionCost(*prob, trajToDblVec(prob->GetInitTraj())), 0);
+
+  for (const auto& evaluator : getCollisionEvaluators(*prob))
+  {
+    auto sphere_evaluator = std::dynamic_pointer_cast<DiscreteSphereCollisionEvaluator>(evaluator);
+    ASSERT_TRUE(sphere_evaluator != nullptr);
+    EXPECT_TRUE(sphere_evaluator->getUseApproximation());
+  }
+
+  // Start with a large trust region, any step which is rejected shrinks it below the exact size. The evaluators have
+  // to check the spheres until then or until the optimizer converges, and the exact geometry from then on.
+  double min_trust_box_size = std::numeric_limits<double>::max();
+  auto checkSpheres = [&](double trust_box_size, double exact_trust_region_size) {
+    prob = constructBoxes([exact_trust_region_size](ProblemConstructionInfo& pci) {
+      getCollisionInfo(pci).evaluator_type = CollisionEvaluatorType::DISCRETE_CONTINUOUS;
+      getCollisionInfo(pci).sphere_spacing = 0.05;
+      getCollisionInfo(pci).sphere_exact_trust_region_size = exact_trust_region_size;
+    });
+    ASSERT_TRUE(!!prob);
+    std::vector<DiscreteSphereCollisionEvaluator::Ptr> evaluators;
+    for (const auto& evaluator : getCollisionEvaluators(*prob))
+      evaluators.push_back(std::dynamic_pointer_cast<DiscreteSphereCollisionEvaluator>(evaluator));
+
+    bool exact = false;
+    std::size_t num_costs = 0;
+    optimizeBoxes(prob, [&](sco::BasicTrustRegionSQP& opt) {
+      opt.getParameters().trust_box_size = trust_box_size;
+      opt.addRefinementCallback(CollisionTrustRegionCallback(opt));
+      opt.addRefinementCallback([&](sco::OptProb*, const sco::OptResults&, bool converging) {
+        min_trust_box_size = std::min(min_trust_box_size, opt.getParameters().trust_box_size);
+        exact = exact || converging || min_trust_box_size < exact_trust_region_size;
+        for (const auto& evaluator : evaluators)
+          EXPECT_EQ(evaluator->getUseApproximation(), !exact);
+        return false;
+      });
+      opt.addCallback([&](sco::OptProb*, sco::OptResults& results) { num_costs = results.cost_vals.size(); });
+    });
+
+    // The results after the last callback have to match the costs of the problem
+    EXPECT_TRUE(exact);
+    EXPECT_EQ(num_costs, prob->getCosts().size());
+    for (const auto& evaluator : evaluators)
+      EXPECT_FALSE(evaluator->getUseApproximation());
+  };
+  checkSpheres(1, 0.5);
+  EXPECT_LT(min_trust_box_size, 0.5);
+
+  // If the trust region never gets small enough, the solution is still checked with the exact geometry
+  checkSpheres(1, 0);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -7,6 +7,7 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 #include <tesseract_environment/ofkt/ofkt_state_solver.h>
 #include <tesseract_environment/core/utils.h>
 #include <tesseract_scene_graph/utils.h>
+#include <thread>
 TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt/common.hpp>
@@ -130,6 +131,72 @@ TEST_F(KinematicCostsTest, CartPoseJacCalculator)  // NOLINT
 
 ////////////////////////////////////////////////////////////////////
 
+TEST_F(KinematicCostsTest, KinematicsCache)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("KinematicCostsTest, KinematicsCache");
+
+  auto kin = env_->getManipulatorManager()->getFwdKinematicSolver("right_arm");
+  auto world_to_base = env_->getCurrentState()->link_transforms.at(kin->getBaseLinkName());
+  auto adjacency_map = std::make_shared<tesseract_environment::AdjacencyMap>(
+      env_->getSceneGraph(), kin->getActiveLinkNames(), env_->getCurrentState()->link_transforms);
+
+  std::string link = "r_gripper_tool_frame";
+  Eigen::Isometry3d input_pose = env_->getCurrentState()->link_transforms.at(link);
+  Eigen::Isometry3d tcp = Eigen::Isometry3d::Identity();
+  Eigen::VectorXi indices = Eigen::Matrix<int, 1, 6>(std::vector<int>({ 0, 1, 2, 3, 4, 5 }).data());
+
+  Eigen::VectorXd values(7);
+  values << -1.1, 1.2, -3.3, -1.4, 5.5, -1.6, 7.7;
+
+  // The error and jacobian calculators of a term share the pose at the same joint values
+  auto cache = std::make_shared<KinematicsCache>(kin);
+  CartPoseErrCalculator f(input_pose, kin, adjacency_map, world_to_base, link, tcp, indices, cache);
+  CartPoseJacCalculator dfdx(input_pose, kin, adjacency_map, world_to_base, link, tcp, indices, cache);
+  CartPoseErrCalculator uncached_f(input_pose, kin, adjacency_map, world_to_base, link, tcp);
+  CartPoseJacCalculator uncached_dfdx(input_pose, kin, adjacency_map, world_to_base, link, tcp);
+
+  EXPECT_TRUE(f(values).isApprox(uncached_f(values)));
+  EXPECT_TRUE(dfdx(values).isApprox(uncached_dfdx(values)));
+  EXPECT_EQ(cache->getNumFwdKinMisses(), 1);
+  EXPECT_EQ(cache->getNumFwdKinHits(), 1);
+  EXPECT_EQ(cache->getNumJacobianMisses(), 1);
+
+  dfdx(values);
+  EXPECT_EQ(cache->getNumFwdKinHits(), 2);
+  EXPECT_EQ(cache->getNumJacobianHits(), 1);
+
+  // Other joint values are computed again
+  values(0) += 1e-12;
+  EXPECT_TRUE(f(values).isApprox(uncached_f(values)));
+  EXPECT_EQ(cache->getNumFwdKinMisses(), 2);
+
+  cache->setCapacity(0);
+  f(values);
+  EXPECT_EQ(cache->getNumFwdKinHits(), 2);
+  EXPECT_EQ(cache->getNumFwdKinMisses(), 2);
+
+  // Terms of several threads may share the cache, the kinematics are calculated with a clone per thread
+  cache->setCapacity(16);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+  {
+    Eigen::VectorXd thread_values = values;
+    thread_values(1) += 0.1 * i;
+    Eigen::VectorXd expected_err = uncached_f(thread_values);
+    Eigen::MatrixXd expected_jac = uncached_dfdx(thread_values);
+    threads.emplace_back([&f, &dfdx, thread_values, expected_err, expected_jac]() {
+      for (int j = 0; j < 100; ++j)
+      {
+        EXPECT_TRUE(f(thread_values).isApprox(expected_err));
+        EXPECT_TRUE(dfdx(thread_values).isApprox(expected_jac));
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  EXPECT_EQ(cache->getNumFwdKinMisses(), 6);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
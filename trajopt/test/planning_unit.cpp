@@ -10,9 +10,11 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 #include <tesseract_scene_graph/utils.h>
 TRAJOPT_IGNORE_WARNINGS_POP
 
+#include <trajopt/collision_terms.hpp>
 #include <trajopt/common.hpp>
 #include <trajopt/plot_callback.hpp>
 #include <trajopt/problem_description.hpp>
+#include <trajopt/trajectory_costs.hpp>
 #include <trajopt_sco/optimizers.hpp>
 #include <trajopt_test_utils.hpp>
 #include <trajopt_utils/clock.hpp>
@@ -176,6 +178,11 @@ TEST_F(PlanningTest, arm_around_table)  // NOLINT
   EXPECT_TRUE(status == sco::OptStatus::OPT_CONVERGED);
   CONSOLE_BRIDGE_logDebug("planning time: %.3f", GetClock() - tStart);
 
+  // All collision terms are evaluated on the same thread, so they share a single contact manager and state solver
+  ContactManagerPool::Ptr pool = prob->GetContactManagerPool();
+  EXPECT_EQ(pool->getNumDiscreteManagers() + pool->getNumContinuousManagers(), 1);
+  EXPECT_LE(pool->getNumStateSolvers(), 1);
+
   double d = 0;
   TrajArray traj = getTraj(opt.x(), prob->GetVars());
   for (unsigned i = 1; i < traj.rows(); ++i)
@@ -200,6 +207,112 @@ TEST_F(PlanningTest, arm_around_table)  // NOLINT
   CONSOLE_BRIDGE_logDebug((found) ? ("Final trajectory is in collision") : ("Final trajectory is collision free"));
 }
 
+TEST_F(PlanningTest, arm_around_table_batched_collision)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("PlanningTest, arm_around_table_batched_collision");
+
+  Json::Value root = readJsonFile(std::string(TRAJOPT_DIR) + "/test/data/config/arm_around_table.json");
+
+  std::unordered_map<std::string, double> ipos;
+  ipos["torso_lift_joint"] = 0;
+  ipos["r_shoulder_pan_joint"] = -1.832;
+  ipos["r_shoulder_lift_joint"] = -0.332;
+  ipos["r_upper_arm_roll_joint"] = -1.011;
+  ipos["r_elbow_flex_joint"] = -1.437;
+  ipos["r_forearm_roll_joint"] = -1.1;
+  ipos["r_wrist_flex_joint"] = -1.926;
+  ipos["r_wrist_roll_joint"] = 3.074;
+  env_->setState(ipos);
+
+  ProblemConstructionInfo pci(env_);
+  pci.fromJson(root);
+  pci.basic_info.convex_solver = sco::ModelType::OSQP;
+  TrajOptProb::Ptr prob = ConstructProblem(pci);
+  ASSERT_TRUE(!!prob);
+
+  root["costs"][0]["params"]["batched"] = true;
+  root["costs"][0]["params"]["batch_threads"] = 2;
+  ProblemConstructionInfo batched_pci(env_);
+  batched_pci.fromJson(root);
+  batched_pci.basic_info.convex_solver = sco::ModelType::OSQP;
+  TrajOptProb::Ptr batched_prob = ConstructProblem(batched_pci);
+  ASSERT_TRUE(!!batched_prob);
+
+  // The five continuous terms between the six steps are replaced by a single one
+  std::vector<sco::Cost::Ptr> costs, batched_costs;
+  for (const sco::Cost::Ptr& cost : prob->getCosts())
+    if (std::dynamic_pointer_cast<CollisionCost>(cost))
+      costs.push_back(cost);
+  for (const sco::Cost::Ptr& cost : batched_prob->getCosts())
+    if (std::dynamic_pointer_cast<TrajectoryCollisionCost>(cost))
+      batched_costs.push_back(cost);
+  ASSERT_EQ(costs.size(), 5);
+  ASSERT_EQ(batched_costs.size(), 1);
+  EXPECT_EQ(batched_prob->getCosts().size() + costs.size() - 1, prob->getCosts().size());
+
+  // Both formulations give the same cost
+  DblVec x = trajToDblVec(prob->GetInitTraj());
+  double value = 0;
+  for (const sco::Cost::Ptr& cost : costs)
+    value += cost->value(x);
+  EXPECT_GT(value, 0);
+  EXPECT_NEAR(batched_costs[0]->value(x), value, 1e-8);
+
+  sco::BasicTrustRegionSQP opt(batched_prob);
+  opt.initialize(x);
+  sco::OptStatus status = opt.optimize();
+  EXPECT_TRUE(status == sco::OptStatus::OPT_CONVERGED);
+
+  std::vector<ContactResultMap> collisions;
+  tesseract_environment::StateSolver::Ptr state_solver = prob->GetEnv()->getStateSolver();
+  ContinuousContactManager::Ptr manager = prob->GetEnv()->getContinuousContactManager();
+  AdjacencyMap::Ptr adjacency_map = std::make_shared<AdjacencyMap>(
+      env_->getSceneGraph(), prob->GetKin()->getActiveLinkNames(), prob->GetEnv()->getCurrentState()->link_transforms);
+
+  manager->setActiveCollisionObjects(adjacency_map->getActiveLinkNames());
+  manager->setDefaultCollisionMarginData(0);
+
+  tesseract_collision::CollisionCheckConfig config;
+  config.type = tesseract_collision::CollisionEvaluatorType::CONTINUOUS;
+  config.longest_valid_segment_length = LONGEST_VALID_SEGMENT_LENGTH;
+  bool found = checkTrajectory(collisions,
+                               *manager,
+                               *state_solver,
+                               prob->GetKin()->getJointNames(),
+                               getTraj(opt.x(), batched_prob->GetVars()),
+                               config);
+  EXPECT_FALSE(found);
+}
+
+TEST_F(PlanningTest, arm_around_table_threads)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("PlanningTest, arm_around_table_threads");
+
+  Json::Value root = readJsonFile(std::string(TRAJOPT_DIR) + "/test/data/config/arm_around_table.json");
+  root["basic_info"]["convexify_threads"] = 2;
+  root["basic_info"]["evaluate_threads"] = 3;
+
+  ProblemConstructionInfo pci(env_);
+  pci.fromJson(root);
+  EXPECT_EQ(pci.basic_info.convexify_threads, 2);
+  EXPECT_EQ(pci.basic_info.evaluate_threads, 3);
+  pci.basic_info.convex_solver = sco::ModelType::OSQP;
+  TrajOptProb::Ptr prob = ConstructProblem(pci);
+  ASSERT_TRUE(!!prob);
+  EXPECT_EQ(prob->GetConvexifyThreads(), 2);
+  EXPECT_EQ(prob->GetEvaluateThreads(), 3);
+
+  // The collision terms share the kinematics cache and the contact manager pool, which are safe to use concurrently
+  for (const sco::Cost::Ptr& cost : prob->getCosts())
+  {
+    if (std::dynamic_pointer_cast<CollisionCost>(cost) || std::dynamic_pointer_cast<JointVelEqCost>(cost))
+      EXPECT_TRUE(cost->isThreadSafe());
+  }
+
+  TrajOptResult::Ptr result = OptimizeProblem(prob);
+  EXPECT_EQ(result->status, sco::OptStatus::OPT_CONVERGED);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,131 @@
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <cmath>
+#include <gtest/gtest.h>
+#include <tesseract_environment/core/environment.h>
+#include <tesseract_environment/ofkt/ofkt_state_solver.h>
+#include <tesseract_scene_graph/utils.h>
+#include <vector>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt/signed_distance_field.hpp>
+#include <trajopt_test_utils.hpp>
+#include <trajopt_utils/logging.hpp>
+
+using namespace trajopt;
+using namespace std;
+using namespace util;
+using namespace tesseract_environment;
+using namespace tesseract_scene_graph;
+using namespace tesseract_geometry;
+
+class SignedDistanceFieldTest : public testing::Test
+{
+public:
+  Environment::Ptr env_ = std::make_shared<Environment>(); /**< Tesseract */
+
+  /** @brief The center and radius of the sphere */
+  const Eigen::Vector3d sphere_center_{ 0, 0, 2 };
+  const double sphere_radius_{ 0.25 };
+
+  /** @brief The center and half extents of the box */
+  const Eigen::Vector3d box_center_{ 1.5, 0, 2 };
+  const Eigen::Vector3d box_half_{ 0.2, 0.3, 0.4 };
+
+  void SetUp() override
+  {
+    boost::filesystem::path urdf_file(std::string(TRAJOPT_DIR) + "/test/data/boxbot.urdf");
+    boost::filesystem::path srdf_file(std::string(TRAJOPT_DIR) + "/test/data/boxbot.srdf");
+
+    ResourceLocator::Ptr locator = std::make_shared<SimpleResourceLocator>(locateResource);
+    EXPECT_TRUE(env_->init<OFKTStateSolver>(urdf_file, srdf_file, locator));
+
+    gLogLevel = util::LevelError;
+
+    addLink("sdf_sphere", std::make_shared<Sphere>(sphere_radius_), sphere_center_);
+    addLink("sdf_box", std::make_shared<Box>(2 * box_half_.x(), 2 * box_half_.y(), 2 * box_half_.z()), box_center_);
+  }
+
+  /** @brief Add a link with the given collision geometry, fixed to the base link at the given position */
+  void addLink(const std::string& name, const Geometry::Ptr& geometry, const Eigen::Vector3d& position)
+  {
+    auto collision = std::make_shared<Collision>();
+    collision->geometry = geometry;
+    collision->origin = Eigen::Isometry3d::Identity();
+
+    Link link(name);
+    link.collision.push_back(collision);
+
+    Joint joint(name + "-base_link");
+    joint.type = JointType::FIXED;
+    joint.parent_link_name = "base_link";
+    joint.child_link_name = name;
+    joint.parent_to_joint_origin_transform.translation() = position;
+
+    env_->addLink(link, joint);
+  }
+};
+
+TEST_F(SignedDistanceFieldTest, calcDistance)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("SignedDistanceFieldTest, calcDistance");
+
+  const double resolution = 0.02;
+  SignedDistanceField sdf(*env_, { "sdf_sphere", "sdf_box" }, resolution, 0.5);
+  ASSERT_TRUE(sdf.isValid());
+
+  // Points outside and inside of the sphere, its distance and gradient are known along every direction
+  Eigen::Vector3d direction = Eigen::Vector3d(0.6, 0, 0.8);
+  for (double radius : { 0.4, 0.15 })
+  {
+    Eigen::Vector3d gradient;
+    std::size_t link_index = 2;
+    double distance = sdf.calcDistance(sphere_center_ + radius * direction, gradient, link_index);
+    EXPECT_NEAR(distance, radius - sphere_radius_, 0.5 * resolution);
+    EXPECT_TRUE(gradient.isApprox(direction, 0.1));
+    EXPECT_EQ(link_index, 0u);
+  }
+
+  // Points in front of a face of the box, outside and inside, and in front of an edge
+  struct BoxPoint
+  {
+    Eigen::Vector3d offset;
+    double distance;
+    Eigen::Vector3d gradient;
+  };
+  std::vector<BoxPoint> box_points{ { Eigen::Vector3d(0.35, 0.05, -0.1), 0.15, Eigen::Vector3d::UnitX() },
+                                    { Eigen::Vector3d(0.15, 0.05, -0.1), -0.05, Eigen::Vector3d::UnitX() },
+                                    { Eigen::Vector3d(0.3, 0.4, 0),
+                                      std::sqrt(0.02),
+                                      Eigen::Vector3d(std::sqrt(0.5), std::sqrt(0.5), 0) } };
+  for (const BoxPoint& point : box_points)
+  {
+    Eigen::Vector3d gradient;
+    std::size_t link_index = 2;
+    double distance = sdf.calcDistance(box_center_ + point.offset, gradient, link_index);
+    EXPECT_NEAR(distance, point.distance, 0.5 * resolution);
+    EXPECT_TRUE(gradient.isApprox(point.gradient, 0.1));
+    EXPECT_EQ(link_index, 1u);
+  }
+
+  // Points outside of the grid are reported at the largest distance
+  Eigen::Vector3d gradient;
+  std::size_t link_index = 2;
+  EXPECT_EQ(sdf.calcDistance(Eigen::Vector3d(10, 10, 10), gradient, link_index), sdf.getMaxDistance());
+  EXPECT_TRUE(gradient.isZero());
+}
+
+TEST_F(SignedDistanceFieldTest, maxCells)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("SignedDistanceFieldTest, maxCells");
+
+  // The grid of the box needs 73 points along x, so the field cannot be built with a limit of 1000
+  EXPECT_TRUE(SignedDistanceField(*env_, { "sdf_box" }, 0.02, 0.5).isValid());
+  EXPECT_FALSE(SignedDistanceField(*env_, { "sdf_box" }, 0.02, 0.5, 1000).isValid());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -38,6 +38,7 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt/utils.hpp>
+#include <trajopt_ifopt/utils/evaluation_cache.h>
 #include <trajopt_ifopt/variable_sets/joint_position_variable.h>
 
 namespace trajopt
@@ -147,6 +148,18 @@ public:
    */
   Eigen::Isometry3d GetCurrentPose() const;
 
+  /**
+   * @brief The values memoized by GetValues() at the current variable values. Its counters show how often they were
+   * reused.
+   */
+  const EvaluationCache<Eigen::VectorXd>& GetValuesCache() const { return values_cache_; }
+
+  /**
+   * @brief The jacobian block memoized by FillJacobianBlock() at the current variable values. Its counters show how
+   * often it was reused.
+   */
+  const EvaluationCache<Jacobian>& GetJacobianCache() const { return jacobian_cache_; }
+
   /** @brief If true, numeric differentiation will be used. Default: true
    *
    * Note: While the logic for using the jacobian from KDL will be used if set to false, this has been buggy. Set this
@@ -172,6 +185,13 @@ private:
   Eigen::Isometry3d target_pose_inv_;
   /** @brief The kinematic information used when calculating error */
   CartPosKinematicInfo::ConstPtr kinematic_info_;
+
+  /** @brief The values at the current variable values */
+  mutable EvaluationCache<Eigen::VectorXd> values_cache_;
+  /** @brief The jacobian block at the current variable values */
+  mutable EvaluationCache<Jacobian> jacobian_cache_;
+  /** @brief The value of use_numeric_differentiation the jacobian block in jacobian_cache_ was computed with */
+  mutable bool jacobian_cache_numeric_{ true };
 };
 };  // namespace trajopt
 #endif
@@ -34,10 +34,31 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt_ifopt/constraints/collision_evaluators.h>
+#include <trajopt_ifopt/utils/evaluation_cache.h>
 #include <trajopt_ifopt/variable_sets/joint_position_variable.h>
 
 namespace trajopt
 {
+/**
+ * @brief The errors of the link pairs in contact at a joint state.
+ *
+ * The values and the jacobian of the collision constraints are computed from the same terms, so the contacts are only
+ * checked once per joint state.
+ */
+struct CollisionTerms
+{
+  /** @brief The contacts the terms are computed from, shared with the cache of the collision evaluator */
+  CollisionCacheData::ConstPtr collisions;
+  /** @brief The link pairs in contact, ordered by decreasing error */
+  std::vector<tesseract_collision::ContactResultMap::key_type> link_pairs;
+  /** @brief The error of each link pair, i.e. the sum of max((margin - distance) * coeff, 0) over its contacts */
+  Eigen::VectorXd errors;
+};
+
+/**
+ * @brief Constrains the sum of the collision errors of all link pairs of a JointPosition. The constraint has a single
+ * row.
+ */
 class CollisionConstraintIfopt : public ifopt::ConstraintSet
 {
 public:
@@ -80,6 +101,18 @@ public:
    */
   void FillJacobianBlock(std::string var_set, Jacobian& jac_block) const override;
 
+  /**
+   * @brief The collision terms memoized at the current variable values. They are shared by GetValues() and
+   * FillJacobianBlock(), its counters show how often they were reused.
+   */
+  const EvaluationCache<CollisionTerms>& GetTermsCache() const { return terms_cache_; }
+
+  /**
+   * @brief The jacobian block memoized by FillJacobianBlock() at the current variable values. Its counters show how
+   * often it was reused.
+   */
+  const EvaluationCache<Jacobian>& GetJacobianCache() const { return jacobian_cache_; }
+
 private:
   /** @brief The number of joints in a single JointPosition */
   long n_dof_;
@@ -93,6 +126,122 @@ private:
   JointPosition::ConstPtr position_var_;
 
   DiscreteCollisionEvaluator::Ptr collision_evaluator_;
+
+  /** @brief The collision terms at the current variable values */
+  mutable EvaluationCache<CollisionTerms> terms_cache_;
+  /** @brief The jacobian block at the current variable values */
+  mutable EvaluationCache<Jacobian> jacobian_cache_;
+
+  /** @brief The collision terms at the current variable values, computed if the variables changed */
+  const CollisionTerms& GetCurrentTerms() const;
+};
+
+/**
+ * @brief Constrains the collision error of every link pair of a JointPosition separately, one row per link pair.
+ *
+ * Unlike CollisionConstraintIfopt, a solver sees which link pairs are in collision and can weigh and linearize each of
+ * them on its own. The number of rows is fixed, so a link pair keeps its row as long as it is in contact, which keeps
+ * the rows comparable between iterations. The rows of link pairs which are no longer in contact are freed and new link
+ * pairs fill the free rows in order of decreasing error. Rows without a link pair are zero. If more link pairs are in
+ * contact than there are free rows, the new ones with the smallest errors are dropped.
+ */
+class LinkPairCollisionConstraintIfopt : public ifopt::ConstraintSet
+{
+public:
+  using Ptr = std::shared_ptr<LinkPairCollisionConstraintIfopt>;
+  using ConstPtr = std::shared_ptr<const LinkPairCollisionConstraintIfopt>;
+
+  /**
+   * @param collision_evaluator The collision evaluator of the link pairs
+   * @param position_var The joint position which is checked
+   * @param max_num_pairs The number of rows, i.e. the largest number of link pairs which is constrained
+   * @param name The name of the constraint
+   */
+  LinkPairCollisionConstraintIfopt(DiscreteCollisionEvaluator::Ptr collision_evaluator,
+                                   JointPosition::ConstPtr position_var,
+                                   int max_num_pairs,
+                                   const std::string& name = "LinkPairCollision");
+
+  /**
+   * @brief Calculates the values associated with the constraint. The link pairs are assigned to the rows starting from
+   * the current assignment, which is not changed.
+   */
+  Eigen::VectorXd CalcValues(const Eigen::Ref<const Eigen::VectorXd>& joint_vals) const;
+  /**
+   * @brief Returns the values associated with the constraint.
+   * @return The error of the link pair assigned to each row
+   */
+  Eigen::VectorXd GetValues() const override;
+
+  /**
+   * @brief  Returns the "bounds" of this constraint. How these are enforced is up to the solver
+   * @return Returns the "bounds" of this constraint
+   */
+  std::vector<ifopt::Bounds> GetBounds() const override;
+
+  /**
+   * @brief Sets the bounds on the collision errors
+   * @param bounds New bounds that will be set. Should be the size of max_num_pairs
+   */
+  void SetBounds(const std::vector<ifopt::Bounds>& bounds);
+
+  /**
+   * @brief Fills the jacobian block associated with the constraint. The link pairs are assigned to the rows like in
+   * CalcValues().
+   * @param jac_block Block of the overall jacobian associated with these constraints
+   */
+  void CalcJacobianBlock(const Eigen::Ref<const Eigen::VectorXd>& joint_vals, Jacobian& jac_block) const;
+  /**
+   * @brief Fills the jacobian block associated with the given var_set.
+   * @param var_set Name of the var_set to which the jac_block is associated
+   * @param jac_block Block of the overall jacobian associated with these constraints and the var_set variable
+   */
+  void FillJacobianBlock(std::string var_set, Jacobian& jac_block) const override;
+
+  /**
+   * @brief The link pairs assigned to the rows at the current variable values
+   * @return The link pair of each row, a pair of empty link names for the free rows
+   */
+  std::vector<tesseract_collision::ContactResultMap::key_type> GetLinkPairs() const;
+
+  /**
+   * @brief The collision terms memoized at the current variable values. They are shared by GetValues() and
+   * FillJacobianBlock(), its counters show how often they were reused.
+   */
+  const EvaluationCache<CollisionTerms>& GetTermsCache() const { return terms_cache_; }
+
+  /**
+   * @brief The jacobian block memoized by FillJacobianBlock() at the current variable values. Its counters show how
+   * often it was reused.
+   */
+  const EvaluationCache<Jacobian>& GetJacobianCache() const { return jacobian_cache_; }
+
+private:
+  /** @brief The number of joints in a single JointPosition */
+  long n_dof_;
+
+  /** @brief Bounds on the constraint values. Default: std::vector<Bounds>(max_num_pairs, ifopt::BoundSmallerZero) */
+  std::vector<ifopt::Bounds> bounds_;
+
+  /** @brief Pointers to the vars used by this constraint.
+   *
+   * Do not access them directly. Instead use this->GetVariables()->GetComponent(position_var->GetName())->GetValues()*/
+  JointPosition::ConstPtr position_var_;
+
+  DiscreteCollisionEvaluator::Ptr collision_evaluator_;
+
+  /** @brief The collision terms at the current variable values */
+  mutable EvaluationCache<CollisionTerms> terms_cache_;
+  /** @brief The jacobian block at the current variable values */
+  mutable EvaluationCache<Jacobian> jacobian_cache_;
+  /** @brief The link pair assigned to each row, updated with the terms. Free rows have empty link names. */
+  mutable std::vector<tesseract_collision::ContactResultMap::key_type> row_link_pairs_;
+
+  /**
+   * @brief The collision terms at the current variable values, computed if the variables changed. Computing them
+   * reassigns the rows.
+   */
+  const CollisionTerms& GetCurrentTerms() const;
 };
 };  // namespace trajopt
 #endif
@@ -38,6 +38,7 @@ TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt_ifopt/variable_sets/joint_position_variable.h>
 #include <trajopt/cache.hxx>
+#include <trajopt/link_motion_bounds.hpp>
 
 namespace trajopt
 {
@@ -152,6 +153,14 @@ struct TrajOptCollisionConfig : public tesseract_collision::CollisionCheckConfig
   /** @brief Additional collision margin that is added for the collision check but is not used when calculating the
    * error */
   double collision_margin_buffer{ 0 };
+
+  /**
+   * @brief If greater than zero, the interpolated states of the longest valid segment checks are checked adaptively.
+   * The clearance up to this distance beyond the collision margin is measured, and together with bounds on the motion
+   * of the active links the states which provably cannot be in contact are skipped. The contact results are the same.
+   * It is not used with ContactTestType::FIRST, since contacts beyond the margin could hide the ones of interest.
+   */
+  double adaptive_subdivision_margin{ 0 };
 };
 
 /** @brief A data structure to contain a links gradient results */
@@ -183,6 +192,19 @@ struct GradientResults
   const Eigen::Vector2d& data;
 };
 
+/** @brief The contact results of a single collision check, shared between the cache and its users */
+struct CollisionCacheData
+{
+  using Ptr = std::shared_ptr<CollisionCacheData>;
+  using ConstPtr = std::shared_ptr<const CollisionCacheData>;
+
+  tesseract_collision::ContactResultMap contact_results_map;
+  tesseract_collision::ContactResultVector contact_results_vector;
+};
+
+/** @brief Collision results keyed by the joint values of a collision evaluator */
+using CollisionCache = LRUCache<std::vector<double>, CollisionCacheData, RangeHash<std::vector<double>>>;
+
 /**
  * @brief Base class for collision evaluators containing function that are commonly used between them.
  *
@@ -233,6 +255,14 @@ struct CollisionEvaluator
                       tesseract_collision::ContactResultMap& dist_map,
                       tesseract_collision::ContactResultVector& dist_vector);
 
+  /**
+   * @brief This function checks to see if results are cached for input variable x. If not it calls CalcCollisions and
+   * caches the results with x as the key.
+   * @param x Joint values. For contact managers that use more than one state, the states should be appended
+   * @return Shared handle to the cached results, which must not be modified
+   */
+  CollisionCacheData::ConstPtr GetCollisionsCached(const std::vector<double>& x);
+
   /**
    * @brief This function checks to see if results are cached for input variable x. If not it calls CalcCollisions and
    * caches the results vector with x as the key.
@@ -302,7 +332,8 @@ struct CollisionEvaluator
    * @return Safety margin information
    */
   TrajOptCollisionConfig& getCollisionConfig() { return collision_config_; }
-  Cache<size_t, std::pair<tesseract_collision::ContactResultMap, tesseract_collision::ContactResultVector>, 10> m_cache;
+  /** @brief Collision results of the most recently used joint values, see GetCollisionsCached */
+  CollisionCache m_cache;
 
 protected:
   tesseract_kinematics::ForwardKinematics::ConstPtr manip_;
@@ -316,6 +347,43 @@ protected:
                                                      const Eigen::Ref<const Eigen::VectorXd>& joint_values)>
       get_state_fn_;
   bool dynamic_environment_;
+  /** @brief The kinematic links of manip_ which the active links are attached to */
+  std::vector<std::string> active_kin_links_;
+  /** @brief For each active link the index of its kinematic link in active_kin_links_ */
+  std::vector<std::size_t> active_link_kin_index_;
+  /** @brief For each active link its transform relative to its kinematic link */
+  tesseract_common::VectorIsometry3d active_link_offsets_;
+  /** @brief The indices of the active links ordered by their kinematic link */
+  std::vector<std::size_t> active_link_order_;
+  /** @brief Indicates if the active link transforms are calculated from manip_ rather than by state_solver_ */
+  bool use_active_link_kinematics_{ false };
+  /** @brief Bounds on the motion of the active links, only set if the adaptive subdivision is used */
+  LinkMotionBounds::ConstPtr motion_bounds_;
+
+  /**
+   * @brief Calculate the world transforms of the active links in the state of state_solver_
+   *
+   * Only the forward kinematics of the kinematic links the active links are attached to are calculated, each of them
+   * once, instead of the state of the whole environment. The results are written into link_transforms so its memory
+   * can be reused for all states of a collision check.
+   * @param joint_values The joint values of manip_
+   * @param link_transforms The returned transforms, in the order of adjacency_map_->getActiveLinkNames()
+   */
+  void CalcActiveLinkTransforms(const Eigen::Ref<const Eigen::VectorXd>& joint_values,
+                                tesseract_common::VectorIsometry3d& link_transforms) const;
+
+  /** @brief Indicates if segments are subdivided adaptively, see TrajOptCollisionConfig::adaptive_subdivision_margin */
+  bool useAdaptiveSubdivision() const { return motion_bounds_ != nullptr; }
+
+  /** @brief The collision margin data to apply to the contact managers */
+  tesseract_collision::CollisionMarginData getContactManagerMarginData() const;
+
+  /**
+   * @brief Remove the contacts which are only reported because of the adaptive subdivision margin
+   * @param contacts The results of a check with the adaptive subdivision margin
+   * @return Lower bound on how much closer any link pair may get before it is reported, at most the margin
+   */
+  double removeAdaptiveSubdivisionContacts(tesseract_collision::ContactResultMap& contacts) const;
 
   /**
    * @brief This takes contacts results at each interpolated timestep and creates a single contact results map.
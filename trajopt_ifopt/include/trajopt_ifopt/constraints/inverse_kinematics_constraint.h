@@ -37,6 +37,7 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt/utils.hpp>
+#include <trajopt_ifopt/utils/evaluation_cache.h>
 #include <trajopt_ifopt/variable_sets/joint_position_variable.h>
 
 namespace trajopt
@@ -157,6 +158,12 @@ public:
    */
   const InverseKinematicsInfo::ConstPtr& getKinematicInfo() { return kinematic_info_; }
 
+  /**
+   * @brief The values memoized by GetValues() at the current variable values. Its counters show how often the IK
+   * solution was reused. The jacobian is constant and therefore not memoized.
+   */
+  const EvaluationCache<Eigen::VectorXd>& GetValuesCache() const { return values_cache_; }
+
 private:
   /** @brief The number of joints in a single JointPosition */
   long n_dof_;
@@ -175,6 +182,9 @@ private:
   Eigen::Isometry3d target_pose_;
   /** @brief The kinematic info used to create this constraint */
   InverseKinematicsInfo::ConstPtr kinematic_info_;
+
+  /** @brief The values at the current values of the constraint and seed variables */
+  mutable EvaluationCache<Eigen::VectorXd> values_cache_;
 };
 };  // namespace trajopt
 #endif
@@ -32,6 +32,7 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 #include <Eigen/Eigen>
 TRAJOPT_IGNORE_WARNINGS_POP
 
+#include <trajopt_ifopt/utils/evaluation_cache.h>
 #include <trajopt_ifopt/variable_sets/joint_position_variable.h>
 
 namespace trajopt
@@ -88,6 +89,12 @@ public:
    */
   void FillJacobianBlock(std::string var_set, Jacobian& jac_block) const override;
 
+  /**
+   * @brief The values memoized by GetValues() at the current variable values. Its counters show how often they were
+   * reused. The jacobian is constant and therefore not memoized.
+   */
+  const EvaluationCache<Eigen::VectorXd>& GetValuesCache() const { return values_cache_; }
+
 private:
   /** @brief The number of joints in a single JointPosition */
   long n_dof_;
@@ -101,6 +108,9 @@ private:
    *
    * Do not access them directly. Instead use this->GetVariables()->GetComponent(position_var->GetName())->GetValues()*/
   std::vector<JointPosition::ConstPtr> position_vars_;
+
+  /** @brief The values at the current variable values */
+  mutable EvaluationCache<Eigen::VectorXd> values_cache_;
 };
 };  // namespace trajopt
 #endif
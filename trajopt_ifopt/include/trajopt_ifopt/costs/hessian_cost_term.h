@@ -0,0 +1,79 @@
+/**
+ * @file hessian_cost_term.h
+ * @brief A cost that also provides its hessian
+ *
+ * @author Levi Armstrong
+ * @date Dec 1, 2020
+ * @version TODO
+ * @bug No known bugs
+ *
+ * @copyright Copyright (c) 2020, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TRAJOPT_IFOPT_HESSIAN_COST_TERM_H
+#define TRAJOPT_IFOPT_HESSIAN_COST_TERM_H
+
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <ifopt/cost_term.h>
+
+#include <Eigen/Eigen>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+namespace trajopt
+{
+/**
+ * @brief A cost that provides a quadratic model in addition to its gradient
+ *
+ * IFOPT costs only provide a value and a gradient, so a SQP has to model them linearly and relies on the trust region
+ * alone to limit the step. Costs derived from this class also provide their hessian, which trajopt_sqp adds to the
+ * hessian of the QP.
+ *
+ * The hessian has to be positive semidefinite, since the QP has to be convex. Costs with an indefinite hessian should
+ * return a positive semidefinite approximation of it, e.g. the Gauss-Newton approximation of a least squares cost.
+ *
+ * Derived classes fill the blocks of the hessian associated with pairs of variable sets, analogous to
+ * FillJacobianBlock. Costs which can compute the whole hessian more efficiently may override GetHessian instead.
+ */
+class HessianCostTerm : public ifopt::CostTerm
+{
+public:
+  using Ptr = std::shared_ptr<HessianCostTerm>;
+  using ConstPtr = std::shared_ptr<const HessianCostTerm>;
+
+  /** @brief The hessian of the cost. Its size is n_vars x n_vars */
+  using Hessian = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+
+  HessianCostTerm(const std::string& name);
+
+  /**
+   * @brief Returns the hessian of the cost with respect to all variables. By default it is assembled from the blocks of
+   * FillHessianBlock.
+   * @return The symmetric positive semidefinite hessian (n_vars x n_vars)
+   */
+  virtual Hessian GetHessian() const;
+
+  /**
+   * @brief Fills the block of the hessian associated with a pair of variable sets
+   * @param row_var_set Name of the var_set associated with the rows of the block
+   * @param col_var_set Name of the var_set associated with the columns of the block
+   * @param hessian_block Block of the hessian, already sized to the variable sets
+   */
+  virtual void FillHessianBlock(std::string row_var_set, std::string col_var_set, Hessian& hessian_block) const = 0;
+};
+
+}  // namespace trajopt
+#endif
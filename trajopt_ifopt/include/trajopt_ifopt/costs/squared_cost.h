@@ -33,6 +33,8 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 #include <Eigen/Eigen>
 TRAJOPT_IGNORE_WARNINGS_POP
 
+#include <trajopt_ifopt/costs/hessian_cost_term.h>
+
 namespace trajopt
 {
 /**
@@ -70,8 +72,13 @@ namespace trajopt
  *
  *     dcost(x)/dx = 2 * error.transpose() * W * J(x)
  *
+ * The hessian is approximated with the Gauss-Newton approximation, which drops the second derivatives of g(x)
+ *
+ *     d^2cost(x)/dx^2 ~= 2 * J(x).transpose() * W * J(x)
+ *
+ * It is positive semidefinite as long as the weights are not negative.
  */
-class SquaredCost : public ifopt::CostTerm
+class SquaredCost : public HessianCostTerm
 {
 public:
   using Ptr = std::shared_ptr<SquaredCost>;
@@ -93,6 +100,10 @@ public:
 
   void FillJacobianBlock(std::string var_set, Jacobian& jac_block) const override;
 
+  Hessian GetHessian() const override;
+
+  void FillHessianBlock(std::string row_var_set, std::string col_var_set, Hessian& hessian_block) const override;
+
 private:
   /** @brief Constraint being converted to a cost */
   std::shared_ptr<const ConstraintSet> constraint_;
@@ -103,6 +114,9 @@ private:
   Eigen::VectorXd weights_;
   /** @brief Vector of targets. By default these are the average of the constraint bounds */
   Eigen::VectorXd targets_;
+
+  /** @brief Returns the block of the constraint jacobian associated with var_set */
+  Jacobian GetConstraintJacobianBlock(const std::string& var_set) const;
 };
 
 }  // namespace trajopt
@@ -30,8 +30,10 @@
 #include <trajopt_ifopt/constraints/joint_position_constraint.h>
 #include <trajopt_ifopt/constraints/joint_velocity_constraint.h>
 
+#include <trajopt_ifopt/costs/hessian_cost_term.h>
 #include <trajopt_ifopt/costs/squared_cost.h>
 
+#include <trajopt_ifopt/utils/evaluation_cache.h>
 #include <trajopt_ifopt/utils/ifopt_utils.h>
 #include <trajopt_ifopt/utils/numeric_differentiation.h>
 #include <trajopt_ifopt/utils/trajopt_utils.h>
@@ -0,0 +1,115 @@
+/**
+ * @file evaluation_cache.h
+ * @brief Memoizes values computed from the current values of joint position variables
+ *
+ * @author Levi Armstrong
+ * @date Dec 1, 2020
+ * @version TODO
+ * @bug No known bugs
+ *
+ * @copyright Copyright (c) 2020, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TRAJOPT_IFOPT_EVALUATION_CACHE_H
+#define TRAJOPT_IFOPT_EVALUATION_CACHE_H
+
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <ifopt/composite.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_ifopt/variable_sets/joint_position_variable.h>
+
+namespace trajopt
+{
+/** @brief The versions of the variables a value is computed from. See JointPosition::GetVersion() */
+using VariableStamp = std::vector<std::size_t>;
+
+/**
+ * @brief Appends the version of a variable to a stamp
+ *
+ * Variables which are not a JointPosition have no version, in which case a zero is appended and values computed from
+ * the stamp are never reused.
+ * @param stamp The stamp the version is appended to
+ * @param variables The variables of the problem, usually GetVariables() of a constraint
+ * @param var_name The name of a variable the value is computed from
+ */
+inline void appendVariableStamp(VariableStamp& stamp, const ifopt::Composite& variables, const std::string& var_name)
+{
+  auto var = std::dynamic_pointer_cast<const JointPosition>(variables.GetComponent(var_name));
+  stamp.push_back((var != nullptr) ? var->GetVersion() : 0);
+}
+
+/**
+ * @brief Memoizes a value computed from the current values of a set of variables, e.g. the values or the jacobian of
+ * a constraint.
+ *
+ * ifopt requests the values and jacobian blocks of a constraint separately, and a solver requests them again when it
+ * evaluates its merit at the same point. The value is keyed on the versions of the variables it is computed from, so
+ * looking it up only compares a few integers instead of the variable values. The number of hits and misses are
+ * counted to verify the reuse.
+ *
+ * Like the constraint sets themselves the cache is not thread safe.
+ */
+template <typename T>
+class EvaluationCache
+{
+public:
+  /**
+   * @brief Returns the value computed at a stamp, computing it if the stamp changed since the last call
+   * @param stamp The versions of the variables the value is computed from
+   * @param compute The function computing the value
+   * @return The value
+   */
+  template <typename ComputeFn>
+  const T& get(const VariableStamp& stamp, ComputeFn compute)
+  {
+    bool reusable = std::find(stamp.begin(), stamp.end(), std::size_t{ 0 }) == stamp.end();
+    if (valid_ && reusable && stamp == stamp_)
+    {
+      ++num_hits_;
+      return value_;
+    }
+
+    ++num_misses_;
+    value_ = compute();
+    stamp_ = stamp;
+    valid_ = reusable;
+    return value_;
+  }
+
+  /** @brief Discards the value, e.g. because the parameters it was computed with changed */
+  void clear() { valid_ = false; }
+
+  /** @brief The number of calls to get() which returned the stored value */
+  std::size_t getNumHits() const { return num_hits_; }
+
+  /** @brief The number of calls to get() which computed the value */
+  std::size_t getNumMisses() const { return num_misses_; }
+
+private:
+  T value_;
+  VariableStamp stamp_;
+  bool valid_{ false };
+  std::size_t num_hits_{ 0 };
+  std::size_t num_misses_{ 0 };
+};
+}  // namespace trajopt
+
+#endif
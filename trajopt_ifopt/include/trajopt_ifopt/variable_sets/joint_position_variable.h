@@ -28,6 +28,7 @@
 
 #include <trajopt_utils/macros.h>
 TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <atomic>
 #include <ifopt/variable_set.h>
 #include <ifopt/bounds.h>
 #include <Eigen/Eigen>
@@ -59,9 +60,19 @@ public:
 
   /**
    * @brief Sets this variable to the given joint position
+   *
+   * Solvers often set the variables to the values they already have, e.g. when evaluating the constraints at the
+   * current point. The version only changes if the values do, so memoized values stay valid in that case.
    * @param x Joint Position to which this variable will be set.
    */
-  void SetVariables(const Eigen::VectorXd& x) override { values_ = x; }
+  void SetVariables(const Eigen::VectorXd& x) override
+  {
+    if (x.size() == values_.size() && x == values_)
+      return;
+
+    values_ = x;
+    version_ = nextVersion();
+  }
 
   /**
    * @brief Gets the joint position associated with this variable
@@ -94,10 +105,24 @@ public:
    */
   std::vector<std::string> GetJointNames() const { return joint_names_; }
 
+  /**
+   * @brief Gets a stamp which changes whenever the values of this variable change. Versions are unique across all
+   * variables and never zero, so they can be used to memoize values computed from the variables.
+   * @return The version of the current values
+   */
+  std::size_t GetVersion() const { return version_; }
+
 private:
   VecBound bounds_;
   Eigen::VectorXd values_;
   std::vector<std::string> joint_names_;
+  std::size_t version_{ nextVersion() };
+
+  static std::size_t nextVersion()
+  {
+    static std::atomic<std::size_t> last_version{ 0 };
+    return ++last_version;
+  }
 };
 
 }  // namespace trajopt
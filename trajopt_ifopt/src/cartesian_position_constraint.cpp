@@ -65,8 +65,12 @@ Eigen::VectorXd CartPosConstraint::CalcValues(const Eigen::Ref<const Eigen::Vect
 
 Eigen::VectorXd CartPosConstraint::GetValues() const
 {
-  VectorXd joint_vals = this->GetVariables()->GetComponent(position_var_->GetName())->GetValues();
-  return CalcValues(joint_vals);
+  VariableStamp stamp;
+  appendVariableStamp(stamp, *GetVariables(), position_var_->GetName());
+  return values_cache_.get(stamp, [this]() {
+    VectorXd joint_vals = this->GetVariables()->GetComponent(position_var_->GetName())->GetValues();
+    return CalcValues(joint_vals);
+  });
 }
 
 // Set the limits on the constraint values
@@ -158,9 +162,22 @@ void CartPosConstraint::FillJacobianBlock(std::string var_set, Jacobian& jac_blo
   // Only modify the jacobian if this constraint uses var_set
   if (var_set == position_var_->GetName())
   {
-    // Get current joint values and calculate jacobian
-    VectorXd joint_vals = this->GetVariables()->GetComponent(position_var_->GetName())->GetValues();
-    CalcJacobianBlock(joint_vals, jac_block);
+    // The jacobian depends on the differentiation method, which can be changed at any time
+    if (jacobian_cache_numeric_ != use_numeric_differentiation)
+    {
+      jacobian_cache_.clear();
+      jacobian_cache_numeric_ = use_numeric_differentiation;
+    }
+
+    VariableStamp stamp;
+    appendVariableStamp(stamp, *GetVariables(), position_var_->GetName());
+    jac_block = jacobian_cache_.get(stamp, [this, &jac_block]() {
+      // Get current joint values and calculate jacobian
+      Jacobian jac(jac_block.rows(), jac_block.cols());
+      VectorXd joint_vals = this->GetVariables()->GetComponent(position_var_->GetName())->GetValues();
+      CalcJacobianBlock(joint_vals, jac);
+      return jac;
+    });
   }
 }
 
@@ -168,6 +185,8 @@ void CartPosConstraint::SetTargetPose(const Eigen::Isometry3d& target_pose)
 {
   target_pose_ = target_pose;
   target_pose_inv_ = target_pose.inverse();
+  values_cache_.clear();
+  jacobian_cache_.clear();
 }
 
 Eigen::Isometry3d CartPosConstraint::GetCurrentPose() const
@@ -27,12 +27,201 @@
 #include <trajopt_ifopt/constraints/collision_constraint.h>
 
 TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
+#include <numeric>
 #include <tesseract_kinematics/core/utils.h>
 #include <console_bridge/console.h>
 TRAJOPT_IGNORE_WARNINGS_POP
 
 namespace trajopt
 {
+namespace
+{
+/** @brief The margin and coefficient of a link pair, as expected by GetGradient */
+Eigen::Vector2d getPairData(DiscreteCollisionEvaluator& collision_evaluator,
+                            const tesseract_collision::ContactResultMap::key_type& link_pair)
+{
+  const TrajOptCollisionConfig& config = collision_evaluator.getCollisionConfig();
+  return Eigen::Vector2d(config.collision_margin_data.getPairCollisionMargin(link_pair.first, link_pair.second),
+                         config.collision_coeff_data.getPairCollisionCoeff(link_pair.first, link_pair.second));
+}
+
+/**
+ * @brief Computes the collision terms of a joint state. The contacts are looked up with GetCollisionsCached, so they
+ * are not checked again for a joint state the collision evaluator has seen recently.
+ */
+CollisionTerms calcCollisionTerms(DiscreteCollisionEvaluator& collision_evaluator,
+                                  const Eigen::Ref<const Eigen::VectorXd>& joint_vals)
+{
+  const std::vector<double> joint_vector(joint_vals.data(), joint_vals.data() + joint_vals.size());
+  CollisionCacheData::ConstPtr collisions = collision_evaluator.GetCollisionsCached(joint_vector);
+
+  std::vector<tesseract_collision::ContactResultMap::key_type> link_pairs;
+  std::vector<double> errors;
+  link_pairs.reserve(collisions->contact_results_map.size());
+  errors.reserve(collisions->contact_results_map.size());
+  for (const auto& pair_results : collisions->contact_results_map)
+  {
+    if (pair_results.second.empty())
+      continue;
+
+    // Contains the contact distance threshold and coefficient for the given link pair
+    Eigen::Vector2d data = getPairData(collision_evaluator, pair_results.first);
+    // distance will be distance from threshold with negative being greater (further) than the threshold times the
+    // coeff
+    double error = 0;
+    for (const tesseract_collision::ContactResult& dist_result : pair_results.second)
+      error += std::max<double>(((data[0] - dist_result.distance) * data[1]), 0.);
+
+    link_pairs.push_back(pair_results.first);
+    errors.push_back(error);
+  }
+
+  // Order the link pairs by decreasing error, ties keep the order of the contact map
+  std::vector<std::size_t> order(link_pairs.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(
+      order.begin(), order.end(), [&errors](std::size_t a, std::size_t b) { return errors[a] > errors[b]; });
+
+  CollisionTerms terms;
+  terms.collisions = std::move(collisions);
+  terms.link_pairs.reserve(order.size());
+  terms.errors.resize(static_cast<Eigen::Index>(order.size()));
+  for (std::size_t i = 0; i < order.size(); ++i)
+  {
+    terms.link_pairs.push_back(std::move(link_pairs[order[i]]));
+    terms.errors[static_cast<Eigen::Index>(i)] = errors[order[i]];
+  }
+  return terms;
+}
+
+/**
+ * @brief Assigns the link pairs of the terms to the rows. Link pairs which are still in contact keep the row they had
+ * in row_link_pairs, the others leave their rows free. New link pairs fill the free rows in order of decreasing error,
+ * the ones left over are dropped.
+ * @param terms The collision terms, ordered by decreasing error
+ * @param row_link_pairs The previous link pair of each row, a pair of empty link names marks a free row
+ * @return The link pair of each row
+ */
+std::vector<tesseract_collision::ContactResultMap::key_type>
+assignLinkPairRows(const CollisionTerms& terms,
+                   const std::vector<tesseract_collision::ContactResultMap::key_type>& row_link_pairs)
+{
+  const tesseract_collision::ContactResultMap::key_type free_row;
+  std::vector<tesseract_collision::ContactResultMap::key_type> rows(row_link_pairs.size(), free_row);
+  std::vector<bool> assigned(terms.link_pairs.size(), false);
+  for (std::size_t r = 0; r < row_link_pairs.size(); ++r)
+  {
+    if (row_link_pairs[r] == free_row)
+      continue;
+
+    auto it = std::find(terms.link_pairs.begin(), terms.link_pairs.end(), row_link_pairs[r]);
+    if (it == terms.link_pairs.end())
+      continue;
+
+    rows[r] = row_link_pairs[r];
+    assigned[static_cast<std::size_t>(it - terms.link_pairs.begin())] = true;
+  }
+
+  std::size_t r = 0;
+  for (std::size_t i = 0; i < terms.link_pairs.size(); ++i)
+  {
+    if (assigned[i])
+      continue;
+
+    while (r < rows.size() && rows[r] != free_row)
+      ++r;
+    if (r == rows.size())
+      break;
+    rows[r] = terms.link_pairs[i];
+  }
+  return rows;
+}
+
+/**
+ * @brief Looks up the row of each link pair of the terms
+ * @return The row of each link pair, -1 if it has none
+ */
+std::vector<Eigen::Index>
+getLinkPairRows(const CollisionTerms& terms,
+                const std::vector<tesseract_collision::ContactResultMap::key_type>& row_link_pairs)
+{
+  std::vector<Eigen::Index> pair_rows(terms.link_pairs.size(), -1);
+  for (std::size_t i = 0; i < terms.link_pairs.size(); ++i)
+  {
+    auto it = std::find(row_link_pairs.begin(), row_link_pairs.end(), terms.link_pairs[i]);
+    if (it != row_link_pairs.end())
+      pair_rows[i] = static_cast<Eigen::Index>(it - row_link_pairs.begin());
+  }
+  return pair_rows;
+}
+
+/** @brief The error of each row, zero for the rows without a link pair */
+Eigen::VectorXd calcRowErrors(const CollisionTerms& terms,
+                              const std::vector<Eigen::Index>& pair_rows,
+                              Eigen::Index rows)
+{
+  Eigen::VectorXd err = Eigen::VectorXd::Zero(rows);
+  for (std::size_t i = 0; i < pair_rows.size(); ++i)
+  {
+    if (pair_rows[i] >= 0)
+      err[pair_rows[i]] = terms.errors[static_cast<Eigen::Index>(i)];
+  }
+  return err;
+}
+
+/**
+ * @brief Computes the jacobian of the errors of the link pairs of the terms. The gradients of each link pair are added
+ * to its row in pair_rows, the link pairs without a row are skipped. The gradients are computed from the contacts
+ * stored in the terms, which are not checked again.
+ */
+Eigen::MatrixXd calcCollisionTermsJacobian(DiscreteCollisionEvaluator& collision_evaluator,
+                                           const Eigen::Ref<const Eigen::VectorXd>& joint_vals,
+                                           const CollisionTerms& terms,
+                                           const std::vector<Eigen::Index>& pair_rows,
+                                           Eigen::Index rows)
+{
+  const Eigen::VectorXd dofvals = joint_vals;
+  Eigen::MatrixXd jac = Eigen::MatrixXd::Zero(rows, joint_vals.size());
+  for (std::size_t i = 0; i < terms.link_pairs.size(); ++i)
+  {
+    const Eigen::Index row = pair_rows[i];
+    if (row < 0)
+      continue;
+
+    const auto& link_pair = terms.link_pairs[i];
+    // GradientResults only refers to the data, so it has to outlive them
+    const Eigen::Vector2d data = getPairData(collision_evaluator, link_pair);
+    for (const tesseract_collision::ContactResult& dist_result : terms.collisions->contact_results_map.at(link_pair))
+    {
+      GradientResults grad = collision_evaluator.GetGradient(dofvals, dist_result, data, true);
+      if (grad.gradients[0].has_gradient)
+        jac.row(row) -= grad.gradients[0].gradient.transpose();
+      if (grad.gradients[1].has_gradient)
+        jac.row(row) -= grad.gradients[1].gradient.transpose();
+    }
+  }
+  return jac;
+}
+
+/**
+ * @brief Copies a dense jacobian into a jacobian block. Every entry is stored, also zeros, so the sparsity pattern of
+ * the block does not change with the contacts.
+ */
+void fillDenseJacobianBlock(const Eigen::MatrixXd& jac, ifopt::Component::Jacobian& jac_block)
+{
+  jac_block.resize(jac.rows(), jac.cols());
+  jac_block.reserve(jac.size());
+  for (Eigen::Index i = 0; i < jac.rows(); ++i)
+  {
+    jac_block.startVec(i);
+    for (Eigen::Index j = 0; j < jac.cols(); ++j)
+      jac_block.insertBack(i, j) = jac(i, j);
+  }
+  jac_block.finalize();
+}
+}  // namespace
+
 CollisionConstraintIfopt::CollisionConstraintIfopt(DiscreteCollisionEvaluator::Ptr collision_evaluator,
                                                    JointPosition::ConstPtr position_var,
                                                    const std::string& name)
@@ -49,38 +238,12 @@ CollisionConstraintIfopt::CollisionConstraintIfopt(DiscreteCollisionEvaluator::P
 
 Eigen::VectorXd CollisionConstraintIfopt::CalcValues(const Eigen::Ref<const Eigen::VectorXd>& joint_vals) const
 {
-  Eigen::VectorXd err = Eigen::VectorXd::Zero(1);
-
-  // Check the collisions
-  tesseract_collision::ContactResultVector dist_results;
-  {
-    tesseract_collision::ContactResultMap dist_results_map;
-    const std::vector<double> joint_vector(joint_vals.data(), joint_vals.data() + joint_vals.size());
-    collision_evaluator_->GetCollisionsCached(joint_vector, dist_results_map);
-    tesseract_collision::flattenMoveResults(std::move(dist_results_map), dist_results);
-  }
-
-  for (tesseract_collision::ContactResult& dist_result : dist_results)
-  {
-    // Contains the contact distance threshold and coefficient for the given link pair
-    double dist = collision_evaluator_->getCollisionConfig().collision_margin_data.getPairCollisionMargin(
-        dist_result.link_names[0], dist_result.link_names[1]);
-    double coeff = collision_evaluator_->getCollisionConfig().collision_coeff_data.getPairCollisionCoeff(
-        dist_result.link_names[0], dist_result.link_names[1]);
-    const Eigen::Vector2d& data = { dist, coeff };
-    // distance will be distance from threshold with negative being greater (further) than the threshold times the
-    // coeff
-    err[0] += std::max<double>(((data[0] - dist_result.distance) * data[1]), 0.);
-  }
-  return err;
+  return Eigen::VectorXd::Constant(1, calcCollisionTerms(*collision_evaluator_, joint_vals).errors.sum());
 }
 
 Eigen::VectorXd CollisionConstraintIfopt::GetValues() const
 {
-  // Get current joint values
-  Eigen::VectorXd joint_vals = this->GetVariables()->GetComponent(position_var_->GetName())->GetValues();
-
-  return CalcValues(joint_vals);
+  return Eigen::VectorXd::Constant(1, GetCurrentTerms().errors.sum());
 }
 
 // Set the limits on the constraint values
@@ -95,60 +258,139 @@ void CollisionConstraintIfopt::SetBounds(const std::vector<ifopt::Bounds>& bound
 void CollisionConstraintIfopt::CalcJacobianBlock(const Eigen::Ref<const Eigen::VectorXd>& joint_vals,
                                                  Jacobian& jac_block) const
 {
-  // Reserve enough room in the sparse matrix
-  jac_block.reserve(n_dof_);
+  CollisionTerms terms = calcCollisionTerms(*collision_evaluator_, joint_vals);
 
-  // Calculate collisions
-  tesseract_collision::ContactResultVector dist_results;
-  {
-    tesseract_collision::ContactResultMap dist_results_map;
-    collision_evaluator_->CalcCollisions(joint_vals, dist_results_map);
-    tesseract_collision::flattenMoveResults(std::move(dist_results_map), dist_results);
-  }
+  // Collision is 1 x n_dof, the gradients of all link pairs are added to the single row
+  std::vector<Eigen::Index> pair_rows(terms.link_pairs.size(), 0);
+  fillDenseJacobianBlock(calcCollisionTermsJacobian(*collision_evaluator_, joint_vals, terms, pair_rows, 1), jac_block);
+}
 
-  // Get gradients for all contacts
-  std::vector<trajopt::GradientResults> grad_results;
-  grad_results.reserve(dist_results.size());
-  for (tesseract_collision::ContactResult& dist_result : dist_results)
+void CollisionConstraintIfopt::FillJacobianBlock(std::string var_set, Jacobian& jac_block) const
+{
+  // Only modify the jacobian if this constraint uses var_set
+  if (var_set == position_var_->GetName())
   {
-    // Contains the contact distance threshold and coefficient for the given link pair
-    double dist = collision_evaluator_->getCollisionConfig().collision_margin_data.getPairCollisionMargin(
-        dist_result.link_names[0], dist_result.link_names[1]);
-    double coeff = collision_evaluator_->getCollisionConfig().collision_coeff_data.getPairCollisionCoeff(
-        dist_result.link_names[0], dist_result.link_names[1]);
-    const Eigen::Vector2d& data = { dist, coeff };
-    grad_results.push_back(collision_evaluator_->GetGradient(joint_vals, dist_result, data, true));
-  }
+    VariableStamp stamp;
+    appendVariableStamp(stamp, *GetVariables(), position_var_->GetName());
+    jac_block = jacobian_cache_.get(stamp, [this]() {
+      const CollisionTerms& terms = GetCurrentTerms();
+      std::vector<Eigen::Index> pair_rows(terms.link_pairs.size(), 0);
 
-  // Convert GradientResults to jacobian
-  int idx = 0;
-  Eigen::VectorXd grad_vec = Eigen::VectorXd::Zero(n_dof_);
-  for (auto& grad : grad_results)
-  {
-    if (grad.gradients[0].has_gradient)
-      grad_vec += grad.gradients[0].gradient;
-    if (grad.gradients[1].has_gradient)
-      grad_vec += grad.gradients[1].gradient;
-    idx++;
-  }
+      // Get current joint values and calculate jacobian from the contacts of the terms
+      VectorXd joint_vals = this->GetVariables()->GetComponent(position_var_->GetName())->GetValues();
+      Eigen::MatrixXd dense_jac = calcCollisionTermsJacobian(*collision_evaluator_, joint_vals, terms, pair_rows, 1);
 
-  // This does work but could be faster
-  for (int j = 0; j < n_dof_; j++)
-  {
-    // Collision is 1 x n_dof
-    jac_block.coeffRef(0, j) = -1 * grad_vec[j];
+      Jacobian jac(1, n_dof_);
+      fillDenseJacobianBlock(dense_jac, jac);
+      return jac;
+    });
   }
 }
 
-void CollisionConstraintIfopt::FillJacobianBlock(std::string var_set, Jacobian& jac_block) const
+const CollisionTerms& CollisionConstraintIfopt::GetCurrentTerms() const
+{
+  VariableStamp stamp;
+  appendVariableStamp(stamp, *GetVariables(), position_var_->GetName());
+  return terms_cache_.get(stamp, [this]() {
+    VectorXd joint_vals = this->GetVariables()->GetComponent(position_var_->GetName())->GetValues();
+    return calcCollisionTerms(*collision_evaluator_, joint_vals);
+  });
+}
+
+LinkPairCollisionConstraintIfopt::LinkPairCollisionConstraintIfopt(
+    DiscreteCollisionEvaluator::Ptr collision_evaluator,
+    JointPosition::ConstPtr position_var,
+    int max_num_pairs,
+    const std::string& name)
+  : ifopt::ConstraintSet(max_num_pairs, name)
+  , position_var_(std::move(position_var))
+  , collision_evaluator_(std::move(collision_evaluator))
+{
+  // Set n_dof_ for convenience
+  n_dof_ = position_var_->GetRows();
+  assert(n_dof_ > 0);
+  assert(max_num_pairs > 0);
+
+  bounds_ = std::vector<ifopt::Bounds>(static_cast<std::size_t>(max_num_pairs), ifopt::BoundSmallerZero);
+  row_link_pairs_.resize(static_cast<std::size_t>(max_num_pairs));
+}
+
+Eigen::VectorXd LinkPairCollisionConstraintIfopt::CalcValues(const Eigen::Ref<const Eigen::VectorXd>& joint_vals) const
+{
+  CollisionTerms terms = calcCollisionTerms(*collision_evaluator_, joint_vals);
+  std::vector<Eigen::Index> pair_rows = getLinkPairRows(terms, assignLinkPairRows(terms, row_link_pairs_));
+  return calcRowErrors(terms, pair_rows, GetRows());
+}
+
+Eigen::VectorXd LinkPairCollisionConstraintIfopt::GetValues() const
+{
+  const CollisionTerms& terms = GetCurrentTerms();
+  std::vector<Eigen::Index> pair_rows = getLinkPairRows(terms, row_link_pairs_);
+  auto n_dropped = std::count(pair_rows.begin(), pair_rows.end(), -1);
+  if (n_dropped > 0)
+    CONSOLE_BRIDGE_logDebug("%s: %d link pairs in contact, %d of them are not constrained since all rows are in use",
+                            GetName().c_str(),
+                            static_cast<int>(pair_rows.size()),
+                            static_cast<int>(n_dropped));
+
+  return calcRowErrors(terms, pair_rows, GetRows());
+}
+
+// Set the limits on the constraint values
+std::vector<ifopt::Bounds> LinkPairCollisionConstraintIfopt::GetBounds() const { return bounds_; }
+
+void LinkPairCollisionConstraintIfopt::SetBounds(const std::vector<ifopt::Bounds>& bounds)
+{
+  assert(bounds.size() == static_cast<std::size_t>(GetRows()));
+  bounds_ = bounds;
+}
+
+void LinkPairCollisionConstraintIfopt::CalcJacobianBlock(const Eigen::Ref<const Eigen::VectorXd>& joint_vals,
+                                                         Jacobian& jac_block) const
+{
+  CollisionTerms terms = calcCollisionTerms(*collision_evaluator_, joint_vals);
+  std::vector<Eigen::Index> pair_rows = getLinkPairRows(terms, assignLinkPairRows(terms, row_link_pairs_));
+  fillDenseJacobianBlock(calcCollisionTermsJacobian(*collision_evaluator_, joint_vals, terms, pair_rows, GetRows()),
+                         jac_block);
+}
+
+void LinkPairCollisionConstraintIfopt::FillJacobianBlock(std::string var_set, Jacobian& jac_block) const
 {
   // Only modify the jacobian if this constraint uses var_set
   if (var_set == position_var_->GetName())
   {
-    // Get current joint values
+    VariableStamp stamp;
+    appendVariableStamp(stamp, *GetVariables(), position_var_->GetName());
+    jac_block = jacobian_cache_.get(stamp, [this]() {
+      // Get current joint values and calculate jacobian from the contacts of the terms
+      VectorXd joint_vals = this->GetVariables()->GetComponent(position_var_->GetName())->GetValues();
+      const CollisionTerms& terms = GetCurrentTerms();
+      std::vector<Eigen::Index> pair_rows = getLinkPairRows(terms, row_link_pairs_);
+      Jacobian jac(GetRows(), n_dof_);
+      fillDenseJacobianBlock(
+          calcCollisionTermsJacobian(*collision_evaluator_, joint_vals, terms, pair_rows, GetRows()), jac);
+      return jac;
+    });
+  }
+}
+
+std::vector<tesseract_collision::ContactResultMap::key_type> LinkPairCollisionConstraintIfopt::GetLinkPairs() const
+{
+  GetCurrentTerms();
+  return row_link_pairs_;
+}
+
+const CollisionTerms& LinkPairCollisionConstraintIfopt::GetCurrentTerms() const
+{
+  VariableStamp stamp;
+  appendVariableStamp(stamp, *GetVariables(), position_var_->GetName());
+  return terms_cache_.get(stamp, [this]() {
     VectorXd joint_vals = this->GetVariables()->GetComponent(position_var_->GetName())->GetValues();
+    CollisionTerms terms = calcCollisionTerms(*collision_evaluator_, joint_vals);
 
-    CalcJacobianBlock(joint_vals, jac_block);
-  }
+    // The rows are only reassigned when the contacts change, so a link pair keeps its row while it is in contact
+    row_link_pairs_ = assignLinkPairRows(terms, row_link_pairs_);
+    return terms;
+  });
 }
 }  // namespace trajopt
@@ -25,7 +25,9 @@
 
 #include <trajopt_utils/macros.h>
 TRAJOPT_IGNORE_WARNINGS_PUSH
-#include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <iterator>
+#include <numeric>
 #include <console_bridge/console.h>
 #include <tesseract_kinematics/core/forward_kinematics.h>
 #include <tesseract_kinematics/core/utils.h>
@@ -349,13 +351,114 @@ CollisionEvaluator::CollisionEvaluator(tesseract_kinematics::ForwardKinematics::
                         const Eigen::Ref<const Eigen::VectorXd>& joint_values) {
       return state_solver_->getState(joint_names, joint_values);
     };
+
+  // Relative to the state of the cloned state solver the active links only move with manip_, so their transforms
+  // follow from its kinematics
+  const std::vector<std::string>& active_links = adjacency_map_->getActiveLinkNames();
+  use_active_link_kinematics_ = true;
+  active_link_kin_index_.reserve(active_links.size());
+  active_link_offsets_.reserve(active_links.size());
+  for (const auto& link_name : active_links)
+  {
+    tesseract_environment::AdjacencyMapPair::ConstPtr it = adjacency_map_->getLinkMapping(link_name);
+    if (it == nullptr)
+    {
+      use_active_link_kinematics_ = false;
+      break;
+    }
+
+    auto kin_link = std::find(active_kin_links_.begin(), active_kin_links_.end(), it->link_name);
+    active_link_kin_index_.push_back(static_cast<std::size_t>(std::distance(active_kin_links_.begin(), kin_link)));
+    if (kin_link == active_kin_links_.end())
+      active_kin_links_.push_back(it->link_name);
+    active_link_offsets_.push_back(it->transform);
+  }
+
+  active_link_order_.resize(active_link_kin_index_.size());
+  std::iota(active_link_order_.begin(), active_link_order_.end(), 0);
+  std::stable_sort(active_link_order_.begin(), active_link_order_.end(), [this](std::size_t a, std::size_t b) {
+    return active_link_kin_index_[a] < active_link_kin_index_[b];
+  });
+
+  if (collision_config_.adaptive_subdivision_margin > 0)
+  {
+    if (collision_config_.contact_request.type == tesseract_collision::ContactTestType::FIRST)
+    {
+      CONSOLE_BRIDGE_logWarn("Adaptive subdivision is not available with contact test type FIRST");
+    }
+    else
+    {
+      motion_bounds_ =
+          std::make_shared<LinkMotionBounds>(*manip_, *env_->getSceneGraph(), adjacency_map_->getActiveLinkNames());
+      if (!motion_bounds_->isValid())
+      {
+        CONSOLE_BRIDGE_logWarn("Adaptive subdivision is disabled, the motion of the active links cannot be bounded");
+        motion_bounds_ = nullptr;
+      }
+    }
+  }
+}
+
+tesseract_collision::CollisionMarginData CollisionEvaluator::getContactManagerMarginData() const
+{
+  if (!useAdaptiveSubdivision())
+    return collision_config_.collision_margin_data;
+
+  return tesseract_collision::CollisionMarginData(collision_config_.collision_margin_data.getMaxCollisionMargin() +
+                                                  collision_config_.adaptive_subdivision_margin);
+}
+
+double CollisionEvaluator::removeAdaptiveSubdivisionContacts(tesseract_collision::ContactResultMap& contacts) const
+{
+  double clearance = collision_config_.adaptive_subdivision_margin;
+  for (auto it = contacts.begin(); it != contacts.end();)
+  {
+    double dist = collision_config_.collision_margin_data.getPairCollisionMargin(it->first.first, it->first.second);
+    for (const auto& r : it->second)
+      clearance = std::min(clearance, r.distance - dist);
+
+    auto end =
+        std::remove_if(it->second.begin(), it->second.end(), [dist](const auto& r) { return r.distance >= dist; });
+    it->second.erase(end, it->second.end());
+
+    if (it->second.empty())
+      it = contacts.erase(it);
+    else
+      ++it;
+  }
+  return clearance;
+}
+
+void CollisionEvaluator::CalcActiveLinkTransforms(const Eigen::Ref<const Eigen::VectorXd>& joint_values,
+                                                  tesseract_common::VectorIsometry3d& link_transforms) const
+{
+  const std::vector<std::string>& active_links = adjacency_map_->getActiveLinkNames();
+  link_transforms.resize(active_links.size());
+
+  if (!use_active_link_kinematics_)
+  {
+    tesseract_environment::EnvState::Ptr state = state_solver_->getState(manip_->getJointNames(), joint_values);
+    for (std::size_t i = 0; i < active_links.size(); ++i)
+      link_transforms[i] = state->link_transforms[active_links[i]];
+    return;
+  }
+
+  std::size_t kin_index = active_kin_links_.size();
+  Eigen::Isometry3d kin_link_pose;
+  for (std::size_t i : active_link_order_)
+  {
+    if (active_link_kin_index_[i] != kin_index)
+    {
+      kin_index = active_link_kin_index_[i];
+      kin_link_pose = world_to_base_ * manip_->calcFwdKin(joint_values, active_kin_links_[kin_index]);
+    }
+    link_transforms[i] = kin_link_pose * active_link_offsets_[i];
+  }
 }
 
 void CollisionEvaluator::CalcDists(const std::vector<double>& x, std::vector<double>& dists)
 {
-  tesseract_collision::ContactResultVector dist_results;
-  GetCollisionsCached(x, dist_results);
-  CollisionsToDistances(dist_results, dists);
+  CollisionsToDistances(GetCollisionsCached(x)->contact_results_vector, dists);
 }
 
 void CollisionEvaluator::CalcCollisions(const std::vector<double>& x,
@@ -366,43 +469,31 @@ void CollisionEvaluator::CalcCollisions(const std::vector<double>& x,
   tesseract_collision::flattenCopyResults(dist_map, dist_vector);
 }
 
-inline size_t hash(const std::vector<double>& x) { return boost::hash_range(x.begin(), x.end()); }
-void CollisionEvaluator::GetCollisionsCached(const std::vector<double>& x,
-                                             tesseract_collision::ContactResultVector& dist_results)
+CollisionCacheData::ConstPtr CollisionEvaluator::GetCollisionsCached(const std::vector<double>& x)
 {
-  size_t key = hash(x);
-  auto it = m_cache.get(key);
-  if (it != nullptr)
+  CollisionCacheData::ConstPtr cached = m_cache.get(x);
+  if (cached != nullptr)
   {
     CONSOLE_BRIDGE_logDebug("Using cached collision check");
-    dist_results = it->second;
-  }
-  else
-  {
-    CONSOLE_BRIDGE_logDebug("Not using cached collision check");
-    tesseract_collision::ContactResultMap dist_map;
-    CalcCollisions(x, dist_map, dist_results);
-    m_cache.put(key, std::make_pair(dist_map, dist_results));
+    return cached;
   }
+
+  CONSOLE_BRIDGE_logDebug("Not using cached collision check");
+  auto data = std::make_shared<CollisionCacheData>();
+  CalcCollisions(x, data->contact_results_map, data->contact_results_vector);
+  return m_cache.put(x, data);
+}
+
+void CollisionEvaluator::GetCollisionsCached(const std::vector<double>& x,
+                                             tesseract_collision::ContactResultVector& dist_results)
+{
+  dist_results = GetCollisionsCached(x)->contact_results_vector;
 }
 
 void CollisionEvaluator::GetCollisionsCached(const std::vector<double>& x,
                                              tesseract_collision::ContactResultMap& dist_results)
 {
-  size_t key = hash(x);
-  auto it = m_cache.get(key);
-  if (it != nullptr)
-  {
-    CONSOLE_BRIDGE_logDebug("Using cached collision check");
-    dist_results = it->first;
-  }
-  else
-  {
-    CONSOLE_BRIDGE_logDebug("Not using cached collision check");
-    tesseract_collision::ContactResultVector dist_vector;
-    CalcCollisions(x, dist_results, dist_vector);
-    m_cache.put(key, std::make_pair(dist_results, dist_vector));
-  }
+  dist_results = GetCollisionsCached(x)->contact_results_map;
 }
 
 void CollisionEvaluator::processInterpolatedCollisionResults(
@@ -565,10 +656,18 @@ void DiscreteCollisionEvaluator::CalcCollisions(const std::vector<double>& x,
 void DiscreteCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eigen::VectorXd>& dof_vals,
                                                 tesseract_collision::ContactResultMap& dist_results)
 {
-  tesseract_environment::EnvState::Ptr state = get_state_fn_(manip_->getJointNames(), dof_vals);
-
-  for (const auto& link_name : env_->getActiveLinkNames())
-    contact_manager_->setCollisionObjectsTransform(link_name, state->link_transforms[link_name]);
+  if (dynamic_environment_)
+  {
+    tesseract_environment::EnvState::Ptr state = get_state_fn_(manip_->getJointNames(), dof_vals);
+    for (const auto& link_name : env_->getActiveLinkNames())
+      contact_manager_->setCollisionObjectsTransform(link_name, state->link_transforms[link_name]);
+  }
+  else
+  {
+    tesseract_common::VectorIsometry3d link_transforms;
+    CalcActiveLinkTransforms(dof_vals, link_transforms);
+    contact_manager_->setCollisionObjectsTransform(adjacency_map_->getActiveLinkNames(), link_transforms);
+  }
 
   contact_manager_->contactTest(dist_results, collision_config_.contact_request);
 
@@ -604,7 +703,7 @@ LVSContinuousCollisionEvaluator::LVSContinuousCollisionEvaluator(
 {
   contact_manager_ = env_->getContinuousContactManager();
   contact_manager_->setActiveCollisionObjects(adjacency_map_->getActiveLinkNames());
-  contact_manager_->setCollisionMarginData(collision_config.collision_margin_data);
+  contact_manager_->setCollisionMarginData(getContactManagerMarginData());
 }
 
 void LVSContinuousCollisionEvaluator::CalcCollisions(const std::vector<double>& x,
@@ -638,18 +737,40 @@ void LVSContinuousCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eige
     std::vector<tesseract_collision::ContactResultMap> contacts_vector;
     contacts_vector.reserve(static_cast<size_t>(subtraj.rows()));
     bool contact_found = false;
+    // The end transforms of a segment are the start transforms of the next one
+    tesseract_common::VectorIsometry3d link_transforms0;
+    tesseract_common::VectorIsometry3d link_transforms1;
+    CalcActiveLinkTransforms(subtraj.row(0), link_transforms1);
+
+    // When subdividing adaptively, the segments which the links cannot reach from the end of the last checked one
+    // without using up its clearance are skipped
+    bool adaptive = useAdaptiveSubdivision();
+    double step_motion = adaptive ? motion_bounds_->calcRelativeMotion(subtraj.row(1) - subtraj.row(0)) : 0;
+    double clearance = -1;
+    int last_checked = 0;
     for (int i = 0; i < subtraj.rows() - 1; ++i)
     {
       tesseract_collision::ContactResultMap contacts;
-      tesseract_environment::EnvState::Ptr state0 = state_solver_->getState(manip_->getJointNames(), subtraj.row(i));
-      tesseract_environment::EnvState::Ptr state1 =
-          state_solver_->getState(manip_->getJointNames(), subtraj.row(i + 1));
+      if (adaptive && static_cast<double>(i - last_checked) * step_motion < clearance)
+      {
+        contacts_vector.push_back(contacts);
+        continue;
+      }
 
-      for (const auto& link_name : adjacency_map_->getActiveLinkNames())
-        contact_manager_->setCollisionObjectsTransform(
-            link_name, state0->link_transforms[link_name], state1->link_transforms[link_name]);
+      if (adaptive && i > 0 && i != last_checked + 1)
+        CalcActiveLinkTransforms(subtraj.row(i), link_transforms1);
+      link_transforms0.swap(link_transforms1);
+      CalcActiveLinkTransforms(subtraj.row(i + 1), link_transforms1);
+      contact_manager_->setCollisionObjectsTransform(
+          adjacency_map_->getActiveLinkNames(), link_transforms0, link_transforms1);
 
       contact_manager_->contactTest(contacts, collision_config_.contact_request);
+      if (adaptive)
+      {
+        clearance = removeAdaptiveSubdivisionContacts(contacts);
+        last_checked = i;
+      }
+
       if (!contacts.empty())
         contact_found = true;
 
@@ -661,13 +782,16 @@ void LVSContinuousCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eige
   }
   else
   {
-    tesseract_environment::EnvState::Ptr state0 = state_solver_->getState(manip_->getJointNames(), dof_vals0);
-    tesseract_environment::EnvState::Ptr state1 = state_solver_->getState(manip_->getJointNames(), dof_vals1);
-    for (const auto& link_name : adjacency_map_->getActiveLinkNames())
-      contact_manager_->setCollisionObjectsTransform(
-          link_name, state0->link_transforms[link_name], state1->link_transforms[link_name]);
+    tesseract_common::VectorIsometry3d link_transforms0;
+    tesseract_common::VectorIsometry3d link_transforms1;
+    CalcActiveLinkTransforms(dof_vals0, link_transforms0);
+    CalcActiveLinkTransforms(dof_vals1, link_transforms1);
+    contact_manager_->setCollisionObjectsTransform(
+        adjacency_map_->getActiveLinkNames(), link_transforms0, link_transforms1);
 
     contact_manager_->contactTest(dist_results, collision_config_.contact_request);
+    if (useAdaptiveSubdivision())
+      removeAdaptiveSubdivisionContacts(dist_results);
 
     // Dont include contacts at the fixed state
     for (auto& pair : dist_results)
@@ -699,7 +823,7 @@ LVSDiscreteCollisionEvaluator::LVSDiscreteCollisionEvaluator(
 {
   contact_manager_ = env_->getDiscreteContactManager();
   contact_manager_->setActiveCollisionObjects(adjacency_map_->getActiveLinkNames());
-  contact_manager_->setCollisionMarginData(collision_config.collision_margin_data);
+  contact_manager_->setCollisionMarginData(getContactManagerMarginData());
 }
 
 void LVSDiscreteCollisionEvaluator::CalcCollisions(const std::vector<double>& x,
@@ -738,15 +862,33 @@ void LVSDiscreteCollisionEvaluator::CalcCollisions(const Eigen::Ref<const Eigen:
   std::vector<tesseract_collision::ContactResultMap> contacts_vector;
   contacts_vector.reserve(static_cast<size_t>(subtraj.rows()));
   bool contact_found = false;
+  tesseract_common::VectorIsometry3d link_transforms;
+
+  // When subdividing adaptively, the states which the links cannot reach from the last checked one without using up
+  // its clearance are skipped
+  bool adaptive = useAdaptiveSubdivision();
+  double step_motion = adaptive ? motion_bounds_->calcRelativeMotion(subtraj.row(1) - subtraj.row(0)) : 0;
+  double clearance = -1;
+  int last_checked = 0;
   for (int i = 0; i < subtraj.rows(); ++i)
   {
     tesseract_collision::ContactResultMap contacts;
-    tesseract_environment::EnvState::Ptr state0 = state_solver_->getState(manip_->getJointNames(), subtraj.row(i));
+    if (adaptive && static_cast<double>(i - last_checked) * step_motion < clearance)
+    {
+      contacts_vector.push_back(contacts);
+      continue;
+    }
 
-    for (const auto& link_name : active_links)
-      contact_manager_->setCollisionObjectsTransform(link_name, state0->link_transforms[link_name]);
+    CalcActiveLinkTransforms(subtraj.row(i), link_transforms);
+    contact_manager_->setCollisionObjectsTransform(active_links, link_transforms);
 
     contact_manager_->contactTest(contacts, collision_config_.contact_request);
+    if (adaptive)
+    {
+      clearance = removeAdaptiveSubdivisionContacts(contacts);
+      last_checked = i;
+    }
+
     if (!contacts.empty())
       contact_found = true;
 
@@ -0,0 +1,66 @@
+/**
+ * @file hessian_cost_term.cpp
+ * @brief A cost that also provides its hessian
+ *
+ * @author Levi Armstrong
+ * @date Dec 1, 2020
+ * @version TODO
+ * @bug No known bugs
+ *
+ * @copyright Copyright (c) 2020, Southwest Research Institute
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <trajopt_ifopt/costs/hessian_cost_term.h>
+
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <vector>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+namespace trajopt
+{
+HessianCostTerm::HessianCostTerm(const std::string& name) : CostTerm(name) {}
+
+HessianCostTerm::Hessian HessianCostTerm::GetHessian() const
+{
+  const std::vector<ifopt::Component::Ptr>& components = GetVariables()->GetComponents();
+  std::vector<Eigen::Triplet<double>> triplets;
+
+  // Assemble the blocks of all pairs of variable sets, like ifopt does for the jacobian
+  int row_offset = 0;
+  for (const auto& row_vars : components)
+  {
+    int col_offset = 0;
+    for (const auto& col_vars : components)
+    {
+      Hessian hessian_block(row_vars->GetRows(), col_vars->GetRows());
+      FillHessianBlock(row_vars->GetName(), col_vars->GetName(), hessian_block);
+
+      for (int k = 0; k < hessian_block.outerSize(); ++k)
+      {
+        for (Hessian::InnerIterator it(hessian_block, k); it; ++it)
+          triplets.emplace_back(row_offset + it.row(), col_offset + it.col(), it.value());
+      }
+      col_offset += col_vars->GetRows();
+    }
+    row_offset += row_vars->GetRows();
+  }
+
+  Hessian hessian(GetVariables()->GetRows(), GetVariables()->GetRows());
+  hessian.setFromTriplets(triplets.begin(), triplets.end());
+  return hessian;
+}
+
+}  // namespace trajopt
@@ -79,11 +79,16 @@ InverseKinematicsConstraint::CalcValues(const Eigen::Ref<const Eigen::VectorXd>&
 
 Eigen::VectorXd InverseKinematicsConstraint::GetValues() const
 {
-  // Get the two variables
-  Eigen::VectorXd seed_joint_position = this->GetVariables()->GetComponent(seed_var_->GetName())->GetValues();
-  Eigen::VectorXd joint_vals = this->GetVariables()->GetComponent(constraint_var_->GetName())->GetValues();
+  VariableStamp stamp;
+  appendVariableStamp(stamp, *GetVariables(), seed_var_->GetName());
+  appendVariableStamp(stamp, *GetVariables(), constraint_var_->GetName());
+  return values_cache_.get(stamp, [this]() {
+    // Get the two variables
+    Eigen::VectorXd seed_joint_position = this->GetVariables()->GetComponent(seed_var_->GetName())->GetValues();
+    Eigen::VectorXd joint_vals = this->GetVariables()->GetComponent(constraint_var_->GetName())->GetValues();
 
-  return CalcValues(joint_vals, seed_joint_position);
+    return CalcValues(joint_vals, seed_joint_position);
+  });
 }
 
 // Set the limits on the constraint values
@@ -113,5 +118,9 @@ void InverseKinematicsConstraint::FillJacobianBlock(std::string var_set, Jacobia
   }
 }
 
-void InverseKinematicsConstraint::SetTargetPose(const Eigen::Isometry3d& target_pose) { target_pose_ = target_pose; }
+void InverseKinematicsConstraint::SetTargetPose(const Eigen::Isometry3d& target_pose)
+{
+  target_pose_ = target_pose;
+  values_cache_.clear();
+}
 }  // namespace trajopt
@@ -66,16 +66,25 @@ JointVelConstraint::JointVelConstraint(const Eigen::VectorXd& targets,
 
 Eigen::VectorXd JointVelConstraint::GetValues() const
 {
-  Eigen::VectorXd velocity(static_cast<size_t>(n_dof_) * (position_vars_.size() - 1));
-  for (std::size_t ind = 0; ind < position_vars_.size() - 1; ind++)
-  {
-    auto vals1 = GetVariables()->GetComponent(position_vars_[ind]->GetName())->GetValues();
-    auto vals2 = GetVariables()->GetComponent(position_vars_[ind + 1]->GetName())->GetValues();
-    Eigen::VectorXd single_step = vals1 - vals2;
-    velocity.block(n_dof_ * static_cast<Eigen::Index>(ind), 0, n_dof_, 1) = single_step;
-  }
+  VariableStamp stamp;
+  stamp.reserve(position_vars_.size());
+  for (const auto& position_var : position_vars_)
+    appendVariableStamp(stamp, *GetVariables(), position_var->GetName());
+
+  return values_cache_.get(stamp, [this]() {
+    Eigen::VectorXd velocity(static_cast<size_t>(n_dof_) * (position_vars_.size() - 1));
+    Eigen::VectorXd vals1 = GetVariables()->GetComponent(position_vars_[0]->GetName())->GetValues();
+    for (std::size_t ind = 0; ind < position_vars_.size() - 1; ind++)
+    {
+      // Every variable is fetched once and used for both of its steps
+      Eigen::VectorXd vals2 = GetVariables()->GetComponent(position_vars_[ind + 1]->GetName())->GetValues();
+      Eigen::VectorXd single_step = vals1 - vals2;
+      velocity.block(n_dof_ * static_cast<Eigen::Index>(ind), 0, n_dof_, 1) = single_step;
+      vals1.swap(vals2);
+    }
 
-  return velocity;
+    return velocity;
+  });
 }
 
 // Set the limits on the constraint values (in this case just the targets)
@@ -37,7 +37,7 @@ SquaredCost::SquaredCost(const ifopt::ConstraintSet::Ptr& constraint)
 }
 
 SquaredCost::SquaredCost(const ifopt::ConstraintSet::Ptr& constraint, const Eigen::Ref<const Eigen::VectorXd>& weights)
-  : CostTerm(constraint->GetName() + "_squared_cost")
+  : HessianCostTerm(constraint->GetName() + "_squared_cost")
   , constraint_(constraint)
   , n_constraints_(constraint->GetRows())
   , weights_(weights)
@@ -60,6 +60,33 @@ double SquaredCost::GetCost() const
 }
 
 void SquaredCost::FillJacobianBlock(std::string var_set, Jacobian& jac_block) const
+{
+  // Get the Jacobian Block from the constraint
+  Jacobian cnt_jac_block = GetConstraintJacobianBlock(var_set);
+
+  // Apply the chain rule. See doxygen for this class
+  Eigen::VectorXd error = constraint_->GetValues() - targets_;
+  jac_block = 2 * error.transpose().sparseView() * weights_.asDiagonal() * cnt_jac_block;
+}
+
+SquaredCost::Hessian SquaredCost::GetHessian() const
+{
+  // Gauss-Newton approximation from the jacobian of the whole constraint. See doxygen for this class
+  Jacobian cnt_jac = constraint_->GetJacobian();
+  Jacobian weighted_cnt_jac = weights_.asDiagonal() * cnt_jac;
+  Hessian hessian = 2 * (cnt_jac.transpose() * weighted_cnt_jac);
+  return hessian;
+}
+
+void SquaredCost::FillHessianBlock(std::string row_var_set, std::string col_var_set, Hessian& hessian_block) const
+{
+  Jacobian row_cnt_jac_block = GetConstraintJacobianBlock(row_var_set);
+  Jacobian col_cnt_jac_block = GetConstraintJacobianBlock(col_var_set);
+  Jacobian weighted_col_cnt_jac_block = weights_.asDiagonal() * col_cnt_jac_block;
+  hessian_block = 2 * (row_cnt_jac_block.transpose() * weighted_col_cnt_jac_block);
+}
+
+SquaredCost::Jacobian SquaredCost::GetConstraintJacobianBlock(const std::string& var_set) const
 {
   // Get a Jacobian block the size necessary for the constraint
   Jacobian cnt_jac_block;
@@ -72,12 +99,8 @@ void SquaredCost::FillJacobianBlock(std::string var_set, Jacobian& jac_block) co
   assert(var_size > 0);
   cnt_jac_block.resize(constraint_->GetRows(), var_size);
 
-  // Get the Jacobian Block from the constraint
   constraint_->FillJacobianBlock(var_set, cnt_jac_block);
-
-  // Apply the chain rule. See doxygen for this class
-  Eigen::VectorXd error = constraint_->GetValues() - targets_;
-  jac_block = 2 * error.transpose().sparseView() * weights_.asDiagonal() * cnt_jac_block;
+  return cnt_jac_block;
 }
 
 }  // namespace trajopt
@@ -214,6 +214,81 @@ TEST_F(CartesianPositionConstraintUnit, IgnoreVariables)  // NOLINT
   }
 }
 
+/**
+ * @brief Checks that the values and the jacobian are only computed again if the variables, the target pose or the
+ * differentiation method change
+ */
+TEST_F(CartesianPositionConstraintUnit, EvaluationCache)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("CartesianPositionConstraintUnit, EvaluationCache");
+
+  Eigen::VectorXd joint_position = Eigen::VectorXd::Ones(n_dof);
+  Eigen::Isometry3d target_pose = forward_kinematics->calcFwdKin(joint_position);
+  constraint->SetTargetPose(target_pose);
+  nlp.SetVariables(joint_position.data());
+
+  const auto& values_cache = constraint->GetValuesCache();
+  std::size_t value_hits = values_cache.getNumHits();
+  std::size_t value_misses = values_cache.getNumMisses();
+
+  // The second evaluation at the same values reuses the first, also if the variables are set to the same values
+  Eigen::VectorXd values = constraint->GetValues();
+  EXPECT_TRUE(constraint->GetValues() == values);
+  nlp.SetVariables(joint_position.data());
+  EXPECT_TRUE(constraint->GetValues() == values);
+  EXPECT_EQ(values_cache.getNumMisses(), value_misses + 1);
+  EXPECT_EQ(values_cache.getNumHits(), value_hits + 2);
+
+  // Moving the variables computes the values again
+  Eigen::VectorXd joint_position_mod = joint_position;
+  joint_position_mod[0] = 2.0;
+  nlp.SetVariables(joint_position_mod.data());
+  EXPECT_TRUE(constraint->GetValues().isApprox(constraint->CalcValues(joint_position_mod)));
+  EXPECT_EQ(values_cache.getNumMisses(), value_misses + 2);
+
+  // So does changing the target pose
+  Eigen::Isometry3d target_pose_mod = target_pose;
+  target_pose_mod.translate(Eigen::Vector3d(0.1, 0.0, 0.0));
+  constraint->SetTargetPose(target_pose_mod);
+  EXPECT_TRUE(constraint->GetValues().isApprox(constraint->CalcValues(joint_position_mod)));
+  EXPECT_EQ(values_cache.getNumMisses(), value_misses + 3);
+  EXPECT_EQ(values_cache.getNumHits(), value_hits + 2);
+
+  const auto& jacobian_cache = constraint->GetJacobianCache();
+  std::size_t jacobian_hits = jacobian_cache.getNumHits();
+  std::size_t jacobian_misses = jacobian_cache.getNumMisses();
+  auto fill_jacobian = [&]() {
+    trajopt::Jacobian jac_block(6, n_dof);
+    constraint->FillJacobianBlock("Joint_Position_0", jac_block);
+    return Eigen::MatrixXd(jac_block);
+  };
+  auto calc_jacobian = [&]() {
+    trajopt::Jacobian jac_block(6, n_dof);
+    constraint->CalcJacobianBlock(joint_position_mod, jac_block);
+    return Eigen::MatrixXd(jac_block);
+  };
+
+  // The jacobian is reused at the same values
+  Eigen::MatrixXd jacobian = fill_jacobian();
+  EXPECT_TRUE(jacobian.isApprox(calc_jacobian()));
+  EXPECT_TRUE(fill_jacobian() == jacobian);
+  EXPECT_EQ(jacobian_cache.getNumMisses(), jacobian_misses + 1);
+  EXPECT_EQ(jacobian_cache.getNumHits(), jacobian_hits + 1);
+
+  // Switching the differentiation method computes it again, with the new method
+  constraint->use_numeric_differentiation = !constraint->use_numeric_differentiation;
+  EXPECT_TRUE(fill_jacobian().isApprox(calc_jacobian()));
+  EXPECT_TRUE(fill_jacobian().isApprox(jacobian, 1e-3));
+  EXPECT_EQ(jacobian_cache.getNumMisses(), jacobian_misses + 2);
+  EXPECT_EQ(jacobian_cache.getNumHits(), jacobian_hits + 2);
+
+  // So does changing the target pose
+  constraint->SetTargetPose(target_pose);
+  EXPECT_TRUE(fill_jacobian().isApprox(calc_jacobian()));
+  EXPECT_EQ(jacobian_cache.getNumMisses(), jacobian_misses + 3);
+  EXPECT_EQ(jacobian_cache.getNumHits(), jacobian_hits + 2);
+}
+
 ////////////////////////////////////////////////////////////////////
 
 int main(int argc, char** argv)
@@ -7,6 +7,7 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 #include <tesseract_environment/core/utils.h>
 #include <tesseract_visualization/visualization.h>
 #include <tesseract_scene_graph/utils.h>
+#include <tesseract_collision/core/common.h>
 #include <ifopt/problem.h>
 #include <ifopt/ipopt_solver.h>
 TRAJOPT_IGNORE_WARNINGS_POP
@@ -179,6 +180,146 @@ TEST_F(CollisionUnit, IgnoreVariables)  // NOLINT
   }
 }
 
+/**
+ * @brief Checks that the values and the jacobian share the contacts computed at the same variable values
+ */
+TEST_F(CollisionUnit, CachedTerms)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("CollisionUnit, CachedTerms");
+
+  Eigen::VectorXd pos(2);
+  pos << -0.9, 0.01;
+  nlp.SetVariables(pos.data());
+  EXPECT_NEAR(constraint->GetValues()[0], 0.2, 1e-6);
+  EXPECT_NEAR(constraint->GetValues()[0], 0.2, 1e-6);
+
+  ifopt::ConstraintSet::Jacobian jac_block;
+  jac_block.resize(1, 2);
+  constraint->FillJacobianBlock("Joint_Position_0", jac_block);
+  constraint->FillJacobianBlock("Joint_Position_0", jac_block);
+  EXPECT_NEAR(jac_block.coeff(0, 0), 1.0, 1e-6);
+  EXPECT_NEAR(jac_block.coeff(0, 1), 0.0, 1e-6);
+
+  // The contacts are only computed by the first call, the jacobian reuses them
+  EXPECT_EQ(constraint->GetTermsCache().getNumMisses(), 1u);
+  EXPECT_EQ(constraint->GetTermsCache().getNumHits(), 2u);
+  EXPECT_EQ(constraint->GetJacobianCache().getNumMisses(), 1u);
+  EXPECT_EQ(constraint->GetJacobianCache().getNumHits(), 1u);
+
+  // The explicit evaluation gives the same results
+  EXPECT_NEAR(constraint->CalcValues(pos)[0], 0.2, 1e-6);
+  ifopt::ConstraintSet::Jacobian calc_jac_block;
+  calc_jac_block.resize(1, 2);
+  constraint->CalcJacobianBlock(pos, calc_jac_block);
+  EXPECT_TRUE(Eigen::MatrixXd(calc_jac_block).isApprox(Eigen::MatrixXd(jac_block)));
+
+  // Changing the variables computes the contacts again. All entries are stored, so the pattern does not change.
+  pos << -1.9, 0.01;
+  nlp.SetVariables(pos.data());
+  EXPECT_NEAR(constraint->GetValues()[0], 0.0, 1e-6);
+  constraint->FillJacobianBlock("Joint_Position_0", jac_block);
+  EXPECT_EQ(jac_block.nonZeros(), 2);
+  EXPECT_TRUE(Eigen::MatrixXd(jac_block).isZero());
+  EXPECT_EQ(constraint->GetTermsCache().getNumMisses(), 2u);
+}
+
+/** @brief Adds a box link fixed to the base link at the given position */
+void addBoxLink(Environment& env, const std::string& name, const Eigen::Vector3d& size, const Eigen::Vector3d& position)
+{
+  auto collision = std::make_shared<Collision>();
+  collision->geometry = std::make_shared<Box>(size.x(), size.y(), size.z());
+  collision->origin = Eigen::Isometry3d::Identity();
+
+  Link link(name);
+  link.collision.push_back(collision);
+
+  Joint joint(name + "-base_link");
+  joint.type = JointType::FIXED;
+  joint.parent_link_name = "base_link";
+  joint.child_link_name = name;
+  joint.parent_to_joint_origin_transform.translation() = position;
+
+  env.addLink(link, joint);
+}
+
+/**
+ * @brief Checks that the link pairs keep their rows while they are in contact, that the link pairs beyond the number of
+ * rows are dropped and that each row has the jacobian of its link pair
+ */
+TEST_F(CollisionUnit, LinkPairRows)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("CollisionUnit, LinkPairRows");
+
+  // Four boxes 0.05 away from the faces of the robot at (5, 0), away from the test box. They are smaller than the
+  // faces they are in front of, so their edges do not align.
+  addBoxLink(*env, "obstacle_px", Eigen::Vector3d(1, 0.5, 0.5), Eigen::Vector3d(6.05, 0, 0));
+  addBoxLink(*env, "obstacle_nx", Eigen::Vector3d(1, 0.5, 0.5), Eigen::Vector3d(3.95, 0, 0));
+  addBoxLink(*env, "obstacle_py", Eigen::Vector3d(0.5, 1, 0.5), Eigen::Vector3d(5, 1.05, 0));
+  addBoxLink(*env, "obstacle_ny", Eigen::Vector3d(0.5, 1, 0.5), Eigen::Vector3d(5, -1.05, 0));
+  const auto px = getObjectPairKey("boxbot_link", "obstacle_px");
+  const auto nx = getObjectPairKey("boxbot_link", "obstacle_nx");
+  const auto py = getObjectPairKey("boxbot_link", "obstacle_py");
+  const auto ny = getObjectPairKey("boxbot_link", "obstacle_ny");
+
+  // The contact manager of the evaluator is cloned from the environment, so it has to be created after the boxes
+  auto kin = env->getManipulatorManager()->getFwdKinematicSolver("manipulator");
+  auto adj_map = std::make_shared<tesseract_environment::AdjacencyMap>(
+      env->getSceneGraph(), kin->getActiveLinkNames(), env->getCurrentState()->link_transforms);
+  auto evaluator = std::make_shared<trajopt::DiscreteCollisionEvaluator>(
+      kin, env, adj_map, Eigen::Isometry3d::Identity(), trajopt::TrajOptCollisionConfig(0.1, 1));
+
+  Eigen::VectorXd pos(2);
+  pos << 5.02, 0.01;
+  auto var0 = std::make_shared<trajopt::JointPosition>(pos, kin->getJointNames(), "Joint_Position_1");
+  ifopt::Problem link_pair_nlp;
+  link_pair_nlp.AddVariableSet(var0);
+  auto link_pair_constraint = std::make_shared<trajopt::LinkPairCollisionConstraintIfopt>(evaluator, var0, 3);
+  link_pair_nlp.AddConstraintSet(link_pair_constraint);
+  EXPECT_EQ(link_pair_constraint->GetRows(), 3);
+  EXPECT_EQ(link_pair_constraint->GetBounds().size(), 3u);
+
+  auto check_rows = [&link_pair_nlp, &link_pair_constraint](const Eigen::Vector2d& point,
+                                                            const std::vector<ContactResultMap::key_type>& pairs,
+                                                            const Eigen::Vector3d& errors,
+                                                            const Eigen::Matrix<double, 3, 2>& jac) {
+    link_pair_nlp.SetVariables(point.data());
+    EXPECT_TRUE(link_pair_constraint->GetLinkPairs() == pairs);
+    EXPECT_TRUE(link_pair_constraint->GetValues().isApprox(errors, 1e-6));
+
+    ifopt::ConstraintSet::Jacobian jac_block;
+    jac_block.resize(3, 2);
+    link_pair_constraint->FillJacobianBlock("Joint_Position_1", jac_block);
+    EXPECT_TRUE(Eigen::MatrixXd(jac_block).isApprox(jac, 1e-6));
+  };
+
+  // All four link pairs are in contact. The rows are filled in order of decreasing error, obstacle_nx with the
+  // smallest error is dropped.
+  Eigen::Matrix<double, 3, 2> jac;
+  jac << 1, 0, 0, 1, 0, -1;
+  check_rows(Eigen::Vector2d(5.02, 0.01), { px, py, ny }, Eigen::Vector3d(0.07, 0.06, 0.04), jac);
+
+  // The order of the errors is reversed, but the link pairs keep their rows and obstacle_nx has no free row
+  check_rows(Eigen::Vector2d(4.98, -0.01), { px, py, ny }, Eigen::Vector3d(0.03, 0.04, 0.06), jac);
+
+  // obstacle_py is out of contact, so its row is free and taken by obstacle_nx
+  jac << 1, 0, -1, 0, 0, -1;
+  check_rows(Eigen::Vector2d(5, -0.06), { px, nx, ny }, Eigen::Vector3d(0.05, 0.05, 0.11), jac);
+
+  // The explicit evaluation assigns the rows starting from the current ones
+  Eigen::VectorXd calc_values = link_pair_constraint->CalcValues(Eigen::Vector2d(5.02, 0.01));
+  EXPECT_TRUE(calc_values.isApprox(Eigen::Vector3d(0.07, 0.03, 0.04), 1e-6));
+  ifopt::ConstraintSet::Jacobian calc_jac_block;
+  calc_jac_block.resize(3, 2);
+  link_pair_constraint->CalcJacobianBlock(Eigen::Vector2d(5.02, 0.01), calc_jac_block);
+  EXPECT_TRUE(Eigen::MatrixXd(calc_jac_block).isApprox(jac, 1e-6));
+
+  // Without contacts all rows are free and zero
+  check_rows(Eigen::Vector2d(8, 0.01),
+             std::vector<ContactResultMap::key_type>(3),
+             Eigen::Vector3d::Zero(),
+             Eigen::Matrix<double, 3, 2>::Zero());
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
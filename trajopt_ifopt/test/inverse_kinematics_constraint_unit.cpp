@@ -171,6 +171,53 @@ TEST_F(InverseKinematicsConstraintUnit, IgnoreVariables)  // NOLINT
   }
 }
 
+/**
+ * @brief Checks that the values are only computed again if one of the variables or the target pose change
+ */
+TEST_F(InverseKinematicsConstraintUnit, EvaluationCache)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("InverseKinematicsConstraintUnit, EvaluationCache");
+
+  Eigen::VectorXd joint_position_single = Eigen::VectorXd::Zero(n_dof);
+  auto target_pose = forward_kinematics->calcFwdKin(joint_position_single);
+  constraint->SetTargetPose(target_pose);
+  Eigen::VectorXd joint_position = Eigen::VectorXd::Zero(n_dof * 2);
+  nlp.SetVariables(joint_position.data());
+
+  const auto& values_cache = constraint->GetValuesCache();
+  std::size_t hits = values_cache.getNumHits();
+  std::size_t misses = values_cache.getNumMisses();
+
+  // The second evaluation at the same values reuses the first, also if the variables are set to the same values
+  Eigen::VectorXd values = constraint->GetValues();
+  EXPECT_TRUE(constraint->GetValues() == values);
+  nlp.SetVariables(joint_position.data());
+  EXPECT_TRUE(constraint->GetValues() == values);
+  EXPECT_EQ(values_cache.getNumMisses(), misses + 1);
+  EXPECT_EQ(values_cache.getNumHits(), hits + 2);
+
+  // Moving the constraint variable or the seed computes the values again
+  Eigen::VectorXd joint_position_mod = joint_position;
+  joint_position_mod[0] = 0.1;
+  nlp.SetVariables(joint_position_mod.data());
+  EXPECT_TRUE(
+      constraint->GetValues().isApprox(constraint->CalcValues(joint_position_mod.head(n_dof), joint_position_single)));
+  EXPECT_EQ(values_cache.getNumMisses(), misses + 2);
+
+  joint_position_mod[n_dof] = 0.1;
+  nlp.SetVariables(joint_position_mod.data());
+  EXPECT_TRUE(constraint->GetValues().isApprox(
+      constraint->CalcValues(joint_position_mod.head(n_dof), joint_position_mod.tail(n_dof))));
+  EXPECT_EQ(values_cache.getNumMisses(), misses + 3);
+
+  // So does changing the target pose
+  constraint->SetTargetPose(forward_kinematics->calcFwdKin(joint_position_mod.head(n_dof)));
+  EXPECT_TRUE(constraint->GetValues().isApprox(
+      constraint->CalcValues(joint_position_mod.head(n_dof), joint_position_mod.tail(n_dof))));
+  EXPECT_EQ(values_cache.getNumMisses(), misses + 4);
+  EXPECT_EQ(values_cache.getNumHits(), hits + 2);
+}
+
 ////////////////////////////////////////////////////////////////////
 
 int main(int argc, char** argv)
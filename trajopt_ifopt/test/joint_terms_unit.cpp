@@ -2,8 +2,10 @@
 TRAJOPT_IGNORE_WARNINGS_PUSH
 #include <ctime>
 #include <gtest/gtest.h>
+#include <ifopt/problem.h>
 TRAJOPT_IGNORE_WARNINGS_POP
 #include <trajopt_ifopt/constraints/joint_position_constraint.h>
+#include <trajopt_ifopt/constraints/joint_velocity_constraint.h>
 #include <console_bridge/console.h>
 
 using namespace trajopt;
@@ -37,6 +39,43 @@ TEST(JointTermsUnit, joint_pos_constraint_1)  // NOLINT
   EXPECT_EQ(position_cnt.GetBounds().size(), targets.size() * static_cast<Eigen::Index>(position_vars.size()));
 }
 
+/**
+ * @brief Tests that the values of the Joint Velocity Constraint are only computed once per point
+ */
+TEST(JointTermsUnit, joint_vel_constraint_memoization)  // NOLINT
+{
+  CONSOLE_BRIDGE_logDebug("JointTermsUnit, joint_vel_constraint_memoization");
+
+  ifopt::Problem nlp;
+  std::vector<JointPosition::ConstPtr> position_vars;
+  std::vector<std::string> joint_names(2, "name");
+  for (int ind = 0; ind < 3; ind++)
+  {
+    auto var = std::make_shared<JointPosition>(Eigen::VectorXd::Constant(2, ind), joint_names, to_string(ind));
+    position_vars.push_back(var);
+    nlp.AddVariableSet(var);
+  }
+  auto vel_cnt = std::make_shared<JointVelConstraint>(Eigen::VectorXd::Zero(2), position_vars);
+  nlp.AddConstraintSet(vel_cnt);
+
+  // Evaluating the constraints and their jacobian at the same point computes the values once
+  Eigen::VectorXd values = vel_cnt->GetValues();
+  EXPECT_TRUE(values.isApprox(Eigen::VectorXd::Constant(4, -1)));
+  Eigen::VectorXd x = nlp.GetVariableValues();
+  nlp.EvaluateConstraints(x.data());
+  nlp.GetJacobianOfConstraints();
+  EXPECT_EQ(vel_cnt->GetValuesCache().getNumMisses(), 1u);
+  EXPECT_EQ(vel_cnt->GetValuesCache().getNumHits(), 1u);
+
+  // Setting the variables invalidates the values, even if only one variable changes
+  x << 0, 0, 1, 1, 4, 4;
+  nlp.SetVariables(x.data());
+  values = vel_cnt->GetValues();
+  EXPECT_TRUE(values.isApprox(Eigen::Vector4d(-1, -1, -3, -3)));
+  EXPECT_EQ(vel_cnt->GetValuesCache().getNumMisses(), 2u);
+  EXPECT_EQ(vel_cnt->GetValuesCache().getNumHits(), 1u);
+}
+
 ////////////////////////////////////////////////////////////////////
 
 int main(int argc, char** argv)
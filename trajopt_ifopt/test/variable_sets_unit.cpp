@@ -30,8 +30,13 @@ TEST(VariableSetsUnit, joint_position_1)  // NOLINT
   // Check that setting variables works
   Eigen::VectorXd changed(10);
   changed << 10, 11, 12, 13, 14, 15, 16, 17, 18, 19;
+  std::size_t version = position_var.GetVersion();
   position_var.SetVariables(changed);
   EXPECT_TRUE(changed.isApprox(position_var.GetValues()));
+  EXPECT_NE(position_var.GetVersion(), version);
+  version = position_var.GetVersion();
+  position_var.SetVariables(changed);
+  EXPECT_EQ(position_var.GetVersion(), version);
 
   // Check that setting bounds works
   ifopt::Bounds bounds(-0.1234, 0.5678);
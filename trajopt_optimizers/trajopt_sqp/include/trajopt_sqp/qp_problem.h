@@ -27,8 +27,10 @@
 #define TRAJOPT_SQP_INCLUDE_QP_PROBLEM_H_
 
 #include <memory>
+#include <vector>
 #include <trajopt_sqp/types.h>
 #include <ifopt/problem.h>
+#include <trajopt_ifopt/costs/hessian_cost_term.h>
 
 namespace trajopt_sqp
 {
@@ -46,19 +48,27 @@ public:
   using ConstPtr = std::shared_ptr<const QPProblem>;
 
   /** @brief Sets up the problem and initializes matrices
+   *
+   * This also computes the sparsity structure of the constraint matrix from the current constraint jacobian, so the
+   * following calls to linearizeConstraints() only have to copy the values of the jacobian.
    * @param nlp
    */
   void init(ifopt::Problem& nlp);
   /** @brief Run the full convexification routine. If in doubt, init(nlp) then convexify() */
   void convexify();
 
-  /** @brief Called by convexify() - helper that updates the cost hessian (Currently does nothing since IFOPT doesn't
-   * support Hessians*/
+  /** @brief Called by convexify() - helper that updates the cost hessian from the costs derived from
+   * trajopt::HessianCostTerm (e.g. the Gauss-Newton hessian of trajopt::SquaredCost). All other costs are modeled
+   * linearly since IFOPT doesn't support Hessians*/
   void updateHessian();
-  /** @brief Called by convexify() - helper that updates the cost gradient including slack variables */
+  /** @brief Called by convexify() - helper that updates the cost gradient including slack variables. This has to be
+   * called after updateHessian(), since the quadratic model is centered at the current point.*/
   void updateGradient();
   /** @brief Called by convexify() - helper that linearizes the constraints about the current point, storing the
-   * jacobian as the constraint matrix and adding slack variables.*/
+   * jacobian as the constraint matrix and adding slack variables.
+   *
+   * The values of the jacobian are written into the existing constraint matrix. Its structure is only rebuilt if the
+   * nonzero pattern of the jacobian differs from the previous one.*/
   void linearizeConstraints();
   /** @brief Called by convexify() - helper that updates the NLP constraint bounds (top section) */
   void updateNLPConstraintBounds();
@@ -67,7 +77,11 @@ public:
   /** @brief Called by convexify() - helper that updates the slack variable bounds (bottom section) */
   void updateSlackVariableBounds();
 
-  /** @brief Evaluates the cost of the convexified function (ie using the stored gradient and hessian) at var_vals
+  /** @brief Evaluates the merit of the convexified problem (ie using the stored gradient and hessian) at var_vals.
+   *
+   * This is the quadratic model f(x0) + g^T * d + 1/2 * d^T * H * d of the costs with d = x - x0, plus the weighted
+   * slack variables. With the smallest slack variables it equals the exact merit at the values x0 it was convexified
+   * about, so the improvement of the model can be compared with the improvement of the exact merit.
    * @param var_vals Point at which the convex cost is calculated. Should be size num_qp_vars
    */
   double evaluateTotalConvexCost(const Eigen::Ref<const Eigen::VectorXd>& var_vals);
@@ -110,6 +124,12 @@ public:
 
   const Eigen::Ref<const Eigen::VectorXd> getBoxSize() { return box_size_; };
   const Eigen::Ref<const Eigen::VectorXd> getConstraintMeritCoeff() { return constraint_merit_coeff_; };
+  /**
+   * @brief Sets the coefficients of the constraint violations in the merit, which are applied to the slack variables
+   * by the next convexify()
+   * @param merit_coeff The coefficient of every NLP constraint
+   */
+  void setConstraintMeritCoeff(const Eigen::Ref<const Eigen::VectorXd>& merit_coeff);
 
   const Eigen::Ref<const Eigen::SparseMatrix<double>> getHessian() { return hessian_; };
   const Eigen::Ref<const Eigen::VectorXd> getGradient() { return gradient_; };
@@ -126,6 +146,8 @@ protected:
   Eigen::Index num_qp_vars_;
   Eigen::Index num_qp_cnts_;
   std::vector<ConstraintType> constraint_types_;
+  /** @brief The costs of the NLP which provide a hessian */
+  std::vector<trajopt::HessianCostTerm::ConstPtr> hessian_costs_;
 
   /** @brief Box size - constraint is set at current_val +/- box_size */
   Eigen::VectorXd box_size_;
@@ -134,9 +156,34 @@ protected:
   Eigen::SparseMatrix<double> hessian_;
   Eigen::VectorXd gradient_;
 
+  /** @brief The values of the NLP variables the problem was convexified about */
+  Eigen::VectorXd x_initial_;
+  /** @brief The total cost of the NLP at x_initial_ */
+  double cost_initial_value_{ 0 };
+  /** @brief The gradient of the NLP costs at x_initial_ */
+  Eigen::VectorXd cost_gradient_;
+
   Eigen::SparseMatrix<double> constraint_matrix_;
   Eigen::VectorXd bounds_lower_;
   Eigen::VectorXd bounds_upper_;
+
+  /** @brief The constraint jacobian the structure of the constraint matrix was built for. Only its pattern is used. */
+  ifopt::ConstraintSet::Jacobian constraint_jac_pattern_;
+  /** @brief The index in the values of the constraint matrix of every nonzero of the constraint jacobian */
+  std::vector<Eigen::Index> constraint_jac_value_indices_;
+
+  /**
+   * @brief Builds the constraint matrix (jacobian, slack variables and variable limits) and the mapping from the
+   * nonzeros of the jacobian to the values of the constraint matrix
+   * @param jac The compressed constraint jacobian
+   */
+  void initConstraintMatrixStructure(const ifopt::ConstraintSet::Jacobian& jac);
+
+  /**
+   * @brief Checks if the constraint matrix was built for the nonzero pattern of a jacobian
+   * @param jac The compressed constraint jacobian
+   */
+  bool hasConstraintJacobianPattern(const ifopt::ConstraintSet::Jacobian& jac) const;
 };
 
 }  // namespace trajopt_sqp
@@ -59,7 +59,8 @@ public:
   QPSolver& operator=(QPSolver&&) = default;
 
   /**
-   * @brief Initializes the QP solver. This is called prior to any of the update methods
+   * @brief Initializes the QP solver. This is called prior to any of the update methods. Updates after the first solve
+   * should keep the solver set up, so a sequence of QPs of the same size only pays for the changed values.
    * @param num_vars Number of QP variables
    * @param num_cnts Number of QP constraints
    * @return true if successful
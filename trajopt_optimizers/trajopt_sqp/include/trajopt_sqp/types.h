@@ -93,7 +93,7 @@ struct SQPResults
   double best_exact_merit{ std::numeric_limits<double>::max() };
   /** @brief The cost achieved this iteration */
   double new_exact_merit{ std::numeric_limits<double>::max() };
-  /** @brief The lowest convexified cost ever achieved */
+  /** @brief The convexified cost at the values it was convexified about, which is their exact merit */
   double best_approx_merit{ std::numeric_limits<double>::max() };
   /** @brief The convexified cost achieved this iteration */
   double new_approx_merit{ std::numeric_limits<double>::max() };
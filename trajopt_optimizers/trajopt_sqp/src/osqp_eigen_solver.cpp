@@ -62,13 +62,20 @@ bool OSQPEigenSolver::clear()
   solver_.clearSolver();
   solver_.data()->clearHessianMatrix();
   solver_.data()->clearLinearConstraintsMatrix();
+  solver_status_ = QPSolverStatus::UNITIALIZED;
   return true;
 }
 
 bool OSQPEigenSolver::solve()
 {
-  // In order to call initSolver, everything must have already been set, so we call it right before solving
-  solver_.initSolver();
+  // In order to call initSolver, everything must have already been set, so we call it right before the first solve.
+  // Afterwards the updates are passed to the workspace, which is kept together with the last solution to warm start.
+  if (!solver_.isInitialized() && !solver_.initSolver())
+  {
+    solver_status_ = QPSolverStatus::QP_ERROR;
+    return false;
+  }
+
   if (solver_.solve())
     return true;
 
@@ -123,14 +130,13 @@ Eigen::VectorXd OSQPEigenSolver::getSolution()
 
 bool OSQPEigenSolver::updateHessianMatrix(const Hessian& hessian)
 {
-  // Clean up values close to 0
-  Hessian cleaned = hessian.pruned(1e-7);
-
+  // The matrix is not pruned, so its sparsity pattern stays the same and the workspace only has to update the values.
+  // OsqpEigen sets the solver up again if the pattern changes.
   if (solver_.isInitialized())
     return solver_.updateHessianMatrix(hessian);
 
   solver_.data()->clearHessianMatrix();
-  return solver_.data()->setHessianMatrix(cleaned);
+  return solver_.data()->setHessianMatrix(hessian);
 }
 
 bool OSQPEigenSolver::updateGradient(const Eigen::Ref<const Eigen::VectorXd>& gradient)
@@ -174,13 +180,12 @@ bool OSQPEigenSolver::updateLinearConstraintsMatrix(const Jacobian& linearConstr
   assert(num_cnts_ == linearConstraintsMatrix.rows());
   assert(num_vars_ == linearConstraintsMatrix.cols());
 
-  solver_.data()->clearLinearConstraintsMatrix();
-  Jacobian cleaned = linearConstraintsMatrix.pruned(1e-7);
-
+  // Not pruned for the same reason as the hessian
   if (solver_.isInitialized())
     return solver_.updateLinearConstraintsMatrix(linearConstraintsMatrix);
 
-  return solver_.data()->setLinearConstraintsMatrix(cleaned);
+  solver_.data()->clearLinearConstraintsMatrix();
+  return solver_.data()->setLinearConstraintsMatrix(linearConstraintsMatrix);
 }
 
 }  // namespace trajopt_sqp
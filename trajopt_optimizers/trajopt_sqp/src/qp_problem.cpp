@@ -24,6 +24,7 @@
  * limitations under the License.
  */
 #include <trajopt_sqp/qp_problem.h>
+#include <algorithm>
 #include <iostream>
 
 namespace trajopt_sqp
@@ -74,13 +75,34 @@ void QPProblem::init(ifopt::Problem& nlp)
     }
   }
 
+  // Find the costs which provide a hessian, all other costs are modeled linearly
+  hessian_costs_.clear();
+  for (const auto& cost : nlp_->GetCosts().GetComponents())
+  {
+    auto hessian_cost = std::dynamic_pointer_cast<const trajopt::HessianCostTerm>(cost);
+    if (hessian_cost)
+      hessian_costs_.push_back(hessian_cost);
+  }
+
   // Initialize the constraint bounds
   bounds_lower_ = Eigen::VectorXd::Ones(num_qp_cnts_) * -INFINITY;
   bounds_upper_ = Eigen::VectorXd::Ones(num_qp_cnts_) * INFINITY;
+
+  // Initialize the matrices, only their values are updated during the iterations
+  hessian_.resize(num_qp_vars_, num_qp_vars_);
+  gradient_ = Eigen::VectorXd::Zero(num_qp_vars_);
+
+  ifopt::ConstraintSet::Jacobian jac = nlp_->GetJacobianOfConstraints();
+  jac.makeCompressed();
+  initConstraintMatrixStructure(jac);
 }
 
 void QPProblem::convexify()
 {
+  // The quadratic model of the costs is centered at the current values
+  x_initial_ = nlp_->GetVariableValues();
+  cost_initial_value_ = nlp_->EvaluateCostFunction(x_initial_.data());
+
   updateHessian();
 
   updateGradient();
@@ -97,9 +119,17 @@ void QPProblem::convexify()
 void QPProblem::updateHessian()
 {
   ////////////////////////////////////////////////////////
-  // Set the Hessian (empty for now)
+  // Set the Hessian of the NLP costs (the slack variables are only in the linear term)
   ////////////////////////////////////////////////////////
-  hessian_.resize(num_qp_vars_, num_qp_vars_);
+  if (hessian_costs_.empty())
+    return;
+
+  trajopt::HessianCostTerm::Hessian nlp_hessian(num_nlp_vars_, num_nlp_vars_);
+  for (const auto& cost : hessian_costs_)
+    nlp_hessian += cost->GetHessian();
+
+  hessian_ = nlp_hessian;
+  hessian_.conservativeResize(num_qp_vars_, num_qp_vars_);
 }
 
 void QPProblem::updateGradient()
@@ -107,10 +137,20 @@ void QPProblem::updateGradient()
   ////////////////////////////////////////////////////////
   // Set the gradient of the NLP costs
   ////////////////////////////////////////////////////////
-  gradient_ = Eigen::VectorXd::Zero(num_qp_vars_);
+  // The cost jacobian is a single row, so its nonzeros are scattered into the gradient
+  cost_gradient_ = Eigen::VectorXd::Zero(num_nlp_vars_);
   ifopt::ConstraintSet::Jacobian cost_jac = nlp_->GetJacobianOfCosts();
-  if (cost_jac.nonZeros() > 0)
-    gradient_.topRows(num_nlp_vars_) = cost_jac.toDense().transpose();
+  for (int k = 0; k < cost_jac.outerSize(); ++k)
+  {
+    for (ifopt::ConstraintSet::Jacobian::InnerIterator it(cost_jac, k); it; ++it)
+      cost_gradient_[it.col()] += it.value();
+  }
+
+  // The quadratic model 1/2 * (x - x0)^T * H * (x - x0) + g^T * (x - x0) is centered at the current values x0, which
+  // adds -H * x0 to the linear term of the QP. Its constant is added back in evaluateTotalConvexCost.
+  gradient_.topRows(num_nlp_vars_) = cost_gradient_;
+  if (hessian_.nonZeros() > 0)
+    gradient_.topRows(num_nlp_vars_) -= hessian_.topLeftCorner(num_nlp_vars_, num_nlp_vars_) * x_initial_;
 
   ////////////////////////////////////////////////////////
   // Set the gradient of the constraint slack variables
@@ -137,17 +177,31 @@ void QPProblem::updateGradient()
 
 void QPProblem::linearizeConstraints()
 {
-  Eigen::SparseMatrix<double> jac = nlp_->GetJacobianOfConstraints();
+  ifopt::ConstraintSet::Jacobian jac = nlp_->GetJacobianOfConstraints();
+  jac.makeCompressed();
+
+  // Constraints may store different entries at different points, in which case the structure has to be rebuilt
+  if (!hasConstraintJacobianPattern(jac))
+    initConstraintMatrixStructure(jac);
+
+  // The slack variables and variable limits do not change, so only the values of the jacobian are copied
+  double* values = constraint_matrix_.valuePtr();
+  const double* jac_values = jac.valuePtr();
+  for (std::size_t k = 0; k < constraint_jac_value_indices_.size(); ++k)
+    values[constraint_jac_value_indices_[k]] = jac_values[k];
+}
 
+void QPProblem::initConstraintMatrixStructure(const ifopt::ConstraintSet::Jacobian& jac)
+{
   // Create triplet list of nonzero constraints
   using T = Eigen::Triplet<double>;
   std::vector<T> tripletList;
-  tripletList.reserve(static_cast<std::size_t>(jac.nonZeros() + num_qp_vars_) * 3);
+  tripletList.reserve(static_cast<std::size_t>(jac.nonZeros() + 2 * num_qp_vars_));
 
   // Add jacobian to triplet list
   for (int k = 0; k < jac.outerSize(); ++k)
   {
-    for (Eigen::SparseMatrix<double>::InnerIterator it(jac, k); it; ++it)
+    for (ifopt::ConstraintSet::Jacobian::InnerIterator it(jac, k); it; ++it)
     {
       tripletList.emplace_back(it.row(), it.col(), it.value());
     }
@@ -173,12 +227,41 @@ void QPProblem::linearizeConstraints()
   // Add a diagonal matrix for the variable limits (including slack variables since the merit coeff is only applied in
   // the cost) below the actual constraints
   for (Eigen::Index i = 0; i < num_qp_vars_; i++)
-    tripletList.emplace_back(i + jac.rows(), i, 1);
+    tripletList.emplace_back(i + num_nlp_cnts_, i, 1);
 
-  // Insert the triplet list into the sparse matrix
+  // Insert the triplet list into the sparse matrix. Explicit zeros of the jacobian are kept, so its entries never
+  // overlap the slack variables or the variable limits.
   constraint_matrix_.resize(num_qp_cnts_, num_qp_vars_);
-  constraint_matrix_.reserve(jac.nonZeros() + num_qp_vars_);
   constraint_matrix_.setFromTriplets(tripletList.begin(), tripletList.end());
+
+  // Find the entry of every nonzero of the jacobian in the column major storage of the constraint matrix
+  const int* outer = constraint_matrix_.outerIndexPtr();
+  const int* inner = constraint_matrix_.innerIndexPtr();
+  constraint_jac_value_indices_.clear();
+  constraint_jac_value_indices_.reserve(static_cast<std::size_t>(jac.nonZeros()));
+  for (int k = 0; k < jac.outerSize(); ++k)
+  {
+    for (ifopt::ConstraintSet::Jacobian::InnerIterator it(jac, k); it; ++it)
+    {
+      const int* column_begin = inner + outer[it.col()];
+      const int* column_end = inner + outer[it.col() + 1];
+      const int* entry = std::lower_bound(column_begin, column_end, it.row());
+      assert(entry != column_end && *entry == it.row());
+      constraint_jac_value_indices_.push_back(entry - inner);
+    }
+  }
+
+  constraint_jac_pattern_ = jac;
+}
+
+bool QPProblem::hasConstraintJacobianPattern(const ifopt::ConstraintSet::Jacobian& jac) const
+{
+  const ifopt::ConstraintSet::Jacobian& pattern = constraint_jac_pattern_;
+  if (jac.rows() != pattern.rows() || jac.cols() != pattern.cols() || jac.nonZeros() != pattern.nonZeros())
+    return false;
+
+  return std::equal(jac.outerIndexPtr(), jac.outerIndexPtr() + jac.outerSize() + 1, pattern.outerIndexPtr()) &&
+         std::equal(jac.innerIndexPtr(), jac.innerIndexPtr() + jac.nonZeros(), pattern.innerIndexPtr());
 }
 
 void QPProblem::updateNLPConstraintBounds()
@@ -265,9 +348,15 @@ void QPProblem::updateSlackVariableBounds()
 
 double QPProblem::evaluateTotalConvexCost(const Eigen::Ref<const Eigen::VectorXd>& var_vals)
 {
-  double result_quad = var_vals.transpose() * hessian_ * var_vals;
-  double result_lin = gradient_.transpose() * var_vals;
-  return result_quad + result_lin;
+  // The quadratic model of the costs about x_initial_
+  Eigen::VectorXd delta = var_vals.head(num_nlp_vars_) - x_initial_;
+  double result_quad = 0.5 * delta.dot(hessian_.topLeftCorner(num_nlp_vars_, num_nlp_vars_) * delta);
+  double result_lin = cost_gradient_.dot(delta);
+
+  // The slack variables are only in the linear term
+  Eigen::Index num_slack_vars = num_qp_vars_ - num_nlp_vars_;
+  double result_slack = gradient_.tail(num_slack_vars).dot(var_vals.tail(num_slack_vars));
+  return cost_initial_value_ + result_lin + result_quad + result_slack;
 }
 
 Eigen::VectorXd QPProblem::evaluateConvexCosts(const Eigen::Ref<const Eigen::VectorXd>& /*var_vals*/)
@@ -303,6 +392,12 @@ Eigen::VectorXd QPProblem::getExactConstraintViolations()
   return violation;
 }
 
+void QPProblem::setConstraintMeritCoeff(const Eigen::Ref<const Eigen::VectorXd>& merit_coeff)
+{
+  assert(merit_coeff.size() == num_nlp_cnts_);
+  constraint_merit_coeff_ = merit_coeff;
+}
+
 void QPProblem::scaleBoxSize(double& scale) { box_size_ = box_size_ * scale; }
 
 void QPProblem::setBoxSize(const Eigen::Ref<const Eigen::VectorXd>& box_size)
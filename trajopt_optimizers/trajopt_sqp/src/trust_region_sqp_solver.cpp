@@ -48,10 +48,21 @@ bool TrustRegionSQPSolver::init(ifopt::Problem& nlp)
 
   qp_problem->init(nlp);
 
+  // The QP keeps its size in every iteration, so the solver is only set up once. The convex iterations update its
+  // values, which keeps the solver workspace and lets it warm start from the previous solution.
+  qp_solver->clear();
+  qp_solver->init(qp_problem->getNumQPVars(), qp_problem->getNumQPConstraints());
+
   // Initialize optimization parameters
   results_ = SQPResults(nlp.GetNumberOfOptimizationVariables(), nlp.GetNumberOfConstraints());
   results_.box_size = Eigen::VectorXd::Ones(nlp.GetNumberOfOptimizationVariables()) * params.initial_trust_box_size;
   qp_problem->setBoxSize(results_.box_size);
+
+  // The improvement of the first step is measured against the exact merit of the initial values
+  results_.best_var_vals = nlp.GetVariableValues();
+  results_.best_constraint_violations = qp_problem->getExactConstraintViolations();
+  results_.best_exact_merit = nlp.EvaluateCostFunction(results_.best_var_vals.data()) +
+                              results_.best_constraint_violations.dot(results_.merit_error_coeffs);
   return true;
 }
 
@@ -78,14 +89,13 @@ void TrustRegionSQPSolver::Solve(ifopt::Problem& nlp)
     // ---------------------------
     for (int convex_iteration = 0; convex_iteration < 100; convex_iteration++)
     {
+      // Convexify the costs and constraints around their current values
+      qp_problem->setConstraintMeritCoeff(results_.merit_error_coeffs);
       qp_problem->convexify();
 
-      // TODO: Look into not clearing and reinitializing the workspace each iteration. It should be as simple as
-      // removing this
-      qp_solver->clear();
+      // The model equals the exact merit at the values it was convexified about, which are the best values
+      results_.best_approx_merit = results_.best_exact_merit;
 
-      // Convexify the costs and constraints around their current values
-      qp_solver->init(qp_problem->getNumQPVars(), qp_problem->getNumQPConstraints());
       qp_solver->updateHessianMatrix(qp_problem->getHessian());
       qp_solver->updateGradient(qp_problem->getGradient());
       qp_solver->updateLinearConstraintsMatrix(qp_problem->getConstraintMatrix());
@@ -152,7 +162,8 @@ void TrustRegionSQPSolver::Solve(ifopt::Problem& nlp)
         {
           results_.best_var_vals = results_.new_var_vals;
           results_.best_exact_merit = results_.new_exact_merit;
-          results_.best_approx_merit = results_.best_approx_merit;
+          results_.best_constraint_violations = results_.new_constraint_violations;
+          nlp.SetVariables(results_.best_var_vals.data());
 
           qp_problem->scaleBoxSize(params.trust_expand_ratio);
           qp_problem->updateNLPVariableBounds();
@@ -216,6 +227,10 @@ void TrustRegionSQPSolver::Solve(ifopt::Problem& nlp)
     results_.box_size = Eigen::VectorXd::Ones(results_.box_size.size()) *
                         fmax(results_.box_size[0], params.min_trust_box_size / params.trust_shrink_ratio * 1.5);
 
+    // The exact merit of the best values changes with the penalties
+    results_.best_exact_merit = nlp.EvaluateCostFunction(results_.best_var_vals.data()) +
+                                results_.best_constraint_violations.dot(results_.merit_error_coeffs);
+
   }  // Penalty adjustment loop
 
   // Final Cleanup
@@ -259,10 +274,14 @@ SQPStatus TrustRegionSQPSolver::stepOptimization(ifopt::Problem& nlp)
     {
       results_.best_var_vals = results_.new_var_vals;
       results_.best_exact_merit = results_.new_exact_merit;
-      results_.best_approx_merit = results_.new_approx_merit;
       results_.best_constraint_violations = results_.new_constraint_violations;
       nlp_->SetVariables(results_.best_var_vals.data());
     }
+    else
+    {
+      // The trust region is centered at the best values
+      nlp_->SetVariables(results_.best_var_vals.data());
+    }
     if (SUPER_DEBUG_MODE)
       results_.print();
   }
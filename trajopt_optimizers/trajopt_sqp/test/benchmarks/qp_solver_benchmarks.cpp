@@ -0,0 +1,138 @@
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_sqp/osqp_eigen_solver.h>
+
+using namespace trajopt_sqp;
+
+/**
+ * @brief A sequence of QPs of the same size and sparsity pattern, like the ones of the convex iterations of the SQP
+ *
+ * The problem mimics a joint velocity cost on n_vars values: the hessian and the velocity constraints are banded, and
+ * the trust region bounds every variable. Every iteration changes the values of the matrices, the gradient and the
+ * center of the trust region.
+ */
+class QPSequence
+{
+public:
+  QPSequence(Eigen::Index n_vars, int n_iterations) : n_vars(n_vars), n_cnts(2 * n_vars - 1)
+  {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dist(-1, 1);
+
+    Eigen::VectorXd center = Eigen::VectorXd::Zero(n_vars);
+    for (int k = 0; k < n_iterations; ++k)
+    {
+      // Hessian: w * D^T * D + 1e-3 * I, where D takes the differences of neighboring values
+      double w = 1 + 0.1 * dist(gen);
+      std::vector<Eigen::Triplet<double>> hessian_triplets;
+      for (Eigen::Index i = 0; i < n_vars; ++i)
+      {
+        double neighbors = (i == 0 || i == n_vars - 1) ? 1 : 2;
+        hessian_triplets.emplace_back(i, i, w * neighbors + 1e-3);
+        if (i + 1 < n_vars)
+        {
+          hessian_triplets.emplace_back(i, i + 1, -w);
+          hessian_triplets.emplace_back(i + 1, i, -w);
+        }
+      }
+      Hessian hessian(n_vars, n_vars);
+      hessian.setFromTriplets(hessian_triplets.begin(), hessian_triplets.end());
+      hessians.push_back(hessian);
+
+      // Constraints: the scaled differences of neighboring values followed by the trust region of every value
+      std::vector<Eigen::Triplet<double>> cnt_triplets;
+      for (Eigen::Index i = 0; i + 1 < n_vars; ++i)
+      {
+        double scale = 1 + 0.1 * dist(gen);
+        cnt_triplets.emplace_back(i, i, -scale);
+        cnt_triplets.emplace_back(i, i + 1, scale);
+      }
+      for (Eigen::Index i = 0; i < n_vars; ++i)
+        cnt_triplets.emplace_back(n_vars - 1 + i, i, 1);
+      Jacobian constraint_matrix(n_cnts, n_vars);
+      constraint_matrix.setFromTriplets(cnt_triplets.begin(), cnt_triplets.end());
+      constraint_matrices.push_back(constraint_matrix);
+
+      Eigen::VectorXd gradient(n_vars);
+      for (Eigen::Index i = 0; i < n_vars; ++i)
+        gradient(i) = dist(gen);
+      gradients.push_back(gradient);
+
+      // The trust region moves by a small random step in every iteration, so the QPs stay feasible
+      for (Eigen::Index i = 0; i < n_vars; ++i)
+        center(i) += 0.05 * dist(gen);
+      Eigen::VectorXd lower(n_cnts);
+      Eigen::VectorXd upper(n_cnts);
+      lower.head(n_vars - 1).setConstant(-1);
+      upper.head(n_vars - 1).setConstant(1);
+      lower.tail(n_vars) = center.array() - 0.1;
+      upper.tail(n_vars) = center.array() + 0.1;
+      bounds_lower.push_back(lower);
+      bounds_upper.push_back(upper);
+    }
+  }
+
+  /** @brief Pass the QP of an iteration to the solver */
+  void update(QPSolver& solver, std::size_t iteration) const
+  {
+    solver.updateHessianMatrix(hessians[iteration]);
+    solver.updateGradient(gradients[iteration]);
+    solver.updateLinearConstraintsMatrix(constraint_matrices[iteration]);
+    solver.updateBounds(bounds_lower[iteration], bounds_upper[iteration]);
+  }
+
+  Eigen::Index n_vars;
+  Eigen::Index n_cnts;
+  std::vector<Hessian> hessians;
+  std::vector<Jacobian> constraint_matrices;
+  std::vector<Eigen::VectorXd> gradients;
+  std::vector<Eigen::VectorXd> bounds_lower;
+  std::vector<Eigen::VectorXd> bounds_upper;
+};
+
+/** @brief Sets the solver up again for every QP, which is what the TrustRegionSQPSolver used to do */
+static void BM_OSQP_SEQUENCE_REINIT(benchmark::State& state)
+{
+  QPSequence sequence(state.range(0), static_cast<int>(state.range(1)));
+  for (auto _ : state)
+  {
+    OSQPEigenSolver solver;
+    for (std::size_t k = 0; k < sequence.hessians.size(); ++k)
+    {
+      solver.clear();
+      solver.init(sequence.n_vars, sequence.n_cnts);
+      sequence.update(solver, k);
+      benchmark::DoNotOptimize(solver.solve());
+    }
+  }
+}
+
+/** @brief Sets the solver up once and only updates the values of the following QPs, which warm start */
+static void BM_OSQP_SEQUENCE_UPDATE(benchmark::State& state)
+{
+  QPSequence sequence(state.range(0), static_cast<int>(state.range(1)));
+  for (auto _ : state)
+  {
+    OSQPEigenSolver solver;
+    solver.clear();
+    solver.init(sequence.n_vars, sequence.n_cnts);
+    for (std::size_t k = 0; k < sequence.hessians.size(); ++k)
+    {
+      sequence.update(solver, k);
+      benchmark::DoNotOptimize(solver.solve());
+    }
+  }
+}
+
+// Arguments are {number of variables, number of QPs in the sequence}
+#define QP_BENCHMARK_ARGS Args({ 50, 20 })->Args({ 200, 20 })->Args({ 1000, 20 })->Unit(benchmark::kMillisecond)
+
+BENCHMARK(BM_OSQP_SEQUENCE_REINIT)->QP_BENCHMARK_ARGS;
+BENCHMARK(BM_OSQP_SEQUENCE_UPDATE)->QP_BENCHMARK_ARGS;
+
+BENCHMARK_MAIN();
@@ -3,6 +3,7 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 #include <gtest/gtest.h>
 #include <iostream>
 
+#include <ifopt/cost_term.h>
 #include <ifopt/problem.h>
 #include <ifopt/ipopt_solver.h>
 #include <console_bridge/console.h>
@@ -17,6 +18,30 @@ TRAJOPT_IGNORE_WARNINGS_POP
 
 const bool DEBUG = false;
 
+/**
+ * @brief Wraps a cost without exposing its hessian, so trajopt_sqp models it linearly
+ */
+class LinearizedCost : public ifopt::CostTerm
+{
+public:
+  LinearizedCost(ifopt::ConstraintSet::Ptr cost)
+    : ifopt::CostTerm(cost->GetName() + "_linearized"), cost_(std::move(cost))
+  {
+  }
+
+  double GetCost() const override { return cost_->GetValues()[0]; }
+
+  void FillJacobianBlock(std::string var_set, Jacobian& jac_block) const override
+  {
+    cost_->FillJacobianBlock(var_set, jac_block);
+  }
+
+private:
+  ifopt::ConstraintSet::Ptr cost_;
+
+  void InitVariableDependedQuantities(const VariablesPtr& x_init) override { cost_->LinkWithVariables(x_init); }
+};
+
 class VelocityConstraintOptimization : public testing::TestWithParam<const char*>
 {
 public:
@@ -30,6 +55,22 @@ public:
     else
       console_bridge::setLogLevel(console_bridge::LogLevel::CONSOLE_BRIDGE_LOG_NONE);
 
+    setupProblem(nlp_);
+
+    if (DEBUG)
+    {
+      nlp_.PrintCurrent();
+      std::cout << "Constraint Jacobian: \n" << nlp_.GetJacobianOfConstraints().toDense() << std::endl;
+      std::cout << "Cost Jacobian: \n" << nlp_.GetJacobianOfCosts() << std::endl;
+    }
+  }
+
+  /**
+   * @brief Add the variables, constraints and costs of the problem to nlp
+   * @param linearize_cost If true, the velocity cost is hidden behind a LinearizedCost
+   */
+  static void setupProblem(ifopt::Problem& nlp, bool linearize_cost = false)
+  {
     // 2) Add Variables
     std::vector<trajopt::JointPosition::ConstPtr> vars;
     std::vector<std::string> joint_names(7, "name");
@@ -39,7 +80,7 @@ public:
       auto bounds = std::vector<ifopt::Bounds>(7, ifopt::NoBound);
       var->SetBounds(bounds);
       vars.push_back(var);
-      nlp_.AddVariableSet(var);
+      nlp.AddVariableSet(var);
     }
     for (int ind = 1; ind < 3; ind++)
     {
@@ -48,7 +89,7 @@ public:
       auto bounds = std::vector<ifopt::Bounds>(7, ifopt::NoBound);
       var->SetBounds(bounds);
       vars.push_back(var);
-      nlp_.AddVariableSet(var);
+      nlp.AddVariableSet(var);
     }
 
     // 3) Add constraints
@@ -56,30 +97,40 @@ public:
     std::vector<trajopt::JointPosition::ConstPtr> start;
     start.push_back(vars.front());
     auto start_constraint = std::make_shared<trajopt::JointPosConstraint>(start_pos, start, "StartPosition");
-    nlp_.AddConstraintSet(start_constraint);
+    nlp.AddConstraintSet(start_constraint);
 
     Eigen::VectorXd end_pos = Eigen::VectorXd::Ones(7) * 10;
     std::vector<trajopt::JointPosition::ConstPtr> end;
     end.push_back(vars.back());
     auto end_constraint = std::make_shared<trajopt::JointPosConstraint>(end_pos, end, "EndPosition");
-    nlp_.AddConstraintSet(end_constraint);
+    nlp.AddConstraintSet(end_constraint);
 
     // 4) Add costs
     Eigen::VectorXd vel_target = Eigen::VectorXd::Zero(7);
     auto vel_constraint = std::make_shared<trajopt::JointVelConstraint>(vel_target, vars, "jv");
 
     // Must link the variables to the constraint since that happens in AddConstraintSet
-    vel_constraint->LinkWithVariables(nlp_.GetOptVariables());
+    vel_constraint->LinkWithVariables(nlp.GetOptVariables());
     Eigen::VectorXd weights = Eigen::VectorXd::Ones(vel_constraint->GetRows()) * 0.1;
     auto vel_cost = std::make_shared<trajopt::SquaredCost>(vel_constraint, weights);
-    nlp_.AddCostSet(vel_cost);
+    if (linearize_cost)
+      nlp.AddCostSet(std::make_shared<LinearizedCost>(vel_cost));
+    else
+      nlp.AddCostSet(vel_cost);
+  }
 
-    if (DEBUG)
-    {
-      nlp_.PrintCurrent();
-      std::cout << "Constraint Jacobian: \n" << nlp_.GetJacobianOfConstraints().toDense() << std::endl;
-      std::cout << "Cost Jacobian: \n" << nlp_.GetJacobianOfCosts() << std::endl;
-    }
+  /** @brief Create the QP solver used by the trajopt_sqp tests */
+  static std::shared_ptr<trajopt_sqp::OSQPEigenSolver> createQPSolver()
+  {
+    auto qp_solver = std::make_shared<trajopt_sqp::OSQPEigenSolver>();
+    qp_solver->solver_.settings()->setVerbosity(DEBUG);
+    qp_solver->solver_.settings()->setWarmStart(true);
+    qp_solver->solver_.settings()->setAbsoluteTolerance(1e-4);
+    qp_solver->solver_.settings()->setRelativeTolerance(1e-6);
+    qp_solver->solver_.settings()->setMaxIteraction(8192);
+    qp_solver->solver_.settings()->setPolish(true);
+    qp_solver->solver_.settings()->setAdaptiveRho(false);
+    return qp_solver;
   }
 };
 
@@ -115,15 +166,8 @@ TEST_F(VelocityConstraintOptimization, velocity_constraint_optimization_ipopt)
 TEST_F(VelocityConstraintOptimization, velocity_constraint_optimization_trajopt_sqp)  // NOLINT
 {
   ifopt::Problem nlp_trajopt_sqp(nlp_);
-  auto qp_solver = std::make_shared<trajopt_sqp::OSQPEigenSolver>();
+  auto qp_solver = createQPSolver();
   trajopt_sqp::TrustRegionSQPSolver solver(qp_solver);
-  qp_solver->solver_.settings()->setVerbosity(DEBUG);
-  qp_solver->solver_.settings()->setWarmStart(true);
-  qp_solver->solver_.settings()->setAbsoluteTolerance(1e-4);
-  qp_solver->solver_.settings()->setRelativeTolerance(1e-6);
-  qp_solver->solver_.settings()->setMaxIteraction(8192);
-  qp_solver->solver_.settings()->setPolish(true);
-  qp_solver->solver_.settings()->setAdaptiveRho(false);
 
   // 6) solve
   solver.verbose = DEBUG;
@@ -142,3 +186,27 @@ TEST_F(VelocityConstraintOptimization, velocity_constraint_optimization_trajopt_
     nlp_trajopt_sqp.PrintCurrent();
   }
 }
+
+/**
+ * @brief The Gauss-Newton hessian of the squared velocity cost lets trajopt_sqp take full steps, so it converges in
+ * fewer iterations than with the linear model of the same cost
+ */
+TEST_F(VelocityConstraintOptimization, velocity_constraint_optimization_gauss_newton)  // NOLINT
+{
+  auto solve = [](bool linearize_cost) {
+    ifopt::Problem nlp;
+    setupProblem(nlp, linearize_cost);
+    trajopt_sqp::TrustRegionSQPSolver solver(createQPSolver());
+    solver.verbose = DEBUG;
+    solver.Solve(nlp);
+
+    Eigen::VectorXd x = nlp.GetOptVariables()->GetValues();
+    for (Eigen::Index i = 7; i < 14; i++)
+      EXPECT_NEAR(x[i], 5.0, 1e-1);
+    return solver.getResults().overall_iteration;
+  };
+
+  int gauss_newton_iterations = solve(false);
+  int linear_iterations = solve(true);
+  EXPECT_LT(gauss_newton_iterations, linear_iterations);
+}
@@ -0,0 +1,181 @@
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <gtest/gtest.h>
+#include <ifopt/problem.h>
+#include <ifopt/constraint_set.h>
+#include <ifopt/cost_term.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_sqp/qp_problem.h>
+#include <trajopt_ifopt/constraints/joint_velocity_constraint.h>
+#include <trajopt_ifopt/costs/squared_cost.h>
+#include <trajopt_ifopt/variable_sets/joint_position_variable.h>
+
+/**
+ * @brief Squares the variables. The first constraint is an equality and the others are inequalities. The jacobian only
+ * stores the entries of nonzero variables, so its pattern changes with the variables.
+ */
+class SquaredConstraint : public ifopt::ConstraintSet
+{
+public:
+  explicit SquaredConstraint(int n) : ifopt::ConstraintSet(n, "Squared") {}
+
+  Eigen::VectorXd GetValues() const override { return GetVariables()->GetValues().array().square(); }
+
+  std::vector<ifopt::Bounds> GetBounds() const override
+  {
+    std::vector<ifopt::Bounds> bounds(static_cast<std::size_t>(GetRows()), ifopt::Bounds(-1, 1));
+    bounds.front() = ifopt::Bounds(0, 0);
+    return bounds;
+  }
+
+  void FillJacobianBlock(std::string /*var_set*/, Jacobian& jac_block) const override
+  {
+    Eigen::VectorXd x = GetVariables()->GetValues();
+    for (Eigen::Index i = 0; i < x.size(); ++i)
+    {
+      if (x[i] != 0)
+        jac_block.coeffRef(i, i) = 2 * x[i];
+    }
+  }
+};
+
+/** @brief Weighted sum of the variables */
+class WeightedSumCost : public ifopt::CostTerm
+{
+public:
+  WeightedSumCost() : ifopt::CostTerm("WeightedSum") {}
+
+  double GetCost() const override
+  {
+    Eigen::VectorXd x = GetVariables()->GetValues();
+    return x.dot(weights());
+  }
+
+  void FillJacobianBlock(std::string /*var_set*/, Jacobian& jac_block) const override
+  {
+    Eigen::VectorXd w = weights();
+    for (Eigen::Index i = 0; i < w.size(); ++i)
+      jac_block.coeffRef(0, i) = w[i];
+  }
+
+private:
+  Eigen::VectorXd weights() const
+  {
+    return Eigen::VectorXd::LinSpaced(GetVariables()->GetValues().size(), 1, 3);
+  }
+};
+
+class QPProblemTest : public testing::Test
+{
+public:
+  ifopt::Problem nlp_;
+  trajopt::JointPosition::Ptr var_;
+
+  void SetUp() override
+  {
+    std::vector<std::string> joint_names(3, "name");
+    var_ = std::make_shared<trajopt::JointPosition>(Eigen::VectorXd::Zero(3), joint_names, "Joint_Position_0");
+    nlp_.AddVariableSet(var_);
+    nlp_.AddConstraintSet(std::make_shared<SquaredConstraint>(3));
+    nlp_.AddCostSet(std::make_shared<WeightedSumCost>());
+  }
+
+  /** @brief The constraint matrix assembled from the current constraint jacobian */
+  Eigen::MatrixXd expectedConstraintMatrix()
+  {
+    // 3 variables, 2 slack variables for the equality constraint and 1 for each inequality constraint, followed by the
+    // limits of all of them
+    Eigen::MatrixXd expected = Eigen::MatrixXd::Zero(3 + 7, 7);
+    expected.topLeftCorner(3, 3) = Eigen::MatrixXd(nlp_.GetJacobianOfConstraints());
+    expected(0, 3) = 1;
+    expected(0, 4) = -1;
+    expected(1, 5) = 1;
+    expected(2, 6) = 1;
+    expected.bottomRows(7) = Eigen::MatrixXd::Identity(7, 7);
+    return expected;
+  }
+};
+
+/** @brief The constraint matrix and gradient are refreshed, also when the jacobian changes its pattern */
+TEST_F(QPProblemTest, convexify)  // NOLINT
+{
+  trajopt_sqp::QPProblem qp_problem;
+  qp_problem.init(nlp_);
+  ASSERT_EQ(qp_problem.getNumQPVars(), 7);
+  ASSERT_EQ(qp_problem.getNumQPConstraints(), 10);
+
+  std::vector<Eigen::VectorXd> points{ Eigen::Vector3d(0, 0, 0),
+                                       Eigen::Vector3d(0.5, 0, -0.25),
+                                       Eigen::Vector3d(-1, 0, 2),
+                                       Eigen::Vector3d(0.1, 0.2, 0.3) };
+  for (const auto& point : points)
+  {
+    nlp_.SetVariables(point.data());
+    qp_problem.convexify();
+
+    Eigen::MatrixXd constraint_matrix = qp_problem.getConstraintMatrix();
+    EXPECT_TRUE(constraint_matrix.isApprox(expectedConstraintMatrix())) << "at " << point.transpose();
+
+    Eigen::VectorXd gradient = qp_problem.getGradient();
+    EXPECT_TRUE(gradient.head(3).isApprox(Eigen::Vector3d(1, 2, 3)));
+    EXPECT_TRUE(gradient.tail(4).isApprox(Eigen::VectorXd::Constant(4, 10)));
+  }
+}
+
+/** @brief A squared velocity cost is modeled by its Gauss-Newton hessian, centered at the current values */
+TEST(QPProblemUnit, squared_cost_hessian)  // NOLINT
+{
+  ifopt::Problem nlp;
+  std::vector<trajopt::JointPosition::ConstPtr> vars;
+  std::vector<std::string> joint_names(2, "name");
+  for (int ind = 0; ind < 3; ind++)
+  {
+    Eigen::VectorXd pos = Eigen::VectorXd::Constant(2, ind * ind);
+    auto var = std::make_shared<trajopt::JointPosition>(pos, joint_names, "Joint_Position_" + std::to_string(ind));
+    vars.push_back(var);
+    nlp.AddVariableSet(var);
+  }
+
+  auto vel_constraint = std::make_shared<trajopt::JointVelConstraint>(Eigen::VectorXd::Zero(2), vars, "jv");
+  vel_constraint->LinkWithVariables(nlp.GetOptVariables());
+  Eigen::VectorXd weights(4);
+  weights << 0.1, 0.2, 0.3, 0.4;
+  auto vel_cost = std::make_shared<trajopt::SquaredCost>(vel_constraint, weights);
+  nlp.AddCostSet(vel_cost);
+
+  // The blocks filled by the cost assemble the same hessian as the one computed at once
+  Eigen::MatrixXd jac = vel_constraint->GetJacobian();
+  Eigen::MatrixXd expected_hessian = 2 * jac.transpose() * weights.asDiagonal() * jac;
+  EXPECT_TRUE(Eigen::MatrixXd(vel_cost->GetHessian()).isApprox(expected_hessian));
+  EXPECT_TRUE(Eigen::MatrixXd(vel_cost->HessianCostTerm::GetHessian()).isApprox(expected_hessian));
+
+  trajopt_sqp::QPProblem qp_problem;
+  qp_problem.init(nlp);
+  qp_problem.convexify();
+
+  Eigen::MatrixXd hessian = qp_problem.getHessian();
+  EXPECT_TRUE(hessian.topLeftCorner(6, 6).isApprox(expected_hessian));
+  EXPECT_TRUE(hessian.rightCols(hessian.cols() - 6).isZero());
+
+  // The velocity residual is linear, so the quadratic model matches the cost exactly
+  Eigen::VectorXd x0 = nlp.GetVariableValues();
+  Eigen::VectorXd cost_gradient = Eigen::MatrixXd(nlp.GetJacobianOfCosts()).transpose();
+  EXPECT_TRUE(qp_problem.getGradient().head(6).isApprox(cost_gradient - expected_hessian * x0));
+
+  Eigen::VectorXd qp_x0 = Eigen::VectorXd::Zero(qp_problem.getNumQPVars());
+  qp_x0.head(6) = x0;
+  Eigen::VectorXd qp_x = Eigen::VectorXd::Zero(qp_problem.getNumQPVars());
+  qp_x.head(6) << 1, -1, 2, 0.5, 3, 4;
+  double model_x0 = qp_problem.evaluateTotalConvexCost(qp_x0);
+  double model_x = qp_problem.evaluateTotalConvexCost(qp_x);
+  EXPECT_NEAR(model_x0, nlp.EvaluateCostFunction(x0.data()), 1e-8);
+  EXPECT_NEAR(model_x, nlp.EvaluateCostFunction(qp_x.data()), 1e-8);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
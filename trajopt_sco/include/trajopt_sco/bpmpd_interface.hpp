@@ -30,6 +30,7 @@ public:
   Cnt addEqCnt(const AffExpr&, const std::string& name) override;
   Cnt addIneqCnt(const AffExpr&, const std::string& name) override;
   Cnt addIneqCnt(const QuadExpr&, const std::string& name) override;
+  bool updateCnt(const Cnt& cnt, const AffExpr& expr) override;
   void removeVars(const VarVector& vars) override;
   void removeCnts(const CntVector& cnts) override;
 
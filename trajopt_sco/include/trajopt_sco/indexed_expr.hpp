@@ -0,0 +1,288 @@
+#pragma once
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <cstdint>
+#include <string>
+#include <vector>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_sco/solver_interface.hpp>
+
+/**
+@file indexed_expr.hpp
+@brief Index based (structure-of-arrays) affine and quadratic expressions
+
+  AffExpr/QuadExpr store a Var (shared_ptr) per coefficient, so evaluating or
+converting them chases a pointer and bumps a reference count per term. The
+expressions here store the variable index directly in a contiguous int32 array
+next to the coefficients. Variable names and handles are kept once per model in
+a VarTable and are only looked up when converting back to AffExpr/QuadExpr.
+ */
+
+namespace sco
+{
+using VarIndex = std::int32_t;
+using VarIndexVector = std::vector<VarIndex>;
+
+/**
+ * @brief Interned variable handles and names of a model, indexed by variable index
+ *
+ * This is the bridge between index based expressions and the Var based Model
+ * interface. It must be refreshed (sync) after variables are added or removed.
+ */
+class VarTable
+{
+public:
+  VarTable() = default;
+  explicit VarTable(const VarVector& vars);
+  explicit VarTable(const Model& model);
+
+  /** @brief Rebuild the table from the provided variables */
+  void sync(const VarVector& vars);
+  /** @brief Rebuild the table from the variables currently in the model */
+  void sync(const Model& model);
+
+  std::size_t size() const { return vars_.size(); }
+  const Var& var(VarIndex index) const { return vars_[static_cast<std::size_t>(index)]; }
+  const std::string& name(VarIndex index) const { return vars_[static_cast<std::size_t>(index)].var_rep->name; }
+
+private:
+  VarVector vars_;
+};
+
+inline VarIndex varIndex(const Var& v) { return static_cast<VarIndex>(v.var_rep->index); }
+
+struct IndexedAffExpr
+{  // affine expression over variable indices
+
+  double constant{ 0 };
+  DblVec coeffs;
+  VarIndexVector inds;
+  IndexedAffExpr() = default;
+  ~IndexedAffExpr() = default;
+  IndexedAffExpr(const IndexedAffExpr&) = default;
+  IndexedAffExpr& operator=(const IndexedAffExpr&) = default;
+  IndexedAffExpr(IndexedAffExpr&&) = default;
+  IndexedAffExpr& operator=(IndexedAffExpr&&) = default;
+
+  explicit IndexedAffExpr(double a) : constant(a) {}
+  explicit IndexedAffExpr(const Var& v) : constant(0), coeffs(1, 1), inds(1, varIndex(v)) {}
+  explicit IndexedAffExpr(const AffExpr& expr);
+
+  size_t size() const { return coeffs.size(); }
+  void reserve(size_t n)
+  {
+    coeffs.reserve(n);
+    inds.reserve(n);
+  }
+  void clear()
+  {
+    constant = 0;
+    coeffs.clear();
+    inds.clear();
+  }
+  double value(const double* x) const;
+  double value(const DblVec& x) const;
+};
+
+struct IndexedQuadExpr
+{
+  IndexedAffExpr affexpr;
+  DblVec coeffs;
+  VarIndexVector inds1;
+  VarIndexVector inds2;
+  IndexedQuadExpr() = default;
+  explicit IndexedQuadExpr(double a) : affexpr(a) {}
+  explicit IndexedQuadExpr(const Var& v) : affexpr(v) {}
+  explicit IndexedQuadExpr(IndexedAffExpr aff) : affexpr(std::move(aff)) {}
+  explicit IndexedQuadExpr(const QuadExpr& expr);
+
+  size_t size() const { return coeffs.size(); }
+  void reserve(size_t n)
+  {
+    coeffs.reserve(n);
+    inds1.reserve(n);
+    inds2.reserve(n);
+  }
+  double value(const double* x) const;
+  double value(const DblVec& x) const;
+};
+
+using IndexedAffExprVector = std::vector<IndexedAffExpr>;
+using IndexedQuadExprVector = std::vector<IndexedQuadExpr>;
+
+/** @brief Convert back to a Var based expression so it can be passed to a Model */
+AffExpr toAffExpr(const IndexedAffExpr& expr, const VarTable& table);
+QuadExpr toQuadExpr(const IndexedQuadExpr& expr, const VarTable& table);
+
+////// In-place operations (same semantics as expr_ops.hpp) ///////
+
+// multiplication
+inline void exprScale(IndexedAffExpr& v, double a)
+{
+  v.constant *= a;
+  for (double& coeff : v.coeffs)
+    coeff *= a;
+}
+inline void exprScale(IndexedQuadExpr& q, double a)
+{
+  exprScale(q.affexpr, a);
+  for (double& coeff : q.coeffs)
+    coeff *= a;
+}
+
+// addition
+inline void exprInc(IndexedAffExpr& a, double b) { a.constant += b; }
+inline void exprInc(IndexedAffExpr& a, const IndexedAffExpr& b)
+{
+  a.constant += b.constant;
+  a.coeffs.insert(a.coeffs.end(), b.coeffs.begin(), b.coeffs.end());
+  a.inds.insert(a.inds.end(), b.inds.begin(), b.inds.end());
+}
+inline void exprInc(IndexedAffExpr& a, const Var& b)
+{
+  a.coeffs.push_back(1);
+  a.inds.push_back(varIndex(b));
+}
+inline void exprInc(IndexedAffExpr& a, const AffExpr& b)
+{
+  a.constant += b.constant;
+  a.coeffs.insert(a.coeffs.end(), b.coeffs.begin(), b.coeffs.end());
+  a.inds.reserve(a.inds.size() + b.vars.size());
+  for (const Var& v : b.vars)
+    a.inds.push_back(varIndex(v));
+}
+inline void exprInc(IndexedQuadExpr& a, double b) { exprInc(a.affexpr, b); }
+inline void exprInc(IndexedQuadExpr& a, const Var& b) { exprInc(a.affexpr, b); }
+inline void exprInc(IndexedQuadExpr& a, const IndexedAffExpr& b) { exprInc(a.affexpr, b); }
+inline void exprInc(IndexedQuadExpr& a, const AffExpr& b) { exprInc(a.affexpr, b); }
+inline void exprInc(IndexedQuadExpr& a, const IndexedQuadExpr& b)
+{
+  exprInc(a.affexpr, b.affexpr);
+  a.coeffs.insert(a.coeffs.end(), b.coeffs.begin(), b.coeffs.end());
+  a.inds1.insert(a.inds1.end(), b.inds1.begin(), b.inds1.end());
+  a.inds2.insert(a.inds2.end(), b.inds2.begin(), b.inds2.end());
+}
+void exprInc(IndexedQuadExpr& a, const QuadExpr& b);
+
+// subtraction
+inline void exprDec(IndexedAffExpr& a, double b) { a.constant -= b; }
+inline void exprDec(IndexedAffExpr& a, IndexedAffExpr b)
+{
+  exprScale(b, -1);
+  exprInc(a, b);
+}
+inline void exprDec(IndexedAffExpr& a, const Var& b)
+{
+  a.coeffs.push_back(-1);
+  a.inds.push_back(varIndex(b));
+}
+inline void exprDec(IndexedQuadExpr& a, double b) { exprDec(a.affexpr, b); }
+inline void exprDec(IndexedQuadExpr& a, const Var& b) { exprDec(a.affexpr, b); }
+inline void exprDec(IndexedQuadExpr& a, const IndexedAffExpr& b) { exprDec(a.affexpr, b); }
+inline void exprDec(IndexedQuadExpr& a, IndexedQuadExpr b)
+{
+  exprScale(b, -1);
+  exprInc(a, b);
+}
+
+/////////////////////
+
+inline IndexedAffExpr exprMult(IndexedAffExpr a, double b)
+{
+  exprScale(a, b);
+  return a;
+}
+inline IndexedQuadExpr exprMult(IndexedQuadExpr a, double b)
+{
+  exprScale(a, b);
+  return a;
+}
+
+inline IndexedAffExpr exprAdd(IndexedAffExpr a, double b)
+{
+  exprInc(a, b);
+  return a;
+}
+inline IndexedAffExpr exprAdd(IndexedAffExpr a, const Var& b)
+{
+  exprInc(a, b);
+  return a;
+}
+inline IndexedAffExpr exprAdd(IndexedAffExpr a, const IndexedAffExpr& b)
+{
+  exprInc(a, b);
+  return a;
+}
+inline IndexedQuadExpr exprAdd(IndexedQuadExpr a, double b)
+{
+  exprInc(a, b);
+  return a;
+}
+inline IndexedQuadExpr exprAdd(IndexedQuadExpr a, const IndexedAffExpr& b)
+{
+  exprInc(a, b);
+  return a;
+}
+inline IndexedQuadExpr exprAdd(IndexedQuadExpr a, const IndexedQuadExpr& b)
+{
+  exprInc(a, b);
+  return a;
+}
+
+inline IndexedAffExpr exprSub(IndexedAffExpr a, double b)
+{
+  exprDec(a, b);
+  return a;
+}
+inline IndexedAffExpr exprSub(IndexedAffExpr a, const Var& b)
+{
+  exprDec(a, b);
+  return a;
+}
+inline IndexedAffExpr exprSub(IndexedAffExpr a, const IndexedAffExpr& b)
+{
+  exprDec(a, b);
+  return a;
+}
+inline IndexedQuadExpr exprSub(IndexedQuadExpr a, double b)
+{
+  exprDec(a, b);
+  return a;
+}
+inline IndexedQuadExpr exprSub(IndexedQuadExpr a, const IndexedAffExpr& b)
+{
+  exprDec(a, b);
+  return a;
+}
+inline IndexedQuadExpr exprSub(IndexedQuadExpr a, const IndexedQuadExpr& b)
+{
+  exprDec(a, b);
+  return a;
+}
+
+//////////////////////
+/**
+ * @brief Multiplies two IndexedAffExpr. Does not consider any optimizations for shared variables
+ * @return The IndexedQuadExpr result of the multiplication
+ */
+IndexedQuadExpr exprMult(const IndexedAffExpr&, const IndexedAffExpr&);
+
+IndexedQuadExpr exprSquare(const IndexedAffExpr&);
+
+IndexedAffExpr cleanupAff(const IndexedAffExpr&);
+
+/**
+ * @brief Sort the terms by variable index and merge duplicate indices in place,
+ *        dropping terms whose merged coefficient is zero.
+ */
+void simplify(IndexedAffExpr& expr);
+/**
+ * @brief Simplify the affine part and merge quadratic terms over the same (unordered) pair of indices in place,
+ *        dropping terms whose merged coefficient is zero. Each pair is stored with inds1 <= inds2.
+ */
+void simplify(IndexedQuadExpr& expr);
+
+std::ostream& operator<<(std::ostream&, const IndexedAffExpr&);
+std::ostream& operator<<(std::ostream&, const IndexedQuadExpr&);
+}  // namespace sco
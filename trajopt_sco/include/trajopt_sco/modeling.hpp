@@ -117,6 +117,17 @@ public:
   virtual ConvexObjective::Ptr convex(const DblVec& x, Model* model) = 0;
   /** Get problem variables associated with this cost */
   virtual VarVector getVars() = 0;
+  /**
+   * @brief True if convex() returns the same objective for every x, consisting of a quadratic expression only (no
+   * auxiliary variables or constraints). The optimizer may then convexify the cost once per solve and reuse it.
+   */
+  virtual bool hasConstantConvexification() { return false; }
+  /**
+   * @brief True if value() and convex() may run concurrently with those of other thread safe terms, i.e. any mutable
+   * state the cost shares with them (e.g. kinematics or collision managers) is safe to use from several threads. Only
+   * such costs are evaluated and convexified on several threads, see BasicTrustRegionSQPParameters::convexify_threads.
+   */
+  virtual bool isThreadSafe() { return false; }
   std::string name() { return name_; }
   void setName(const std::string& name) { name_ = name; }
 
@@ -154,6 +165,11 @@ public:
   double violation(const DblVec& x);
   /** Get problem variables associated with this constraint */
   virtual VarVector getVars() = 0;
+  /**
+   * @brief True if value() and convex() may run concurrently with those of other thread safe terms, see
+   * Cost::isThreadSafe
+   */
+  virtual bool isThreadSafe() { return false; }
   std::string name() { return name_; }
   void setName(const std::string& name) { name_ = name; }
 
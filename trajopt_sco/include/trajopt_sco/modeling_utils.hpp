@@ -42,12 +42,16 @@ public:
   double value(const DblVec& x) override;
   ConvexObjective::Ptr convex(const DblVec& x, Model* model) override;
   VarVector getVars() override { return vars_; }
+  bool isThreadSafe() override { return thread_safe_; }
+  /** @brief Declare that the supplied functions may be called concurrently, see Cost::isThreadSafe. Default: false */
+  void setThreadSafe(bool thread_safe) { thread_safe_ = thread_safe; }
 
 protected:
   ScalarOfVector::Ptr f_;
   VarVector vars_;
   bool full_hessian_;
   double epsilon_;
+  bool thread_safe_{ false };
 };
 
 class CostFromErrFunc : public Cost
@@ -69,6 +73,9 @@ public:
   double value(const DblVec& x) override;
   ConvexObjective::Ptr convex(const DblVec& x, Model* model) override;
   VarVector getVars() override { return vars_; }
+  bool isThreadSafe() override { return thread_safe_; }
+  /** @brief Declare that the supplied functions may be called concurrently, see Cost::isThreadSafe. Default: false */
+  void setThreadSafe(bool thread_safe) { thread_safe_ = thread_safe; }
 
 protected:
   VectorOfVector::Ptr f_;
@@ -77,6 +84,7 @@ protected:
   Eigen::VectorXd coeffs_;
   PenaltyType pen_type_;
   double epsilon_;
+  bool thread_safe_{ false };
 };
 
 class ConstraintFromErrFunc : public Constraint
@@ -101,6 +109,9 @@ public:
   ConvexConstraints::Ptr convex(const DblVec& x, Model* model) override;
   ConstraintType type() override { return type_; }
   VarVector getVars() override { return vars_; }
+  bool isThreadSafe() override { return thread_safe_; }
+  /** @brief Declare that the supplied functions may be called concurrently, see Cost::isThreadSafe. Default: false */
+  void setThreadSafe(bool thread_safe) { thread_safe_ = thread_safe; }
 
 protected:
   VectorOfVector::Ptr f_;
@@ -110,6 +121,7 @@ protected:
   ConstraintType type_;
   double epsilon_;
   Eigen::VectorXd scaling_;
+  bool thread_safe_{ false };
 };
 
 std::string AffExprToString(const AffExpr& aff);
@@ -1,11 +1,14 @@
 #pragma once
 #include <trajopt_utils/macros.h>
 TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
 #include <functional>
 #include <string>
+#include <vector>
 TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt_sco/modeling.hpp>
+#include <trajopt_utils/thread_pool.hpp>
 
 /*
  * Algorithms for non-convex, constrained optimization
@@ -28,6 +31,47 @@ static const char* OptStatus_strings[] = { "CONVERGED",
                                            "FAILED",
                                            "INVALID" };
 inline std::string statusToString(OptStatus status) { return OptStatus_strings[status]; }
+/** @brief Time spent on and number of calls to a single cost or constraint, see OptTimings */
+struct TermTiming
+{
+  /** @brief Cost::name() or Constraint::name() */
+  std::string name;
+  /** @brief Seconds spent in convex() */
+  double convexify{ 0 };
+  /** @brief Seconds spent in the exact evaluation (Cost::value() or Constraint::violation()) */
+  double evaluate{ 0 };
+  int n_convexify{ 0 };
+  int n_evaluate{ 0 };
+};
+
+/**
+ * @brief Breakdown of the wall time of BasicTrustRegionSQP::optimize(), measured with a monotonic clock.
+ *
+ * All times are in seconds. Time spent outside of the listed phases (e.g. bookkeeping and logging) is included in
+ * total only. Terms served from a cache (see reuse_unchanged_terms) are not timed.
+ */
+struct OptTimings
+{
+  /** @brief Convexifying the costs and constraints, including turning constraints into penalties */
+  double convexify{ 0 };
+  /** @brief Adding the convexifications to the model, setting the objective and the trust region */
+  double update_model{ 0 };
+  /** @brief Model::optimize() */
+  double qp_solve{ 0 };
+  /** @brief Exact evaluation of the costs and constraints for the merit */
+  double evaluate{ 0 };
+  /** @brief Callbacks added with addCallback() and addRefinementCallback() */
+  double callbacks{ 0 };
+  double total{ 0 };
+  /** @brief Per term breakdown, indexed like OptProb::getCosts() and OptProb::getConstraints() */
+  std::vector<TermTiming> costs, cnts;
+
+  void clear() { *this = OptTimings(); }
+};
+
+/** @brief Prints the phases and the per term times summed by term name */
+std::ostream& operator<<(std::ostream& o, const OptTimings& t);
+
 struct OptResults
 {
   DblVec x;  // solution estimate
@@ -36,6 +80,14 @@ struct OptResults
   DblVec cost_vals;
   DblVec cnt_viols;
   int n_func_evals, n_qp_solves;
+  /** @brief Number of SQP iterations, i.e. convexifications of the problem */
+  int n_sqp_iters;
+  /** @brief Exact term evaluations which were reused (hits) or computed (misses), see reuse_unchanged_terms */
+  int n_value_cache_hits, n_value_cache_misses;
+  /** @brief Term convexifications which were reused (hits) or computed (misses), see reuse_unchanged_terms */
+  int n_convex_cache_hits, n_convex_cache_misses;
+  /** @brief Where the time of the solve was spent */
+  OptTimings timings;
   void clear()
   {
     x.clear();
@@ -44,12 +96,99 @@ struct OptResults
     cnt_viols.clear();
     n_func_evals = 0;
     n_qp_solves = 0;
+    n_sqp_iters = 0;
+    n_value_cache_hits = 0;
+    n_value_cache_misses = 0;
+    n_convex_cache_hits = 0;
+    n_convex_cache_misses = 0;
+    timings.clear();
   }
   OptResults() { clear(); }
 };
 
 std::ostream& operator<<(std::ostream& o, const OptResults& r);
 
+/**
+ * @brief Results computed for the terms (costs or constraints) of a problem, keyed on the values of the variables
+ * each term reports through getVars().
+ *
+ * An entry is reused as long as none of the variables of its term moved since it was stored, so the terms must be
+ * deterministic functions of those variables. Values are compared exactly.
+ */
+template <typename T>
+class TermCache
+{
+public:
+  template <typename Term>
+  explicit TermCache(const std::vector<std::shared_ptr<Term>>& terms)
+    : var_inds_(terms.size()), points_(terms.size()), results_(terms.size()), valid_(terms.size(), 0)
+  {
+    for (std::size_t i = 0; i < terms.size(); ++i)
+    {
+      for (const Var& var : terms[i]->getVars())
+        var_inds_[i].push_back(var.var_rep->index);
+    }
+  }
+
+  /**
+   * @brief Get the result of term i if its variables have the same values in x as when it was stored
+   * @return False on a miss, in which case the stale entry is released
+   */
+  bool lookup(std::size_t i, const DblVec& x, T& result)
+  {
+    if (valid_[i] != 0 && samePoint(i, x))
+    {
+      result = results_[i];
+      ++n_hits_;
+      return true;
+    }
+    valid_[i] = 0;
+    results_[i] = T();
+    ++n_misses_;
+    return false;
+  }
+
+  /** @brief Store the result of term i evaluated at x */
+  void store(std::size_t i, const DblVec& x, T result)
+  {
+    const std::vector<std::size_t>& inds = var_inds_[i];
+    points_[i].resize(inds.size());
+    for (std::size_t j = 0; j < inds.size(); ++j)
+      points_[i][j] = x[inds[j]];
+    results_[i] = std::move(result);
+    valid_[i] = 1;
+  }
+
+  /** @brief Release all entries, e.g. after the terms changed so that they return different results for the same x */
+  void clear()
+  {
+    std::fill(valid_.begin(), valid_.end(), 0);
+    std::fill(results_.begin(), results_.end(), T());
+  }
+
+  int getNumHits() const { return n_hits_; }
+  int getNumMisses() const { return n_misses_; }
+
+private:
+  std::vector<std::vector<std::size_t>> var_inds_; /**< indices into x of the variables of each term */
+  std::vector<DblVec> points_;                     /**< values of those variables when the result was stored */
+  std::vector<T> results_;
+  std::vector<char> valid_;
+  int n_hits_{ 0 };
+  int n_misses_{ 0 };
+
+  bool samePoint(std::size_t i, const DblVec& x) const
+  {
+    const std::vector<std::size_t>& inds = var_inds_[i];
+    for (std::size_t j = 0; j < inds.size(); ++j)
+    {
+      if (x[inds[j]] != points_[i][j])
+        return false;
+    }
+    return true;
+  }
+};
+
 class Optimizer
 {
   /*
@@ -71,10 +210,34 @@ public:
   DblVec& x() { return results_.x; }
   OptResults& results() { return results_; }
   using Callback = std::function<void(OptProb*, OptResults&)>;
-  void addCallback(const Callback& cb);  // called before each iteration
+  /**
+   * @brief Add a callback which is called before each iteration and once more after the optimization
+   *
+   * A callback which changes the terms of the problem before an iteration, so that they return different values at
+   * results().x, has to clear results().cost_vals and results().cnt_viols. The optimizer then drops its cached term
+   * results and evaluates the terms again before the iteration. Terms which refine an approximation should use a
+   * RefinementCallback instead, which is also called before convergence is reported.
+   */
+  void addCallback(const Callback& cb);
+
+  /**
+   * @brief A callback which refines an approximation made by the terms of the problem, so that they return different
+   * values for the same variables. It returns true if it changed the terms.
+   *
+   * It is called before each iteration with converging set to false, and with converging set to true before the
+   * optimizer reports convergence, in which case it should switch to the exact terms. Whenever it changed the terms,
+   * the optimizer drops its cached term results and evaluates the terms again at results().x. Before convergence the
+   * optimizer then keeps iterating, so the returned solution is always checked with the exact terms.
+   */
+  using RefinementCallback = std::function<bool(OptProb*, const OptResults&, bool converging)>;
+  void addRefinementCallback(const RefinementCallback& cb);
+
 protected:
   std::vector<Callback> callbacks_;
+  std::vector<RefinementCallback> refinement_callbacks_;
   void callCallbacks();
+  /** @brief Calls all refinement callbacks, returns true if any of them changed the terms */
+  bool callRefinementCallbacks(bool converging);
   OptProb::Ptr prob_;
   OptResults results_;
 };
@@ -114,6 +277,53 @@ struct BasicTrustRegionSQPParameters
   bool inflate_constraints_individually;
   double trust_box_size;  // current size of trust region (component-wise)
 
+  /**
+   * @brief If true, the auxiliary variables and constraint rows each term adds to the convex model are allocated once
+   * and only refreshed in place on later iterations (see PersistentTermModel). Rows are only reused if the backend
+   * implements Model::updateCnt.
+   */
+  bool persistent_convex_model;
+
+  /**
+   * @brief If true, each convex solve is started from the primal and dual solution of the previous one (see
+   * Model::setWarmStart). Variables and rows which persist across trust region, SQP and penalty iterations keep their
+   * values, which pays off most together with persistent_convex_model.
+   */
+  bool warm_start_convex_solve;
+
+  /**
+   * @brief Number of threads used to convexify the costs and constraints, 1 convexifies them serially.
+   * Only terms which declare themselves thread safe (Cost::isThreadSafe, Constraint::isThreadSafe) are convexified
+   * concurrently, all others are convexified serially since they may share kinematics or collision managers. Variables
+   * the terms add to the model are staged and added in a fixed order afterwards (see StagingModel), so the convex model
+   * does not depend on the number of threads.
+   */
+  int convexify_threads;
+
+  /**
+   * @brief Number of threads used to evaluate the exact costs and constraint violations after every convex solve, 1
+   * evaluates them serially. Like for convexify_threads only thread safe terms are evaluated concurrently. The merits
+   * are summed in a fixed order, so the results do not depend on the number of threads.
+   */
+  int evaluate_threads;
+
+  /**
+   * @brief If true, the exact values and convexifications of terms whose variables (Cost::getVars /
+   * Constraint::getVars) did not move since they were last computed are reused (see TermCache). This requires terms
+   * to be deterministic functions of the variables they report. Callbacks which change the terms have to clear the
+   * term values of the results or be refinement callbacks (see Optimizer::addCallback), so the cached results are
+   * dropped as well.
+   */
+  bool reuse_unchanged_terms;
+
+  /**
+   * @brief If true, costs with a constant convexification (Cost::hasConstantConvexification) are convexified once per
+   * solve. Their quadratic objectives are merged into a single precomputed block, which is passed to the model once if
+   * the backend keeps it assembled (Model::setConstantObjective). Each iteration then only convexifies and sums the
+   * terms which depend on x.
+   */
+  bool precompute_constant_costs;
+
   bool log_results;     // Log results to file
   std::string log_dir;  // Directory to store log results (Default: /tmp)
 
@@ -193,6 +403,10 @@ struct BasicTrustRegionSQPResults
    * @param constraints The current exact constraints
    * @param costs The current exact costs
    * @param merit_error_coeff The iteration penalty to apply to constraints
+   * @param thread_pool If not nullptr, the exact costs and constraints are evaluated on it
+   * @param cost_cache If not nullptr, exact cost values are reused from and stored to it
+   * @param cnt_cache If not nullptr, exact constraint violations are reused from and stored to it
+   * @param timings If not nullptr, the time spent evaluating the exact costs and constraints is added to it
    */
   void update(const OptResults& prev_opt_results,
               const Model& model,
@@ -201,7 +415,11 @@ struct BasicTrustRegionSQPResults
               const std::vector<ConvexObjective::Ptr>& cnt_cost_models,
               const std::vector<Constraint::Ptr>& constraints,
               const std::vector<Cost::Ptr>& costs,
-              std::vector<double> merit_error_coeffs);
+              std::vector<double> merit_error_coeffs,
+              util::ThreadPool* thread_pool = nullptr,
+              TermCache<double>* cost_cache = nullptr,
+              TermCache<double>* cnt_cache = nullptr,
+              OptTimings* timings = nullptr);
 
   /** @brief Print current results to the terminal */
   void print() const;
@@ -245,7 +463,11 @@ protected:
   void ctor(const OptProb::Ptr& prob);
   void adjustTrustRegion(double ratio);
   void setTrustBoxConstraints(const DblVec& x);
+  /** @brief Returns pool, (re)created with n_threads threads if needed, or nullptr if n_threads < 2 */
+  static util::ThreadPool* getThreadPool(util::ThreadPool::Ptr& pool, int n_threads);
   Model::Ptr model_;
   BasicTrustRegionSQPParameters param_;
+  util::ThreadPool::Ptr convexify_pool_;
+  util::ThreadPool::Ptr evaluate_pool_;
 };
 }  // namespace sco
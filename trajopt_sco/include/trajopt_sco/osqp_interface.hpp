@@ -31,7 +31,8 @@ class OSQPModel : public Model
   OSQPWorkspace* osqp_workspace_{ nullptr };
 
   /** Updates OSQP quadratic cost matrix from QuadExpr expression.
-   *  Transforms QuadExpr objective_ into the OSQP CSC matrix P_ */
+   *  Transforms QuadExpr objective_ into the OSQP CSC matrix P_ and adds the constant part, which is only assembled
+   *  again if it changed or the indices of its variables may have */
   void updateObjective();
 
   /** Updates qpOASES constraints from AffExpr expression.
@@ -39,15 +40,25 @@ class OSQPModel : public Model
    *  OSQP CSC matrix A_, and vectors lbA_ and ubA_ */
   void updateConstraints();
 
-  /** Creates or updates the solver and its workspace */
+  /** Creates or updates the solver and its workspace.
+   *  If the sparsity of P and A is the same as when the workspace was set up, the new values, linear cost and
+   *  bounds are pushed into the existing workspace. Otherwise the workspace is set up again. */
   void createOrUpdateSolver();
 
+  /** Returns true if the workspace exists and was set up with the sparsity pattern currently stored in P_ and A_ */
+  bool workspaceMatchesSparsity() const;
+
+  /** Passes warm_start_ to the workspace, mapping it to the current columns and rows, and clears it */
+  void applyWarmStart();
+
   VarVector vars_;                 /**< model variables */
   CntVector cnts_;                 /**< model's constraints sizes */
   DblVec lbs_, ubs_;               /**< variables bounds */
   AffExprVector cnt_exprs_;        /**< constraints expressions */
   ConstraintTypeVector cnt_types_; /**< constraints types */
   DblVec solution_;                /**< optimizizer's solution for current model */
+  DblVec dual_solution_;           /**< duals of the solution, constraint rows followed by variable bounds */
+  WarmStart warm_start_;           /**< starting point for the next solve */
 
   std::unique_ptr<csc> P_;               /**< Takes ownership of OSQPData.P to avoid having to deallocate manually */
   std::unique_ptr<csc> A_;               /**< Takes ownership of OSQPData.A to avoid having to deallocate manually */
@@ -61,7 +72,24 @@ class OSQPModel : public Model
   DblVec A_csc_data_;                    /**< constraint matrix values in CSC format */
   DblVec l_, u_;                         /**< linear constraints upper and lower limits */
 
-  QuadExpr objective_; /**< objective QuadExpr expression */
+  QuadExpr objective_;          /**< objective QuadExpr expression */
+  QuadExpr constant_objective_; /**< constant part of the objective, see setConstantObjective() */
+
+  std::vector<c_int> P_constant_row_indices_;     /**< row indices for the constant part of P, CSC format */
+  std::vector<c_int> P_constant_column_pointers_; /**< column pointers for the constant part of P, CSC format */
+  DblVec P_constant_csc_data_;                    /**< values of the constant part of P in CSC format */
+  Eigen::VectorXd q_constant_;                    /**< linear part of the constant part of the objective */
+  bool constant_objective_assembled_{ false };    /**< whether the CSC arrays match constant_objective_ */
+
+  c_int setup_n_{ 0 };                         /**< number of variables when the workspace was set up */
+  c_int setup_m_{ 0 };                         /**< number of constraints when the workspace was set up */
+  std::vector<c_int> setup_P_row_indices_;     /**< P row indices when the workspace was set up */
+  std::vector<c_int> setup_P_column_pointers_; /**< P column pointers when the workspace was set up */
+  std::vector<c_int> setup_A_row_indices_;     /**< A row indices when the workspace was set up */
+  std::vector<c_int> setup_A_column_pointers_; /**< A column pointers when the workspace was set up */
+
+  long n_workspace_setups_{ 0 };  /**< number of times osqp_setup was called */
+  long n_workspace_updates_{ 0 }; /**< number of times the workspace was updated in place */
 
 public:
   OSQPModel();
@@ -75,6 +103,7 @@ public:
   Cnt addEqCnt(const AffExpr&, const std::string& name) override;
   Cnt addIneqCnt(const AffExpr&, const std::string& name) override;
   Cnt addIneqCnt(const QuadExpr&, const std::string& name) override;
+  bool updateCnt(const Cnt& cnt, const AffExpr& expr) override;
   void removeVars(const VarVector& vars) override;
   void removeCnts(const CntVector& cnts) override;
 
@@ -84,7 +113,15 @@ public:
   CvxOptStatus optimize() override;
   void setObjective(const AffExpr&) override;
   void setObjective(const QuadExpr&) override;
+  bool setConstantObjective(const QuadExpr& expr) override;
   VarVector getVars() const override;
   void writeToFile(const std::string& fname) const override;
+  void setWarmStart(const WarmStart& start) override;
+  WarmStart getWarmStart() const override;
+
+  /** @brief Number of solves which had to set up the OSQP workspace (first solve or sparsity change) */
+  long getNumWorkspaceSetups() const { return n_workspace_setups_; }
+  /** @brief Number of solves which updated the values and bounds of the existing OSQP workspace in place */
+  long getNumWorkspaceUpdates() const { return n_workspace_updates_; }
 };
 }  // namespace sco
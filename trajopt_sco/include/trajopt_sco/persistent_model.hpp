@@ -0,0 +1,100 @@
+#pragma once
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_sco/solver_interface.hpp>
+
+namespace sco
+{
+/**
+ * @brief A Model decorator that keeps the auxiliary variables and constraint rows of a single Cost or Constraint
+ * alive across SQP iterations.
+ *
+ * Each convexification creates a new ConvexObjective/ConvexConstraints which adds slack variables and rows to the
+ * model, and its destructor removes them again. When the convexification is done through this model instead, the
+ * removed variables and rows are parked rather than removed from the underlying model. The next convexification of
+ * the same term reuses them in the same order, only refreshing bounds and coefficients in place, so the underlying
+ * model keeps its size and structure when the term produces the same shape of approximation.
+ *
+ * Parked entries which were not reused are removed from the underlying model by flush(), which should be called
+ * once all terms have been convexified and added to the model.
+ */
+class PersistentTermModel : public Model
+{
+public:
+  using Ptr = std::shared_ptr<PersistentTermModel>;
+
+  /** @param model The underlying model. It must outlive this object. */
+  explicit PersistentTermModel(Model* model);
+  ~PersistentTermModel() override;
+  PersistentTermModel(const PersistentTermModel&) = delete;
+  PersistentTermModel& operator=(const PersistentTermModel&) = delete;
+  PersistentTermModel(PersistentTermModel&&) = delete;
+  PersistentTermModel& operator=(PersistentTermModel&&) = delete;
+
+  /** @brief Always adds a new variable to the underlying model */
+  Var addVar(const std::string& name) override;
+  /** @brief Reuses a parked variable with the same name if available, otherwise adds a new one */
+  Var addVar(const std::string& name, double lb, double ub) override;
+
+  /** @brief Reuses a parked row of the same type if available, otherwise adds a new one */
+  Cnt addEqCnt(const AffExpr&, const std::string& name) override;
+  /** @brief Reuses a parked row of the same type if available, otherwise adds a new one */
+  Cnt addIneqCnt(const AffExpr&, const std::string& name) override;
+  /** @brief Quadratic constraints are never reused and are forwarded to the underlying model */
+  Cnt addIneqCnt(const QuadExpr&, const std::string& name) override;
+
+  /** @brief Parks the variables for reuse. Variables not created through this model are removed. */
+  void removeVars(const VarVector& vars) override;
+  /** @brief Parks the affine rows for reuse. Rows not created through this model are removed. */
+  void removeCnts(const CntVector& cnts) override;
+
+  bool updateCnt(const Cnt& cnt, const AffExpr& expr) override;
+  void update() override;
+  void setVarBounds(const VarVector& vars, const DblVec& lower, const DblVec& upper) override;
+  DblVec getVarValues(const VarVector& vars) const override;
+  CvxOptStatus optimize() override;
+  void setObjective(const AffExpr&) override;
+  void setObjective(const QuadExpr&) override;
+  bool setConstantObjective(const QuadExpr& expr) override;
+  void writeToFile(const std::string& fname) const override;
+  VarVector getVars() const override;
+  void setWarmStart(const WarmStart& start) override;
+  WarmStart getWarmStart() const override;
+
+  /** @brief Remove all parked variables and rows which were not reused from the underlying model */
+  void flush();
+
+  /** @brief Number of variables added to the underlying model through this model */
+  long getNumVarsAdded() const { return n_vars_added_; }
+  /** @brief Number of addVar calls served by a parked variable */
+  long getNumVarsReused() const { return n_vars_reused_; }
+  /** @brief Number of rows added to the underlying model through this model */
+  long getNumCntsAdded() const { return n_cnts_added_; }
+  /** @brief Number of constraint additions served by updating a parked row in place */
+  long getNumCntsReused() const { return n_cnts_reused_; }
+
+private:
+  Model* model_;
+  std::map<std::string, std::deque<Var>> parked_vars_;
+  std::deque<Cnt> parked_eqs_;
+  std::deque<Cnt> parked_ineqs_;
+  std::unordered_set<const VarRep*> owned_vars_;
+  std::unordered_set<const CntRep*> owned_cnts_;
+  /** @brief Cleared the first time the underlying model refuses an in-place row update */
+  bool cnt_update_supported_{ true };
+
+  long n_vars_added_{ 0 };
+  long n_vars_reused_{ 0 };
+  long n_cnts_added_{ 0 };
+  long n_cnts_reused_{ 0 };
+
+  Cnt addCnt(const AffExpr& expr, const std::string& name, ConstraintType type);
+};
+}  // namespace sco
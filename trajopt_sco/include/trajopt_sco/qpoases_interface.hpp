@@ -31,7 +31,8 @@ class qpOASESModel : public Model
   qpOASES::SparseMatrix A_; /**< Constraints matrix */
 
   /** Updates qpOASES Hessian matrix from QuadExpr expression.
-   *  Transforms QuadExpr objective_ into the qpOASES sparse matrix H_*/
+   *  Transforms QuadExpr objective_ into the qpOASES sparse matrix H_ and adds the constant part, which is only
+   *  assembled again if it changed or the indices of its variables may have */
   void updateObjective();
 
   /** Updates qpOASES constraints from AffExpr expression.
@@ -52,12 +53,22 @@ class qpOASESModel : public Model
    */
   void createSolver();
 
+  /**
+   * Maps warm_start_ to the current columns and rows of the problem.
+   * The duals are laid out as qpOASES expects them, variable bounds followed by constraint rows.
+   *
+   * @returns false if there is no warm start
+   */
+  bool getWarmStartGuess(DblVec& x, DblVec& y, bool& has_duals) const;
+
   VarVector vars_;                 /**< model variables */
   CntVector cnts_;                 /**< model's constraints sizes */
   DblVec lb_, ub_;                 /**< variables bounds */
   AffExprVector cnt_exprs_;        /**< constraints expressions */
   ConstraintTypeVector cnt_types_; /**< constraints types */
   DblVec solution_;                /**< optimizizer's solution for current model */
+  DblVec dual_solution_;           /**< duals of the solution, variable bounds followed by constraint rows */
+  WarmStart warm_start_;           /**< starting point for the next solve which has to initialize qpOASES */
 
   IntVec H_row_indices_;     /**< row indices for Hessian, CSC format */
   IntVec H_column_pointers_; /**< column pointers for Hessian, CSC format */
@@ -69,7 +80,14 @@ class qpOASESModel : public Model
   DblVec A_csc_data_;        /**< constraint matrix values in CSC format */
   DblVec lbA_, ubA_;         /**< linear constraints upper and lower limits */
 
-  QuadExpr objective_; /**< objective QuadExpr expression */
+  QuadExpr objective_;          /**< objective QuadExpr expression */
+  QuadExpr constant_objective_; /**< constant part of the objective, see setConstantObjective() */
+
+  IntVec H_constant_row_indices_;              /**< row indices for the constant part of the Hessian, CSC format */
+  IntVec H_constant_column_pointers_;          /**< column pointers for the constant part of the Hessian, CSC format */
+  DblVec H_constant_csc_data_;                 /**< values of the constant part of the Hessian in CSC format */
+  Eigen::VectorXd g_constant_;                 /**< gradient of the constant part of the objective */
+  bool constant_objective_assembled_{ false }; /**< whether the CSC arrays match constant_objective_ */
 
 public:
   qpOASESModel();
@@ -79,6 +97,7 @@ public:
   Cnt addEqCnt(const AffExpr&, const std::string& name) override;
   Cnt addIneqCnt(const AffExpr&, const std::string& name) override;
   Cnt addIneqCnt(const QuadExpr&, const std::string& name) override;
+  bool updateCnt(const Cnt& cnt, const AffExpr& expr) override;
   void removeVars(const VarVector& vars) override;
   void removeCnts(const CntVector& cnts) override;
 
@@ -88,7 +107,12 @@ public:
   virtual CvxOptStatus optimize() override;
   virtual void setObjective(const AffExpr&) override;
   virtual void setObjective(const QuadExpr&) override;
+  bool setConstantObjective(const QuadExpr& expr) override;
   virtual void writeToFile(const std::string& fname) const override;
   virtual VarVector getVars() const override;
+  /** qpOASES only needs the starting point when the problem has to be initialized, hotstarts already continue from
+   *  the previous active set */
+  void setWarmStart(const WarmStart& start) override;
+  WarmStart getWarmStart() const override;
 };
 }  // namespace sco
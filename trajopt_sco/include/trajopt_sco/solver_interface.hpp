@@ -33,6 +33,8 @@ enum ConstraintType
 
 using ConstraintTypeVector = std::vector<ConstraintType>;
 
+struct WarmStart;
+
 enum CvxOptStatus
 {
   CVX_SOLVED,
@@ -67,6 +69,12 @@ public:
   virtual Cnt addIneqCnt(const AffExpr&, const std::string& name) = 0;   // expr <= 0
   virtual Cnt addIneqCnt(const QuadExpr&, const std::string& name) = 0;  // expr <= 0
 
+  /**
+   * @brief Replace the expression of an existing affine constraint in place, keeping its row and type
+   * @return False if the backend does not support in-place updates, in which case the model is unchanged
+   */
+  virtual bool updateCnt(const Cnt& cnt, const AffExpr& expr);
+
   virtual void removeVar(const Var& var);
   virtual void removeCnt(const Cnt& cnt);
   virtual void removeVars(const VarVector& vars) = 0;
@@ -81,9 +89,34 @@ public:
 
   virtual void setObjective(const AffExpr&) = 0;
   virtual void setObjective(const QuadExpr&) = 0;
+
+  /**
+   * @brief Set a part of the objective which stays the same over many solves. It is added to the objective passed to
+   * setObjective(), so backends can assemble it once instead of for every solve.
+   *
+   * Its variables have to stay in the model while it is set. An empty expression removes it.
+   * @return False if the backend does not support a constant part, in which case the model is unchanged
+   */
+  virtual bool setConstantObjective(const QuadExpr& expr);
+
   virtual void writeToFile(const std::string& fname) const = 0;
 
   virtual VarVector getVars() const = 0;
+
+  /**
+   * @brief Provide a starting point for the next call to optimize()
+   *
+   * The values are matched to the variables and constraints themselves instead of their current column/row, so the
+   * start stays valid if the model is updated in between. Variables and constraints which are not part of the start,
+   * or no longer part of the model, start at zero. Backends without warm start support ignore it.
+   */
+  virtual void setWarmStart(const WarmStart& start);
+
+  /**
+   * @brief Get the primal and dual solution of the last call to optimize() as a starting point
+   * @return An empty start if the backend does not support warm starting or nothing was solved yet
+   */
+  virtual WarmStart getWarmStart() const;
 };
 
 struct VarRep
@@ -194,6 +227,23 @@ struct QuadExpr
   double value(const DblVec& x) const;
 };
 
+/**
+ * @brief Primal and dual starting point of a Model, see Model::setWarmStart
+ *
+ * The duals use the sign convention of the backend which produced them, so they should only be passed back to a
+ * model of the same type. Either dual vector may be left empty.
+ */
+struct WarmStart
+{
+  VarVector vars;
+  DblVec primal;    /**< values of vars */
+  DblVec var_duals; /**< duals of the bounds of vars */
+  CntVector cnts;
+  DblVec cnt_duals; /**< duals of cnts */
+
+  bool empty() const { return vars.empty() && cnts.empty(); }
+};
+
 std::ostream& operator<<(std::ostream&, const Var&);
 std::ostream& operator<<(std::ostream&, const Cnt&);
 std::ostream& operator<<(std::ostream&, const AffExpr&);
@@ -6,6 +6,7 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 #include <iostream>
 TRAJOPT_IGNORE_WARNINGS_POP
 
+#include <trajopt_sco/indexed_expr.hpp>
 #include <trajopt_sco/solver_interface.hpp>
 
 namespace sco
@@ -44,6 +45,64 @@ void exprToEigen(const QuadExpr& expr,
                  const bool& matrix_is_halved = false,
                  const bool& force_diagonal = false);
 
+/**
+ * @brief transform a `QuadExpr` directly into compressed sparse column (CSC)
+ *        arrays plus an `Eigen::VectorXd`, without intermediate sparse matrices.
+ *
+ *        The terms are bucketed by row and then scattered column by column, so
+ *        the row indices of every column come out sorted and duplicate terms
+ *        are merged on the way. Same semantics as the `exprToEigen` overload.
+ *
+ * @param [in] expr a `QuadExpr` expression
+ * @param [out] row_indices row indices of the CSC matrix
+ * @param [out] column_pointers column pointers of the CSC matrix, `n_vars + 1`
+ *                              entries ending with the number of non-zeros
+ * @param [out] values non-zero elements of the CSC matrix
+ * @param [out] vector vector where to store the affine part of the
+ *                     `QuadExpr`. It will be resized to the correct size.
+ * @param [in] n_vars the number of variables in expr
+ * @param [in] matrix_is_halved if `true`, the matrix will be premultiplied
+ *                              by the coefficient `2`.
+ * @param [in] force_diagonal if true, every diagonal element is stored,
+ *                            adding `0.` if needed
+ * @param [in] upper_triangular if true, only the upper triangle of the
+ *                              symmetric matrix is stored (e.g. for OSQP)
+ */
+template <typename T>
+void exprToCSC(const QuadExpr& expr,
+               std::vector<T>& row_indices,
+               std::vector<T>& column_pointers,
+               DblVec& values,
+               Eigen::VectorXd& vector,
+               const int& n_vars,
+               const bool& matrix_is_halved = false,
+               const bool& force_diagonal = false,
+               const bool& upper_triangular = false);
+
+/**
+ * @brief add a matrix in compressed sparse column (CSC) format to another one,
+ *        e.g. a constant part of a Hessian assembled once by `exprToCSC`.
+ *
+ *        The row indices of every column have to be sorted, as returned by
+ *        `exprToCSC`, and stay sorted in the sum.
+ *
+ * @param [in] row_indices row indices of the matrix which is added
+ * @param [in] column_pointers column pointers of the matrix which is added. It
+ *                             may have fewer columns than the sum, the missing
+ *                             ones are empty.
+ * @param [in] values non-zero elements of the matrix which is added
+ * @param [in,out] sum_row_indices row indices of the sum
+ * @param [in,out] sum_column_pointers column pointers of the sum
+ * @param [in,out] sum_values non-zero elements of the sum
+ */
+template <typename T>
+void addCSC(const std::vector<T>& row_indices,
+            const std::vector<T>& column_pointers,
+            const DblVec& values,
+            std::vector<T>& sum_row_indices,
+            std::vector<T>& sum_column_pointers,
+            DblVec& sum_values);
+
 /**
  * @brief transform a vector of `AffExpr` to an `Eigen::SparseMatrix` plus an
  *        `Eigen::VectorXd`.
@@ -65,6 +124,59 @@ void exprToEigen(const AffExprVector& expr_vec,
                  Eigen::SparseMatrix<double>& sparse_matrix,
                  Eigen::VectorXd& vector,
                  const int& n_vars = -1);
+/**
+ * @brief transform a vector of `AffExpr` directly into compressed sparse
+ *        column (CSC) arrays plus an `Eigen::VectorXd`, without intermediate
+ *        sparse matrices. Same semantics as the `exprToEigen` overload.
+ *
+ * @param [in] expr_vec an `AffExprVector`
+ * @param [out] row_indices row indices of the CSC matrix
+ * @param [out] column_pointers column pointers of the CSC matrix, `n_vars + 1`
+ *                              entries ending with the number of non-zeros
+ * @param [out] values non-zero elements of the CSC matrix
+ * @param [out] vector vector where to store the negated constants of each
+ *                     `AffExpr`. It will be resized to the correct size.
+ * @param [in] n_vars the number of variables in expr_vec
+ * @param [in] append_identity if true, the `n_vars` rows of the identity
+ *                             matrix are appended below the expressions
+ *                             (e.g. for the variable bounds of OSQP)
+ */
+template <typename T>
+void exprToCSC(const AffExprVector& expr_vec,
+               std::vector<T>& row_indices,
+               std::vector<T>& column_pointers,
+               DblVec& values,
+               Eigen::VectorXd& vector,
+               const int& n_vars,
+               const bool& append_identity = false);
+
+/**
+ * @brief transform an `IndexedAffExpr` to an `Eigen::SparseVector`.
+ *        Same semantics as the `AffExpr` overload.
+ */
+void exprToEigen(const IndexedAffExpr& expr, Eigen::SparseVector<double>& sparse_vector, const int& n_vars);
+
+/**
+ * @brief transform an `IndexedQuadExpr` to an `Eigen::SparseMatrix` plus
+ *        `Eigen::VectorXd`. Same semantics as the `QuadExpr` overload, but the
+ *        symmetric matrix is assembled in a single `setFromTriplets` pass.
+ */
+void exprToEigen(const IndexedQuadExpr& expr,
+                 Eigen::SparseMatrix<double>& sparse_matrix,
+                 Eigen::VectorXd& vector,
+                 const int& n_vars,
+                 const bool& matrix_is_halved = false,
+                 const bool& force_diagonal = false);
+
+/**
+ * @brief transform a vector of `IndexedAffExpr` to an `Eigen::SparseMatrix`
+ *        plus an `Eigen::VectorXd`. Same semantics as the `AffExprVector` overload.
+ */
+void exprToEigen(const IndexedAffExprVector& expr_vec,
+                 Eigen::SparseMatrix<double>& sparse_matrix,
+                 Eigen::VectorXd& vector,
+                 const int& n_vars = -1);
+
 /**
  * @brief Converts triplets to an `Eigen::SparseMatrix`.
  * @param [in] rows_i a vector of row indices
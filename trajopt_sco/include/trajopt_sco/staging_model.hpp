@@ -0,0 +1,83 @@
+#pragma once
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <memory>
+#include <string>
+#include <vector>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_sco/modeling.hpp>
+#include <trajopt_sco/solver_interface.hpp>
+
+namespace sco
+{
+/**
+ * @brief A Model decorator which allows a single Cost or Constraint to be convexified on a worker thread.
+ *
+ * Models are not thread safe, so while staging the variables requested through addVar are only recorded and handed
+ * out as placeholders, and everything else that would modify the underlying model throws. Once all terms have been
+ * convexified, commit() adds the recorded variables to the underlying model in the order they were requested and
+ * replaces the placeholders in the convexification. From then on every call is forwarded, so the convexification
+ * can be added to and removed from the model as usual.
+ *
+ * Committing the terms one after the other in a fixed order results in exactly the same model as convexifying them
+ * serially, independent of the number of threads.
+ */
+class StagingModel : public Model
+{
+public:
+  using Ptr = std::shared_ptr<StagingModel>;
+
+  /** @param model The underlying model. It must outlive this object. */
+  explicit StagingModel(Model* model);
+
+  Var addVar(const std::string& name) override;
+  Var addVar(const std::string& name, double lb, double ub) override;
+  Cnt addEqCnt(const AffExpr&, const std::string& name) override;
+  Cnt addIneqCnt(const AffExpr&, const std::string& name) override;
+  Cnt addIneqCnt(const QuadExpr&, const std::string& name) override;
+  bool updateCnt(const Cnt& cnt, const AffExpr& expr) override;
+  /** @brief Placeholders which were never committed are dropped, other variables are removed */
+  void removeVars(const VarVector& vars) override;
+  void removeCnts(const CntVector& cnts) override;
+
+  void update() override;
+  void setVarBounds(const VarVector& vars, const DblVec& lower, const DblVec& upper) override;
+  DblVec getVarValues(const VarVector& vars) const override;
+  CvxOptStatus optimize() override;
+  void setObjective(const AffExpr&) override;
+  void setObjective(const QuadExpr&) override;
+  bool setConstantObjective(const QuadExpr& expr) override;
+  void writeToFile(const std::string& fname) const override;
+  VarVector getVars() const override;
+
+  /** @brief Add the staged variables to the underlying model and replace the placeholders in the convexification */
+  void commit(ConvexObjective& obj);
+  /** @copydoc commit(ConvexObjective&) */
+  void commit(ConvexConstraints& cnts);
+
+  /** @brief True until commit() is called */
+  bool isStaging() const { return staging_; }
+
+private:
+  struct StagedVar
+  {
+    std::string name;
+    double lb;
+    double ub;
+  };
+
+  Model* model_;
+  bool staging_{ true };
+  std::vector<StagedVar> staged_vars_;
+  /** @brief The variables the placeholders were committed as, indexed like staged_vars_ */
+  VarVector committed_vars_;
+
+  bool isPlaceholder(const Var& var) const;
+  void commitVars();
+  void replacePlaceholders(VarVector& vars) const;
+  void replacePlaceholders(AffExpr& expr) const;
+  void replacePlaceholders(AffExprVector& exprs) const;
+  void assertNotStaging(const char* function) const;
+};
+}  // namespace sco
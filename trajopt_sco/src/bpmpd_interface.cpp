@@ -259,6 +259,13 @@ Cnt BPMPDModel::addIneqCnt(const QuadExpr&, const std::string& /*name*/)
   throw std::runtime_error("BPMPDModel::addIneqCnt is not implemented yet!");
 }
 
+bool BPMPDModel::updateCnt(const Cnt& cnt, const AffExpr& expr)
+{
+  assert(cnt.cnt_rep->creator == this && !cnt.cnt_rep->removed);
+  m_cntExprs[cnt.cnt_rep->index] = expr;
+  return true;
+}
+
 void BPMPDModel::removeVars(const VarVector& vars)
 {
   SizeTVec inds;
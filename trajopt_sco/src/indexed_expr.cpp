@@ -0,0 +1,314 @@
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_sco/indexed_expr.hpp>
+
+namespace sco
+{
+VarTable::VarTable(const VarVector& vars) { sync(vars); }
+VarTable::VarTable(const Model& model) { sync(model); }
+
+void VarTable::sync(const VarVector& vars)
+{
+  vars_.clear();
+  vars_.resize(vars.size());
+  for (const Var& v : vars)
+  {
+    if (v.var_rep->index >= vars_.size())
+      vars_.resize(v.var_rep->index + 1);
+    vars_[v.var_rep->index] = v;
+  }
+}
+
+void VarTable::sync(const Model& model) { sync(model.getVars()); }
+
+IndexedAffExpr::IndexedAffExpr(const AffExpr& expr) : constant(expr.constant), coeffs(expr.coeffs)
+{
+  inds.resize(expr.vars.size());
+  for (size_t i = 0; i < inds.size(); ++i)
+    inds[i] = varIndex(expr.vars[i]);
+}
+
+double IndexedAffExpr::value(const double* x) const
+{
+  double out = constant;
+  for (size_t i = 0; i < size(); ++i)
+    out += coeffs[i] * x[inds[i]];
+  return out;
+}
+
+double IndexedAffExpr::value(const DblVec& x) const { return value(x.data()); }
+
+IndexedQuadExpr::IndexedQuadExpr(const QuadExpr& expr) : affexpr(expr.affexpr), coeffs(expr.coeffs)
+{
+  inds1.resize(expr.vars1.size());
+  inds2.resize(expr.vars2.size());
+  for (size_t i = 0; i < inds1.size(); ++i)
+  {
+    inds1[i] = varIndex(expr.vars1[i]);
+    inds2[i] = varIndex(expr.vars2[i]);
+  }
+}
+
+double IndexedQuadExpr::value(const double* x) const
+{
+  double out = affexpr.value(x);
+  for (size_t i = 0; i < size(); ++i)
+    out += coeffs[i] * x[inds1[i]] * x[inds2[i]];
+  return out;
+}
+
+double IndexedQuadExpr::value(const DblVec& x) const { return value(x.data()); }
+
+AffExpr toAffExpr(const IndexedAffExpr& expr, const VarTable& table)
+{
+  AffExpr out(expr.constant);
+  out.coeffs = expr.coeffs;
+  out.vars.reserve(expr.size());
+  for (VarIndex ind : expr.inds)
+    out.vars.push_back(table.var(ind));
+  return out;
+}
+
+QuadExpr toQuadExpr(const IndexedQuadExpr& expr, const VarTable& table)
+{
+  QuadExpr out(toAffExpr(expr.affexpr, table));
+  out.coeffs = expr.coeffs;
+  out.vars1.reserve(expr.size());
+  out.vars2.reserve(expr.size());
+  for (size_t i = 0; i < expr.size(); ++i)
+  {
+    out.vars1.push_back(table.var(expr.inds1[i]));
+    out.vars2.push_back(table.var(expr.inds2[i]));
+  }
+  return out;
+}
+
+void exprInc(IndexedQuadExpr& a, const QuadExpr& b)
+{
+  exprInc(a.affexpr, b.affexpr);
+  a.coeffs.insert(a.coeffs.end(), b.coeffs.begin(), b.coeffs.end());
+  a.inds1.reserve(a.inds1.size() + b.size());
+  a.inds2.reserve(a.inds2.size() + b.size());
+  for (size_t i = 0; i < b.size(); ++i)
+  {
+    a.inds1.push_back(varIndex(b.vars1[i]));
+    a.inds2.push_back(varIndex(b.vars2[i]));
+  }
+}
+
+IndexedQuadExpr exprMult(const IndexedAffExpr& affexpr1, const IndexedAffExpr& affexpr2)
+{
+  IndexedQuadExpr out;
+  size_t naff1 = affexpr1.size();
+  size_t naff2 = affexpr2.size();
+  size_t nquad = naff1 * naff2;
+
+  // Multiply the constants of the two expr
+  out.affexpr.constant = affexpr1.constant * affexpr2.constant;
+
+  // Account for vars in each expr multiplied by the constant in the other expr
+  out.affexpr.inds.reserve(naff1 + naff2);
+  out.affexpr.inds.insert(out.affexpr.inds.end(), affexpr1.inds.begin(), affexpr1.inds.end());
+  out.affexpr.inds.insert(out.affexpr.inds.end(), affexpr2.inds.begin(), affexpr2.inds.end());
+  out.affexpr.coeffs.resize(naff1 + naff2);
+  for (size_t i = 0; i < naff1; ++i)
+    out.affexpr.coeffs[i] = affexpr2.constant * affexpr1.coeffs[i];
+  for (size_t i = 0; i < naff2; ++i)
+    out.affexpr.coeffs[i + naff1] = affexpr1.constant * affexpr2.coeffs[i];
+
+  // Account for the vars in each expr that are multipled by another var in the other expr
+  out.reserve(nquad);
+  for (size_t i = 0; i < naff1; ++i)
+  {
+    for (size_t j = 0; j < naff2; ++j)
+    {
+      out.inds1.push_back(affexpr1.inds[i]);
+      out.inds2.push_back(affexpr2.inds[j]);
+      out.coeffs.push_back(affexpr1.coeffs[i] * affexpr2.coeffs[j]);
+    }
+  }
+  return out;
+}
+
+IndexedQuadExpr exprSquare(const IndexedAffExpr& affexpr)
+{
+  IndexedQuadExpr out;
+  size_t naff = affexpr.size();
+  size_t nquad = (naff * (naff + 1)) / 2;
+
+  out.affexpr.constant = sq(affexpr.constant);
+
+  out.affexpr.inds = affexpr.inds;
+  out.affexpr.coeffs.resize(naff);
+  for (size_t i = 0; i < naff; ++i)
+    out.affexpr.coeffs[i] = 2 * affexpr.constant * affexpr.coeffs[i];
+
+  out.reserve(nquad);
+  for (size_t i = 0; i < naff; ++i)
+  {
+    out.inds1.push_back(affexpr.inds[i]);
+    out.inds2.push_back(affexpr.inds[i]);
+    out.coeffs.push_back(sq(affexpr.coeffs[i]));
+    for (size_t j = i + 1; j < naff; ++j)
+    {
+      out.inds1.push_back(affexpr.inds[i]);
+      out.inds2.push_back(affexpr.inds[j]);
+      out.coeffs.push_back(2 * affexpr.coeffs[i] * affexpr.coeffs[j]);
+    }
+  }
+  return out;
+}
+
+IndexedAffExpr cleanupAff(const IndexedAffExpr& a)
+{
+  IndexedAffExpr out(a.constant);
+  out.reserve(a.size());
+  for (size_t i = 0; i < a.size(); ++i)
+  {
+    if (fabs(a.coeffs[i]) > 1e-7)
+    {
+      out.coeffs.push_back(a.coeffs[i]);
+      out.inds.push_back(a.inds[i]);
+    }
+  }
+  return out;
+}
+
+void simplify(IndexedAffExpr& expr)
+{
+  if (expr.size() == 0)
+    return;
+
+  std::vector<size_t> order(expr.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&expr](size_t a, size_t b) { return expr.inds[a] < expr.inds[b]; });
+
+  DblVec coeffs;
+  VarIndexVector inds;
+  coeffs.reserve(expr.size());
+  inds.reserve(expr.size());
+  for (size_t k : order)
+  {
+    if (!inds.empty() && inds.back() == expr.inds[k])
+      coeffs.back() += expr.coeffs[k];
+    else
+    {
+      inds.push_back(expr.inds[k]);
+      coeffs.push_back(expr.coeffs[k]);
+    }
+  }
+
+  expr.coeffs.clear();
+  expr.inds.clear();
+  for (size_t i = 0; i < inds.size(); ++i)
+  {
+    if (coeffs[i] != 0.)
+    {
+      expr.coeffs.push_back(coeffs[i]);
+      expr.inds.push_back(inds[i]);
+    }
+  }
+}
+
+void simplify(IndexedQuadExpr& expr)
+{
+  simplify(expr.affexpr);
+  if (expr.size() == 0)
+    return;
+
+  for (size_t i = 0; i < expr.size(); ++i)
+  {
+    if (expr.inds2[i] < expr.inds1[i])
+      std::swap(expr.inds1[i], expr.inds2[i]);
+  }
+
+  std::vector<size_t> order(expr.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&expr](size_t a, size_t b) {
+    return expr.inds1[a] < expr.inds1[b] || (expr.inds1[a] == expr.inds1[b] && expr.inds2[a] < expr.inds2[b]);
+  });
+
+  DblVec coeffs;
+  VarIndexVector inds1, inds2;
+  coeffs.reserve(expr.size());
+  inds1.reserve(expr.size());
+  inds2.reserve(expr.size());
+  for (size_t k : order)
+  {
+    if (!inds1.empty() && inds1.back() == expr.inds1[k] && inds2.back() == expr.inds2[k])
+      coeffs.back() += expr.coeffs[k];
+    else
+    {
+      inds1.push_back(expr.inds1[k]);
+      inds2.push_back(expr.inds2[k]);
+      coeffs.push_back(expr.coeffs[k]);
+    }
+  }
+
+  expr.coeffs.clear();
+  expr.inds1.clear();
+  expr.inds2.clear();
+  for (size_t i = 0; i < coeffs.size(); ++i)
+  {
+    if (coeffs[i] != 0.)
+    {
+      expr.coeffs.push_back(coeffs[i]);
+      expr.inds1.push_back(inds1[i]);
+      expr.inds2.push_back(inds2[i]);
+    }
+  }
+}
+
+std::ostream& operator<<(std::ostream& o, const IndexedAffExpr& e)
+{
+  std::string sep;
+  if (e.constant != 0)
+  {
+    o << e.constant;
+    sep = " + ";
+  }
+
+  for (size_t i = 0; i < e.size(); ++i)
+  {
+    if (e.coeffs[i] != 0)
+    {
+      if (e.coeffs[i] == 1)
+        o << sep << "x" << e.inds[i];
+      else
+        o << sep << e.coeffs[i] << " x" << e.inds[i];
+      sep = " + ";
+    }
+  }
+  return o;
+}
+
+std::ostream& operator<<(std::ostream& o, const IndexedQuadExpr& e)
+{
+  o << e.affexpr;
+  o << " + [ ";
+
+  std::string op;
+  for (size_t i = 0; i < e.size(); ++i)
+  {
+    if (e.coeffs[i] != 0)
+    {
+      o << op;
+      if (e.coeffs[i] != 1)
+        o << e.coeffs[i] << " ";
+      if (e.inds1[i] == e.inds2[i])
+        o << "x" << e.inds1[i] << " ^ 2";
+      else
+        o << "x" << e.inds1[i] << " * x" << e.inds2[i];
+      op = " + ";
+    }
+  }
+  o << " ]";
+  return o;
+}
+}  // namespace sco
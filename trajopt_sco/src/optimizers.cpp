@@ -4,13 +4,17 @@ TRAJOPT_IGNORE_WARNINGS_PUSH
 #include <cmath>
 #include <chrono>
 #include <cstdio>
+#include <map>
 TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt_sco/expr_ops.hpp>
+#include <trajopt_sco/indexed_expr.hpp>
 #include <trajopt_sco/modeling.hpp>
 #include <trajopt_sco/optimizers.hpp>
+#include <trajopt_sco/persistent_model.hpp>
 #include <trajopt_sco/sco_common.hpp>
 #include <trajopt_sco/solver_interface.hpp>
+#include <trajopt_sco/staging_model.hpp>
 #include <trajopt_utils/logging.hpp>
 #include <trajopt_utils/macros.h>
 #include <trajopt_utils/stl_to_string.hpp>
@@ -26,7 +30,53 @@ std::ostream& operator<<(std::ostream& o, const OptResults& r)
     << "cost values: " << util::Str(r.cost_vals) << std::endl
     << "constraint violations: " << util::Str(r.cnt_viols) << std::endl
     << "n func evals: " << r.n_func_evals << std::endl
-    << "n qp solves: " << r.n_qp_solves << std::endl;
+    << "n qp solves: " << r.n_qp_solves << std::endl
+    << "n sqp iterations: " << r.n_sqp_iters << std::endl;
+  if (r.n_value_cache_hits + r.n_value_cache_misses + r.n_convex_cache_hits + r.n_convex_cache_misses > 0)
+  {
+    o << "term value cache hits/misses: " << r.n_value_cache_hits << "/" << r.n_value_cache_misses << std::endl
+      << "term convexification cache hits/misses: " << r.n_convex_cache_hits << "/" << r.n_convex_cache_misses
+      << std::endl;
+  }
+  if (r.timings.total > 0)
+  {
+    o << "time [s] total: " << r.timings.total << ", convexify: " << r.timings.convexify
+      << ", update model: " << r.timings.update_model << ", qp solve: " << r.timings.qp_solve
+      << ", evaluate: " << r.timings.evaluate << ", callbacks: " << r.timings.callbacks << std::endl;
+  }
+  return o;
+}
+
+std::ostream& operator<<(std::ostream& o, const OptTimings& t)
+{
+  o << "Optimization timings [s]:" << std::endl
+    << "total: " << t.total << std::endl
+    << "convexify: " << t.convexify << std::endl
+    << "update model: " << t.update_model << std::endl
+    << "qp solve: " << t.qp_solve << std::endl
+    << "evaluate: " << t.evaluate << std::endl
+    << "callbacks: " << t.callbacks << std::endl;
+
+  auto printTerms = [&o](const char* header, const std::vector<TermTiming>& terms) {
+    std::map<std::string, TermTiming> by_name;
+    for (const TermTiming& term : terms)
+    {
+      TermTiming& sum = by_name[term.name];
+      sum.convexify += term.convexify;
+      sum.evaluate += term.evaluate;
+      sum.n_convexify += term.n_convexify;
+      sum.n_evaluate += term.n_evaluate;
+    }
+    if (!by_name.empty())
+      o << header << " (convexify s/calls, evaluate s/calls):" << std::endl;
+    for (const auto& term : by_name)
+    {
+      o << "  " << term.first << ": " << term.second.convexify << "/" << term.second.n_convexify << ", "
+        << term.second.evaluate << "/" << term.second.n_evaluate << std::endl;
+    }
+  };
+  printTerms("costs", t.costs);
+  printTerms("constraints", t.cnts);
   return o;
 }
 
@@ -34,45 +84,279 @@ std::ostream& operator<<(std::ostream& o, const OptResults& r)
 ////////// private utility functions for  sqp /////////
 //////////////////////////////////////////////////
 
-static DblVec evaluateCosts(const std::vector<Cost::Ptr>& costs, const DblVec& x)
+using SteadyClock = std::chrono::steady_clock;
+/** @brief Seconds elapsed since start */
+static double secondsSince(const SteadyClock::time_point& start)
 {
-  DblVec out(costs.size());
-  for (size_t i = 0; i < costs.size(); ++i)
+  return std::chrono::duration<double>(SteadyClock::now() - start).count();
+}
+
+/**
+ * @brief Split the terms to compute into the ones which may run on the thread pool and the ones which have to run
+ * serially, see Cost::isThreadSafe. Without a thread pool all terms run serially.
+ */
+template <typename Term>
+static void splitThreadSafeTerms(const std::vector<std::shared_ptr<Term>>& terms,
+                                 const std::vector<std::size_t>& indices,
+                                 const util::ThreadPool* thread_pool,
+                                 std::vector<std::size_t>& concurrent,
+                                 std::vector<std::size_t>& serial)
+{
+  concurrent.clear();
+  serial.clear();
+  for (std::size_t i : indices)
   {
-    out[i] = costs[i]->value(x);
+    if (thread_pool != nullptr && terms[i]->isThreadSafe())
+      concurrent.push_back(i);
+    else
+      serial.push_back(i);
   }
-  return out;
 }
-static DblVec evaluateConstraintViols(const std::vector<Constraint::Ptr>& constraints, const DblVec& x)
+
+/*
+ * The exact evaluations of thread safe terms run on thread_pool if one is given, all other terms are evaluated
+ * serially afterwards. Every term writes to its own slot, so the results and any sum over them taken in index order
+ * are identical to the serial evaluation. Terms found in cache are not evaluated again. The time spent on each
+ * evaluated term is added to term_timings if given.
+ */
+template <typename Term, typename Evaluate>
+static DblVec evaluateTerms(const std::vector<std::shared_ptr<Term>>& terms,
+                            const DblVec& x,
+                            util::ThreadPool* thread_pool,
+                            TermCache<double>* cache,
+                            std::vector<TermTiming>* term_timings,
+                            const Evaluate& evaluate)
 {
-  DblVec out(constraints.size());
-  for (size_t i = 0; i < constraints.size(); ++i)
+  DblVec out(terms.size());
+  std::vector<std::size_t> misses;
+  misses.reserve(terms.size());
+  for (std::size_t i = 0; i < terms.size(); ++i)
   {
-    out[i] = constraints[i]->violation(x);
+    if (cache == nullptr || !cache->lookup(i, x, out[i]))
+      misses.push_back(i);
+  }
+
+  auto evaluateTerm = [&](std::size_t i) {
+    if (term_timings == nullptr)
+    {
+      out[i] = evaluate(*terms[i]);
+      return;
+    }
+    const auto start = SteadyClock::now();
+    out[i] = evaluate(*terms[i]);
+    TermTiming& timing = (*term_timings)[i];
+    timing.evaluate += secondsSince(start);
+    ++timing.n_evaluate;
+  };
+
+  std::vector<std::size_t> concurrent;
+  std::vector<std::size_t> serial;
+  splitThreadSafeTerms(terms, misses, thread_pool, concurrent, serial);
+  if (!concurrent.empty())
+    thread_pool->parallelFor(concurrent.size(), [&](std::size_t j) { evaluateTerm(concurrent[j]); });
+  for (std::size_t i : serial)
+    evaluateTerm(i);
+
+  if (cache != nullptr)
+  {
+    for (std::size_t i : misses)
+      cache->store(i, x, out[i]);
   }
   return out;
 }
-static std::vector<ConvexObjective::Ptr> convexifyCosts(const std::vector<Cost::Ptr>& costs,
-                                                        const DblVec& x,
-                                                        Model* model)
+static DblVec evaluateCosts(const std::vector<Cost::Ptr>& costs,
+                            const DblVec& x,
+                            util::ThreadPool* thread_pool = nullptr,
+                            TermCache<double>* cache = nullptr,
+                            std::vector<TermTiming>* term_timings = nullptr)
 {
-  std::vector<ConvexObjective::Ptr> out(costs.size());
-  for (size_t i = 0; i < costs.size(); ++i)
+  return evaluateTerms(costs, x, thread_pool, cache, term_timings, [&x](Cost& cost) { return cost.value(x); });
+}
+static DblVec evaluateConstraintViols(const std::vector<Constraint::Ptr>& constraints,
+                                      const DblVec& x,
+                                      util::ThreadPool* thread_pool = nullptr,
+                                      TermCache<double>* cache = nullptr,
+                                      std::vector<TermTiming>* term_timings = nullptr)
+{
+  return evaluateTerms(
+      constraints, x, thread_pool, cache, term_timings, [&x](Constraint& cnt) { return cnt.violation(x); });
+}
+/** @brief The model term i should be convexified into: its persistent model if there is one, otherwise model */
+static Model* termModel(const std::vector<PersistentTermModel::Ptr>& term_models, size_t i, Model* model)
+{
+  return term_models.empty() ? model : term_models[i].get();
+}
+static std::vector<PersistentTermModel::Ptr> createTermModels(size_t n_terms, Model* model)
+{
+  std::vector<PersistentTermModel::Ptr> out(n_terms);
+  for (auto& term_model : out)
+    term_model = std::make_shared<PersistentTermModel>(model);
+  return out;
+}
+static void flushTermModels(const std::vector<PersistentTermModel::Ptr>& term_models)
+{
+  for (const auto& term_model : term_models)
+    term_model->flush();
+}
+/** @brief A cached convexification together with the staging model it refers to, if it was convexified concurrently */
+template <typename Convexification>
+struct CachedConvexification
+{
+  // Declared first so it is destroyed after the convexification, which removes itself through it
+  StagingModel::Ptr staging_model;
+  std::shared_ptr<Convexification> convexification;
+};
+
+/**
+ * @brief Convexify the terms, the thread safe ones concurrently if a thread pool is given (see Cost::isThreadSafe).
+ *
+ * In the concurrent case each term is convexified into its own StagingModel, which are then committed serially in
+ * the order of the terms. The staging models are returned through staging_models since the convexifications keep
+ * pointers to them, so they have to outlive the convexifications.
+ *
+ * Terms found in cache reuse their convexification, which is still part of the model. Terms with an entry in
+ * precomputed (empty if there are none) are not convexified at all. The time spent on each convexified term is added
+ * to term_timings if given.
+ */
+template <typename Term, typename Convexification>
+static std::vector<std::shared_ptr<Convexification>>
+convexifyTerms(const std::vector<std::shared_ptr<Term>>& terms,
+               const DblVec& x,
+               Model* model,
+               const std::vector<PersistentTermModel::Ptr>& term_models,
+               util::ThreadPool* thread_pool,
+               std::vector<StagingModel::Ptr>& staging_models,
+               TermCache<CachedConvexification<Convexification>>* cache,
+               const std::vector<std::shared_ptr<Convexification>>& precomputed,
+               std::vector<TermTiming>* term_timings)
+{
+  std::vector<std::shared_ptr<Convexification>> out(terms.size());
+  staging_models.resize(terms.size());
+  std::vector<std::size_t> misses;
+  misses.reserve(terms.size());
+  for (size_t i = 0; i < terms.size(); ++i)
   {
-    out[i] = costs[i]->convex(x, model);
+    CachedConvexification<Convexification> cached;
+    if (!precomputed.empty() && precomputed[i])
+    {
+      out[i] = precomputed[i];
+    }
+    else if (cache != nullptr && cache->lookup(i, x, cached))
+    {
+      staging_models[i] = cached.staging_model;
+      out[i] = cached.convexification;
+    }
+    else
+    {
+      misses.push_back(i);
+    }
+  }
+
+  auto convexifyTerm = [&](size_t i, Model* term_model) {
+    if (term_timings == nullptr)
+    {
+      out[i] = terms[i]->convex(x, term_model);
+      return;
+    }
+    const auto start = SteadyClock::now();
+    out[i] = terms[i]->convex(x, term_model);
+    TermTiming& timing = (*term_timings)[i];
+    timing.convexify += secondsSince(start);
+    ++timing.n_convexify;
+  };
+
+  if (thread_pool == nullptr)
+  {
+    for (size_t i : misses)
+      convexifyTerm(i, termModel(term_models, i, model));
+  }
+  else
+  {
+    // Terms which are not thread safe are staged as well, so all terms are added to the model in the same order
+    for (size_t i : misses)
+      staging_models[i] = std::make_shared<StagingModel>(termModel(term_models, i, model));
+
+    std::vector<std::size_t> concurrent;
+    std::vector<std::size_t> serial;
+    splitThreadSafeTerms(terms, misses, thread_pool, concurrent, serial);
+    if (!concurrent.empty())
+    {
+      thread_pool->parallelFor(concurrent.size(), [&](std::size_t j) {
+        const size_t i = concurrent[j];
+        convexifyTerm(i, staging_models[i].get());
+      });
+    }
+    for (size_t i : serial)
+      convexifyTerm(i, staging_models[i].get());
+
+    for (size_t i : misses)
+      staging_models[i]->commit(*out[i]);
+  }
+
+  if (cache != nullptr)
+  {
+    for (size_t i : misses)
+      cache->store(i, x, { staging_models[i], out[i] });
   }
   return out;
 }
-static std::vector<ConvexConstraints::Ptr> convexifyConstraints(const std::vector<Constraint::Ptr>& cnts,
-                                                                const DblVec& x,
-                                                                Model* model)
+static std::vector<ConvexObjective::Ptr>
+convexifyCosts(const std::vector<Cost::Ptr>& costs,
+               const DblVec& x,
+               Model* model,
+               const std::vector<PersistentTermModel::Ptr>& term_models,
+               util::ThreadPool* thread_pool,
+               std::vector<StagingModel::Ptr>& staging_models,
+               TermCache<CachedConvexification<ConvexObjective>>* cache,
+               const std::vector<ConvexObjective::Ptr>& precomputed,
+               std::vector<TermTiming>* term_timings)
 {
-  std::vector<ConvexConstraints::Ptr> out(cnts.size());
-  for (size_t i = 0; i < cnts.size(); ++i)
+  return convexifyTerms<Cost, ConvexObjective>(
+      costs, x, model, term_models, thread_pool, staging_models, cache, precomputed, term_timings);
+}
+static std::vector<ConvexConstraints::Ptr>
+convexifyConstraints(const std::vector<Constraint::Ptr>& cnts,
+                     const DblVec& x,
+                     Model* model,
+                     const std::vector<PersistentTermModel::Ptr>& term_models,
+                     util::ThreadPool* thread_pool,
+                     std::vector<StagingModel::Ptr>& staging_models,
+                     TermCache<CachedConvexification<ConvexConstraints>>* cache,
+                     std::vector<TermTiming>* term_timings)
+{
+  return convexifyTerms<Constraint, ConvexConstraints>(
+      cnts, x, model, term_models, thread_pool, staging_models, cache, {}, term_timings);
+}
+/**
+ * @brief Convexify the costs with a constant convexification once and merge their objectives into a single block.
+ *
+ * The convexifications are returned through cost_models, indexed like costs and null for all other costs, since they
+ * are still needed to evaluate the model value of each cost. vars are the problem variables, which are the only ones
+ * such a cost can refer to.
+ */
+static QuadExpr precomputeConstantCosts(const std::vector<Cost::Ptr>& costs,
+                                        const DblVec& x,
+                                        Model* model,
+                                        const VarVector& vars,
+                                        std::vector<ConvexObjective::Ptr>& cost_models)
+{
+  cost_models.assign(costs.size(), nullptr);
+  IndexedQuadExpr block;
+  for (size_t i = 0; i < costs.size(); ++i)
   {
-    out[i] = cnts[i]->convex(x, model);
+    if (!costs[i]->hasConstantConvexification())
+      continue;
+
+    ConvexObjective::Ptr cost = costs[i]->convex(x, model);
+    // Only quadratic objectives can be merged, anything else is convexified every iteration as usual
+    if (!cost->vars_.empty() || !cost->eqs_.empty() || !cost->ineqs_.empty())
+      continue;
+
+    exprInc(block, cost->quad_);
+    cost_models[i] = cost;
   }
-  return out;
+  simplify(block);
+  return toQuadExpr(block, VarTable(vars));
 }
 
 DblVec evaluateModelCosts(const std::vector<ConvexObjective::Ptr>& costs, const DblVec& x)
@@ -121,13 +405,14 @@ static std::vector<std::string> getVarNames(const VarVector& vars)
 // todo: use different coeffs for each constraint
 std::vector<ConvexObjective::Ptr> cntsToCosts(const std::vector<ConvexConstraints::Ptr>& cnts,
                                               const std::vector<double>& err_coeffs,
-                                              Model* model)
+                                              Model* model,
+                                              const std::vector<PersistentTermModel::Ptr>& term_models = {})
 {
   assert(cnts.size() == err_coeffs.size());
   std::vector<ConvexObjective::Ptr> out;
   for (std::size_t c = 0; c < cnts.size(); ++c)
   {
-    auto obj = std::make_shared<ConvexObjective>(model);
+    auto obj = std::make_shared<ConvexObjective>(termModel(term_models, c, model));
     for (std::size_t idx = 0; idx < cnts[c]->eqs_.size(); ++idx)
     {
       const AffExpr& aff = cnts[c]->eqs_[idx];
@@ -146,10 +431,26 @@ std::vector<ConvexObjective::Ptr> cntsToCosts(const std::vector<ConvexConstraint
 void Optimizer::addCallback(const Callback& cb) { callbacks_.push_back(cb); }
 void Optimizer::callCallbacks()
 {
+  const auto start = SteadyClock::now();
   for (auto& callback : callbacks_)
   {
     callback(prob_.get(), results_);
   }
+  results_.timings.callbacks += secondsSince(start);
+}
+
+void Optimizer::addRefinementCallback(const RefinementCallback& cb) { refinement_callbacks_.push_back(cb); }
+bool Optimizer::callRefinementCallbacks(bool converging)
+{
+  const auto start = SteadyClock::now();
+  bool changed = false;
+  for (auto& callback : refinement_callbacks_)
+  {
+    if (callback(prob_.get(), results_, converging))
+      changed = true;
+  }
+  results_.timings.callbacks += secondsSince(start);
+  return changed;
 }
 
 void Optimizer::initialize(const DblVec& x)
@@ -180,6 +481,12 @@ BasicTrustRegionSQPParameters::BasicTrustRegionSQPParameters()
   initial_merit_error_coeff = 10;
   inflate_constraints_individually = true;
   trust_box_size = 1e-1;
+  persistent_convex_model = false;
+  warm_start_convex_solve = false;
+  convexify_threads = 1;
+  evaluate_threads = 1;
+  reuse_unchanged_terms = false;
+  precompute_constant_costs = false;
   log_results = false;
   log_dir = "/tmp";
 }
@@ -208,6 +515,16 @@ void BasicTrustRegionSQP::setTrustBoxConstraints(const DblVec& x)
   model_->setVarBounds(vars, lbtrust, ubtrust);
 }
 
+util::ThreadPool* BasicTrustRegionSQP::getThreadPool(util::ThreadPool::Ptr& pool, int n_threads)
+{
+  if (n_threads < 2)
+    return nullptr;
+
+  if (!pool || pool->size() != static_cast<std::size_t>(n_threads))
+    pool = std::make_shared<util::ThreadPool>(static_cast<std::size_t>(n_threads));
+  return pool.get();
+}
+
 #if 0
 struct MultiCritFilter {
   /**
@@ -259,7 +576,11 @@ void BasicTrustRegionSQPResults::update(const OptResults& prev_opt_results,
                                         const std::vector<ConvexObjective::Ptr>& cnt_cost_models,
                                         const std::vector<Constraint::Ptr>& constraints,
                                         const std::vector<Cost::Ptr>& costs,
-                                        std::vector<double> merit_error_coeffs)
+                                        std::vector<double> merit_error_coeffs,
+                                        util::ThreadPool* thread_pool,
+                                        TermCache<double>* cost_cache,
+                                        TermCache<double>* cnt_cache,
+                                        OptTimings* timings)
 {
   this->merit_error_coeffs = merit_error_coeffs;
   model_var_vals = model.getVarValues(model.getVars());
@@ -283,8 +604,12 @@ void BasicTrustRegionSQPResults::update(const OptResults& prev_opt_results,
 
   old_cost_vals = prev_opt_results.cost_vals;
   old_cnt_viols = prev_opt_results.cnt_viols;
-  new_cost_vals = evaluateCosts(costs, new_x);
-  new_cnt_viols = evaluateConstraintViols(constraints, new_x);
+  const auto evaluate_start = SteadyClock::now();
+  new_cost_vals = evaluateCosts(costs, new_x, thread_pool, cost_cache, timings ? &timings->costs : nullptr);
+  new_cnt_viols =
+      evaluateConstraintViols(constraints, new_x, thread_pool, cnt_cache, timings ? &timings->cnts : nullptr);
+  if (timings != nullptr)
+    timings->evaluate += secondsSince(evaluate_start);
 
   old_merit = vecSum(old_cost_vals) + vecDot(old_cnt_viols, merit_error_coeffs);
   model_merit = vecSum(model_cost_vals) + vecDot(model_cnt_viols, merit_error_coeffs);
@@ -555,6 +880,7 @@ void BasicTrustRegionSQPResults::printRaw() const
 
 OptStatus BasicTrustRegionSQP::optimize()
 {
+  const auto optimize_start = SteadyClock::now();
   std::vector<std::string> var_names = getVarNames(prob_->getVars());
   std::vector<std::string> cost_names = getCostNames(prob_->getCosts());
   std::vector<Constraint::Ptr> constraints = prob_->getConstraints();
@@ -586,6 +912,86 @@ OptStatus BasicTrustRegionSQP::optimize()
 
   OptStatus retval = INVALID;
 
+  OptTimings& timings = results_.timings;
+  timings.clear();
+  timings.costs.resize(cost_names.size());
+  for (std::size_t i = 0; i < cost_names.size(); ++i)
+    timings.costs[i].name = cost_names[i];
+  timings.cnts.resize(cnt_names.size());
+  for (std::size_t i = 0; i < cnt_names.size(); ++i)
+    timings.cnts[i].name = cnt_names[i];
+  auto phase_start = SteadyClock::now();
+
+  // Models that keep the auxiliary variables and rows of each term alive across iterations
+  std::vector<PersistentTermModel::Ptr> cost_term_models, cnt_term_models, cnt_cost_term_models;
+  if (param_.persistent_convex_model)
+  {
+    cost_term_models = createTermModels(prob_->getCosts().size(), model_.get());
+    cnt_term_models = createTermModels(constraints.size(), model_.get());
+    cnt_cost_term_models = createTermModels(constraints.size(), model_.get());
+  }
+
+  // Solution of the last successful convex solve, used as the starting point of the next one
+  WarmStart warm_start;
+
+  // Results of terms whose variables did not move are reused. The cached convexifications refer to the term models,
+  // so these are declared after them.
+  std::unique_ptr<TermCache<double>> cost_value_cache, cnt_value_cache;
+  std::unique_ptr<TermCache<CachedConvexification<ConvexObjective>>> cost_convex_cache;
+  std::unique_ptr<TermCache<CachedConvexification<ConvexConstraints>>> cnt_convex_cache;
+  if (param_.reuse_unchanged_terms)
+  {
+    cost_value_cache = std::make_unique<TermCache<double>>(prob_->getCosts());
+    cnt_value_cache = std::make_unique<TermCache<double>>(constraints);
+    cost_convex_cache = std::make_unique<TermCache<CachedConvexification<ConvexObjective>>>(prob_->getCosts());
+    cnt_convex_cache = std::make_unique<TermCache<CachedConvexification<ConvexConstraints>>>(constraints);
+  }
+
+  // Costs whose convexification does not depend on x are convexified once, their objectives are part of
+  // constant_objective
+  std::vector<ConvexObjective::Ptr> constant_cost_models;
+  QuadExpr constant_objective;
+  if (param_.precompute_constant_costs)
+  {
+    phase_start = SteadyClock::now();
+    constant_objective =
+        precomputeConstantCosts(prob_->getCosts(), results_.x, model_.get(), prob_->getVars(), constant_cost_models);
+    timings.convexify += secondsSince(phase_start);
+  }
+  // Backends which support it keep the constant objective assembled, otherwise it is part of every objective
+  bool constant_objective_in_model = model_->setConstantObjective(constant_objective);
+
+  // Exact values of the terms at the current iterate, needed on the first iteration and whenever the terms changed
+  auto evaluateIterate = [&]() {
+    if (param_.reuse_unchanged_terms)
+    {
+      cost_value_cache->clear();
+      cnt_value_cache->clear();
+      cost_convex_cache->clear();
+      cnt_convex_cache->clear();
+    }
+    phase_start = SteadyClock::now();
+    util::ThreadPool* evaluate_pool = getThreadPool(evaluate_pool_, param_.evaluate_threads);
+    results_.cnt_viols =
+        evaluateConstraintViols(constraints, results_.x, evaluate_pool, cnt_value_cache.get(), &timings.cnts);
+    results_.cost_vals =
+        evaluateCosts(prob_->getCosts(), results_.x, evaluate_pool, cost_value_cache.get(), &timings.costs);
+    timings.evaluate += secondsSince(phase_start);
+    ++results_.n_func_evals;
+  };
+
+  // Called before convergence is reported. If the terms were refined, the current iterate is evaluated with the exact
+  // terms and the optimization continues with a trust region which is large enough for another iteration.
+  auto refineBeforeConvergence = [&]() {
+    if (!callRefinementCallbacks(true))
+      return false;
+
+    LOG_INFO("the terms were refined before convergence, continuing with the exact terms");
+    evaluateIterate();
+    param_.trust_box_size = fmax(param_.trust_box_size, param_.min_trust_box_size / param_.trust_shrink_ratio * 1.5);
+    return true;
+  };
+
   using Clock = std::chrono::high_resolution_clock;
   auto start_time = Clock::now();
 
@@ -605,16 +1011,12 @@ OptStatus BasicTrustRegionSQP::optimize()
 
       LOG_DEBUG("current iterate: %s", CSTR(results_.x));
       LOG_INFO("iteration %i", iter);
+      ++results_.n_sqp_iters;
 
       // speedup: if you just evaluated the cost when doing the line search, use
-      // that
-      if (results_.cost_vals.empty() && results_.cnt_viols.empty())
-      {  // only happens on the first iteration
-        results_.cnt_viols = evaluateConstraintViols(constraints, results_.x);
-        results_.cost_vals = evaluateCosts(prob_->getCosts(), results_.x);
-        assert(results_.n_func_evals == 0);
-        ++results_.n_func_evals;
-      }
+      // that. The terms are only evaluated again on the first iteration, or after a callback changed the terms.
+      if (callRefinementCallbacks(false) || (results_.cost_vals.empty() && results_.cnt_viols.empty()))
+        evaluateIterate();
 
       // DblVec new_cnt_viols = evaluateConstraintViols(constraints, results_.x);
       // DblVec new_cost_vals = evaluateCosts(prob_->getCosts(), results_.x);
@@ -628,23 +1030,58 @@ OptStatus BasicTrustRegionSQP::optimize()
       //   results_.cost_vals[i] << endl;
       // }
 
-      std::vector<ConvexObjective::Ptr> cost_models = convexifyCosts(prob_->getCosts(), results_.x, model_.get());
-      std::vector<ConvexConstraints::Ptr> cnt_models = convexifyConstraints(constraints, results_.x, model_.get());
-      std::vector<ConvexObjective::Ptr> cnt_cost_models = cntsToCosts(cnt_models, merit_error_coeffs, model_.get());
+      // Declared before the convex models which keep pointers to them
+      std::vector<StagingModel::Ptr> cost_staging_models, cnt_staging_models;
+      phase_start = SteadyClock::now();
+      util::ThreadPool* convexify_pool = getThreadPool(convexify_pool_, param_.convexify_threads);
+      std::vector<ConvexObjective::Ptr> cost_models = convexifyCosts(prob_->getCosts(),
+                                                                     results_.x,
+                                                                     model_.get(),
+                                                                     cost_term_models,
+                                                                     convexify_pool,
+                                                                     cost_staging_models,
+                                                                     cost_convex_cache.get(),
+                                                                     constant_cost_models,
+                                                                     &timings.costs);
+      std::vector<ConvexConstraints::Ptr> cnt_models = convexifyConstraints(constraints,
+                                                                            results_.x,
+                                                                            model_.get(),
+                                                                            cnt_term_models,
+                                                                            convexify_pool,
+                                                                            cnt_staging_models,
+                                                                            cnt_convex_cache.get(),
+                                                                            &timings.cnts);
+      std::vector<ConvexObjective::Ptr> cnt_cost_models =
+          cntsToCosts(cnt_models, merit_error_coeffs, model_.get(), cnt_cost_term_models);
+      timings.convexify += secondsSince(phase_start);
+
+      phase_start = SteadyClock::now();
       model_->update();
       for (ConvexObjective::Ptr& cost : cost_models)
-        cost->addConstraintsToModel();
+      {
+        // Convexifications reused from an earlier iteration already have their rows in the model
+        if (cost->cnts_.empty())
+          cost->addConstraintsToModel();
+      }
       for (ConvexObjective::Ptr& cost : cnt_cost_models)
         cost->addConstraintsToModel();
+      // Remove whatever the previous iteration allocated but this one did not reuse
+      flushTermModels(cost_term_models);
+      flushTermModels(cnt_term_models);
+      flushTermModels(cnt_cost_term_models);
       model_->update();
-      QuadExpr objective;
-      for (ConvexObjective::Ptr& co : cost_models)
-        exprInc(objective, co->quad_);
+      QuadExpr objective = constant_objective_in_model ? QuadExpr() : constant_objective;
+      for (size_t i = 0; i < cost_models.size(); ++i)
+      {
+        if (constant_cost_models.empty() || !constant_cost_models[i])
+          exprInc(objective, cost_models[i]->quad_);
+      }
       for (ConvexObjective::Ptr& co : cnt_cost_models)
         exprInc(objective, co->quad_);
 
       //    objective = cleanupExpr(objective);
       model_->setObjective(objective);
+      timings.update_model += secondsSince(phase_start);
 
       //    if (logging::filter() >= IPI_LEVEL_DEBUG) {
       //      DblVec model_cost_vals;
@@ -657,8 +1094,15 @@ OptStatus BasicTrustRegionSQP::optimize()
 
       while (param_.trust_box_size >= param_.min_trust_box_size)
       {
+        phase_start = SteadyClock::now();
         setTrustBoxConstraints(results_.x);
+        if (param_.warm_start_convex_solve && !warm_start.empty())
+          model_->setWarmStart(warm_start);
+        timings.update_model += secondsSince(phase_start);
+
+        phase_start = SteadyClock::now();
         CvxOptStatus status = model_->optimize();
+        timings.qp_solve += secondsSince(phase_start);
 
         ++results_.n_qp_solves;
         if (status != CVX_SOLVED)
@@ -680,6 +1124,9 @@ OptStatus BasicTrustRegionSQP::optimize()
           goto cleanup;
         }
 
+        if (param_.warm_start_convex_solve)
+          warm_start = model_->getWarmStart();
+
         iteration_results.update(results_,
                                  *model_,
                                  cost_models,
@@ -687,7 +1134,11 @@ OptStatus BasicTrustRegionSQP::optimize()
                                  cnt_cost_models,
                                  constraints,
                                  prob_->getCosts(),
-                                 merit_error_coeffs);
+                                 merit_error_coeffs,
+                                 getThreadPool(evaluate_pool_, param_.evaluate_threads),
+                                 cost_value_cache.get(),
+                                 cnt_value_cache.get(),
+                                 &timings);
         if (SUPER_DEBUG_MODE)
         {
           model_->writeToFile("trajopt_model.txt");
@@ -720,6 +1171,8 @@ OptStatus BasicTrustRegionSQP::optimize()
 
         if (iteration_results.approx_merit_improve < param_.min_approx_improve)
         {
+          if (refineBeforeConvergence())
+            break;
           LOG_INFO("converged because improvement was small (%.3e < %.3e)",
                    iteration_results.approx_merit_improve,
                    param_.min_approx_improve);
@@ -729,6 +1182,8 @@ OptStatus BasicTrustRegionSQP::optimize()
 
         if (iteration_results.approx_merit_improve / iteration_results.old_merit < param_.min_approx_improve_frac)
         {
+          if (refineBeforeConvergence())
+            break;
           LOG_INFO("converged because improvement ratio was small (%.3e < %.3e)",
                    iteration_results.approx_merit_improve / iteration_results.old_merit,
                    param_.min_approx_improve_frac);
@@ -752,7 +1207,7 @@ OptStatus BasicTrustRegionSQP::optimize()
         }
       }
 
-      if (param_.trust_box_size < param_.min_trust_box_size)
+      if (param_.trust_box_size < param_.min_trust_box_size && !refineBeforeConvergence())
       {
         LOG_INFO("converged because trust region is tiny");
         retval = OPT_CONVERGED;
@@ -763,6 +1218,10 @@ OptStatus BasicTrustRegionSQP::optimize()
         LOG_INFO("iteration limit");
         retval = OPT_SCO_ITERATION_LIMIT;
 
+        // No further iteration is made, but the constraints are checked and the results reported with the exact terms
+        if (callRefinementCallbacks(true))
+          evaluateIterate();
+
         if (results_.cnt_viols.empty() || vecMax(results_.cnt_viols) < param_.cnt_tolerance)
         {
           retval = OPT_CONVERGED;
@@ -811,9 +1270,21 @@ OptStatus BasicTrustRegionSQP::optimize()
 cleanup:
   assert(retval != INVALID && "should never happen");
   results_.status = retval;
+  if (param_.reuse_unchanged_terms)
+  {
+    results_.n_value_cache_hits = cost_value_cache->getNumHits() + cnt_value_cache->getNumHits();
+    results_.n_value_cache_misses = cost_value_cache->getNumMisses() + cnt_value_cache->getNumMisses();
+    results_.n_convex_cache_hits = cost_convex_cache->getNumHits() + cnt_convex_cache->getNumHits();
+    results_.n_convex_cache_misses = cost_convex_cache->getNumMisses() + cnt_convex_cache->getNumMisses();
+  }
   results_.total_cost = vecSum(results_.cost_vals);
+  if (constant_objective_in_model)
+    model_->setConstantObjective(QuadExpr());
+  timings.total = secondsSince(optimize_start);
   LOG_INFO("\n==================\n%s==================", CSTR(results_));
   callCallbacks();
+  // Again to include the final callbacks
+  timings.total = secondsSince(optimize_start);
 
   if (param_.log_results || util::GetLogLevel() >= util::LevelDebug)
   {
@@ -77,6 +77,13 @@ Cnt OSQPModel::addIneqCnt(const AffExpr& expr, const std::string& /*name*/)
 
 Cnt OSQPModel::addIneqCnt(const QuadExpr&, const std::string& /*name*/) { throw std::runtime_error("NOT IMPLEMENTED"); }
 
+bool OSQPModel::updateCnt(const Cnt& cnt, const AffExpr& expr)
+{
+  assert(cnt.cnt_rep->creator == this && !cnt.cnt_rep->removed);
+  cnt_exprs_[cnt.cnt_rep->index] = expr;
+  return true;
+}
+
 void OSQPModel::removeVars(const VarVector& vars)
 {
   SizeTVec inds;
@@ -98,15 +105,38 @@ void OSQPModel::updateObjective()
   const size_t n = vars_.size();
   osqp_data_.n = static_cast<c_int>(n);
 
-  Eigen::SparseMatrix<double> sm;
-  exprToEigen(objective_, sm, q_, static_cast<int>(n), true);
-
-  // Copy triangular upper into empty matrix
-  Eigen::SparseMatrix<double> triangular_sm;
-  triangular_sm = sm.triangularView<Eigen::Upper>();
+  // OSQP only takes the upper triangle of P
+  if (!constant_objective_assembled_ || P_constant_column_pointers_.size() > n + 1)
+  {
+    exprToCSC(constant_objective_,
+              P_constant_row_indices_,
+              P_constant_column_pointers_,
+              P_constant_csc_data_,
+              q_constant_,
+              static_cast<int>(n),
+              true,
+              false,
+              true);
+    constant_objective_assembled_ = true;
+  }
+  exprToCSC(objective_, P_row_indices_, P_column_pointers_, P_csc_data_, q_, static_cast<int>(n), true, false, true);
+  addCSC(P_constant_row_indices_,
+         P_constant_column_pointers_,
+         P_constant_csc_data_,
+         P_row_indices_,
+         P_column_pointers_,
+         P_csc_data_);
+  q_.head(q_constant_.size()) += q_constant_;
   if (SUPER_DEBUG_MODE)
-    std::cout << std::fixed << std::setprecision(3) << "OSQP Hessian:\n" << triangular_sm.toDense() << std::endl;
-  eigenToCSC(triangular_sm, P_row_indices_, P_column_pointers_, P_csc_data_);
+  {
+    Eigen::Map<const Eigen::SparseMatrix<double, Eigen::ColMajor, c_int>> P_map(osqp_data_.n,
+                                                                                osqp_data_.n,
+                                                                                static_cast<c_int>(P_csc_data_.size()),
+                                                                                P_column_pointers_.data(),
+                                                                                P_row_indices_.data(),
+                                                                                P_csc_data_.data());
+    std::cout << std::fixed << std::setprecision(3) << "OSQP Hessian:\n" << P_map.toDense() << std::endl;
+  }
 
   P_.reset(csc_matrix(osqp_data_.n,
                       osqp_data_.n,
@@ -129,17 +159,12 @@ void OSQPModel::updateConstraints()
 {
   const size_t n = vars_.size();
   const size_t m = cnts_.size();
-  const auto n_int = static_cast<int>(n);
-  const auto m_int = static_cast<int>(m);
 
   osqp_data_.m = static_cast<c_int>(m) + static_cast<c_int>(n);
 
-  Eigen::SparseMatrix<double> sm;
+  // The constraint rows are followed by the identity rows of the variable bounds
   Eigen::VectorXd v;
-  exprToEigen(cnt_exprs_, sm, v, static_cast<int>(n));
-  Eigen::SparseMatrix<double> sm_e(n_int + m_int, n_int);
-  Eigen::SparseMatrix<double> sm_e2 = sm;
-  sm.conservativeResize(m_int + n_int, Eigen::NoChange_t(n));
+  exprToCSC(cnt_exprs_, A_row_indices_, A_column_pointers_, A_csc_data_, v, static_cast<int>(n), true);
 
   l_.clear();
   l_.resize(m + n, -OSQP_INFINITY);
@@ -156,11 +181,17 @@ void OSQPModel::updateConstraints()
   {
     l_[i_bnd + m] = fmax(lbs_[i_bnd], -OSQP_INFINITY);
     u_[i_bnd + m] = fmin(ubs_[i_bnd], OSQP_INFINITY);
-    sm.insert(static_cast<Eigen::Index>(i_bnd + m), static_cast<Eigen::Index>(i_bnd)) = 1.;
   }
   if (SUPER_DEBUG_MODE)
-    std::cout << std::fixed << std::setprecision(3) << "OSQP Constraint Matrix:\n" << sm.toDense() << std::endl;
-  eigenToCSC(sm, A_row_indices_, A_column_pointers_, A_csc_data_);
+  {
+    Eigen::Map<const Eigen::SparseMatrix<double, Eigen::ColMajor, c_int>> A_map(osqp_data_.m,
+                                                                                osqp_data_.n,
+                                                                                static_cast<c_int>(A_csc_data_.size()),
+                                                                                A_column_pointers_.data(),
+                                                                                A_row_indices_.data(),
+                                                                                A_csc_data_.data());
+    std::cout << std::fixed << std::setprecision(3) << "OSQP Constraint Matrix:\n" << A_map.toDense() << std::endl;
+  }
 
   A_.reset(csc_matrix(osqp_data_.m,
                       osqp_data_.n,
@@ -182,17 +213,48 @@ void OSQPModel::updateConstraints()
   osqp_data_.u = u_.data();
 }
 
+bool OSQPModel::workspaceMatchesSparsity() const
+{
+  return osqp_workspace_ != nullptr && osqp_data_.n == setup_n_ && osqp_data_.m == setup_m_ &&
+         P_column_pointers_ == setup_P_column_pointers_ && P_row_indices_ == setup_P_row_indices_ &&
+         A_column_pointers_ == setup_A_column_pointers_ && A_row_indices_ == setup_A_row_indices_;
+}
+
 void OSQPModel::createOrUpdateSolver()
 {
   updateObjective();
   updateConstraints();
 
-  // TODO atm we are not updating the workspace, but recreating it each time.
-  // In the future, we will checking sparsity did not change and update instead
+  // If the sparsity did not change only the values need to be updated, which
+  // keeps the symbolic factorization of the KKT system done by osqp_setup
+  if (workspaceMatchesSparsity())
+  {
+    c_int ret = osqp_update_P_A(osqp_workspace_,
+                                P_csc_data_.data(),
+                                nullptr,
+                                static_cast<c_int>(P_csc_data_.size()),
+                                A_csc_data_.data(),
+                                nullptr,
+                                static_cast<c_int>(A_csc_data_.size()));
+    if (ret == 0)
+      ret = osqp_update_lin_cost(osqp_workspace_, q_.data());
+    if (ret == 0)
+      ret = osqp_update_bounds(osqp_workspace_, l_.data(), u_.data());
+
+    if (ret == 0)
+    {
+      ++n_workspace_updates_;
+      return;
+    }
+    LOG_DEBUG("OSQP workspace update failed with error %i, setting it up again", static_cast<int>(ret));
+  }
+
   if (osqp_workspace_ != nullptr)
     osqp_cleanup(osqp_workspace_);
+  osqp_workspace_ = nullptr;
+  setup_n_ = 0;
+  setup_m_ = 0;
 
-  // Setup workspace - this should be called only once
   auto ret = osqp_setup(&osqp_workspace_, &osqp_data_, &osqp_settings_);
   if (ret)
   {
@@ -201,6 +263,50 @@ void OSQPModel::createOrUpdateSolver()
       osqp_workspace_ = nullptr;
     throw std::runtime_error("Could not initialize OSQP: error " + std::to_string(ret));
   }
+
+  // Remember the sparsity the workspace was set up with
+  setup_n_ = osqp_data_.n;
+  setup_m_ = osqp_data_.m;
+  setup_P_row_indices_ = P_row_indices_;
+  setup_P_column_pointers_ = P_column_pointers_;
+  setup_A_row_indices_ = A_row_indices_;
+  setup_A_column_pointers_ = A_column_pointers_;
+  ++n_workspace_setups_;
+}
+
+void OSQPModel::applyWarmStart()
+{
+  if (warm_start_.empty())
+    return;
+
+  const std::size_t n = vars_.size();
+  const std::size_t m = cnts_.size();
+  DblVec x(n, 0.), y(m + n, 0.);
+  for (std::size_t i = 0; i < warm_start_.vars.size(); ++i)
+  {
+    const VarRep* rep = warm_start_.vars[i].var_rep.get();
+    if (rep == nullptr || rep->creator != this || rep->removed || rep->index >= n)
+      continue;
+    if (i < warm_start_.primal.size())
+      x[rep->index] = warm_start_.primal[i];
+    if (i < warm_start_.var_duals.size())
+      y[m + rep->index] = warm_start_.var_duals[i];
+  }
+  for (std::size_t i = 0; i < warm_start_.cnts.size() && i < warm_start_.cnt_duals.size(); ++i)
+  {
+    const CntRep* rep = warm_start_.cnts[i].cnt_rep.get();
+    if (rep == nullptr || rep->creator != this || rep->removed || rep->index >= m)
+      continue;
+    y[rep->index] = warm_start_.cnt_duals[i];
+  }
+
+  // Without duals keep whatever the workspace holds, which is better than zero after an in-place update
+  if (warm_start_.var_duals.empty() && warm_start_.cnt_duals.empty())
+    osqp_warm_start_x(osqp_workspace_, x.data());
+  else
+    osqp_warm_start(osqp_workspace_, x.data(), y.data());
+
+  warm_start_ = WarmStart();
 }
 
 void OSQPModel::update()
@@ -215,6 +321,9 @@ void OSQPModel::update()
         vars_[inew] = var;
         lbs_[inew] = lbs_[iold];
         ubs_[inew] = ubs_[iold];
+        // The constant part of the objective is assembled with the old indices
+        if (var.var_rep->index != inew)
+          constant_objective_assembled_ = false;
         var.var_rep->index = inew;
         ++inew;
       }
@@ -277,6 +386,7 @@ CvxOptStatus OSQPModel::optimize()
   try
   {
     createOrUpdateSolver();
+    applyWarmStart();
   }
   catch (std::exception& e)
   {
@@ -291,6 +401,8 @@ CvxOptStatus OSQPModel::optimize()
   {
     // opt += m_objective.affexpr.constant;
     solution_ = DblVec(osqp_workspace_->solution->x, osqp_workspace_->solution->x + vars_.size());
+    dual_solution_ =
+        DblVec(osqp_workspace_->solution->y, osqp_workspace_->solution->y + cnts_.size() + vars_.size());
 
     if (SUPER_DEBUG_MODE)
     {
@@ -309,15 +421,43 @@ CvxOptStatus OSQPModel::optimize()
 }
 void OSQPModel::setObjective(const AffExpr& expr) { objective_.affexpr = expr; }
 void OSQPModel::setObjective(const QuadExpr& expr) { objective_ = expr; }
+bool OSQPModel::setConstantObjective(const QuadExpr& expr)
+{
+  constant_objective_ = expr;
+  constant_objective_assembled_ = false;
+  return true;
+}
 
 VarVector OSQPModel::getVars() const { return vars_; }
 
+void OSQPModel::setWarmStart(const WarmStart& start) { warm_start_ = start; }
+
+WarmStart OSQPModel::getWarmStart() const
+{
+  WarmStart start;
+  const std::size_t n = vars_.size();
+  const std::size_t m = cnts_.size();
+  // The solution is only meaningful if the model was not changed since it was solved
+  if (solution_.size() != n || dual_solution_.size() != m + n)
+    return start;
+
+  const auto split = dual_solution_.begin() + static_cast<std::ptrdiff_t>(m);
+  start.vars = vars_;
+  start.primal = solution_;
+  start.var_duals.assign(split, dual_solution_.end());
+  start.cnts = cnts_;
+  start.cnt_duals.assign(dual_solution_.begin(), split);
+  return start;
+}
+
 void OSQPModel::writeToFile(const std::string& fname) const
 {
   std::ofstream outStream(fname);
   outStream << "\\ Generated by trajopt_sco with backend OSQP\n";
   outStream << "Minimize\n";
   outStream << objective_;
+  if (constant_objective_.size() > 0 || constant_objective_.affexpr.size() > 0)
+    outStream << " + " << constant_objective_;
   outStream << "Subject To\n";
   for (std::size_t i = 0; i < cnt_exprs_.size(); ++i)
   {
@@ -0,0 +1,161 @@
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <cmath>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_sco/persistent_model.hpp>
+
+namespace sco
+{
+PersistentTermModel::PersistentTermModel(Model* model) : model_(model) { assert(model_ != nullptr); }
+
+PersistentTermModel::~PersistentTermModel() { flush(); }
+
+Var PersistentTermModel::addVar(const std::string& name)
+{
+  Var v = model_->addVar(name);
+  owned_vars_.insert(v.var_rep.get());
+  ++n_vars_added_;
+  return v;
+}
+
+Var PersistentTermModel::addVar(const std::string& name, double lb, double ub)
+{
+  auto it = parked_vars_.find(name);
+  if (it != parked_vars_.end() && !it->second.empty())
+  {
+    Var v = it->second.front();
+    it->second.pop_front();
+    model_->setVarBounds(v, lb, ub);
+    ++n_vars_reused_;
+    return v;
+  }
+
+  Var v = model_->addVar(name, lb, ub);
+  owned_vars_.insert(v.var_rep.get());
+  ++n_vars_added_;
+  return v;
+}
+
+Cnt PersistentTermModel::addCnt(const AffExpr& expr, const std::string& name, ConstraintType type)
+{
+  std::deque<Cnt>& parked = (type == EQ) ? parked_eqs_ : parked_ineqs_;
+  if (!parked.empty())
+  {
+    Cnt cnt = parked.front();
+    parked.pop_front();
+    if (model_->updateCnt(cnt, expr))
+    {
+      ++n_cnts_reused_;
+      return cnt;
+    }
+
+    // The underlying model does not support in-place updates, so stop parking rows
+    cnt_update_supported_ = false;
+    owned_cnts_.erase(cnt.cnt_rep.get());
+    model_->removeCnt(cnt);
+  }
+
+  Cnt cnt = (type == EQ) ? model_->addEqCnt(expr, name) : model_->addIneqCnt(expr, name);
+  cnt.cnt_rep->type = type;
+  owned_cnts_.insert(cnt.cnt_rep.get());
+  ++n_cnts_added_;
+  return cnt;
+}
+
+Cnt PersistentTermModel::addEqCnt(const AffExpr& expr, const std::string& name) { return addCnt(expr, name, EQ); }
+
+Cnt PersistentTermModel::addIneqCnt(const AffExpr& expr, const std::string& name)
+{
+  return addCnt(expr, name, INEQ);
+}
+
+Cnt PersistentTermModel::addIneqCnt(const QuadExpr& expr, const std::string& name)
+{
+  return model_->addIneqCnt(expr, name);
+}
+
+void PersistentTermModel::removeVars(const VarVector& vars)
+{
+  VarVector not_owned;
+  for (const Var& var : vars)
+  {
+    if (owned_vars_.find(var.var_rep.get()) != owned_vars_.end())
+      parked_vars_[var.var_rep->name].push_back(var);
+    else
+      not_owned.push_back(var);
+  }
+
+  if (!not_owned.empty())
+    model_->removeVars(not_owned);
+}
+
+void PersistentTermModel::removeCnts(const CntVector& cnts)
+{
+  CntVector not_parked;
+  for (const Cnt& cnt : cnts)
+  {
+    if (cnt_update_supported_ && owned_cnts_.find(cnt.cnt_rep.get()) != owned_cnts_.end())
+    {
+      if (cnt.cnt_rep->type == EQ)
+        parked_eqs_.push_back(cnt);
+      else
+        parked_ineqs_.push_back(cnt);
+    }
+    else
+    {
+      owned_cnts_.erase(cnt.cnt_rep.get());
+      not_parked.push_back(cnt);
+    }
+  }
+
+  if (!not_parked.empty())
+    model_->removeCnts(not_parked);
+}
+
+void PersistentTermModel::flush()
+{
+  VarVector vars;
+  for (auto& parked : parked_vars_)
+  {
+    for (const Var& var : parked.second)
+    {
+      owned_vars_.erase(var.var_rep.get());
+      vars.push_back(var);
+    }
+    parked.second.clear();
+  }
+
+  CntVector cnts;
+  for (std::deque<Cnt>* parked : { &parked_eqs_, &parked_ineqs_ })
+  {
+    for (const Cnt& cnt : *parked)
+    {
+      owned_cnts_.erase(cnt.cnt_rep.get());
+      cnts.push_back(cnt);
+    }
+    parked->clear();
+  }
+
+  if (!cnts.empty())
+    model_->removeCnts(cnts);
+  if (!vars.empty())
+    model_->removeVars(vars);
+}
+
+bool PersistentTermModel::updateCnt(const Cnt& cnt, const AffExpr& expr) { return model_->updateCnt(cnt, expr); }
+void PersistentTermModel::update() { model_->update(); }
+void PersistentTermModel::setVarBounds(const VarVector& vars, const DblVec& lower, const DblVec& upper)
+{
+  model_->setVarBounds(vars, lower, upper);
+}
+DblVec PersistentTermModel::getVarValues(const VarVector& vars) const { return model_->getVarValues(vars); }
+CvxOptStatus PersistentTermModel::optimize() { return model_->optimize(); }
+void PersistentTermModel::setObjective(const AffExpr& expr) { model_->setObjective(expr); }
+void PersistentTermModel::setObjective(const QuadExpr& expr) { model_->setObjective(expr); }
+bool PersistentTermModel::setConstantObjective(const QuadExpr& expr) { return model_->setConstantObjective(expr); }
+void PersistentTermModel::writeToFile(const std::string& fname) const { model_->writeToFile(fname); }
+VarVector PersistentTermModel::getVars() const { return model_->getVars(); }
+void PersistentTermModel::setWarmStart(const WarmStart& start) { model_->setWarmStart(start); }
+WarmStart PersistentTermModel::getWarmStart() const { return model_->getWarmStart(); }
+}  // namespace sco
@@ -66,6 +66,13 @@ Cnt qpOASESModel::addIneqCnt(const QuadExpr&, const std::string& /*name*/)
   return 0;
 }
 
+bool qpOASESModel::updateCnt(const Cnt& cnt, const AffExpr& expr)
+{
+  assert(cnt.cnt_rep->creator == this && !cnt.cnt_rep->removed);
+  cnt_exprs_[cnt.cnt_rep->index] = expr;
+  return true;
+}
+
 void qpOASESModel::removeVars(const VarVector& vars)
 {
   IntVec inds;
@@ -86,9 +93,26 @@ void qpOASESModel::updateObjective()
 {
   const size_t n = vars_.size();
 
-  Eigen::SparseMatrix<double> sm;
-  exprToEigen(objective_, sm, g_, n, true, true);
-  eigenToCSC(sm, H_row_indices_, H_column_pointers_, H_csc_data_);
+  if (!constant_objective_assembled_ || H_constant_column_pointers_.size() > n + 1)
+  {
+    exprToCSC(constant_objective_,
+              H_constant_row_indices_,
+              H_constant_column_pointers_,
+              H_constant_csc_data_,
+              g_constant_,
+              static_cast<int>(n),
+              true,
+              false);
+    constant_objective_assembled_ = true;
+  }
+  exprToCSC(objective_, H_row_indices_, H_column_pointers_, H_csc_data_, g_, static_cast<int>(n), true, true);
+  addCSC(H_constant_row_indices_,
+         H_constant_column_pointers_,
+         H_constant_csc_data_,
+         H_row_indices_,
+         H_column_pointers_,
+         H_csc_data_);
+  g_.head(g_constant_.size()) += g_constant_;
 
   H_ = SymSparseMat(vars_.size(), vars_.size(), H_row_indices_.data(), H_column_pointers_.data(), H_csc_data_.data());
   H_.createDiagInfo();
@@ -137,6 +161,36 @@ void qpOASESModel::createSolver()
   updateSolver();
 }
 
+bool qpOASESModel::getWarmStartGuess(DblVec& x, DblVec& y, bool& has_duals) const
+{
+  if (warm_start_.empty())
+    return false;
+
+  const size_t n = vars_.size();
+  const size_t m = cnts_.size();
+  x.assign(n, 0.);
+  y.assign(n + m, 0.);
+  has_duals = !warm_start_.var_duals.empty() || !warm_start_.cnt_duals.empty();
+  for (size_t i = 0; i < warm_start_.vars.size(); ++i)
+  {
+    const VarRep* rep = warm_start_.vars[i].var_rep.get();
+    if (rep == nullptr || rep->creator != this || rep->removed || rep->index >= n)
+      continue;
+    if (i < warm_start_.primal.size())
+      x[rep->index] = warm_start_.primal[i];
+    if (i < warm_start_.var_duals.size())
+      y[rep->index] = warm_start_.var_duals[i];
+  }
+  for (size_t i = 0; i < warm_start_.cnts.size() && i < warm_start_.cnt_duals.size(); ++i)
+  {
+    const CntRep* rep = warm_start_.cnts[i].cnt_rep.get();
+    if (rep == nullptr || rep->creator != this || rep->removed || rep->index >= m)
+      continue;
+    y[n + rep->index] = warm_start_.cnt_duals[i];
+  }
+  return true;
+}
+
 void qpOASESModel::update()
 {
   {
@@ -149,6 +203,9 @@ void qpOASESModel::update()
         vars_[inew] = var;
         lb_[inew] = lb_[iold];
         ub_[inew] = ub_[iold];
+        // The constant part of the objective is assembled with the old indices
+        if (var.var_rep->index != static_cast<std::size_t>(inew))
+          constant_objective_assembled_ = false;
         var.var_rep->index = inew;
         ++inew;
       }
@@ -228,14 +285,37 @@ CvxOptStatus qpOASESModel::optimize()
     //      tests pass.
     createSolver();
 
-    val = qpoases_problem_->init(&H_, g_.data(), &A_, lb_.data(), ub_.data(), lbA_.data(), ubA_.data(), nWSR, nullptr);
+    DblVec x_guess, y_guess;
+    bool has_duals = false;
+    if (getWarmStartGuess(x_guess, y_guess, has_duals))
+    {
+      val = qpoases_problem_->init(&H_,
+                                   g_.data(),
+                                   &A_,
+                                   lb_.data(),
+                                   ub_.data(),
+                                   lbA_.data(),
+                                   ubA_.data(),
+                                   nWSR,
+                                   nullptr,
+                                   x_guess.data(),
+                                   has_duals ? y_guess.data() : nullptr);
+    }
+    else
+    {
+      val =
+          qpoases_problem_->init(&H_, g_.data(), &A_, lb_.data(), ub_.data(), lbA_.data(), ubA_.data(), nWSR, nullptr);
+    }
   }
+  warm_start_ = WarmStart();
 
   if (val == qpOASES::SUCCESSFUL_RETURN)
   {
     // opt += m_objective.affexpr.constant;
     solution_.resize(vars_.size(), 0.);
     val = qpoases_problem_->getPrimalSolution(solution_.data());
+    dual_solution_.resize(vars_.size() + cnts_.size(), 0.);
+    qpoases_problem_->getDualSolution(dual_solution_.data());
     return CVX_SOLVED;
   }
   else if (val == qpOASES::RET_INIT_FAILED_INFEASIBILITY)
@@ -249,9 +329,35 @@ CvxOptStatus qpOASESModel::optimize()
 }
 void qpOASESModel::setObjective(const AffExpr& expr) { objective_.affexpr = expr; }
 void qpOASESModel::setObjective(const QuadExpr& expr) { objective_ = expr; }
+bool qpOASESModel::setConstantObjective(const QuadExpr& expr)
+{
+  constant_objective_ = expr;
+  constant_objective_assembled_ = false;
+  return true;
+}
 void qpOASESModel::writeToFile(const std::string& /*fname*/) const
 {
   return;  // NOT IMPLEMENTED
 }
 VarVector qpOASESModel::getVars() const { return vars_; }
+
+void qpOASESModel::setWarmStart(const WarmStart& start) { warm_start_ = start; }
+
+WarmStart qpOASESModel::getWarmStart() const
+{
+  WarmStart start;
+  const size_t n = vars_.size();
+  const size_t m = cnts_.size();
+  // The solution is only meaningful if the model was not changed since it was solved
+  if (solution_.size() != n || dual_solution_.size() != n + m)
+    return start;
+
+  const auto split = dual_solution_.begin() + static_cast<std::ptrdiff_t>(n);
+  start.vars = vars_;
+  start.primal = solution_;
+  start.var_duals.assign(dual_solution_.begin(), split);
+  start.cnts = cnts_;
+  start.cnt_duals.assign(split, dual_solution_.end());
+  return start;
+}
 }  // namespace sco
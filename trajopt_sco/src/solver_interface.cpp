@@ -104,6 +104,8 @@ Var Model::addVar(const std::string& name, double lb, double ub)
   setVarBounds(v, lb, ub);
   return v;
 }
+bool Model::updateCnt(const Cnt& /*cnt*/, const AffExpr& /*expr*/) { return false; }
+bool Model::setConstantObjective(const QuadExpr& /*expr*/) { return false; }
 void Model::removeVar(const Var& var)
 {
   VarVector vars(1, var);
@@ -128,6 +130,9 @@ void Model::setVarBounds(const Var& var, double lower, double upper)
   setVarBounds(vars, lowers, uppers);
 }
 
+void Model::setWarmStart(const WarmStart& /*start*/) {}
+WarmStart Model::getWarmStart() const { return WarmStart(); }
+
 std::ostream& operator<<(std::ostream& o, const Var& v)
 {
   if (v.var_rep != nullptr)
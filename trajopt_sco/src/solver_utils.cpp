@@ -1,6 +1,7 @@
 #include <trajopt_utils/macros.h>
 TRAJOPT_IGNORE_WARNINGS_PUSH
 #include <algorithm>
+#include <cassert>
 #include <Eigen/SparseCore>
 #include <sstream>
 TRAJOPT_IGNORE_WARNINGS_POP
@@ -35,53 +36,246 @@ void exprToEigen(const QuadExpr& expr,
                  const bool& matrix_is_halved,
                  const bool& force_diagonal)
 {
-  SizeTVec ind1;
-  vars2inds(expr.vars1, ind1);
-  SizeTVec ind2;
-  vars2inds(expr.vars2, ind2);
-  sparse_matrix.resize(n_vars, n_vars);
-  sparse_matrix.reserve(static_cast<long int>(2 * expr.size()));
+  IntVec row_indices, column_pointers;
+  DblVec values;
+  exprToCSC(expr, row_indices, column_pointers, values, vector, n_vars, matrix_is_halved, force_diagonal);
 
-  Eigen::SparseVector<double> vector_sparse;
-  exprToEigen(expr.affexpr, vector_sparse, n_vars);
-  vector = vector_sparse;
+  sparse_matrix = Eigen::Map<const Eigen::SparseMatrix<double>>(n_vars,
+                                                                n_vars,
+                                                                static_cast<Eigen::Index>(values.size()),
+                                                                column_pointers.data(),
+                                                                row_indices.data(),
+                                                                values.data());
+}
 
-  for (size_t i = 0; i < expr.coeffs.size(); ++i)
+template <typename T>
+void exprToCSC(const QuadExpr& expr,
+               std::vector<T>& row_indices,
+               std::vector<T>& column_pointers,
+               DblVec& values,
+               Eigen::VectorXd& vector,
+               const int& n_vars,
+               const bool& matrix_is_halved,
+               const bool& force_diagonal,
+               const bool& upper_triangular)
+{
+  const auto n = static_cast<size_t>(n_vars);
+
+  vector.setZero(n_vars);
+  for (size_t i = 0; i < expr.affexpr.size(); ++i)
   {
-    if (expr.coeffs[i] != 0.0)
+    const size_t i_var_index = expr.affexpr.vars[i].var_rep->index;
+    if (i_var_index >= n)
+    {
+      std::stringstream msg;
+      msg << "Coefficient " << i << "has index " << i_var_index << " but n_vars is " << n_vars;
+      throw std::runtime_error(msg.str());
+    }
+    vector[static_cast<Eigen::Index>(i_var_index)] += expr.affexpr.coeffs[i];
+  }
+
+  // Off-diagonal terms are mirrored (or only stored once in the upper triangle) and diagonal terms doubled, which is
+  // equivalent to adding the transpose of the upper triangular matrix.
+  const double scale = matrix_is_halved ? 1.0 : 0.5;
+  auto forEachEntry = [&](const auto& add) {
+    if (force_diagonal)
+      for (size_t k = 0; k < n; ++k)
+        add(k, k, 0.0);
+
+    for (size_t i = 0; i < expr.coeffs.size(); ++i)
     {
-      if (ind1[i] == ind2[i])
-        sparse_matrix.coeffRef(static_cast<Eigen::Index>(ind1[i]), static_cast<Eigen::Index>(ind2[i])) +=
-            expr.coeffs[i];
+      if (expr.coeffs[i] == 0.0)
+        continue;
+
+      size_t r = expr.vars1[i].var_rep->index;
+      size_t c = expr.vars2[i].var_rep->index;
+      if (r >= n || c >= n)
+      {
+        std::stringstream msg;
+        msg << "Coefficient " << i << "has indices " << r << ", " << c << " but n_vars is " << n_vars;
+        throw std::runtime_error(msg.str());
+      }
+
+      if (r == c)
+      {
+        add(r, c, 2 * scale * expr.coeffs[i]);
+      }
+      else if (upper_triangular)
+      {
+        add(std::min(r, c), std::max(r, c), scale * expr.coeffs[i]);
+      }
       else
       {
-        Eigen::Index c, r;
-        if (ind1[i] < ind2[i])
-        {
-          r = static_cast<Eigen::Index>(ind1[i]);
-          c = static_cast<Eigen::Index>(ind2[i]);
-        }
-        else
-        {
-          r = static_cast<Eigen::Index>(ind2[i]);
-          c = static_cast<Eigen::Index>(ind1[i]);
-        }
-        sparse_matrix.coeffRef(r, c) += expr.coeffs[i];
+        add(r, c, scale * expr.coeffs[i]);
+        add(c, r, scale * expr.coeffs[i]);
       }
     }
+  };
+
+  // Bucket the entries by row, counting the entries of each row and column first
+  SizeTVec row_starts(n + 1, 0);
+  SizeTVec column_starts(n + 1, 0);
+  forEachEntry([&](size_t r, size_t c, double /*v*/) {
+    ++row_starts[r + 1];
+    ++column_starts[c + 1];
+  });
+  for (size_t k = 0; k < n; ++k)
+  {
+    row_starts[k + 1] += row_starts[k];
+    column_starts[k + 1] += column_starts[k];
   }
 
-  auto sparse_matrix_T = Eigen::SparseMatrix<double>(sparse_matrix.transpose());
-  sparse_matrix = sparse_matrix + sparse_matrix_T;
+  const size_t n_entries = row_starts[n];
+  SizeTVec entry_columns(n_entries);
+  DblVec entry_values(n_entries);
+  SizeTVec next(row_starts.begin(), row_starts.end() - 1);
+  forEachEntry([&](size_t r, size_t c, double v) {
+    entry_columns[next[r]] = c;
+    entry_values[next[r]] = v;
+    ++next[r];
+  });
 
-  if (!matrix_is_halved)
-    sparse_matrix = 0.5 * sparse_matrix;
+  // Scatter the rows in order into their columns. The row indices of each column come out sorted, so a duplicate
+  // entry is always the last one written to its column and is merged into it.
+  row_indices.resize(n_entries);
+  values.resize(n_entries);
+  next.assign(column_starts.begin(), column_starts.end() - 1);
+  for (size_t r = 0; r < n; ++r)
+  {
+    for (size_t k = row_starts[r]; k < row_starts[r + 1]; ++k)
+    {
+      const size_t c = entry_columns[k];
+      if (next[c] > column_starts[c] && row_indices[next[c] - 1] == static_cast<T>(r))
+      {
+        values[next[c] - 1] += entry_values[k];
+      }
+      else
+      {
+        row_indices[next[c]] = static_cast<T>(r);
+        values[next[c]] = entry_values[k];
+        ++next[c];
+      }
+    }
+  }
 
-  if (force_diagonal)
-    for (int k = 0; k < n_vars; ++k)
-      sparse_matrix.coeffRef(k, k) += 0.0;
+  // Close the gaps left by merged duplicates
+  column_pointers.resize(n + 1);
+  size_t nnz = 0;
+  for (size_t c = 0; c < n; ++c)
+  {
+    column_pointers[c] = static_cast<T>(nnz);
+    for (size_t k = column_starts[c]; k < next[c]; ++k, ++nnz)
+    {
+      row_indices[nnz] = row_indices[k];
+      values[nnz] = values[k];
+    }
+  }
+  column_pointers[n] = static_cast<T>(nnz);
+  row_indices.resize(nnz);
+  values.resize(nnz);
+}
+
+// The index types used by the solver interfaces
+template void exprToCSC<int>(const QuadExpr&,
+                             std::vector<int>&,
+                             std::vector<int>&,
+                             DblVec&,
+                             Eigen::VectorXd&,
+                             const int&,
+                             const bool&,
+                             const bool&,
+                             const bool&);
+template void exprToCSC<long>(const QuadExpr&,
+                              std::vector<long>&,
+                              std::vector<long>&,
+                              DblVec&,
+                              Eigen::VectorXd&,
+                              const int&,
+                              const bool&,
+                              const bool&,
+                              const bool&);
+template void exprToCSC<long long>(const QuadExpr&,
+                                   std::vector<long long>&,
+                                   std::vector<long long>&,
+                                   DblVec&,
+                                   Eigen::VectorXd&,
+                                   const int&,
+                                   const bool&,
+                                   const bool&,
+                                   const bool&);
+
+template <typename T>
+void addCSC(const std::vector<T>& row_indices,
+            const std::vector<T>& column_pointers,
+            const DblVec& values,
+            std::vector<T>& sum_row_indices,
+            std::vector<T>& sum_column_pointers,
+            DblVec& sum_values)
+{
+  assert(!sum_column_pointers.empty() && column_pointers.size() <= sum_column_pointers.size());
+  const size_t n = sum_column_pointers.size() - 1;
+  const size_t n_added = column_pointers.empty() ? 0 : column_pointers.size() - 1;
+
+  std::vector<T> out_row_indices;
+  std::vector<T> out_column_pointers(n + 1);
+  DblVec out_values;
+  out_row_indices.reserve(sum_row_indices.size() + row_indices.size());
+  out_values.reserve(sum_values.size() + values.size());
+
+  // Both columns are sorted by row, so they are merged like sorted lists
+  for (size_t c = 0; c < n; ++c)
+  {
+    out_column_pointers[c] = static_cast<T>(out_row_indices.size());
+    auto k = static_cast<size_t>(sum_column_pointers[c]);
+    const auto k_end = static_cast<size_t>(sum_column_pointers[c + 1]);
+    auto j = (c < n_added) ? static_cast<size_t>(column_pointers[c]) : 0;
+    const auto j_end = (c < n_added) ? static_cast<size_t>(column_pointers[c + 1]) : 0;
+    while (k < k_end || j < j_end)
+    {
+      if (j == j_end || (k < k_end && sum_row_indices[k] < row_indices[j]))
+      {
+        out_row_indices.push_back(sum_row_indices[k]);
+        out_values.push_back(sum_values[k++]);
+      }
+      else if (k == k_end || row_indices[j] < sum_row_indices[k])
+      {
+        out_row_indices.push_back(row_indices[j]);
+        out_values.push_back(values[j++]);
+      }
+      else
+      {
+        out_row_indices.push_back(row_indices[j]);
+        out_values.push_back(sum_values[k++] + values[j++]);
+      }
+    }
+  }
+  out_column_pointers[n] = static_cast<T>(out_row_indices.size());
+
+  sum_row_indices.swap(out_row_indices);
+  sum_column_pointers.swap(out_column_pointers);
+  sum_values.swap(out_values);
 }
 
+// The index types used by the solver interfaces
+template void addCSC<int>(const std::vector<int>&,
+                          const std::vector<int>&,
+                          const DblVec&,
+                          std::vector<int>&,
+                          std::vector<int>&,
+                          DblVec&);
+template void addCSC<long>(const std::vector<long>&,
+                           const std::vector<long>&,
+                           const DblVec&,
+                           std::vector<long>&,
+                           std::vector<long>&,
+                           DblVec&);
+template void addCSC<long long>(const std::vector<long long>&,
+                                const std::vector<long long>&,
+                                const DblVec&,
+                                std::vector<long long>&,
+                                std::vector<long long>&,
+                                DblVec&);
+
 void exprToEigen(const AffExprVector& expr_vec,
                  Eigen::SparseMatrix<double>& sparse_matrix,
                  Eigen::VectorXd& vector,
@@ -118,6 +312,214 @@ void exprToEigen(const AffExprVector& expr_vec,
   sparse_matrix.setFromTriplets(triplets.begin(), triplets.end());
 }
 
+template <typename T>
+void exprToCSC(const AffExprVector& expr_vec,
+               std::vector<T>& row_indices,
+               std::vector<T>& column_pointers,
+               DblVec& values,
+               Eigen::VectorXd& vector,
+               const int& n_vars,
+               const bool& append_identity)
+{
+  const auto n = static_cast<size_t>(n_vars);
+  const size_t m = expr_vec.size();
+
+  vector.resize(static_cast<Eigen::Index>(m));
+  auto forEachEntry = [&](const auto& add) {
+    for (size_t i = 0; i < m; ++i)
+    {
+      const AffExpr& expr = expr_vec[i];
+      for (size_t j = 0; j < expr.size(); ++j)
+      {
+        const size_t i_var_index = expr.vars[j].var_rep->index;
+        if (i_var_index >= n)
+        {
+          std::stringstream msg;
+          msg << "Coefficient " << i << "has index " << i_var_index << " but n_vars is " << n_vars;
+          throw std::runtime_error(msg.str());
+        }
+        if (expr.coeffs[j] != 0.)
+          add(i, i_var_index, expr.coeffs[j]);
+      }
+    }
+    if (append_identity)
+      for (size_t k = 0; k < n; ++k)
+        add(m + k, k, 1.);
+  };
+
+  for (size_t i = 0; i < m; ++i)
+    vector[static_cast<Eigen::Index>(i)] = -expr_vec[i].constant;
+
+  // Count the entries of each column, then scatter the rows in order into their columns. The row indices of each
+  // column come out sorted, so a duplicate entry is always the last one written to its column and is merged into it.
+  SizeTVec column_starts(n + 1, 0);
+  forEachEntry([&](size_t /*r*/, size_t c, double /*v*/) { ++column_starts[c + 1]; });
+  for (size_t k = 0; k < n; ++k)
+    column_starts[k + 1] += column_starts[k];
+
+  row_indices.resize(column_starts[n]);
+  values.resize(column_starts[n]);
+  SizeTVec next(column_starts.begin(), column_starts.end() - 1);
+  forEachEntry([&](size_t r, size_t c, double v) {
+    if (next[c] > column_starts[c] && row_indices[next[c] - 1] == static_cast<T>(r))
+    {
+      values[next[c] - 1] += v;
+    }
+    else
+    {
+      row_indices[next[c]] = static_cast<T>(r);
+      values[next[c]] = v;
+      ++next[c];
+    }
+  });
+
+  // Close the gaps left by merged duplicates
+  column_pointers.resize(n + 1);
+  size_t nnz = 0;
+  for (size_t c = 0; c < n; ++c)
+  {
+    column_pointers[c] = static_cast<T>(nnz);
+    for (size_t k = column_starts[c]; k < next[c]; ++k, ++nnz)
+    {
+      row_indices[nnz] = row_indices[k];
+      values[nnz] = values[k];
+    }
+  }
+  column_pointers[n] = static_cast<T>(nnz);
+  row_indices.resize(nnz);
+  values.resize(nnz);
+}
+
+// The index types used by the solver interfaces
+template void exprToCSC<int>(const AffExprVector&,
+                             std::vector<int>&,
+                             std::vector<int>&,
+                             DblVec&,
+                             Eigen::VectorXd&,
+                             const int&,
+                             const bool&);
+template void exprToCSC<long>(const AffExprVector&,
+                              std::vector<long>&,
+                              std::vector<long>&,
+                              DblVec&,
+                              Eigen::VectorXd&,
+                              const int&,
+                              const bool&);
+template void exprToCSC<long long>(const AffExprVector&,
+                                   std::vector<long long>&,
+                                   std::vector<long long>&,
+                                   DblVec&,
+                                   Eigen::VectorXd&,
+                                   const int&,
+                                   const bool&);
+
+void exprToEigen(const IndexedAffExpr& expr, Eigen::SparseVector<double>& sparse_vector, const int& n_vars)
+{
+  sparse_vector.resize(n_vars);
+  sparse_vector.reserve(static_cast<long int>(expr.size()));
+  for (size_t i = 0; i < expr.size(); ++i)
+  {
+    VarIndex i_var_index = expr.inds[i];
+    if (i_var_index >= n_vars)
+    {
+      std::stringstream msg;
+      msg << "Coefficient " << i << "has index " << i_var_index << " but n_vars is " << n_vars;
+      throw std::runtime_error(msg.str());
+    }
+    if (expr.coeffs[i] != 0.)
+      sparse_vector.coeffRef(i_var_index) += expr.coeffs[i];
+  }
+}
+
+void exprToEigen(const IndexedQuadExpr& expr,
+                 Eigen::SparseMatrix<double>& sparse_matrix,
+                 Eigen::VectorXd& vector,
+                 const int& n_vars,
+                 const bool& matrix_is_halved,
+                 const bool& force_diagonal)
+{
+  Eigen::SparseVector<double> vector_sparse;
+  exprToEigen(expr.affexpr, vector_sparse, n_vars);
+  vector = vector_sparse;
+
+  // Off-diagonal terms are mirrored and diagonal terms doubled, which is
+  // equivalent to adding the transpose of the upper triangular matrix.
+  const double scale = matrix_is_halved ? 1.0 : 0.5;
+
+  using T = Eigen::Triplet<double>;
+  std::vector<T, Eigen::aligned_allocator<T>> triplets;
+  triplets.reserve(2 * expr.size() + (force_diagonal ? static_cast<size_t>(n_vars) : 0));
+  for (size_t i = 0; i < expr.size(); ++i)
+  {
+    if (expr.coeffs[i] == 0.0)
+      continue;
+
+    VarIndex r = expr.inds1[i];
+    VarIndex c = expr.inds2[i];
+    if (r >= n_vars || c >= n_vars)
+    {
+      std::stringstream msg;
+      msg << "Coefficient " << i << "has indices " << r << ", " << c << " but n_vars is " << n_vars;
+      throw std::runtime_error(msg.str());
+    }
+
+    if (r == c)
+    {
+      triplets.emplace_back(r, c, 2 * scale * expr.coeffs[i]);
+    }
+    else
+    {
+      triplets.emplace_back(r, c, scale * expr.coeffs[i]);
+      triplets.emplace_back(c, r, scale * expr.coeffs[i]);
+    }
+  }
+
+  if (force_diagonal)
+    for (int k = 0; k < n_vars; ++k)
+      triplets.emplace_back(k, k, 0.0);
+
+  sparse_matrix.resize(n_vars, n_vars);
+  sparse_matrix.setFromTriplets(triplets.begin(), triplets.end());
+}
+
+void exprToEigen(const IndexedAffExprVector& expr_vec,
+                 Eigen::SparseMatrix<double>& sparse_matrix,
+                 Eigen::VectorXd& vector,
+                 const int& n_vars)
+{
+  vector.resize(static_cast<long int>(expr_vec.size()));
+  vector.setZero();
+  sparse_matrix.resize(static_cast<long int>(expr_vec.size()), n_vars);
+
+  size_t nnz = 0;
+  for (const IndexedAffExpr& expr : expr_vec)
+    nnz += expr.size();
+
+  using T = Eigen::Triplet<double>;
+  std::vector<T, Eigen::aligned_allocator<T>> triplets;
+  triplets.reserve(nnz);
+
+  for (int i = 0; i < static_cast<int>(expr_vec.size()); ++i)
+  {
+    const IndexedAffExpr& expr = expr_vec[static_cast<size_t>(i)];
+    vector[i] = -expr.constant;
+
+    for (size_t j = 0; j < expr.size(); ++j)
+    {
+      VarIndex i_var_index = expr.inds[j];
+      if (i_var_index >= n_vars)
+      {
+        std::stringstream msg;
+        msg << "Coefficient " << i << "has index " << i_var_index << " but n_vars is " << n_vars;
+        throw std::runtime_error(msg.str());
+      }
+      if (expr.coeffs[j] != 0.)
+        triplets.emplace_back(i, i_var_index, expr.coeffs[j]);
+    }
+  }
+  sparse_matrix.setFromTriplets(triplets.begin(), triplets.end());
+}
+
 void tripletsToEigen(const IntVec& rows_i,
                      const IntVec& cols_j,
                      const DblVec& values_ij,
@@ -0,0 +1,181 @@
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <cmath>
+#include <iostream>
+#include <sstream>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_sco/staging_model.hpp>
+
+namespace sco
+{
+StagingModel::StagingModel(Model* model) : model_(model) { assert(model_ != nullptr); }
+
+Var StagingModel::addVar(const std::string& name)
+{
+  return addVar(name, -static_cast<double>(INFINITY), static_cast<double>(INFINITY));
+}
+
+Var StagingModel::addVar(const std::string& name, double lb, double ub)
+{
+  if (!staging_)
+    return model_->addVar(name, lb, ub);
+
+  staged_vars_.push_back({ name, lb, ub });
+  return std::make_shared<VarRep>(staged_vars_.size() - 1, name, this);
+}
+
+Cnt StagingModel::addEqCnt(const AffExpr& expr, const std::string& name)
+{
+  assertNotStaging("addEqCnt");
+  return model_->addEqCnt(expr, name);
+}
+
+Cnt StagingModel::addIneqCnt(const AffExpr& expr, const std::string& name)
+{
+  assertNotStaging("addIneqCnt");
+  return model_->addIneqCnt(expr, name);
+}
+
+Cnt StagingModel::addIneqCnt(const QuadExpr& expr, const std::string& name)
+{
+  assertNotStaging("addIneqCnt");
+  return model_->addIneqCnt(expr, name);
+}
+
+bool StagingModel::updateCnt(const Cnt& cnt, const AffExpr& expr)
+{
+  assertNotStaging("updateCnt");
+  return model_->updateCnt(cnt, expr);
+}
+
+void StagingModel::removeVars(const VarVector& vars)
+{
+  VarVector committed;
+  committed.reserve(vars.size());
+  for (const Var& var : vars)
+  {
+    if (!isPlaceholder(var))
+      committed.push_back(var);
+  }
+
+  if (!committed.empty())
+    model_->removeVars(committed);
+}
+
+void StagingModel::removeCnts(const CntVector& cnts)
+{
+  if (!cnts.empty())
+    model_->removeCnts(cnts);
+}
+
+void StagingModel::update()
+{
+  assertNotStaging("update");
+  model_->update();
+}
+
+void StagingModel::setVarBounds(const VarVector& vars, const DblVec& lower, const DblVec& upper)
+{
+  if (!staging_)
+  {
+    model_->setVarBounds(vars, lower, upper);
+    return;
+  }
+
+  for (std::size_t i = 0; i < vars.size(); ++i)
+  {
+    if (!isPlaceholder(vars[i]))
+      PRINT_AND_THROW("StagingModel: only the bounds of staged variables can be set while staging");
+    staged_vars_[vars[i].var_rep->index].lb = lower[i];
+    staged_vars_[vars[i].var_rep->index].ub = upper[i];
+  }
+}
+
+DblVec StagingModel::getVarValues(const VarVector& vars) const { return model_->getVarValues(vars); }
+
+CvxOptStatus StagingModel::optimize()
+{
+  assertNotStaging("optimize");
+  return model_->optimize();
+}
+
+void StagingModel::setObjective(const AffExpr& expr)
+{
+  assertNotStaging("setObjective");
+  model_->setObjective(expr);
+}
+
+void StagingModel::setObjective(const QuadExpr& expr)
+{
+  assertNotStaging("setObjective");
+  model_->setObjective(expr);
+}
+
+bool StagingModel::setConstantObjective(const QuadExpr& expr)
+{
+  assertNotStaging("setConstantObjective");
+  return model_->setConstantObjective(expr);
+}
+
+void StagingModel::writeToFile(const std::string& fname) const { model_->writeToFile(fname); }
+VarVector StagingModel::getVars() const { return model_->getVars(); }
+
+void StagingModel::commit(ConvexObjective& obj)
+{
+  commitVars();
+  replacePlaceholders(obj.quad_.affexpr);
+  replacePlaceholders(obj.quad_.vars1);
+  replacePlaceholders(obj.quad_.vars2);
+  replacePlaceholders(obj.vars_);
+  replacePlaceholders(obj.eqs_);
+  replacePlaceholders(obj.ineqs_);
+}
+
+void StagingModel::commit(ConvexConstraints& cnts)
+{
+  commitVars();
+  replacePlaceholders(cnts.eqs_);
+  replacePlaceholders(cnts.ineqs_);
+}
+
+bool StagingModel::isPlaceholder(const Var& var) const
+{
+  return var.var_rep != nullptr && var.var_rep->creator == this;
+}
+
+void StagingModel::commitVars()
+{
+  if (!staging_)
+    return;
+
+  committed_vars_.reserve(staged_vars_.size());
+  for (const StagedVar& staged : staged_vars_)
+    committed_vars_.push_back(model_->addVar(staged.name, staged.lb, staged.ub));
+  staged_vars_.clear();
+  staging_ = false;
+}
+
+void StagingModel::replacePlaceholders(VarVector& vars) const
+{
+  for (Var& var : vars)
+  {
+    if (isPlaceholder(var))
+      var = committed_vars_[var.var_rep->index];
+  }
+}
+
+void StagingModel::replacePlaceholders(AffExpr& expr) const { replacePlaceholders(expr.vars); }
+
+void StagingModel::replacePlaceholders(AffExprVector& exprs) const
+{
+  for (AffExpr& expr : exprs)
+    replacePlaceholders(expr.vars);
+}
+
+void StagingModel::assertNotStaging(const char* function) const
+{
+  if (staging_)
+    PRINT_AND_THROW(std::string("StagingModel: ") + function + " is not allowed while staging");
+}
+}  // namespace sco
@@ -0,0 +1,192 @@
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_sco/expr_ops.hpp>
+#include <trajopt_sco/indexed_expr.hpp>
+#include <trajopt_sco/solver_utils.hpp>
+
+using namespace sco;
+
+/**
+ * @brief Creates n_vars variables without a model, the same way the unit tests do
+ * @param n_vars Number of variables
+ * @return The variables, where vars[i] has index i
+ */
+inline VarVector createVars(std::size_t n_vars)
+{
+  VarVector vars;
+  vars.reserve(n_vars);
+  for (std::size_t i = 0; i < n_vars; ++i)
+    vars.emplace_back(std::make_shared<VarRep>(i, "x_" + std::to_string(i), nullptr));
+  return vars;
+}
+
+/**
+ * @brief Contains the data shared by the Var based and index based benchmarks
+ *
+ * The expression mimics a trajectory cost: n_terms random coefficients over
+ * n_vars variables accessed in a scattered order.
+ */
+class ExprBenchmarkInfo
+{
+public:
+  ExprBenchmarkInfo(std::size_t n_vars, std::size_t n_terms) : vars(createVars(n_vars)), x(n_vars)
+  {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<std::size_t> ind_dist(0, n_vars - 1);
+    std::uniform_real_distribution<double> val_dist(-1, 1);
+
+    for (double& v : x)
+      v = val_dist(gen);
+
+    for (std::size_t i = 0; i < n_terms; ++i)
+    {
+      const Var& v1 = vars[ind_dist(gen)];
+      const Var& v2 = vars[ind_dist(gen)];
+      double c = val_dist(gen);
+
+      aff.coeffs.push_back(c);
+      aff.vars.push_back(v1);
+
+      quad.coeffs.push_back(c);
+      quad.vars1.push_back(v1);
+      quad.vars2.push_back(v2);
+    }
+    quad.affexpr = aff;
+
+    indexed_aff = IndexedAffExpr(aff);
+    indexed_quad = IndexedQuadExpr(quad);
+  }
+
+  VarVector vars;
+  DblVec x;
+  AffExpr aff;
+  QuadExpr quad;
+  IndexedAffExpr indexed_aff;
+  IndexedQuadExpr indexed_quad;
+};
+
+static void BM_AFF_EXPR_VALUE(benchmark::State& state)
+{
+  ExprBenchmarkInfo info(static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(info.aff.value(info.x));
+}
+
+static void BM_INDEXED_AFF_EXPR_VALUE(benchmark::State& state)
+{
+  ExprBenchmarkInfo info(static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(info.indexed_aff.value(info.x));
+}
+
+static void BM_AFF_EXPR_INC(benchmark::State& state)
+{
+  ExprBenchmarkInfo info(static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1)));
+  for (auto _ : state)
+  {
+    AffExpr out;
+    for (int i = 0; i < 10; ++i)
+      exprInc(out, info.aff);
+    benchmark::DoNotOptimize(out);
+  }
+}
+
+static void BM_INDEXED_AFF_EXPR_INC(benchmark::State& state)
+{
+  ExprBenchmarkInfo info(static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1)));
+  for (auto _ : state)
+  {
+    IndexedAffExpr out;
+    for (int i = 0; i < 10; ++i)
+      exprInc(out, info.indexed_aff);
+    benchmark::DoNotOptimize(out);
+  }
+}
+
+static void BM_QUAD_EXPR_TO_EIGEN(benchmark::State& state)
+{
+  ExprBenchmarkInfo info(static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1)));
+  Eigen::SparseMatrix<double> m;
+  Eigen::VectorXd v;
+  for (auto _ : state)
+  {
+    exprToEigen(info.quad, m, v, static_cast<int>(info.vars.size()), true, true);
+    benchmark::DoNotOptimize(m);
+  }
+}
+
+static void BM_INDEXED_QUAD_EXPR_TO_EIGEN(benchmark::State& state)
+{
+  ExprBenchmarkInfo info(static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1)));
+  Eigen::SparseMatrix<double> m;
+  Eigen::VectorXd v;
+  for (auto _ : state)
+  {
+    exprToEigen(info.indexed_quad, m, v, static_cast<int>(info.vars.size()), true, true);
+    benchmark::DoNotOptimize(m);
+  }
+}
+
+/** @brief The previous OSQP objective path: Eigen matrix, upper triangular copy, then CSC arrays */
+static void BM_QUAD_EXPR_TO_EIGEN_UPPER_CSC(benchmark::State& state)
+{
+  ExprBenchmarkInfo info(static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1)));
+  Eigen::SparseMatrix<double> m;
+  Eigen::VectorXd v;
+  IntVec row_indices, column_pointers;
+  DblVec values;
+  for (auto _ : state)
+  {
+    exprToEigen(info.quad, m, v, static_cast<int>(info.vars.size()), true);
+    Eigen::SparseMatrix<double> upper = m.triangularView<Eigen::Upper>();
+    eigenToCSC(upper, row_indices, column_pointers, values);
+    benchmark::DoNotOptimize(values);
+  }
+}
+
+static void BM_QUAD_EXPR_TO_CSC(benchmark::State& state)
+{
+  ExprBenchmarkInfo info(static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1)));
+  Eigen::VectorXd v;
+  IntVec row_indices, column_pointers;
+  DblVec values;
+  for (auto _ : state)
+  {
+    exprToCSC(info.quad, row_indices, column_pointers, values, v, static_cast<int>(info.vars.size()), true, true);
+    benchmark::DoNotOptimize(values);
+  }
+}
+
+static void BM_QUAD_EXPR_TO_UPPER_CSC(benchmark::State& state)
+{
+  ExprBenchmarkInfo info(static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1)));
+  Eigen::VectorXd v;
+  IntVec row_indices, column_pointers;
+  DblVec values;
+  for (auto _ : state)
+  {
+    exprToCSC(
+        info.quad, row_indices, column_pointers, values, v, static_cast<int>(info.vars.size()), true, false, true);
+    benchmark::DoNotOptimize(values);
+  }
+}
+
+// Arguments are {number of variables, number of terms}, e.g. 7 DOF x 100 to 1000 steps
+#define EXPR_BENCHMARK_ARGS Args({ 700, 1000 })->Args({ 700, 10000 })->Args({ 7000, 10000 })->Args({ 7000, 100000 })
+
+BENCHMARK(BM_AFF_EXPR_VALUE)->EXPR_BENCHMARK_ARGS;
+BENCHMARK(BM_INDEXED_AFF_EXPR_VALUE)->EXPR_BENCHMARK_ARGS;
+BENCHMARK(BM_AFF_EXPR_INC)->EXPR_BENCHMARK_ARGS;
+BENCHMARK(BM_INDEXED_AFF_EXPR_INC)->EXPR_BENCHMARK_ARGS;
+BENCHMARK(BM_QUAD_EXPR_TO_EIGEN)->EXPR_BENCHMARK_ARGS;
+BENCHMARK(BM_INDEXED_QUAD_EXPR_TO_EIGEN)->EXPR_BENCHMARK_ARGS;
+BENCHMARK(BM_QUAD_EXPR_TO_EIGEN_UPPER_CSC)->EXPR_BENCHMARK_ARGS;
+BENCHMARK(BM_QUAD_EXPR_TO_CSC)->EXPR_BENCHMARK_ARGS;
+BENCHMARK(BM_QUAD_EXPR_TO_UPPER_CSC)->EXPR_BENCHMARK_ARGS;
+
+BENCHMARK_MAIN();
@@ -0,0 +1,104 @@
+#pragma once
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <cmath>
+#include <stdexcept>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_sco/solver_interface.hpp>
+
+namespace sco
+{
+/** @brief Minimal model which only does the variable and constraint bookkeeping, it can not be optimized */
+class BookkeepingModel : public Model
+{
+public:
+  Var addVar(const std::string& name) override
+  {
+    vars_.push_back(std::make_shared<VarRep>(vars_.size(), name, this));
+    lbs_.push_back(-INFINITY);
+    ubs_.push_back(INFINITY);
+    return vars_.back();
+  }
+  Cnt addEqCnt(const AffExpr& expr, const std::string& /*name*/) override { return addCnt(expr); }
+  Cnt addIneqCnt(const AffExpr& expr, const std::string& /*name*/) override { return addCnt(expr); }
+  Cnt addIneqCnt(const QuadExpr&, const std::string& /*name*/) override { throw std::runtime_error("NOT IMPLEMENTED"); }
+  bool updateCnt(const Cnt& cnt, const AffExpr& expr) override
+  {
+    if (!support_update)
+      return false;
+    cnt_exprs_[cnt.cnt_rep->index] = expr;
+    return true;
+  }
+  void removeVars(const VarVector& vars) override
+  {
+    for (const auto& var : vars)
+      var.var_rep->removed = true;
+  }
+  void removeCnts(const CntVector& cnts) override
+  {
+    for (const auto& cnt : cnts)
+      cnt.cnt_rep->removed = true;
+  }
+  void update() override
+  {
+    std::size_t inew = 0;
+    for (std::size_t iold = 0; iold < vars_.size(); ++iold)
+    {
+      if (!vars_[iold].var_rep->removed)
+      {
+        vars_[inew] = vars_[iold];
+        lbs_[inew] = lbs_[iold];
+        ubs_[inew] = ubs_[iold];
+        vars_[inew].var_rep->index = inew;
+        ++inew;
+      }
+    }
+    vars_.resize(inew);
+    lbs_.resize(inew);
+    ubs_.resize(inew);
+
+    inew = 0;
+    for (std::size_t iold = 0; iold < cnts_.size(); ++iold)
+    {
+      if (!cnts_[iold].cnt_rep->removed)
+      {
+        cnts_[inew] = cnts_[iold];
+        cnt_exprs_[inew] = cnt_exprs_[iold];
+        cnts_[inew].cnt_rep->index = inew;
+        ++inew;
+      }
+    }
+    cnts_.resize(inew);
+    cnt_exprs_.resize(inew);
+  }
+  void setVarBounds(const VarVector& vars, const DblVec& lower, const DblVec& upper) override
+  {
+    for (std::size_t i = 0; i < vars.size(); ++i)
+    {
+      lbs_[vars[i].var_rep->index] = lower[i];
+      ubs_[vars[i].var_rep->index] = upper[i];
+    }
+  }
+  DblVec getVarValues(const VarVector& vars) const override { return DblVec(vars.size(), 0); }
+  CvxOptStatus optimize() override { return CVX_FAILED; }
+  void setObjective(const AffExpr&) override {}
+  void setObjective(const QuadExpr&) override {}
+  void writeToFile(const std::string&) const override {}
+  VarVector getVars() const override { return vars_; }
+
+  bool support_update{ true };
+  VarVector vars_;
+  DblVec lbs_, ubs_;
+  CntVector cnts_;
+  AffExprVector cnt_exprs_;
+
+private:
+  Cnt addCnt(const AffExpr& expr)
+  {
+    cnts_.push_back(std::make_shared<CntRep>(cnts_.size(), this));
+    cnt_exprs_.push_back(expr);
+    return cnts_.back();
+  }
+};
+}  // namespace sco
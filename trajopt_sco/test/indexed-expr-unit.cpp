@@ -0,0 +1,155 @@
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <gtest/gtest.h>
+#include <Eigen/Core>
+#include <sstream>
+#include <vector>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_sco/expr_ops.hpp>
+#include <trajopt_sco/indexed_expr.hpp>
+#include <trajopt_sco/solver_utils.hpp>
+
+using namespace sco;
+
+class IndexedExpr : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+      std::stringstream var_name;
+      var_name << "x_" << i;
+      x.emplace_back(std::make_shared<VarRep>(i, var_name.str(), nullptr));
+    }
+    table.sync(x);
+    x_vals = { 1, -2, 3, 0.5 };
+  }
+
+  VarVector x;
+  VarTable table;
+  DblVec x_vals;
+};
+
+TEST_F(IndexedExpr, RoundTrip)  // NOLINT
+{
+  // 2 + 3 x_0 - x_2 + 4 x_0 * x_3 + x_1^2
+  AffExpr aff(2);
+  exprInc(aff, exprMult(x[0], 3));
+  exprDec(aff, x[2]);
+  QuadExpr quad(aff);
+  quad.coeffs = { 4, 1 };
+  quad.vars1 = { x[0], x[1] };
+  quad.vars2 = { x[3], x[1] };
+
+  IndexedQuadExpr indexed(quad);
+  EXPECT_DOUBLE_EQ(indexed.affexpr.value(x_vals), aff.value(x_vals));
+  EXPECT_DOUBLE_EQ(indexed.value(x_vals), quad.value(x_vals));
+
+  QuadExpr back = toQuadExpr(indexed, table);
+  EXPECT_DOUBLE_EQ(back.value(x_vals), quad.value(x_vals));
+  ASSERT_EQ(back.affexpr.vars.size(), aff.vars.size());
+  for (std::size_t i = 0; i < aff.vars.size(); ++i)
+    EXPECT_EQ(back.affexpr.vars[i].var_rep, aff.vars[i].var_rep);
+  EXPECT_EQ(table.name(indexed.inds1[0]), "x_0");
+  EXPECT_EQ(table.name(indexed.inds2[0]), "x_3");
+}
+
+TEST_F(IndexedExpr, Operators)  // NOLINT
+{
+  AffExpr a = exprAdd(exprMult(AffExpr(x[0]), 2), x[1]);
+  AffExpr b = exprSub(AffExpr(x[2]), 1.5);
+
+  IndexedAffExpr ia(a);
+  IndexedAffExpr ib(b);
+
+  EXPECT_DOUBLE_EQ(exprAdd(ia, ib).value(x_vals), exprAdd(a, b).value(x_vals));
+  EXPECT_DOUBLE_EQ(exprSub(ia, ib).value(x_vals), exprSub(a, b).value(x_vals));
+  EXPECT_DOUBLE_EQ(exprMult(ia, ib).value(x_vals), exprMult(a, b).value(x_vals));
+  EXPECT_DOUBLE_EQ(exprSquare(ia).value(x_vals), exprSquare(a).value(x_vals));
+
+  // Mixing Var based expressions into index based ones
+  IndexedQuadExpr iq;
+  exprInc(iq, exprSquare(b));
+  exprInc(iq, a);
+  QuadExpr q = exprSquare(b);
+  exprInc(q, a);
+  EXPECT_DOUBLE_EQ(iq.value(x_vals), q.value(x_vals));
+}
+
+TEST_F(IndexedExpr, Simplify)  // NOLINT
+{
+  IndexedAffExpr e(1);
+  exprInc(e, x[3]);
+  exprInc(e, exprMult(IndexedAffExpr(x[1]), 2));
+  exprDec(e, x[3]);
+  exprInc(e, x[1]);
+  double expected = e.value(x_vals);
+
+  simplify(e);
+  ASSERT_EQ(e.size(), 1);
+  EXPECT_EQ(e.inds[0], 1);
+  EXPECT_DOUBLE_EQ(e.coeffs[0], 3);
+  EXPECT_DOUBLE_EQ(e.value(x_vals), expected);
+}
+
+TEST_F(IndexedExpr, SimplifyQuad)  // NOLINT
+{
+  QuadExpr quad(AffExpr(1));
+  exprInc(quad.affexpr, x[2]);
+  exprInc(quad.affexpr, x[2]);
+  quad.coeffs = { 2, 1, -1, 5, 1 };
+  quad.vars1 = { x[0], x[1], x[3], x[1], x[0] };
+  quad.vars2 = { x[1], x[0], x[0], x[1], x[3] };
+  IndexedQuadExpr e(quad);
+  double expected = e.value(x_vals);
+
+  simplify(e);
+  EXPECT_EQ(e.affexpr.size(), 1);
+  ASSERT_EQ(e.size(), 2);
+  EXPECT_EQ(e.inds1[0], 0);
+  EXPECT_EQ(e.inds2[0], 1);
+  EXPECT_DOUBLE_EQ(e.coeffs[0], 3);
+  EXPECT_EQ(e.inds1[1], 1);
+  EXPECT_EQ(e.inds2[1], 1);
+  EXPECT_DOUBLE_EQ(e.coeffs[1], 5);
+  EXPECT_DOUBLE_EQ(e.value(x_vals), expected);
+}
+
+TEST_F(IndexedExpr, exprToEigen)  // NOLINT
+{
+  QuadExpr quad(AffExpr(1));
+  exprInc(quad.affexpr, exprMult(x[2], 3));
+  quad.coeffs = { 2, 1, -1, 5 };
+  quad.vars1 = { x[0], x[0], x[3], x[1] };
+  quad.vars2 = { x[1], x[0], x[0], x[1] };
+  IndexedQuadExpr indexed(quad);
+
+  for (bool halved : { true, false })
+  {
+    for (bool force_diagonal : { true, false })
+    {
+      Eigen::SparseMatrix<double> m, m_indexed;
+      Eigen::VectorXd v, v_indexed;
+      exprToEigen(quad, m, v, 4, halved, force_diagonal);
+      exprToEigen(indexed, m_indexed, v_indexed, 4, halved, force_diagonal);
+
+      EXPECT_TRUE(Eigen::MatrixXd(m).isApprox(Eigen::MatrixXd(m_indexed)));
+      EXPECT_TRUE(v.isApprox(v_indexed));
+      if (force_diagonal)
+      {
+        EXPECT_EQ(m.nonZeros(), m_indexed.nonZeros());
+      }
+    }
+  }
+
+  AffExprVector aff_vec{ quad.affexpr, exprMult(AffExpr(x[1]), -2) };
+  IndexedAffExprVector indexed_vec{ IndexedAffExpr(aff_vec[0]), IndexedAffExpr(aff_vec[1]) };
+  Eigen::SparseMatrix<double> m, m_indexed;
+  Eigen::VectorXd v, v_indexed;
+  exprToEigen(aff_vec, m, v, 4);
+  exprToEigen(indexed_vec, m_indexed, v_indexed, 4);
+  EXPECT_TRUE(Eigen::MatrixXd(m).isApprox(Eigen::MatrixXd(m_indexed)));
+  EXPECT_TRUE(v.isApprox(v_indexed));
+}
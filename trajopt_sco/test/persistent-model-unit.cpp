@@ -0,0 +1,97 @@
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <cmath>
+#include <gtest/gtest.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_sco/expr_ops.hpp>
+#include <trajopt_sco/modeling.hpp>
+#include <trajopt_sco/persistent_model.hpp>
+#include <bookkeeping_model.hpp>
+
+using namespace sco;
+
+/** @brief Convexify a term with n_hinges hinges and n_abs abs terms through model, like the SQP loop does */
+static ConvexObjective::Ptr convexify(Model* model, const Var& x, int n_hinges, int n_abs, double offset)
+{
+  auto obj = std::make_shared<ConvexObjective>(model);
+  for (int i = 0; i < n_hinges; ++i)
+    obj->addHinge(exprAdd(AffExpr(x), offset + i), 1);
+  for (int i = 0; i < n_abs; ++i)
+    obj->addAbs(exprSub(AffExpr(x), offset + i), 2);
+  model->update();
+  obj->addConstraintsToModel();
+  return obj;
+}
+
+TEST(PersistentTermModel, ReusesVarsAndRows)  // NOLINT
+{
+  BookkeepingModel model;
+  Var x = model.addVar("x");
+  model.update();
+
+  PersistentTermModel term_model(&model);
+  VarVector first_vars;
+  {
+    ConvexObjective::Ptr obj = convexify(&term_model, x, 2, 1, 0);
+    term_model.flush();
+    model.update();
+    first_vars = obj->vars_;
+    EXPECT_EQ(model.vars_.size(), 5);
+    EXPECT_EQ(model.cnts_.size(), 3);
+  }
+
+  // Same shape: nothing is added or removed, the expressions are refreshed in place
+  {
+    ConvexObjective::Ptr obj = convexify(&term_model, x, 2, 1, 10);
+    term_model.flush();
+    model.update();
+    EXPECT_EQ(model.vars_.size(), 5);
+    EXPECT_EQ(model.cnts_.size(), 3);
+    ASSERT_EQ(obj->vars_.size(), first_vars.size());
+    for (std::size_t i = 0; i < first_vars.size(); ++i)
+      EXPECT_EQ(obj->vars_[i].var_rep, first_vars[i].var_rep);
+    // Equality rows (abs) are added before inequality rows (hinges)
+    EXPECT_DOUBLE_EQ(model.cnt_exprs_[0].constant, -10);
+    EXPECT_DOUBLE_EQ(model.cnt_exprs_[1].constant, 10);
+    EXPECT_DOUBLE_EQ(model.cnt_exprs_[2].constant, 11);
+  }
+  EXPECT_EQ(term_model.getNumVarsAdded(), 4);
+  EXPECT_EQ(term_model.getNumVarsReused(), 4);
+  EXPECT_EQ(term_model.getNumCntsAdded(), 3);
+  EXPECT_EQ(term_model.getNumCntsReused(), 3);
+
+  // Smaller shape: the extra hinge is removed by flush
+  {
+    ConvexObjective::Ptr obj = convexify(&term_model, x, 1, 1, 0);
+    term_model.flush();
+    model.update();
+    EXPECT_EQ(model.vars_.size(), 4);
+    EXPECT_EQ(model.cnts_.size(), 2);
+  }
+  term_model.flush();
+  model.update();
+  EXPECT_EQ(model.vars_.size(), 1);
+  EXPECT_EQ(model.cnts_.size(), 0);
+}
+
+TEST(PersistentTermModel, FallsBackWithoutUpdateCnt)  // NOLINT
+{
+  BookkeepingModel model;
+  model.support_update = false;
+  Var x = model.addVar("x");
+  model.update();
+
+  PersistentTermModel term_model(&model);
+  for (int iter = 0; iter < 3; ++iter)
+  {
+    ConvexObjective::Ptr obj = convexify(&term_model, x, 2, 0, iter);
+    term_model.flush();
+    model.update();
+    EXPECT_EQ(model.vars_.size(), 3);
+    ASSERT_EQ(model.cnts_.size(), 2);
+    EXPECT_DOUBLE_EQ(model.cnt_exprs_[0].constant, iter);
+  }
+  EXPECT_EQ(term_model.getNumVarsAdded(), 2);
+  EXPECT_EQ(term_model.getNumCntsReused(), 0);
+}
@@ -1,11 +1,14 @@
 #include <trajopt_utils/macros.h>
 TRAJOPT_IGNORE_WARNINGS_PUSH
 #include <Eigen/Dense>
+#include <atomic>
 #include <boost/format.hpp>
+#include <chrono>
 #include <cmath>
 #include <gtest/gtest.h>
 #include <iostream>
 #include <sstream>
+#include <thread>
 TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt_sco/expr_op_overloads.hpp>
@@ -89,21 +92,33 @@ void testProblem(ScalarOfVector::Ptr f,
                  ConstraintType cnt_type,
                  const DblVec& init,
                  const DblVec& sol,
-                 ModelType convex_solver)
+                 ModelType convex_solver,
+                 bool persistent_convex_model = false,
+                 bool warm_start_convex_solve = false,
+                 int convexify_threads = 1,
+                 bool reuse_unchanged_terms = false)
 {
   OptProb::Ptr prob;
   size_t n = init.size();
   assert(sol.size() == n);
   setupProblem(prob, n, convex_solver);
-  prob->addCost(std::make_shared<CostFromFunc>(std::move(f), prob->getVars(), "f", true));
-  prob->addConstraint(
-      std::make_shared<ConstraintFromErrFunc>(std::move(g), prob->getVars(), VectorXd(), cnt_type, "g"));
+  // The test functions have no state, so they may run concurrently
+  auto cost = std::make_shared<CostFromFunc>(std::move(f), prob->getVars(), "f", true);
+  cost->setThreadSafe(true);
+  prob->addCost(cost);
+  auto cnt = std::make_shared<ConstraintFromErrFunc>(std::move(g), prob->getVars(), VectorXd(), cnt_type, "g");
+  cnt->setThreadSafe(true);
+  prob->addConstraint(cnt);
   BasicTrustRegionSQP solver(prob);
   BasicTrustRegionSQPParameters& params = solver.getParameters();
   params.max_iter = 1000;
   params.min_trust_box_size = 1e-5;
   params.min_approx_improve = 1e-10;
   params.initial_merit_error_coeff = 1;
+  params.persistent_convex_model = persistent_convex_model;
+  params.warm_start_convex_solve = warm_start_convex_solve;
+  params.convexify_threads = convexify_threads;
+  params.reuse_unchanged_terms = reuse_unchanged_terms;
 
   solver.initialize(init);
   OptStatus status = solver.optimize();
@@ -172,6 +187,342 @@ TEST_P(SQP, TP7)  // NOLINT
               { 0., sqrtf(3.) },
               GetParam());
 }
+TEST_P(SQP, TP1PersistentModel)  // NOLINT
+{
+  testProblem(ScalarOfVector::construct(&f_TP1),
+              VectorOfVector::construct(&g_TP1),
+              INEQ,
+              { -2, 1 },
+              { 1, 1 },
+              GetParam(),
+              true);
+}
+TEST_P(SQP, TP6PersistentModel)  // NOLINT
+{
+  testProblem(ScalarOfVector::construct(&f_TP6),
+              VectorOfVector::construct(&g_TP6),
+              EQ,
+              { 10, 1 },
+              { 1, 1 },
+              GetParam(),
+              true);
+}
+TEST_P(SQP, TP1WarmStart)  // NOLINT
+{
+  testProblem(ScalarOfVector::construct(&f_TP1),
+              VectorOfVector::construct(&g_TP1),
+              INEQ,
+              { -2, 1 },
+              { 1, 1 },
+              GetParam(),
+              false,
+              true);
+}
+TEST_P(SQP, TP6PersistentModelWarmStart)  // NOLINT
+{
+  testProblem(ScalarOfVector::construct(&f_TP6),
+              VectorOfVector::construct(&g_TP6),
+              EQ,
+              { 10, 1 },
+              { 1, 1 },
+              GetParam(),
+              true,
+              true);
+}
+TEST_P(SQP, TP6ParallelConvexify)  // NOLINT
+{
+  testProblem(ScalarOfVector::construct(&f_TP6),
+              VectorOfVector::construct(&g_TP6),
+              EQ,
+              { 10, 1 },
+              { 1, 1 },
+              GetParam(),
+              true,
+              false,
+              4);
+}
+TEST_P(SQP, TP1ReuseUnchangedTerms)  // NOLINT
+{
+  testProblem(ScalarOfVector::construct(&f_TP1),
+              VectorOfVector::construct(&g_TP1),
+              INEQ,
+              { -2, 1 },
+              { 1, 1 },
+              GetParam(),
+              true,
+              false,
+              1,
+              true);
+}
+/** Convexifying and evaluating the terms on several threads must give exactly the serial results */
+TEST_P(SQP, TP7ThreadsMatchSerial)  // NOLINT
+{
+  auto solve = [this](int n_threads) {
+    OptProb::Ptr prob;
+    setupProblem(prob, 2, GetParam());
+    for (int i = 0; i < 4; ++i)
+    {
+      auto cost = std::make_shared<CostFromFunc>(ScalarOfVector::construct(&f_TP7), prob->getVars(), "f", true);
+      cost->setThreadSafe(true);
+      prob->addCost(cost);
+      auto cnt = std::make_shared<ConstraintFromErrFunc>(
+          VectorOfVector::construct(&g_TP7), prob->getVars(), VectorXd(), EQ, "g");
+      cnt->setThreadSafe(true);
+      prob->addConstraint(cnt);
+    }
+    BasicTrustRegionSQP solver(prob);
+    BasicTrustRegionSQPParameters& params = solver.getParameters();
+    params.max_iter = 1000;
+    params.min_trust_box_size = 1e-5;
+    params.min_approx_improve = 1e-10;
+    params.initial_merit_error_coeff = 1;
+    params.convexify_threads = n_threads;
+    params.evaluate_threads = n_threads;
+    solver.initialize(DblVec{ 2, 2 });
+    solver.optimize();
+    return solver.results();
+  };
+
+  OptResults serial = solve(1);
+  OptResults threaded = solve(4);
+  EXPECT_EQ(threaded.status, serial.status);
+  EXPECT_EQ(threaded.n_qp_solves, serial.n_qp_solves);
+  EXPECT_TRUE(threaded.x == serial.x);
+  EXPECT_TRUE(threaded.cost_vals == serial.cost_vals);
+  EXPECT_TRUE(threaded.cnt_viols == serial.cnt_viols);
+}
+
+/** @brief Counts how many terms sharing the counter run at the same time */
+struct ConcurrencyCounter
+{
+  std::atomic<int> active{ 0 };
+  std::atomic<int> max_active{ 0 };
+
+  void enter()
+  {
+    int now = ++active;
+    int max = max_active;
+    while (now > max && !max_active.compare_exchange_weak(max, now))
+    {
+    }
+    // Give other threads the chance to overlap
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  void leave() { --active; }
+};
+
+/** @brief Cost from a function, which records how many such costs are evaluated or convexified at the same time */
+class ConcurrencyCheckCost : public CostFromFunc
+{
+public:
+  ConcurrencyCheckCost(ScalarOfVector::Ptr f, VarVector vars, ConcurrencyCounter& counter)
+    : CostFromFunc(std::move(f), std::move(vars), "f", true), counter_(counter)
+  {
+  }
+  double value(const DblVec& x) override
+  {
+    counter_.enter();
+    double out = CostFromFunc::value(x);
+    counter_.leave();
+    return out;
+  }
+  ConvexObjective::Ptr convex(const DblVec& x, Model* model) override
+  {
+    counter_.enter();
+    ConvexObjective::Ptr out = CostFromFunc::convex(x, model);
+    counter_.leave();
+    return out;
+  }
+
+private:
+  ConcurrencyCounter& counter_;
+};
+
+/** Only terms which declare themselves thread safe may be convexified and evaluated concurrently */
+TEST_P(SQP, ThreadSafeTermsOnly)  // NOLINT
+{
+  auto solve = [this](ConcurrencyCounter& safe, ConcurrencyCounter& unsafe) {
+    OptProb::Ptr prob;
+    setupProblem(prob, 2, GetParam());
+    for (int i = 0; i < 4; ++i)
+    {
+      auto safe_cost =
+          std::make_shared<ConcurrencyCheckCost>(ScalarOfVector::construct(&f_TP7), prob->getVars(), safe);
+      safe_cost->setThreadSafe(true);
+      prob->addCost(safe_cost);
+      prob->addCost(
+          std::make_shared<ConcurrencyCheckCost>(ScalarOfVector::construct(&f_TP7), prob->getVars(), unsafe));
+    }
+    BasicTrustRegionSQP solver(prob);
+    BasicTrustRegionSQPParameters& params = solver.getParameters();
+    params.max_iter = 10;
+    params.convexify_threads = 4;
+    params.evaluate_threads = 4;
+    solver.initialize(DblVec{ 2, 2 });
+    solver.optimize();
+  };
+
+  ConcurrencyCounter safe;
+  ConcurrencyCounter unsafe;
+  solve(safe, unsafe);
+  EXPECT_EQ(unsafe.max_active, 1);
+  // Thread safe terms are run concurrently, but without any guarantee that they actually overlap
+  EXPECT_GE(safe.max_active, 1);
+  EXPECT_LE(safe.max_active, 4);
+}
+
+/** @brief Fixed quadratic cost, whose convexification does not depend on x */
+class ConstantQuadCost : public Cost
+{
+public:
+  ConstantQuadCost(QuadExpr expr, VarVector vars) : Cost("quad"), expr_(std::move(expr)), vars_(std::move(vars)) {}
+  double value(const DblVec& x) override { return expr_.value(x); }
+  ConvexObjective::Ptr convex(const DblVec& /*x*/, Model* model) override
+  {
+    auto out = std::make_shared<ConvexObjective>(model);
+    out->addQuadExpr(expr_);
+    return out;
+  }
+  VarVector getVars() override { return vars_; }
+  bool hasConstantConvexification() override { return true; }
+
+private:
+  QuadExpr expr_;
+  VarVector vars_;
+};
+
+/** Merging the constant costs into a precomputed block must not change the solution */
+TEST_P(SQP, PrecomputeConstantCosts)  // NOLINT
+{
+  auto solve = [this](bool precompute_constant_costs) {
+    OptProb::Ptr prob;
+    setupProblem(prob, 2, GetParam());
+    const VarVector& vars = prob->getVars();
+    prob->addCost(std::make_shared<CostFromFunc>(ScalarOfVector::construct(&f_TP1), vars, "f", true));
+    for (int i = 0; i < 3; ++i)
+    {
+      // Overlapping terms, so the merged block has to combine duplicate entries
+      prob->addCost(std::make_shared<ConstantQuadCost>(exprSquare(exprSub(AffExpr(vars[0]), vars[1])), vars));
+      prob->addCost(std::make_shared<ConstantQuadCost>(exprSquare(exprAdd(AffExpr(vars[1]), -1)), vars));
+    }
+    prob->addConstraint(std::make_shared<ConstraintFromErrFunc>(
+        VectorOfVector::construct(&g_TP1), vars, VectorXd(), INEQ, "g"));
+    BasicTrustRegionSQP solver(prob);
+    BasicTrustRegionSQPParameters& params = solver.getParameters();
+    params.max_iter = 1000;
+    params.min_trust_box_size = 1e-5;
+    params.min_approx_improve = 1e-10;
+    params.initial_merit_error_coeff = 1;
+    params.precompute_constant_costs = precompute_constant_costs;
+    solver.initialize(DblVec{ -2, 1 });
+    solver.optimize();
+    return solver.results();
+  };
+
+  OptResults expected = solve(false);
+  OptResults precomputed = solve(true);
+  EXPECT_EQ(precomputed.status, OPT_CONVERGED);
+  EXPECT_EQ(precomputed.status, expected.status);
+  expectAllNear(precomputed.x, { 1, 1 }, .01);
+  expectAllNear(precomputed.x, expected.x, 1e-4);
+  expectAllNear(precomputed.cost_vals, expected.cost_vals, 1e-4);
+}
+
+TEST_P(SQP, Timings)  // NOLINT
+{
+  OptProb::Ptr prob;
+  setupProblem(prob, 2, GetParam());
+  const VarVector& vars = prob->getVars();
+  prob->addCost(std::make_shared<CostFromFunc>(ScalarOfVector::construct(&f_TP1), vars, "f", true));
+  prob->addConstraint(
+      std::make_shared<ConstraintFromErrFunc>(VectorOfVector::construct(&g_TP1), vars, VectorXd(), INEQ, "g"));
+  BasicTrustRegionSQP solver(prob);
+  solver.initialize(DblVec{ -2, 1 });
+  solver.optimize();
+
+  const OptResults& results = solver.results();
+  const OptTimings& timings = results.timings;
+  EXPECT_GT(timings.total, 0);
+  EXPECT_GT(timings.qp_solve, 0);
+  EXPECT_LE(timings.convexify + timings.update_model + timings.qp_solve + timings.evaluate + timings.callbacks,
+            timings.total);
+
+  ASSERT_EQ(timings.costs.size(), 1);
+  ASSERT_EQ(timings.cnts.size(), 1);
+  EXPECT_EQ(timings.costs[0].name, "f");
+  EXPECT_EQ(timings.cnts[0].name, "g");
+  EXPECT_EQ(timings.costs[0].n_convexify, results.n_sqp_iters);
+  EXPECT_EQ(timings.costs[0].n_evaluate, results.n_func_evals);
+  EXPECT_EQ(timings.cnts[0].n_evaluate, results.n_func_evals);
+}
+
+TEST_P(SQP, CallbackChangingTheTerms)  // NOLINT
+{
+  // The callback moves the minimum of the cost to the current iterate before the second iteration. The cached value
+  // and convexification of the cost at that point are stale then, so the optimizer has to evaluate it again.
+  OptProb::Ptr prob;
+  setupProblem(prob, 1, GetParam());
+  auto target = std::make_shared<double>(0);
+  auto f = [target](const VectorXd& x) { return sq(x(0) - *target); };
+  prob->addCost(std::make_shared<CostFromFunc>(ScalarOfVector::construct(f), prob->getVars(), "f"));
+  BasicTrustRegionSQP solver(prob);
+  solver.getParameters().reuse_unchanged_terms = true;
+
+  solver.addCallback([target](OptProb*, OptResults& results) {
+    if (!results.cost_vals.empty())
+    {
+      EXPECT_DOUBLE_EQ(results.cost_vals[0], sq(results.x[0] - *target));
+    }
+
+    if (results.n_sqp_iters == 1)
+    {
+      *target = results.x[0];
+      results.cost_vals.clear();
+      results.cnt_viols.clear();
+    }
+  });
+
+  solver.initialize(DblVec{ 3 });
+  OptStatus status = solver.optimize();
+  EXPECT_EQ(status, OPT_CONVERGED);
+  EXPECT_LT(*target, 3);
+  EXPECT_NEAR(solver.x()[0], *target, 1e-3);
+}
+
+TEST_P(SQP, RefinementBeforeConvergence)  // NOLINT
+{
+  // The cost approximates its minimum at 0 until the optimizer is about to converge, then the refinement callback
+  // moves it to 1. The optimizer has to continue from there instead of returning the minimum of the approximation.
+  OptProb::Ptr prob;
+  setupProblem(prob, 1, GetParam());
+  auto target = std::make_shared<double>(0);
+  auto f = [target](const VectorXd& x) { return sq(x(0) - *target); };
+  prob->addCost(std::make_shared<CostFromFunc>(ScalarOfVector::construct(f), prob->getVars(), "f"));
+  BasicTrustRegionSQP solver(prob);
+  solver.getParameters().reuse_unchanged_terms = true;
+
+  auto n_refinements = std::make_shared<int>(0);
+  solver.addRefinementCallback([target, n_refinements](OptProb*, const OptResults&, bool converging) {
+    if (!converging || *target == 1)
+      return false;
+
+    *target = 1;
+    ++(*n_refinements);
+    return true;
+  });
+  // The callbacks are called once more after the optimization, they see the values of the refined cost
+  auto final_cost_vals = std::make_shared<DblVec>();
+  solver.addCallback([final_cost_vals](OptProb*, OptResults& results) { *final_cost_vals = results.cost_vals; });
+
+  solver.initialize(DblVec{ 3 });
+  OptStatus status = solver.optimize();
+  EXPECT_EQ(status, OPT_CONVERGED);
+  EXPECT_EQ(*n_refinements, 1);
+  EXPECT_NEAR(solver.x()[0], 1, 1e-3);
+  ASSERT_EQ(final_cost_vals->size(), 1);
+  EXPECT_DOUBLE_EQ((*final_cost_vals)[0], sq(solver.x()[0] - 1));
+  EXPECT_DOUBLE_EQ(solver.results().total_cost, (*final_cost_vals)[0]);
+}
 
 auto getAvailableSolvers = []() {
   std::vector<ModelType> solvers = availableSolvers();
@@ -7,6 +7,9 @@ TRAJOPT_IGNORE_WARNINGS_POP
 
 #include <trajopt_sco/expr_ops.hpp>
 #include <trajopt_sco/solver_interface.hpp>
+#ifdef HAVE_OSQP
+#include <trajopt_sco/osqp_interface.hpp>
+#endif
 #include <trajopt_utils/logging.hpp>
 #include <trajopt_utils/stl_to_string.hpp>
 
@@ -72,6 +75,37 @@ TEST_P(SolverInterface, setup_problem)  // NOLINT
   EXPECT_EQ(solver->getVars().size(), 2);
 }
 
+/** The constant part of the objective is added to the objective, also after the indices of its variables changed */
+TEST_P(SolverInterface, ConstantObjective)  // NOLINT
+{
+  Model::Ptr solver = createModel(GetParam());
+  VarVector vars;
+  for (int i = 0; i < 3; ++i)
+    vars.push_back(solver->addVar("v" + std::to_string(i), -10, 10));
+  solver->update();
+
+  if (!solver->setConstantObjective(exprSquare(exprAdd(AffExpr(vars[1]), -1))))
+    return;
+  solver->setObjective(exprSquare(exprAdd(AffExpr(vars[2]), -2)));
+  ASSERT_EQ(solver->optimize(), CVX_SOLVED);
+  EXPECT_NEAR(solver->getVarValue(vars[1]), 1, 1e-4);
+  EXPECT_NEAR(solver->getVarValue(vars[2]), 2, 1e-4);
+
+  solver->removeVar(vars[0]);
+  solver->update();
+  ASSERT_EQ(solver->optimize(), CVX_SOLVED);
+  EXPECT_NEAR(solver->getVarValue(vars[1]), 1, 1e-4);
+  EXPECT_NEAR(solver->getVarValue(vars[2]), 2, 1e-4);
+
+  QuadExpr objective = exprSquare(exprAdd(AffExpr(vars[1]), 1));
+  exprInc(objective, exprSquare(exprAdd(AffExpr(vars[2]), -2)));
+  EXPECT_TRUE(solver->setConstantObjective(QuadExpr()));
+  solver->setObjective(objective);
+  ASSERT_EQ(solver->optimize(), CVX_SOLVED);
+  EXPECT_NEAR(solver->getVarValue(vars[1]), -1, 1e-4);
+  EXPECT_NEAR(solver->getVarValue(vars[2]), 2, 1e-4);
+}
+
 // Tests multiplying larger terms
 TEST_P(SolverInterface, DISABLED_ExprMult_test1)  // NOLINT // QuadExpr not PSD
 {
@@ -236,6 +270,57 @@ TEST_P(SolverInterface, ExprMult_test3)  // NOLINT
   EXPECT_NEAR(aff12.value(soln), answer, 1e-6);
 }
 
+#ifdef HAVE_OSQP
+// Tests that OSQP only sets up its workspace again if the sparsity changes
+TEST(SolverInterface, OSQPWorkspaceUpdate)  // NOLINT
+{
+  OSQPModel solver;
+  VarVector vars;
+  vars.push_back(solver.addVar("v1"));
+  vars.push_back(solver.addVar("v2"));
+  solver.update();
+
+  // (v1 - 1)^2 + (v2 - 2)^2 s.t. v1 + v2 <= 2
+  QuadExpr obj = exprSquare(exprAdd(AffExpr(vars[0]), -1));
+  exprInc(obj, exprSquare(exprAdd(AffExpr(vars[1]), -2)));
+  solver.setObjective(obj);
+  solver.addIneqCnt(exprAdd(exprAdd(AffExpr(vars[0]), vars[1]), -2), "");
+  solver.setVarBounds(vars, { -10, -10 }, { 10, 10 });
+
+  ASSERT_EQ(solver.optimize(), CVX_SOLVED);
+  EXPECT_EQ(solver.getNumWorkspaceSetups(), 1);
+  EXPECT_EQ(solver.getNumWorkspaceUpdates(), 0);
+  EXPECT_NEAR(solver.getVarValue(vars[0]), 0.5, 1e-3);
+  EXPECT_NEAR(solver.getVarValue(vars[1]), 1.5, 1e-3);
+
+  // Only bounds change
+  solver.setVarBounds(vars, { -10, -10 }, { 10, 1 });
+  ASSERT_EQ(solver.optimize(), CVX_SOLVED);
+  EXPECT_EQ(solver.getNumWorkspaceSetups(), 1);
+  EXPECT_EQ(solver.getNumWorkspaceUpdates(), 1);
+  EXPECT_NEAR(solver.getVarValue(vars[0]), 1, 1e-3);
+  EXPECT_NEAR(solver.getVarValue(vars[1]), 1, 1e-3);
+
+  // Only values change
+  QuadExpr obj2 = exprSquare(exprAdd(AffExpr(vars[0]), -3));
+  exprInc(obj2, exprSquare(exprAdd(AffExpr(vars[1]), 2)));
+  solver.setObjective(obj2);
+  ASSERT_EQ(solver.optimize(), CVX_SOLVED);
+  EXPECT_EQ(solver.getNumWorkspaceSetups(), 1);
+  EXPECT_EQ(solver.getNumWorkspaceUpdates(), 2);
+  EXPECT_NEAR(solver.getVarValue(vars[0]), 3, 1e-3);
+  EXPECT_NEAR(solver.getVarValue(vars[1]), -2, 1e-3);
+
+  // Structural change
+  solver.addEqCnt(exprSub(AffExpr(vars[0]), vars[1]), "");
+  ASSERT_EQ(solver.optimize(), CVX_SOLVED);
+  EXPECT_EQ(solver.getNumWorkspaceSetups(), 2);
+  EXPECT_EQ(solver.getNumWorkspaceUpdates(), 2);
+  EXPECT_NEAR(solver.getVarValue(vars[0]), 0.5, 1e-3);
+  EXPECT_NEAR(solver.getVarValue(vars[1]), 0.5, 1e-3);
+}
+#endif
+
 auto getAvailableSolvers = []() {
   std::vector<ModelType> solvers = availableSolvers();
   auto it = std::find(solvers.begin(), solvers.end(), ModelType::OSQP);
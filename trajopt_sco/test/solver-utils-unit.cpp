@@ -261,3 +261,129 @@ TEST(solver_utils, eigenToCSC_upper_triangular)  // NOLINT
                                                 << "CRC form:\n"
                                                 << CSTR(cols_p);
 }
+
+TEST(solver_utils, exprToCSC)  // NOLINT
+{
+  VarVector x;
+  for (std::size_t i = 0; i < 3; ++i)
+    x.push_back(Var(std::make_shared<VarRep>(i, "x_" + std::to_string(i), nullptr)));
+
+  // q = 1 + x_2 + 2 x_0 x_1 + x_1 x_0 + 3 x_1^2 + x_1^2 - x_2 x_0 (duplicate and mirrored terms)
+  QuadExpr q(AffExpr(1));
+  exprInc(q.affexpr, x[2]);
+  q.coeffs = { 2, 1, 3, 1, -1 };
+  q.vars1 = { x[0], x[1], x[1], x[1], x[2] };
+  q.vars2 = { x[1], x[0], x[1], x[1], x[0] };
+
+  /*
+   * Q = [ 0, 3, -1,
+   *       3, 8,  0,
+   *      -1, 0,  0]
+   */
+  DblVec P;
+  IntVec rows_i;
+  IntVec cols_p;
+  Eigen::VectorXd v;
+  exprToCSC(q, rows_i, cols_p, P, v, 3, true);
+  EXPECT_TRUE((P == DblVec{ 3, -1, 3, 8, -1 })) << "bad P:\n" << CSTR(P);
+  EXPECT_TRUE((rows_i == IntVec{ 1, 2, 0, 1, 0 })) << "bad rows_i:\n" << CSTR(rows_i);
+  EXPECT_TRUE((cols_p == IntVec{ 0, 2, 4, 5 })) << "bad cols_p:\n" << CSTR(cols_p);
+  EXPECT_TRUE(v.isApprox(Eigen::Vector3d(0, 0, 1)));
+
+  exprToCSC(q, rows_i, cols_p, P, v, 3, true, true, true);
+  EXPECT_TRUE((P == DblVec{ 0, 3, 8, -1, 0 })) << "bad P:\n" << CSTR(P);
+  EXPECT_TRUE((rows_i == IntVec{ 0, 0, 1, 0, 2 })) << "bad rows_i:\n" << CSTR(rows_i);
+  EXPECT_TRUE((cols_p == IntVec{ 0, 1, 3, 5 })) << "bad cols_p:\n" << CSTR(cols_p);
+
+  // Same matrix as going through Eigen and taking the upper triangle
+  Eigen::SparseMatrix<double> m_Q;
+  exprToEigen(q, m_Q, v, 3);
+  std::vector<long long int> rows_i_ll, cols_p_ll, rows_i_ll_exp, cols_p_ll_exp;
+  DblVec P_exp;
+  eigenToCSC<Eigen::Upper>(m_Q, rows_i_ll_exp, cols_p_ll_exp, P_exp);
+  exprToCSC(q, rows_i_ll, cols_p_ll, P, v, 3, false, false, true);
+  EXPECT_TRUE(rows_i_ll == rows_i_ll_exp);
+  EXPECT_TRUE(cols_p_ll == cols_p_ll_exp);
+  EXPECT_TRUE(P == P_exp) << "bad P:\n" << CSTR(P) << " vs\n" << CSTR(P_exp);
+
+  q.vars2[0] = Var(std::make_shared<VarRep>(3, "x_3", nullptr));
+  EXPECT_ANY_THROW(exprToCSC(q, rows_i, cols_p, P, v, 3));  // NOLINT
+}
+
+TEST(solver_utils, addCSC)  // NOLINT
+{
+  VarVector x;
+  for (std::size_t i = 0; i < 3; ++i)
+    x.push_back(Var(std::make_shared<VarRep>(i, "x_" + std::to_string(i), nullptr)));
+
+  // a = 2 x_0 x_1 + x_1^2 only refers to the first two variables, b = 3 x_1^2 - x_2 x_0 + x_2^2
+  QuadExpr a, b;
+  a.coeffs = { 2, 1 };
+  a.vars1 = { x[0], x[1] };
+  a.vars2 = { x[1], x[1] };
+  b.coeffs = { 3, -1, 1 };
+  b.vars1 = { x[1], x[2], x[2] };
+  b.vars2 = { x[1], x[0], x[2] };
+
+  DblVec P_a, P, P_exp;
+  IntVec rows_i_a, cols_p_a, rows_i, cols_p, rows_i_exp, cols_p_exp;
+  Eigen::VectorXd v;
+  exprToCSC(a, rows_i_a, cols_p_a, P_a, v, 2, true, false, true);
+  exprToCSC(b, rows_i, cols_p, P, v, 3, true, false, true);
+  addCSC(rows_i_a, cols_p_a, P_a, rows_i, cols_p, P);
+
+  // Same matrix as assembling the sum of the expressions
+  QuadExpr sum = a;
+  exprInc(sum, b);
+  exprToCSC(sum, rows_i_exp, cols_p_exp, P_exp, v, 3, true, false, true);
+  EXPECT_TRUE(rows_i == rows_i_exp) << "bad rows_i:\n" << CSTR(rows_i) << " vs\n" << CSTR(rows_i_exp);
+  EXPECT_TRUE(cols_p == cols_p_exp) << "bad cols_p:\n" << CSTR(cols_p) << " vs\n" << CSTR(cols_p_exp);
+  EXPECT_TRUE(P == P_exp) << "bad P:\n" << CSTR(P) << " vs\n" << CSTR(P_exp);
+}
+
+TEST(solver_utils, exprToCSC_AffExprVector)  // NOLINT
+{
+  VarVector x;
+  for (std::size_t i = 0; i < 3; ++i)
+    x.push_back(Var(std::make_shared<VarRep>(i, "x_" + std::to_string(i), nullptr)));
+
+  // e_0 = 2 x_1 + x_1 - 1, e_1 = 4 x_0 + 0 x_2 + 5 x_2 + 2 (duplicate and zero terms)
+  AffExprVector exprs(2);
+  exprs[0].vars = { x[1], x[1] };
+  exprs[0].coeffs = { 2, 1 };
+  exprs[0].constant = -1;
+  exprs[1].vars = { x[0], x[2], x[2] };
+  exprs[1].coeffs = { 4, 0, 5 };
+  exprs[1].constant = 2;
+
+  /*
+   * A = [ 0, 3, 0,
+   *       4, 0, 5]
+   */
+  DblVec A;
+  IntVec rows_i;
+  IntVec cols_p;
+  Eigen::VectorXd v;
+  exprToCSC(exprs, rows_i, cols_p, A, v, 3);
+  EXPECT_TRUE((A == DblVec{ 4, 3, 5 })) << "bad A:\n" << CSTR(A);
+  EXPECT_TRUE((rows_i == IntVec{ 1, 0, 1 })) << "bad rows_i:\n" << CSTR(rows_i);
+  EXPECT_TRUE((cols_p == IntVec{ 0, 1, 2, 3 })) << "bad cols_p:\n" << CSTR(cols_p);
+  EXPECT_TRUE(v.isApprox(Eigen::Vector2d(1, -2)));
+
+  // With the identity appended, the same matrix as going through Eigen
+  Eigen::SparseMatrix<double> m_A;
+  exprToEigen(exprs, m_A, v, 3);
+  m_A.conservativeResize(5, 3);
+  for (Eigen::Index i = 0; i < 3; ++i)
+    m_A.insert(2 + i, i) = 1;
+  std::vector<long long int> rows_i_ll, cols_p_ll, rows_i_ll_exp, cols_p_ll_exp;
+  DblVec A_exp;
+  eigenToCSC(m_A, rows_i_ll_exp, cols_p_ll_exp, A_exp);
+  exprToCSC(exprs, rows_i_ll, cols_p_ll, A, v, 3, true);
+  EXPECT_TRUE(rows_i_ll == rows_i_ll_exp);
+  EXPECT_TRUE(cols_p_ll == cols_p_ll_exp);
+  EXPECT_TRUE(A == A_exp) << "bad A:\n" << CSTR(A) << " vs\n" << CSTR(A_exp);
+
+  exprs[1].vars[0] = Var(std::make_shared<VarRep>(3, "x_3", nullptr));
+  EXPECT_ANY_THROW(exprToCSC(exprs, rows_i, cols_p, A, v, 3));  // NOLINT
+}
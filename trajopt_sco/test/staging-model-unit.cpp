@@ -0,0 +1,110 @@
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <gtest/gtest.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_sco/expr_ops.hpp>
+#include <trajopt_sco/modeling.hpp>
+#include <trajopt_sco/staging_model.hpp>
+#include <trajopt_utils/thread_pool.hpp>
+#include <bookkeeping_model.hpp>
+
+using namespace sco;
+
+/** @brief Build the convexification of term i, only adding variables to the model like Cost::convex does */
+static ConvexObjective::Ptr convexifyTerm(Model* model, const Var& x, std::size_t i)
+{
+  auto obj = std::make_shared<ConvexObjective>(model);
+  for (std::size_t j = 0; j < i % 3; ++j)
+    obj->addHinge(exprAdd(AffExpr(x), static_cast<double>(i + j)), 1);
+  for (std::size_t j = 0; j < i % 2; ++j)
+    obj->addAbs(exprSub(AffExpr(x), static_cast<double>(i + j)), 2);
+  return obj;
+}
+
+static void expectSameRows(const BookkeepingModel& model1, const BookkeepingModel& model2)
+{
+  ASSERT_EQ(model1.cnt_exprs_.size(), model2.cnt_exprs_.size());
+  for (std::size_t i = 0; i < model1.cnt_exprs_.size(); ++i)
+  {
+    const AffExpr& expr1 = model1.cnt_exprs_[i];
+    const AffExpr& expr2 = model2.cnt_exprs_[i];
+    EXPECT_EQ(expr1.constant, expr2.constant);
+    EXPECT_TRUE(expr1.coeffs == expr2.coeffs);
+    ASSERT_EQ(expr1.vars.size(), expr2.vars.size());
+    for (std::size_t j = 0; j < expr1.vars.size(); ++j)
+      EXPECT_EQ(expr1.vars[j].var_rep->index, expr2.vars[j].var_rep->index);
+  }
+}
+
+TEST(StagingModel, MatchesSerialConvexification)  // NOLINT
+{
+  const std::size_t n_terms = 50;
+
+  BookkeepingModel serial_model;
+  Var serial_x = serial_model.addVar("x");
+  serial_model.update();
+  std::vector<ConvexObjective::Ptr> serial_objs;
+  for (std::size_t i = 0; i < n_terms; ++i)
+    serial_objs.push_back(convexifyTerm(&serial_model, serial_x, i));
+  serial_model.update();
+  for (auto& obj : serial_objs)
+    obj->addConstraintsToModel();
+
+  for (std::size_t n_threads : std::vector<std::size_t>{ 1, 2, 4 })
+  {
+    BookkeepingModel model;
+    Var x = model.addVar("x");
+    model.update();
+
+    std::vector<StagingModel::Ptr> staging_models(n_terms);
+    for (auto& staging_model : staging_models)
+      staging_model = std::make_shared<StagingModel>(&model);
+
+    std::vector<ConvexObjective::Ptr> objs(n_terms);
+    util::ThreadPool pool(n_threads);
+    pool.parallelFor(n_terms, [&](std::size_t i) { objs[i] = convexifyTerm(staging_models[i].get(), x, i); });
+    EXPECT_EQ(model.vars_.size(), 1);
+
+    for (std::size_t i = 0; i < n_terms; ++i)
+      staging_models[i]->commit(*objs[i]);
+    model.update();
+    for (auto& obj : objs)
+      obj->addConstraintsToModel();
+
+    ASSERT_EQ(model.vars_.size(), serial_model.vars_.size());
+    for (std::size_t i = 0; i < model.vars_.size(); ++i)
+    {
+      EXPECT_EQ(model.vars_[i].var_rep->name, serial_model.vars_[i].var_rep->name);
+      EXPECT_EQ(model.lbs_[i], serial_model.lbs_[i]);
+      EXPECT_EQ(model.ubs_[i], serial_model.ubs_[i]);
+    }
+    expectSameRows(model, serial_model);
+
+    // After the commit everything is forwarded, so the convexifications clean up after themselves
+    objs.clear();
+    model.update();
+    EXPECT_EQ(model.vars_.size(), 1);
+    EXPECT_EQ(model.cnts_.size(), 0);
+  }
+}
+
+TEST(StagingModel, RejectsModificationsWhileStaging)  // NOLINT
+{
+  BookkeepingModel model;
+  Var x = model.addVar("x");
+  model.update();
+
+  StagingModel staging_model(&model);
+  EXPECT_ANY_THROW(staging_model.addEqCnt(AffExpr(x), ""));                   // NOLINT
+  EXPECT_ANY_THROW(staging_model.setVarBounds(VarVector{ x }, { 0 }, { 1 }));  // NOLINT
+  EXPECT_ANY_THROW(staging_model.update());                                   // NOLINT
+
+  // Placeholders which are dropped before the commit never reach the model
+  {
+    ConvexObjective obj(&staging_model);
+    obj.addHinge(AffExpr(x), 1);
+  }
+  model.update();
+  EXPECT_EQ(model.vars_.size(), 1);
+}
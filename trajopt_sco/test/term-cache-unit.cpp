@@ -0,0 +1,77 @@
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <gtest/gtest.h>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+#include <trajopt_sco/modeling.hpp>
+#include <trajopt_sco/optimizers.hpp>
+
+using namespace sco;
+
+/** @brief Cost on a subset of the variables which counts how often it is evaluated */
+class CountingCost : public Cost
+{
+public:
+  CountingCost(VarVector vars) : vars_(std::move(vars)) {}
+  double value(const DblVec& x) override
+  {
+    ++n_evals;
+    double out = 0;
+    for (const Var& var : vars_)
+      out += var.value(x);
+    return out;
+  }
+  ConvexObjective::Ptr convex(const DblVec& /*x*/, Model* model) override
+  {
+    return std::make_shared<ConvexObjective>(model);
+  }
+  VarVector getVars() override { return vars_; }
+
+  int n_evals{ 0 };
+
+private:
+  VarVector vars_;
+};
+
+TEST(TermCache, ReusesTermsWhoseVariablesDidNotMove)  // NOLINT
+{
+  VarVector vars;
+  for (std::size_t i = 0; i < 4; ++i)
+    vars.push_back(std::make_shared<VarRep>(i, "x", nullptr));
+
+  std::vector<std::shared_ptr<CountingCost>> costs{ std::make_shared<CountingCost>(VarVector{ vars[0], vars[1] }),
+                                                    std::make_shared<CountingCost>(VarVector{ vars[2] }),
+                                                    std::make_shared<CountingCost>(VarVector{ vars[3] }) };
+  TermCache<double> cache(costs);
+
+  auto evaluate = [&](const DblVec& x) {
+    DblVec out(costs.size());
+    for (std::size_t i = 0; i < costs.size(); ++i)
+    {
+      if (!cache.lookup(i, x, out[i]))
+      {
+        out[i] = costs[i]->value(x);
+        cache.store(i, x, out[i]);
+      }
+    }
+    return out;
+  };
+
+  EXPECT_TRUE((evaluate({ 1, 2, 3, 4 }) == DblVec{ 3, 3, 4 }));
+  EXPECT_EQ(cache.getNumHits(), 0);
+  EXPECT_EQ(cache.getNumMisses(), 3);
+
+  // Only the variable of the last cost moved
+  EXPECT_TRUE((evaluate({ 1, 2, 3, 5 }) == DblVec{ 3, 3, 5 }));
+  EXPECT_EQ(cache.getNumHits(), 2);
+  EXPECT_EQ(cache.getNumMisses(), 4);
+  EXPECT_EQ(costs[0]->n_evals, 1);
+  EXPECT_EQ(costs[1]->n_evals, 1);
+  EXPECT_EQ(costs[2]->n_evals, 2);
+
+  // Any move of a variable of the first cost invalidates it
+  EXPECT_TRUE((evaluate({ 1, 2.5, 3, 5 }) == DblVec{ 3.5, 3, 5 }));
+  EXPECT_EQ(costs[0]->n_evals, 2);
+  EXPECT_EQ(cache.getNumHits(), 4);
+  EXPECT_EQ(cache.getNumMisses(), 5);
+}
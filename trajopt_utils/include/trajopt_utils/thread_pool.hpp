@@ -0,0 +1,65 @@
+#pragma once
+#include <trajopt_utils/macros.h>
+TRAJOPT_IGNORE_WARNINGS_PUSH
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+TRAJOPT_IGNORE_WARNINGS_POP
+
+namespace util
+{
+/**
+ * @brief A fixed set of worker threads which run the iterations of a loop concurrently
+ *
+ * The thread calling parallelFor() takes part in the work, so a pool of size n starts n - 1 threads. Iterations are
+ * handed out in increasing order, the order they finish in is unspecified. Callers which need deterministic results
+ * should write the result of each iteration to its own slot and combine them afterwards.
+ */
+class ThreadPool
+{
+public:
+  using Ptr = std::shared_ptr<ThreadPool>;
+
+  /** @param n_threads The number of threads working on a loop, including the calling thread */
+  explicit ThreadPool(std::size_t n_threads);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ThreadPool(ThreadPool&&) = delete;
+  ThreadPool& operator=(ThreadPool&&) = delete;
+
+  /** @brief The number of threads working on a loop, including the calling thread */
+  std::size_t size() const { return workers_.size() + 1; }
+
+  /**
+   * @brief Call fn(i) for every i in [0, n) and wait for all of them to finish
+   *
+   * If an iteration throws, the remaining iterations still run and the first exception caught is rethrown. This must
+   * not be called from several threads at once or from within fn.
+   */
+  void parallelFor(std::size_t n, const std::function<void(std::size_t)>& fn);
+
+private:
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+
+  const std::function<void(std::size_t)>* fn_{ nullptr };
+  std::size_t n_{ 0 };
+  std::atomic<std::size_t> next_{ 0 };
+  std::size_t generation_{ 0 }; /**< incremented for every loop, wakes up the workers */
+  std::size_t n_busy_{ 0 };     /**< workers which have not finished the current loop yet */
+  bool stop_{ false };
+  std::exception_ptr error_;
+
+  void workerLoop();
+  void runIterations();
+};
+}  // namespace util
@@ -0,0 +1,96 @@
+#include <trajopt_utils/thread_pool.hpp>
+
+namespace util
+{
+ThreadPool::ThreadPool(std::size_t n_threads)
+{
+  for (std::size_t i = 1; i < n_threads; ++i)
+    workers_.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (std::thread& worker : workers_)
+    worker.join();
+}
+
+void ThreadPool::parallelFor(std::size_t n, const std::function<void(std::size_t)>& fn)
+{
+  if (workers_.empty() || n < 2)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      fn(i);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fn_ = &fn;
+    n_ = n;
+    next_ = 0;
+    error_ = nullptr;
+    n_busy_ = workers_.size();
+    ++generation_;
+  }
+  work_cv_.notify_all();
+
+  runIterations();
+
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return n_busy_ == 0; });
+    fn_ = nullptr;
+    error = error_;
+    error_ = nullptr;
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+void ThreadPool::workerLoop()
+{
+  std::size_t generation = 0;
+  for (;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_cv_.wait(lock, [this, generation] { return stop_ || generation_ != generation; });
+      if (stop_)
+        return;
+      generation = generation_;
+    }
+
+    runIterations();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--n_busy_ == 0)
+        done_cv_.notify_one();
+    }
+  }
+}
+
+void ThreadPool::runIterations()
+{
+  for (std::size_t i = next_++; i < n_; i = next_++)
+  {
+    try
+    {
+      (*fn_)(i);
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_)
+        error_ = std::current_exception();
+    }
+  }
+}
+}  // namespace util